@@ -0,0 +1,184 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "df1_protocol.h"
+
+// 帧编码微基准：对比旧的三遍拷贝实现与单遍编码器的每秒帧数
+
+#define BENCH_ITERATIONS 2000000
+
+static uint16_t legacy_crc16_table[256];
+
+static void legacy_init_crc16_table(void)
+{
+    for (unsigned i = 0; i < 256; i++)
+    {
+        uint16_t crc = (uint16_t)i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+        }
+        legacy_crc16_table[i] = crc;
+    }
+}
+
+static uint16_t legacy_crc16(const uint8_t* data, size_t length)
+{
+    uint16_t crc = 0x0000;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = (crc >> 8) ^ legacy_crc16_table[(crc ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+static size_t legacy_add_length(uint8_t* buffer, uint16_t value)
+{
+    if (value < 255)
+    {
+        buffer[0] = (uint8_t)value;
+        return 1;
+    }
+    buffer[0] = 0xFF;
+    buffer[1] = (uint8_t)(value & 0xFF);
+    buffer[2] = (uint8_t)(value >> 8);
+    return 3;
+}
+
+// 旧实现：PDU写入栈缓冲区，再拷贝一次计算CRC，最后转义到输出缓冲区
+static int legacy_build_write_command(const df1_config_t* config, const char* address, const uint8_t* data,
+                                      uint16_t data_length, uint8_t* buffer, size_t buffer_size,
+                                      size_t* actual_size)
+{
+    df1_address_t addr;
+    if (df1_address_parse(address, &addr) != 0)
+    {
+        return -1;
+    }
+
+    uint8_t cmd_buffer[512];
+    size_t cmd_pos = 0;
+    cmd_buffer[cmd_pos++] = config->dst_node;
+    cmd_buffer[cmd_pos++] = config->src_node;
+    cmd_buffer[cmd_pos++] = 0x0F;
+    cmd_buffer[cmd_pos++] = 0x00;
+    cmd_buffer[cmd_pos++] = (uint8_t)(config->transaction_id & 0xFF);
+    cmd_buffer[cmd_pos++] = (uint8_t)(config->transaction_id >> 8);
+    cmd_buffer[cmd_pos++] = data ? DF1_CMD_WRITE : DF1_CMD_READ;
+    cmd_buffer[cmd_pos++] = (uint8_t)(data_length & 0xFF);
+    cmd_pos += legacy_add_length(&cmd_buffer[cmd_pos], addr.db_block);
+    cmd_buffer[cmd_pos++] = (uint8_t)addr.data_code;
+    cmd_pos += legacy_add_length(&cmd_buffer[cmd_pos], addr.address_start);
+    cmd_pos += legacy_add_length(&cmd_buffer[cmd_pos], 0);
+    if (data)
+    {
+        memcpy(&cmd_buffer[cmd_pos], data, data_length);
+        cmd_pos += data_length;
+    }
+
+    size_t packed_pos = 0;
+    buffer[packed_pos++] = 0x10;
+    buffer[packed_pos++] = 0x01;
+    buffer[packed_pos++] = config->station;
+    if (config->station == 0x10)
+    {
+        buffer[packed_pos++] = config->station;
+    }
+    buffer[packed_pos++] = 0x10;
+    buffer[packed_pos++] = 0x02;
+    for (size_t i = 0; i < cmd_pos; i++)
+    {
+        buffer[packed_pos++] = cmd_buffer[i];
+        if (cmd_buffer[i] == 0x10)
+        {
+            buffer[packed_pos++] = 0x10;
+        }
+    }
+    buffer[packed_pos++] = 0x10;
+    buffer[packed_pos++] = 0x03;
+
+    uint8_t crc_data[512];
+    size_t crc_pos = 0;
+    crc_data[crc_pos++] = config->station;
+    crc_data[crc_pos++] = 0x02;
+    memcpy(&crc_data[crc_pos], cmd_buffer, cmd_pos);
+    crc_pos += cmd_pos;
+    crc_data[crc_pos++] = 0x03;
+
+    uint16_t crc = legacy_crc16(crc_data, crc_pos);
+    buffer[packed_pos++] = (uint8_t)(crc >> 8);
+    buffer[packed_pos++] = (uint8_t)(crc & 0xFF);
+
+    *actual_size = packed_pos;
+    return (packed_pos <= buffer_size) ? 0 : -1;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(const char* name, size_t payload, double elapsed)
+{
+    printf("%-28s payload=%3zu  %10.0f frames/s  %7.1f ns/frame\n", name, payload, BENCH_ITERATIONS / elapsed,
+           elapsed * 1e9 / BENCH_ITERATIONS);
+}
+
+int main(void)
+{
+    static const size_t payload_sizes[] = {0, 2, 64, 200};
+    uint8_t payload[256];
+    uint8_t buffer[1024];
+    size_t actual_size = 0;
+    unsigned long checksum = 0;
+
+    legacy_init_crc16_table();
+    for (size_t i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = (uint8_t)(i * 37);
+    }
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+
+    printf("DF1 帧编码微基准 (%d 次迭代)\n", BENCH_ITERATIONS);
+
+    for (size_t s = 0; s < sizeof(payload_sizes) / sizeof(payload_sizes[0]); s++)
+    {
+        size_t size = payload_sizes[s];
+        const uint8_t* data = size ? payload : NULL;
+
+        double start = now_seconds();
+        for (int i = 0; i < BENCH_ITERATIONS; i++)
+        {
+            config.transaction_id = (uint16_t)i;
+            legacy_build_write_command(&config, "N7:0", data, (uint16_t)size, buffer, sizeof(buffer), &actual_size);
+            checksum += buffer[actual_size - 1];
+        }
+        report("legacy (3-pass)", size, now_seconds() - start);
+
+        start = now_seconds();
+        for (int i = 0; i < BENCH_ITERATIONS; i++)
+        {
+            config.transaction_id = (uint16_t)i;
+            if (size)
+            {
+                df1_build_write_command(&config, "N7:0", data, (uint16_t)size, buffer, sizeof(buffer), &actual_size);
+            }
+            else
+            {
+                df1_build_read_command(&config, "N7:0", 0, buffer, sizeof(buffer), &actual_size);
+            }
+            checksum += buffer[actual_size - 1];
+        }
+        report("single-pass encoder", size, now_seconds() - start);
+    }
+
+    // 防止编译器优化掉循环
+    printf("(checksum %lu)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,572 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "df1_protocol.h"
+#include "df1_address.h"
+#include "df1_capture.h"
+#include "df1_crc.h"
+#include "df1_dle.h"
+
+// 协议热路径微基准：地址解析、命令编码、响应解析、流式解码、校验与线路抓包
+//
+// 每个用例先标定迭代次数（单次运行不少于 --min-time 毫秒），之后以相同迭代次数重复
+// --repeat 次，报告中位数与最小值。输入数据固定，迭代次数可用 --iterations 指定，
+// 两次运行之间的结果可以直接比较。输出格式：text（默认）、csv、json（每行一个对象）。
+
+#define BENCH_DEFAULT_REPEAT 5
+#define BENCH_MAX_REPEAT 64
+#define BENCH_DEFAULT_MIN_TIME_MS 100
+
+typedef enum {
+    FORMAT_TEXT,
+    FORMAT_CSV,
+    FORMAT_JSON
+} output_format_t;
+
+typedef struct bench_case bench_case_t;
+
+// 执行 iterations 次操作，返回处理的字节数
+typedef size_t (*bench_fn_t)(const bench_case_t* bench, size_t iterations);
+
+struct bench_case {
+    const char* name; // 用例名称
+    size_t size;      // 数据大小（字节）：载荷、响应数据或校验输入
+    bench_fn_t run;   // 用例函数
+};
+
+// 所有用例共享的输入，在 main 中准备
+static df1_config_t bench_config;
+static uint8_t bench_payload[DF1_MAX_DATA_SIZE];
+static uint8_t bench_block[4096];
+static uint8_t bench_responses[3][DF1_MAX_FRAME_SIZE];
+static size_t bench_response_sizes[3];
+
+static const char* const bench_addresses[] = {
+    "N7:0", "F8:12", "B3:0/5", "T4:0.ACC", "N255:1023", "C5:3.PRE", "L9:7", "ST10:2",
+};
+#define BENCH_ADDRESS_COUNT (sizeof(bench_addresses) / sizeof(bench_addresses[0]))
+
+// 累加每次操作的结果，防止编译器优化掉循环
+static volatile unsigned long bench_sink;
+
+static size_t response_index(size_t size)
+{
+    return size <= 2 ? 0 : (size <= 64 ? 1 : 2);
+}
+
+static size_t run_address_parse(const bench_case_t* bench, size_t iterations)
+{
+    (void)bench;
+    size_t lengths[BENCH_ADDRESS_COUNT];
+    for (size_t i = 0; i < BENCH_ADDRESS_COUNT; i++)
+    {
+        lengths[i] = strlen(bench_addresses[i]);
+    }
+
+    df1_address_t addr;
+    unsigned long sink = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        size_t index = i % BENCH_ADDRESS_COUNT;
+        if (df1_address_parse(bench_addresses[index], &addr) == 0)
+        {
+            sink += addr.address_start;
+        }
+        bytes += lengths[index];
+    }
+    bench_sink += sink;
+    return bytes;
+}
+
+static size_t run_build_read(const bench_case_t* bench, size_t iterations)
+{
+    df1_config_t config = bench_config;
+    uint8_t buffer[DF1_MAX_FRAME_SIZE];
+    size_t actual_size = 0;
+    unsigned long sink = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        config.transaction_id = (uint16_t)i;
+        if (df1_build_read_command(&config, "N7:0", (uint16_t)bench->size, buffer, sizeof(buffer), &actual_size) == 0)
+        {
+            sink += buffer[actual_size - 1];
+            bytes += actual_size;
+        }
+    }
+    bench_sink += sink;
+    return bytes;
+}
+
+// 扫描循环的稳态编码：读命令模板只填入事务ID并修补校验
+static size_t run_template_emit(const bench_case_t* bench, size_t iterations)
+{
+    df1_address_t addr;
+    df1_frame_template_t tmpl;
+    df1_address_parse("N7:0", &addr);
+    if (df1_frame_template_read(&tmpl, &bench_config, &addr, (uint16_t)bench->size) != 0)
+    {
+        return 0;
+    }
+
+    uint8_t buffer[DF1_FRAME_TEMPLATE_SIZE + 2];
+    size_t actual_size = 0;
+    unsigned long sink = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        if (df1_frame_template_emit(&tmpl, (uint16_t)i, buffer, sizeof(buffer), &actual_size) == 0)
+        {
+            sink += buffer[actual_size - 1];
+            bytes += actual_size;
+        }
+    }
+    bench_sink += sink;
+    return bytes;
+}
+
+static size_t run_build_write(const bench_case_t* bench, size_t iterations)
+{
+    df1_config_t config = bench_config;
+    uint8_t buffer[DF1_MAX_FRAME_SIZE];
+    size_t actual_size = 0;
+    unsigned long sink = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        config.transaction_id = (uint16_t)i;
+        if (df1_build_write_command(&config, "N7:0", bench_payload, (uint16_t)bench->size, buffer, sizeof(buffer),
+                                    &actual_size)
+            == 0)
+        {
+            sink += buffer[actual_size - 1];
+            bytes += actual_size;
+        }
+    }
+    bench_sink += sink;
+    return bytes;
+}
+
+static size_t run_parse_response(const bench_case_t* bench, size_t iterations)
+{
+    size_t index = response_index(bench->size);
+    const uint8_t* response = bench_responses[index];
+    size_t response_size = bench_response_sizes[index];
+    uint8_t data[DF1_MAX_DATA_SIZE];
+    size_t actual_size = 0;
+    unsigned long sink = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        if (df1_parse_response(response, response_size, data, sizeof(data), &actual_size) == 0)
+        {
+            sink += actual_size;
+            bytes += response_size;
+        }
+    }
+    bench_sink += sink;
+    return bytes;
+}
+
+static size_t run_decoder_push(const bench_case_t* bench, size_t iterations)
+{
+    size_t index = response_index(bench->size);
+    const uint8_t* response = bench_responses[index];
+    size_t response_size = bench_response_sizes[index];
+    df1_decoder_t decoder;
+    df1_frame_t frame;
+    size_t consumed = 0;
+    unsigned long sink = 0;
+    size_t bytes = 0;
+
+    df1_decoder_init(&decoder, bench_config.check_type);
+    for (size_t i = 0; i < iterations; i++)
+    {
+        if (df1_decoder_push(&decoder, response, response_size, &consumed, &frame) == DF1_DECODE_FRAME)
+        {
+            sink += frame.data_length;
+            bytes += consumed;
+        }
+    }
+    bench_sink += sink;
+    return bytes;
+}
+
+static size_t run_crc16(const bench_case_t* bench, size_t iterations)
+{
+    unsigned long sink = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        sink += df1_crc16((uint16_t)i, bench_block, bench->size);
+    }
+    bench_sink += sink;
+    return iterations * bench->size;
+}
+
+// 指定CRC16内核，当前CPU不支持时返回0
+static size_t run_crc16_kernel(df1_crc16_kernel_t kernel, const bench_case_t* bench, size_t iterations)
+{
+    if (!df1_crc16_supported(kernel))
+    {
+        return 0;
+    }
+
+    unsigned long sink = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        sink += df1_crc16_compute(kernel, (uint16_t)i, bench_block, bench->size);
+    }
+    bench_sink += sink;
+    return iterations * bench->size;
+}
+
+static size_t run_crc16_bytewise(const bench_case_t* bench, size_t iterations)
+{
+    return run_crc16_kernel(DF1_CRC16_BYTEWISE, bench, iterations);
+}
+
+static size_t run_crc16_slice8(const bench_case_t* bench, size_t iterations)
+{
+    return run_crc16_kernel(DF1_CRC16_SLICE8, bench, iterations);
+}
+
+static size_t run_crc16_slice16(const bench_case_t* bench, size_t iterations)
+{
+    return run_crc16_kernel(DF1_CRC16_SLICE16, bench, iterations);
+}
+
+static size_t run_crc16_pclmul(const bench_case_t* bench, size_t iterations)
+{
+    return run_crc16_kernel(DF1_CRC16_PCLMUL, bench, iterations);
+}
+
+// 指定DLE查找内核，逐个找出数据中的DLE（约每256字节一个）；当前CPU不支持时返回0
+static size_t run_dle_kernel(df1_dle_kernel_t kernel, const bench_case_t* bench, size_t iterations)
+{
+    if (!df1_dle_supported(kernel))
+    {
+        return 0;
+    }
+
+    unsigned long sink = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        size_t pos = df1_dle_scan(kernel, bench_block, bench->size);
+        while (pos < bench->size)
+        {
+            sink += pos;
+            pos += 1 + df1_dle_scan(kernel, bench_block + pos + 1, bench->size - pos - 1);
+        }
+    }
+    bench_sink += sink;
+    return iterations * bench->size;
+}
+
+static size_t run_dle_scalar(const bench_case_t* bench, size_t iterations)
+{
+    return run_dle_kernel(DF1_DLE_SCALAR, bench, iterations);
+}
+
+static size_t run_dle_sse2(const bench_case_t* bench, size_t iterations)
+{
+    return run_dle_kernel(DF1_DLE_SSE2, bench, iterations);
+}
+
+static size_t run_dle_avx2(const bench_case_t* bench, size_t iterations)
+{
+    return run_dle_kernel(DF1_DLE_AVX2, bench, iterations);
+}
+
+static size_t run_bcc(const bench_case_t* bench, size_t iterations)
+{
+    unsigned long sink = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        sink += df1_bcc(bench_block + (i & 7), bench->size);
+    }
+    bench_sink += sink;
+    return iterations * bench->size;
+}
+
+// 抓包记录：每32条释放一次缓冲区（没有打开文件），保证不因缓冲区满而丢弃
+static size_t run_capture_record(const bench_case_t* bench, size_t iterations)
+{
+    static df1_capture_t* capture;
+    if (!capture && !(capture = df1_capture_create(0)))
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < iterations; i++)
+    {
+        df1_capture_record(capture, (df1_capture_dir_t)(i & 1), bench_block, bench->size);
+        if ((i & 31) == 31)
+        {
+            df1_capture_flush(capture);
+        }
+    }
+    return iterations * bench->size;
+}
+
+static const bench_case_t bench_cases[] = {
+    {"address_parse", 0, run_address_parse},
+    {"build_read_command", 2, run_build_read},
+    {"build_read_command", 64, run_build_read},
+    {"build_read_command", 236, run_build_read},
+    {"frame_template_emit", 2, run_template_emit},
+    {"frame_template_emit", 236, run_template_emit},
+    {"build_write_command", 2, run_build_write},
+    {"build_write_command", 64, run_build_write},
+    {"build_write_command", 236, run_build_write},
+    {"parse_response", 2, run_parse_response},
+    {"parse_response", 64, run_parse_response},
+    {"parse_response", 236, run_parse_response},
+    {"decoder_push", 2, run_decoder_push},
+    {"decoder_push", 64, run_decoder_push},
+    {"decoder_push", 236, run_decoder_push},
+    {"crc16", 16, run_crc16},
+    {"crc16", 256, run_crc16},
+    {"crc16", 4088, run_crc16},
+    {"crc16_bytewise", 256, run_crc16_bytewise},
+    {"crc16_bytewise", 4088, run_crc16_bytewise},
+    {"crc16_slice8", 256, run_crc16_slice8},
+    {"crc16_slice8", 4088, run_crc16_slice8},
+    {"crc16_slice16", 256, run_crc16_slice16},
+    {"crc16_slice16", 4088, run_crc16_slice16},
+    {"crc16_pclmul", 256, run_crc16_pclmul},
+    {"crc16_pclmul", 4088, run_crc16_pclmul},
+    {"dle_find_scalar", 256, run_dle_scalar},
+    {"dle_find_scalar", 4088, run_dle_scalar},
+    {"dle_find_sse2", 256, run_dle_sse2},
+    {"dle_find_sse2", 4088, run_dle_sse2},
+    {"dle_find_avx2", 256, run_dle_avx2},
+    {"dle_find_avx2", 4088, run_dle_avx2},
+    {"bcc", 16, run_bcc},
+    {"bcc", 256, run_bcc},
+    {"bcc", 4088, run_bcc},
+    {"capture_record", 16, run_capture_record},
+    {"capture_record", 256, run_capture_record},
+};
+#define BENCH_CASE_COUNT (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// 构建读响应帧：DST SRC CMD|0x40 STS TNS 数据
+static int prepare_response(size_t index, size_t data_size)
+{
+    uint8_t pdu[6 + DF1_MAX_DATA_SIZE];
+    pdu[0] = bench_config.src_node;
+    pdu[1] = bench_config.dst_node;
+    pdu[2] = 0x4F;
+    pdu[3] = 0x00;
+    pdu[4] = 0x34;
+    pdu[5] = 0x12;
+    memcpy(&pdu[6], bench_payload, data_size);
+    return df1_build_frame(&bench_config, pdu, 6 + data_size, bench_responses[index], sizeof(bench_responses[index]),
+                           &bench_response_sizes[index]);
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "用法: %s [选项]\n"
+            "  --format text|csv|json  输出格式（默认 text，json 为每行一个对象）\n"
+            "  --filter 名称           只运行名称包含该字符串的用例\n"
+            "  --repeat N              每个用例重复次数（默认 %d，最多 %d）\n"
+            "  --min-time 毫秒         标定迭代次数时单次运行的最短时间（默认 %d）\n"
+            "  --iterations N          固定迭代次数，跳过标定\n"
+            "  --list                  列出用例\n",
+            program, BENCH_DEFAULT_REPEAT, BENCH_MAX_REPEAT, BENCH_DEFAULT_MIN_TIME_MS);
+}
+
+int main(int argc, char* argv[])
+{
+    output_format_t format = FORMAT_TEXT;
+    const char* filter = NULL;
+    int repeat = BENCH_DEFAULT_REPEAT;
+    double min_time = BENCH_DEFAULT_MIN_TIME_MS / 1000.0;
+    size_t fixed_iterations = 0;
+    int list = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--list") == 0)
+        {
+            list = 1;
+            continue;
+        }
+        if (!value)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "--format") == 0)
+        {
+            if (strcmp(value, "text") == 0)
+                format = FORMAT_TEXT;
+            else if (strcmp(value, "csv") == 0)
+                format = FORMAT_CSV;
+            else if (strcmp(value, "json") == 0)
+                format = FORMAT_JSON;
+            else
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "--filter") == 0)
+        {
+            filter = value;
+        }
+        else if (strcmp(arg, "--repeat") == 0)
+        {
+            repeat = atoi(value);
+            if (repeat < 1 || repeat > BENCH_MAX_REPEAT)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "--min-time") == 0)
+        {
+            min_time = atoi(value) / 1000.0;
+        }
+        else if (strcmp(arg, "--iterations") == 0)
+        {
+            fixed_iterations = (size_t)strtoull(value, NULL, 10);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (list)
+    {
+        for (size_t c = 0; c < BENCH_CASE_COUNT; c++)
+        {
+            printf("%s/%zu\n", bench_cases[c].name, bench_cases[c].size);
+        }
+        return 0;
+    }
+
+    // 固定输入：载荷中含有需要转义的 0x10
+    for (size_t i = 0; i < sizeof(bench_payload); i++)
+    {
+        bench_payload[i] = (uint8_t)(i * 37);
+    }
+    for (size_t i = 0; i < sizeof(bench_block); i++)
+    {
+        bench_block[i] = (uint8_t)(i * 131 + 7);
+    }
+    df1_config_init(&bench_config, 1, 1, 0);
+    if (prepare_response(0, 2) != 0 || prepare_response(1, 64) != 0 || prepare_response(2, DF1_MAX_DATA_SIZE) != 0)
+    {
+        fprintf(stderr, "构建响应帧失败\n");
+        return 1;
+    }
+
+    if (format == FORMAT_TEXT)
+    {
+        printf("DF1 协议微基准（重复 %d 次，取中位数）\n", repeat);
+        printf("%-22s %6s %12s %12s %12s %10s\n", "用例", "大小", "迭代次数", "ns/op", "ns/op(min)", "MB/s");
+    }
+    else if (format == FORMAT_CSV)
+    {
+        printf("name,size,iterations,repeat,ns_per_op,ns_per_op_min,mb_per_s\n");
+    }
+
+    for (size_t c = 0; c < BENCH_CASE_COUNT; c++)
+    {
+        const bench_case_t* bench = &bench_cases[c];
+        if (filter && !strstr(bench->name, filter))
+        {
+            continue;
+        }
+
+        // 当前CPU不支持的用例（如没有 PCLMULQDQ 时的折叠内核）不处理任何字节，跳过
+        if (bench->run(bench, 1) == 0)
+        {
+            continue;
+        }
+
+        // 标定：迭代次数翻倍直到单次运行达到 min_time，同时作为预热
+        size_t iterations = fixed_iterations;
+        if (iterations == 0)
+        {
+            iterations = 1;
+            for (;;)
+            {
+                double start = now_seconds();
+                bench->run(bench, iterations);
+                double elapsed = now_seconds() - start;
+                if (elapsed >= min_time || iterations >= ((size_t)1 << 40))
+                {
+                    break;
+                }
+                iterations *= 2;
+            }
+        }
+        else
+        {
+            bench->run(bench, iterations);
+        }
+
+        double samples[BENCH_MAX_REPEAT];
+        size_t bytes = 0;
+        for (int r = 0; r < repeat; r++)
+        {
+            double start = now_seconds();
+            bytes = bench->run(bench, iterations);
+            samples[r] = (now_seconds() - start) * 1e9 / (double)iterations;
+        }
+        qsort(samples, (size_t)repeat, sizeof(samples[0]), compare_double);
+
+        double median = (repeat % 2) ? samples[repeat / 2] : (samples[repeat / 2 - 1] + samples[repeat / 2]) / 2.0;
+        double best = samples[0];
+        double bytes_per_op = (double)bytes / (double)iterations;
+        double mb_per_s = median > 0.0 ? bytes_per_op * 1e3 / median : 0.0;
+
+        switch (format)
+        {
+        case FORMAT_TEXT:
+            printf("%-22s %6zu %12zu %12.1f %12.1f %10.1f\n", bench->name, bench->size, iterations, median, best,
+                   mb_per_s);
+            break;
+        case FORMAT_CSV:
+            printf("%s,%zu,%zu,%d,%.3f,%.3f,%.3f\n", bench->name, bench->size, iterations, repeat, median, best,
+                   mb_per_s);
+            break;
+        case FORMAT_JSON:
+            printf("{\"name\":\"%s\",\"size\":%zu,\"iterations\":%zu,\"repeat\":%d,\"ns_per_op\":%.3f,"
+                   "\"ns_per_op_min\":%.3f,\"mb_per_s\":%.3f}\n",
+                   bench->name, bench->size, iterations, repeat, median, best, mb_per_s);
+            break;
+        }
+        fflush(stdout);
+    }
+
+    if (format == FORMAT_TEXT)
+    {
+        printf("(checksum %lu)\n", (unsigned long)bench_sink);
+    }
+    return 0;
+}
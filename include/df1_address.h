@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,10 +35,21 @@ typedef struct {
     uint16_t db_block;            // 文件号
     uint16_t address_start;       // 起始地址
     uint16_t length;              // 数据长度
+    uint16_t sub_element;         // 子元素号，如 T4:0.ACC 为2
+    uint8_t bit;                  // 位号（has_bit 为真时有效）
+    bool has_bit;                 // 是否为位地址，如 B3:0/5、T4:0/DN
 } df1_address_t;
 
 /**
  * @brief 解析DF1地址字符串
+ *
+ * 支持的格式：
+ * - 元素：N7:0、F8:12、I:0
+ * - 位：B3:0/5、N7:2/15，B 文件可省略元素写作 B3/37（即 B3:2/5）
+ * - 子元素：T4:0.PRE、T4:0.ACC、C5:1.PRE、R6:0.LEN、R6:0.POS
+ * - 控制位：T4:0/DN、C5:0.CU、R6:0/EN 等，位于子元素0
+ *
+ * 子元素只用于 T、C、R 文件（0~2），F、L、ST 文件不接受位地址。
  * 
  * @param address_str 地址字符串，如 "N7:1"
  * @param addr 输出的地址结构体
@@ -55,6 +67,17 @@ int df1_address_parse(const char* address_str, df1_address_t* addr);
  */
 int df1_address_to_string(const df1_address_t* addr, char* buffer, size_t buffer_size);
 
+/**
+ * @brief 获取数据类型单个元素的字节数
+ *
+ * 定时器、计数器、控制元素为3个字，字符串元素为84字节，整数、位、状态、输入输出与ASCII
+ * 元素为1个字，浮点与长整数为2个字。
+ *
+ * @param data_code 数据类型代码
+ * @return 元素字节数，未知类型返回0
+ */
+size_t df1_address_element_size(df1_addr_type_t data_code);
+
 #ifdef __cplusplus
 }
 #endif
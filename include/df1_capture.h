@@ -0,0 +1,157 @@
+#ifndef AB_DF1_CAPTURE_H_
+#define AB_DF1_CAPTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/uio.h>
+#include "df1_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 单条抓包记录的最大数据字节数，更长的一次收发拆成多条记录
+ */
+#define DF1_CAPTURE_MAX_RECORD 2048
+
+/**
+ * @brief 抓包缓冲区的默认大小（字节）
+ */
+#define DF1_CAPTURE_DEFAULT_SIZE (64 * 1024)
+
+/**
+ * @brief 抓包文件的魔数与版本
+ */
+#define DF1_TRACE_MAGIC "DF1TRACE"
+#define DF1_TRACE_VERSION 1
+
+/**
+ * @brief 数据方向
+ */
+typedef enum {
+    DF1_CAPTURE_TX = 0,        // 本端发送
+    DF1_CAPTURE_RX = 1         // 本端接收
+} df1_capture_dir_t;
+
+/**
+ * @brief 线路抓包环形缓冲区
+ *
+ * 传输层每次成功收发后把线路字节连同单调时钟时间戳写入缓冲区，写入方是驱动连接的
+ * 线程，不加锁；df1_capture_flush 可在其他线程中把已写入的记录追加到抓包文件。
+ * 缓冲区满时丢弃新记录并计数，不阻塞收发。
+ */
+typedef struct df1_capture df1_capture_t;
+
+/**
+ * @brief 抓包文件头
+ */
+typedef struct {
+    df1_duplex_t duplex;       // 链路工作方式
+    df1_check_type_t check_type; // 校验类型
+    uint64_t start_ns;         // 打开文件时的单调时钟（纳秒），与记录时间戳同一时基
+    uint64_t start_realtime_ns; // 打开文件时的系统时间（纳秒，UNIX 纪元）
+} df1_trace_header_t;
+
+/**
+ * @brief 抓包文件中的一条记录
+ */
+typedef struct {
+    uint64_t timestamp_ns;     // 收发完成时的单调时钟（纳秒）
+    df1_capture_dir_t direction; // 方向
+    size_t size;               // 数据字节数
+    uint8_t data[DF1_CAPTURE_MAX_RECORD]; // 线路字节
+} df1_trace_record_t;
+
+/**
+ * @brief 创建抓包缓冲区
+ *
+ * @param size 缓冲区大小（字节），向上取整为2的幂，0 使用 DF1_CAPTURE_DEFAULT_SIZE
+ * @return 抓包缓冲区，失败返回NULL
+ */
+df1_capture_t* df1_capture_create(size_t size);
+
+/**
+ * @brief 销毁抓包缓冲区：写出剩余记录并关闭文件
+ *
+ * 调用前应先从传输层上取消（或关闭连接）。
+ *
+ * @param capture 抓包缓冲区
+ */
+void df1_capture_destroy(df1_capture_t* capture);
+
+/**
+ * @brief 打开抓包文件并写入文件头
+ *
+ * @param capture 抓包缓冲区
+ * @param path 文件路径，已存在时覆盖
+ * @param config DF1协议配置，记录链路工作方式与校验类型供离线解码
+ * @return 0 成功，-1 失败
+ */
+int df1_capture_open_file(df1_capture_t* capture, const char* path, const df1_config_t* config);
+
+/**
+ * @brief 把缓冲区中的记录追加到抓包文件
+ *
+ * 可在任意线程中调用（多个调用者之间互斥），不影响写入方。没有打开文件时丢弃记录。
+ *
+ * @param capture 抓包缓冲区
+ * @return 写出的记录数，-1 写文件失败
+ */
+int df1_capture_flush(df1_capture_t* capture);
+
+/**
+ * @brief 记录一次收发（只能由驱动连接的线程调用）
+ *
+ * @param capture 抓包缓冲区
+ * @param direction 方向
+ * @param data 线路字节
+ * @param size 字节数
+ */
+void df1_capture_record(df1_capture_t* capture, df1_capture_dir_t direction, const uint8_t* data, size_t size);
+
+/**
+ * @brief 记录一次分散到多个缓冲区的接收（只能由驱动连接的线程调用）
+ *
+ * @param capture 抓包缓冲区
+ * @param direction 方向
+ * @param iov 缓冲区数组
+ * @param count 缓冲区个数
+ * @param size 实际收发的字节数，按顺序取自各缓冲区
+ */
+void df1_capture_record_iov(df1_capture_t* capture, df1_capture_dir_t direction, const struct iovec* iov,
+                            int count, size_t size);
+
+/**
+ * @brief 获取因缓冲区满而丢弃的记录数
+ *
+ * @param capture 抓包缓冲区
+ * @return 丢弃的记录数
+ */
+uint64_t df1_capture_dropped(const df1_capture_t* capture);
+
+/**
+ * @brief 读取抓包文件头
+ *
+ * @param file 以二进制方式打开的抓包文件
+ * @param header 输出文件头
+ * @return 0 成功，-1 不是抓包文件或版本不支持
+ */
+int df1_trace_read_header(FILE* file, df1_trace_header_t* header);
+
+/**
+ * @brief 读取下一条记录
+ *
+ * @param file 抓包文件（已读取文件头）
+ * @param record 输出记录
+ * @return 1 读到记录，0 文件结束，-1 文件损坏
+ */
+int df1_trace_read_record(FILE* file, df1_trace_record_t* record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_CAPTURE_H_
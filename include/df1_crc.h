@@ -0,0 +1,77 @@
+#ifndef AB_DF1_CRC_H_
+#define AB_DF1_CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CRC16 计算内核
+ *
+ * 所有内核计算相同的 CRC-16/ARC（多项式 0xA001 反射、初值由调用者给出、无输出异或），
+ * 结果逐位相同，只是速度不同。
+ */
+typedef enum {
+    DF1_CRC16_AUTO = 0,        // 按CPU特性自动选择
+    DF1_CRC16_BYTEWISE = 1,    // 逐字节查表（256项）
+    DF1_CRC16_SLICE8 = 2,      // 每次8字节，8张表
+    DF1_CRC16_SLICE16 = 3,     // 每次16字节，16张表
+    DF1_CRC16_PCLMUL = 4       // x86 无进位乘法（PCLMULQDQ）折叠，每次64字节
+} df1_crc16_kernel_t;
+
+/**
+ * @brief 判断当前CPU是否支持某个内核
+ *
+ * @param kernel 内核
+ * @return 支持返回 true；DF1_CRC16_AUTO 始终支持
+ */
+bool df1_crc16_supported(df1_crc16_kernel_t kernel);
+
+/**
+ * @brief 选择 df1_crc16 与帧编码、解码使用的内核
+ *
+ * 默认在第一次计算时按CPU特性自动选择：支持 PCLMULQDQ 时使用折叠内核，否则使用
+ * 每次16字节的查表内核；短数据始终逐字节计算。选择对整个进程生效。
+ *
+ * @param kernel 内核，DF1_CRC16_AUTO 恢复自动选择
+ * @return 0 成功，-1 当前CPU不支持
+ */
+int df1_crc16_select(df1_crc16_kernel_t kernel);
+
+/**
+ * @brief 当前使用的内核（自动选择的结果）
+ *
+ * @return 内核
+ */
+df1_crc16_kernel_t df1_crc16_active(void);
+
+/**
+ * @brief 内核名称，如 "slice16"
+ *
+ * @param kernel 内核
+ * @return 名称字符串
+ */
+const char* df1_crc16_kernel_name(df1_crc16_kernel_t kernel);
+
+/**
+ * @brief 使用指定内核计算一段数据的CRC16，与 df1_crc16 的结果相同
+ *
+ * 供测试与基准对比各内核使用。
+ *
+ * @param kernel 内核，DF1_CRC16_AUTO 或当前CPU不支持时使用 df1_crc16_select 选择的内核
+ * @param crc 初值或上一段的累加值
+ * @param data 数据
+ * @param length 数据长度
+ * @return 累加后的CRC16
+ */
+uint16_t df1_crc16_compute(df1_crc16_kernel_t kernel, uint16_t crc, const uint8_t* data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_CRC_H_
@@ -0,0 +1,84 @@
+#ifndef AB_DF1_DLE_H_
+#define AB_DF1_DLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief DLE 查找内核
+ *
+ * 帧编码转义与解码去转义时按向量宽度查找下一个 DLE（0x10），两个 DLE 之间的数据整段复制。
+ * 所有内核结果相同，只是速度不同。
+ */
+typedef enum {
+    DF1_DLE_AUTO = 0,          // 按CPU特性自动选择
+    DF1_DLE_SCALAR = 1,        // 每次8字节的整数位运算，适用于所有平台
+    DF1_DLE_SSE2 = 2,          // x86 SSE2，每次16字节
+    DF1_DLE_AVX2 = 3           // x86 AVX2，每次32字节
+} df1_dle_kernel_t;
+
+/**
+ * @brief 查找第一个 DLE（0x10）
+ *
+ * @param data 数据
+ * @param length 数据长度
+ * @return DLE 的下标，没有时返回 length
+ */
+size_t df1_dle_find(const uint8_t* data, size_t length);
+
+/**
+ * @brief 判断当前CPU是否支持某个内核
+ *
+ * @param kernel 内核
+ * @return 支持返回 true；DF1_DLE_AUTO 始终支持
+ */
+bool df1_dle_supported(df1_dle_kernel_t kernel);
+
+/**
+ * @brief 选择 df1_dle_find 与帧编码、解码使用的内核
+ *
+ * 默认在第一次查找时按CPU特性自动选择：支持 AVX2 时使用 AVX2，x86 上否则使用 SSE2，
+ * 其他平台使用整数位运算。选择对整个进程生效。
+ *
+ * @param kernel 内核，DF1_DLE_AUTO 恢复自动选择
+ * @return 0 成功，-1 当前CPU不支持
+ */
+int df1_dle_select(df1_dle_kernel_t kernel);
+
+/**
+ * @brief 当前使用的内核（自动选择的结果）
+ *
+ * @return 内核
+ */
+df1_dle_kernel_t df1_dle_active(void);
+
+/**
+ * @brief 内核名称，如 "avx2"
+ *
+ * @param kernel 内核
+ * @return 名称字符串
+ */
+const char* df1_dle_kernel_name(df1_dle_kernel_t kernel);
+
+/**
+ * @brief 使用指定内核查找第一个 DLE，与 df1_dle_find 的结果相同
+ *
+ * 供测试与基准对比各内核使用。
+ *
+ * @param kernel 内核，DF1_DLE_AUTO 或当前CPU不支持时使用 df1_dle_select 选择的内核
+ * @param data 数据
+ * @param length 数据长度
+ * @return DLE 的下标，没有时返回 length
+ */
+size_t df1_dle_scan(df1_dle_kernel_t kernel, const uint8_t* data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_DLE_H_
@@ -0,0 +1,235 @@
+#ifndef AB_DF1_LINK_H_
+#define AB_DF1_LINK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "df1_protocol.h"
+#include "df1_stats.h"
+#include "df1_rtt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 链路层同时未完成命令数量上限
+ */
+#define DF1_LINK_MAX_OUTSTANDING 16
+
+/**
+ * @brief 链路层发送缓冲区大小
+ */
+#define DF1_LINK_TX_BUFFER_SIZE (DF1_MAX_FRAME_SIZE + 64)
+
+/**
+ * @brief 命令完成回调
+ *
+ * @param user_data 提交命令时传入的用户数据
+ * @param status 0 收到响应帧，-1 命令失败（NAK/ENQ次数用尽或响应超时）
+ * @param reply 响应帧，仅在回调期间有效；失败时为NULL
+ */
+typedef void (*df1_link_callback_t)(void* user_data, int status, const df1_frame_t* reply);
+
+/**
+ * @brief 链路层配置
+ */
+typedef struct {
+    int max_outstanding;       // 同时未完成命令数（1..DF1_LINK_MAX_OUTSTANDING）
+    int ack_timeout_ms;        // 全双工：等待 DLE ACK 的超时，超时后发送 DLE ENQ
+    int reply_timeout_ms;      // 命令被确认后等待响应帧的超时
+    int max_nak;               // 全双工：收到 NAK 后的最多重发次数
+    int max_enq;               // 全双工：ACK 超时后的最多 ENQ 次数
+} df1_link_config_t;
+
+/**
+ * @brief 链路层中的一个未完成命令
+ */
+typedef struct {
+    bool in_use;               // 是否占用
+    bool acked;                // 是否已被链路层确认
+    uint16_t tns;              // 事务ID
+    long long deadline_ms;     // 当前等待的截止时间（ACK或响应）
+    int nak_count;             // 已收到的 NAK 次数
+    int enq_count;             // 已发送的 ENQ 次数
+    int retries;               // 自适应超时：无应答后以新事务ID重发的次数
+    long long sent_ms;         // 最近一次写入发送缓冲区的时间，用于往返样本
+    size_t reply_bytes;        // 期望的响应帧在线路上的字节数，自适应超时按它加上传输时间
+    long long expire_ms;       // 等待响应的最终期限（reply_timeout_ms），重发不延长
+    bool fast_fail;            // 从站离线，未发送即在下一次 tick 时失败
+    df1_link_callback_t callback; // 完成回调
+    void* user_data;           // 回调用户数据
+    size_t frame_size;         // 已编码命令帧长度
+    uint8_t frame[DF1_MAX_FRAME_SIZE]; // 已编码命令帧，用于重发
+#ifdef DF1_ENABLE_STATS
+    uint64_t submit_ns;        // 提交时间（纳秒）
+#endif
+} df1_link_slot_t;
+
+/**
+ * @brief DF1链路层状态机
+ *
+ * 链路层不直接进行任何 I/O：调用者通过 df1_link_input 输入收到的字节，通过
+ * df1_link_output / df1_link_output_done 取出待发送的字节，并在
+ * df1_link_next_deadline 给出的时间调用 df1_link_tick。
+ *
+ * 全双工方式下实现 DLE ACK/NAK 应答、ACK 超时后的 DLE ENQ、NAK 重发以及重复消息检测；
+ * 命令一经确认即可发送下一条命令，多个命令的响应按事务ID匹配。
+ * 半双工方式下不做链路应答，同一时间只有一个未完成命令。
+ *
+ * 设置 rtt 后 ACK 与响应的超时按测得的往返时间计算，ENQ 间隔每次加倍；响应超时的命令
+ * 以从 tns_counter 分配的新事务ID重发（本库的读、写与掩码写都可以重复执行），从站离线时命令
+ * 不发送直接失败。
+ */
+typedef struct {
+    df1_link_config_t config;  // 链路配置
+    df1_duplex_t duplex;       // 链路工作方式
+    df1_decoder_t decoder;     // 接收帧解码器
+    df1_link_slot_t slots[DF1_LINK_MAX_OUTSTANDING]; // 命令槽
+    int tx_queue[DF1_LINK_MAX_OUTSTANDING]; // 等待发送的命令槽（先进先出）
+    size_t tx_queue_head;      // 发送队列读取计数
+    size_t tx_queue_tail;      // 发送队列写入计数
+    int awaiting_ack;          // 正在等待 ACK 的命令槽，-1 表示无
+    size_t outstanding;        // 未完成命令数
+    uint8_t last_response;     // 最近一次发送的链路应答（ACK/NAK），用于回应 ENQ
+    bool has_last_message;     // 是否已收到过消息
+    uint8_t last_src;          // 最近一次收到消息的源节点（重复检测）
+    uint8_t last_cmd;          // 最近一次收到消息的命令字节（重复检测）
+    uint16_t last_tns;         // 最近一次收到消息的事务ID（重复检测）
+    uint8_t tx_buffer[DF1_LINK_TX_BUFFER_SIZE]; // 待发送字节
+    size_t tx_pos;             // 已取走的字节数
+    size_t tx_len;             // 待发送字节末尾
+    long long now_ms;          // 最近一次调用时传入的时间
+    unsigned long naks_sent;   // 发送的 NAK 次数
+    unsigned long duplicates;  // 丢弃的重复消息数
+    df1_rtt_t* rtt;            // 自适应超时，NULL 表示使用配置中的固定超时；df1_link_init 之后由所属连接设置
+    uint16_t* tns_counter;     // 重发使用的事务ID计数器，与新命令共用；NULL 表示不重发；df1_link_init 之后由所属连接设置
+#ifdef DF1_ENABLE_STATS
+    df1_stats_t* stats;        // 统计，NULL 表示不记录；df1_link_init 之后由所属连接设置
+#endif
+} df1_link_t;
+
+/**
+ * @brief 初始化链路层配置为默认值
+ *
+ * @param config 链路配置
+ * @param timeout_ms 等待ACK与响应的超时（毫秒）
+ */
+void df1_link_config_default(df1_link_config_t* config, int timeout_ms);
+
+/**
+ * @brief 初始化链路层
+ *
+ * @param link 链路层
+ * @param config 链路配置，NULL 表示使用1秒超时的默认配置
+ * @param duplex 链路工作方式
+ * @param check_type 校验类型
+ */
+void df1_link_init(df1_link_t* link, const df1_link_config_t* config, df1_duplex_t duplex,
+                   df1_check_type_t check_type);
+
+/**
+ * @brief 丢弃所有未完成命令（以失败状态回调）和待发送数据
+ *
+ * @param link 链路层
+ */
+void df1_link_reset(df1_link_t* link);
+
+/**
+ * @brief 当前是否可以提交新命令
+ *
+ * @param link 链路层
+ * @return true 未完成命令数低于上限
+ */
+bool df1_link_can_submit(const df1_link_t* link);
+
+/**
+ * @brief 提交一个已编码的命令帧
+ *
+ * @param link 链路层
+ * @param frame 已编码的命令帧
+ * @param frame_size 命令帧长度
+ * @param tns 命令的事务ID，用于匹配响应
+ * @param now_ms 当前单调时间（毫秒）
+ * @param callback 完成回调
+ * @param user_data 回调用户数据
+ * @return 0 成功，-1 未完成命令已达上限或参数无效
+ */
+int df1_link_submit(df1_link_t* link, const uint8_t* frame, size_t frame_size, uint16_t tns,
+                   long long now_ms, df1_link_callback_t callback, void* user_data);
+
+/**
+ * @brief 提交一个已编码的命令帧，并给出期望的响应长度
+ *
+ * 与 df1_link_submit 相同；设置了自适应超时时，等待响应的超时按 reply_bytes 加上响应的
+ * 传输时间，而不是按最大数据长度的响应估计。
+ *
+ * @param link 链路层
+ * @param frame 已编码的命令帧
+ * @param frame_size 命令帧长度
+ * @param tns 命令的事务ID，用于匹配响应
+ * @param reply_bytes 期望的响应帧在线路上的字节数，0 表示未知
+ * @param now_ms 当前单调时间（毫秒）
+ * @param callback 完成回调
+ * @param user_data 回调用户数据
+ * @return 0 成功，-1 未完成命令已达上限或参数无效
+ */
+int df1_link_submit_expect(df1_link_t* link, const uint8_t* frame, size_t frame_size, uint16_t tns,
+                           size_t reply_bytes, long long now_ms, df1_link_callback_t callback, void* user_data);
+
+/**
+ * @brief 输入从线路上收到的字节
+ *
+ * @param link 链路层
+ * @param data 收到的数据
+ * @param length 数据长度
+ * @param now_ms 当前单调时间（毫秒）
+ */
+void df1_link_input(df1_link_t* link, const uint8_t* data, size_t length, long long now_ms);
+
+/**
+ * @brief 处理超时（ENQ、重发与响应超时）
+ *
+ * @param link 链路层
+ * @param now_ms 当前单调时间（毫秒）
+ */
+void df1_link_tick(df1_link_t* link, long long now_ms);
+
+/**
+ * @brief 获取最近的超时时间
+ *
+ * @param link 链路层
+ * @return 单调时间（毫秒），没有等待中的命令时返回 -1
+ */
+long long df1_link_next_deadline(const df1_link_t* link);
+
+/**
+ * @brief 获取待发送的字节
+ *
+ * @param link 链路层
+ * @param data 输出待发送数据指针
+ * @return 待发送字节数
+ */
+size_t df1_link_output(const df1_link_t* link, const uint8_t** data);
+
+/**
+ * @brief 标记已发送的字节
+ *
+ * @param link 链路层
+ * @param length 已发送的字节数
+ */
+void df1_link_output_done(df1_link_t* link, size_t length);
+
+/**
+ * @brief 获取未完成命令数
+ *
+ * @param link 链路层
+ * @return 未完成命令数
+ */
+size_t df1_link_outstanding(const df1_link_t* link);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_LINK_H_
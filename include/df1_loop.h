@@ -0,0 +1,130 @@
+#ifndef AB_DF1_LOOP_H_
+#define AB_DF1_LOOP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "df1_serial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 异步请求完成回调
+ *
+ * 调用时请求的 status / actual_size / sts / ext_sts 已填写。回调中可以继续提交请求，
+ * 但不能移除连接或销毁事件循环。
+ *
+ * @param user_data 提交请求时传入的用户数据
+ * @param port 请求所属的连接
+ * @param request 已完成的请求
+ */
+typedef void (*df1_loop_callback_t)(void* user_data, df1_serial_t* port, df1_request_t* request);
+
+/**
+ * @brief 事件循环：一个线程驱动任意数量的连接
+ *
+ * 所有连接的文件描述符与一个定时器注册在同一个 epoll 实例上，每个连接的链路层
+ * 超时（ACK、响应）按最近截止时间保存在最小堆中，定时器始终指向堆顶。
+ * 可以直接调用 df1_loop_run，也可以将 df1_loop_fd 加入已有的事件循环，
+ * 在其可读时调用 df1_loop_process(loop, 0)。
+ */
+typedef struct df1_loop df1_loop_t;
+
+/**
+ * @brief 创建事件循环
+ *
+ * @return 事件循环指针，失败返回NULL
+ */
+df1_loop_t* df1_loop_create(void);
+
+/**
+ * @brief 销毁事件循环，未完成的请求以失败状态回调
+ *
+ * 连接本身不会被关闭。
+ *
+ * @param loop 事件循环
+ */
+void df1_loop_destroy(df1_loop_t* loop);
+
+/**
+ * @brief 将已打开的连接加入事件循环
+ *
+ * 加入后该连接只能通过事件循环访问，不能同时使用同步读写接口。
+ * 传输层必须提供文件描述符（串口、TCP、伪终端），内存回环不能加入。
+ * 读写出错或对端关闭（TCP 读到连接结束、终端挂断）后不再监听该连接，
+ * 其上未完成的请求以失败状态回调，之后的提交直接失败。
+ *
+ * @param loop 事件循环
+ * @param port 已打开的连接
+ * @return 0 成功，-1 失败
+ */
+int df1_loop_add(df1_loop_t* loop, df1_serial_t* port);
+
+/**
+ * @brief 将连接移出事件循环，该连接上未完成的请求以失败状态回调
+ *
+ * @param loop 事件循环
+ * @param port 连接
+ * @return 0 成功，-1 连接不在事件循环中
+ */
+int df1_loop_remove(df1_loop_t* loop, df1_serial_t* port);
+
+/**
+ * @brief 提交一条异步请求
+ *
+ * 请求进入连接的等待队列，在链路层窗口允许时发送（全双工最多
+ * link_config.max_outstanding 条同时在途，半双工一次一条）。
+ * 完成之前请求及其缓冲区必须保持有效。
+ *
+ * @param loop 事件循环
+ * @param port 已加入事件循环的连接
+ * @param request 请求
+ * @param callback 完成回调
+ * @param user_data 回调用户数据
+ * @return 0 成功，-1 失败
+ */
+int df1_loop_submit(df1_loop_t* loop, df1_serial_t* port, df1_request_t* request, df1_loop_callback_t callback,
+                    void* user_data);
+
+/**
+ * @brief 获取可加入外部事件循环的文件描述符
+ *
+ * 任一连接可读写或有超时到期时该描述符可读。
+ *
+ * @param loop 事件循环
+ * @return 文件描述符，失败返回-1
+ */
+int df1_loop_fd(const df1_loop_t* loop);
+
+/**
+ * @brief 处理一轮事件：收发数据、处理到期的超时并回调已完成的请求
+ *
+ * @param loop 事件循环
+ * @param timeout_ms 没有事件时最多等待的时间，0 表示不等待，-1 表示一直等待
+ * @return 本轮完成的请求数，失败返回-1
+ */
+int df1_loop_process(df1_loop_t* loop, int timeout_ms);
+
+/**
+ * @brief 运行事件循环直到所有已提交的请求完成
+ *
+ * @param loop 事件循环
+ * @param timeout_ms 超时（毫秒）
+ * @return 0 全部完成，-1 超时或失败
+ */
+int df1_loop_run(df1_loop_t* loop, int timeout_ms);
+
+/**
+ * @brief 获取已提交但尚未完成的请求数
+ *
+ * @param loop 事件循环
+ * @return 请求数
+ */
+size_t df1_loop_pending(const df1_loop_t* loop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_LOOP_H_
@@ -0,0 +1,188 @@
+#ifndef AB_DF1_MASTER_H_
+#define AB_DF1_MASTER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "df1_serial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 一条多点线路上的从站数量上限
+ */
+#define DF1_MASTER_MAX_STATIONS 32
+
+/**
+ * @brief 每个从站的请求队列长度（等待发送与等待响应各自的上限）
+ */
+#define DF1_MASTER_QUEUE_SIZE 32
+
+/**
+ * @brief 轮询主站配置
+ */
+typedef struct {
+    int ack_timeout_ms;        // 发送命令后等待从站 DLE ACK 的超时
+    int poll_timeout_ms;       // 发送轮询包后等待从站消息或 DLE EOT 的超时
+    int reply_timeout_ms;      // 命令被确认后等待响应的超时
+    int busy_poll_ms;          // 有等待响应命令的从站的轮询间隔
+    int idle_poll_min_ms;      // 空闲从站的初始轮询间隔
+    int idle_poll_max_ms;      // 空闲从站的轮询间隔上限，每次 DLE EOT 后加倍
+    int max_retries;           // 命令收到 NAK 或 ACK 超时后的最多重发次数
+    int max_outstanding;       // 每个从站同时等待响应的命令数（1..DF1_MASTER_QUEUE_SIZE）
+} df1_master_config_t;
+
+/**
+ * @brief 从站主动上报（不对应任何已发送命令）的消息回调
+ *
+ * @param user_data 设置回调时传入的用户数据
+ * @param station 发送该消息的从站站号
+ * @param message 消息帧，仅在回调期间有效
+ */
+typedef void (*df1_master_message_callback_t)(void* user_data, uint8_t station, const df1_frame_t* message);
+
+/**
+ * @brief 已被从站确认、等待响应的命令
+ */
+typedef struct {
+    df1_request_t* request;    // 请求
+    uint16_t tns;              // 事务ID
+    long long deadline_ms;     // 响应截止时间
+} df1_master_pending_t;
+
+/**
+ * @brief 轮询主站中的一个从站
+ */
+typedef struct {
+    uint8_t station;           // 站号（DLE SOH STN 与轮询包中的 STN）
+    uint8_t dst_node;          // 命令中的目标节点号
+    df1_request_t* queue[DF1_MASTER_QUEUE_SIZE]; // 等待发送的请求（先进先出）
+    size_t queue_head;         // 发送队列读取计数
+    size_t queue_tail;         // 发送队列写入计数
+    int send_retries;          // 队首请求已重发的次数
+    df1_master_pending_t pending[DF1_MASTER_QUEUE_SIZE]; // 等待响应的命令
+    size_t pending_count;      // 等待响应的命令数
+    int poll_interval_ms;      // 当前空闲轮询间隔
+    long long next_poll_ms;    // 下一次轮询时间
+    bool has_last_message;     // 是否已收到过消息
+    uint8_t last_cmd;          // 最近一次消息的命令字节（重复检测）
+    uint16_t last_tns;         // 最近一次消息的事务ID（重复检测）
+    unsigned long polls;       // 发送的轮询次数
+    unsigned long eots;        // 收到的 DLE EOT 次数
+    unsigned long messages;    // 收到的消息数
+    unsigned long timeouts;    // 轮询或命令无应答次数
+    df1_rtt_t rtt;             // 往返时间估计（轮询应答与 DLE ACK）
+} df1_master_station_t;
+
+/**
+ * @brief 半双工多点轮询主站
+ *
+ * 主站独占一个半双工连接，对站号列表中的从站依次发送命令并轮询（DLE ENQ STN BCC），
+ * 从站以待发送的消息或 DLE EOT 应答。发送命令与轮询交替进行：一个从站处理命令期间
+ * 线路用于其他从站的命令和轮询。没有数据上报的从站每次应答 DLE EOT 后轮询间隔加倍，
+ * 直到 idle_poll_max_ms；收到消息后恢复为 idle_poll_min_ms。
+ *
+ * 连接启用自适应超时时，每个从站按轮询应答与 DLE ACK 的往返时间单独估计超时，
+ * ACK 与轮询等待不超过配置的超时；从站离线期间提交给它的命令直接失败，轮询照常退避。
+ */
+typedef struct {
+    df1_serial_t* port;        // 已打开的半双工连接
+    df1_master_config_t config; // 主站配置
+    df1_master_station_t stations[DF1_MASTER_MAX_STATIONS]; // 从站列表
+    size_t station_count;      // 从站数量
+    size_t send_cursor;        // 下一次发送命令时开始查找的从站
+    size_t poll_cursor;        // 下一次轮询时开始查找的从站
+    bool last_was_send;        // 上一次线路操作是否为发送命令
+    size_t pending_requests;   // 已提交但尚未完成的请求数
+    df1_master_message_callback_t on_message; // 主动上报消息回调
+    void* on_message_user;     // 回调用户数据
+    unsigned long unsolicited; // 收到的主动上报消息数
+} df1_master_t;
+
+/**
+ * @brief 初始化主站配置为默认值
+ *
+ * @param config 主站配置
+ * @param timeout_ms 等待ACK、轮询应答与响应的超时（毫秒）
+ */
+void df1_master_config_default(df1_master_config_t* config, int timeout_ms);
+
+/**
+ * @brief 初始化轮询主站
+ *
+ * 连接的 df1_config 提供源节点号、校验类型和事务ID计数器，站号和目标节点号按从站设置。
+ *
+ * @param master 轮询主站
+ * @param port 已打开的半双工连接
+ * @param config 主站配置，NULL 表示使用连接超时的默认配置
+ * @return 0 成功，-1 失败
+ */
+int df1_master_init(df1_master_t* master, df1_serial_t* port, const df1_master_config_t* config);
+
+/**
+ * @brief 添加一个从站
+ *
+ * @param master 轮询主站
+ * @param station 站号
+ * @param dst_node 目标节点号
+ * @return 0 成功，-1 从站已存在或数量已达上限
+ */
+int df1_master_add_station(df1_master_t* master, uint8_t station, uint8_t dst_node);
+
+/**
+ * @brief 设置从站主动上报消息的回调
+ *
+ * @param master 轮询主站
+ * @param callback 回调，NULL 表示丢弃
+ * @param user_data 回调用户数据
+ */
+void df1_master_set_message_callback(df1_master_t* master, df1_master_message_callback_t callback, void* user_data);
+
+/**
+ * @brief 向从站提交一条请求
+ *
+ * 请求在 df1_master_step / df1_master_run 中发送，完成后写入其 status 字段；
+ * 完成之前请求及其缓冲区必须保持有效。
+ *
+ * @param master 轮询主站
+ * @param station 站号
+ * @param request 请求
+ * @return 0 成功，-1 从站不存在或队列已满
+ */
+int df1_master_submit(df1_master_t* master, uint8_t station, df1_request_t* request);
+
+/**
+ * @brief 执行一次线路操作（发送一条命令或轮询一个从站）
+ *
+ * @param master 轮询主站
+ * @return 1 执行了线路操作，0 当前没有到期的操作，-1 失败
+ */
+int df1_master_step(df1_master_t* master);
+
+/**
+ * @brief 运行主站直到已提交的请求全部完成
+ *
+ * 没有已提交的请求时持续轮询从站直到超时，用于接收从站主动上报的消息。
+ * 超时后仍未完成的请求保持 DF1_REQUEST_PENDING，可在之后继续运行。
+ *
+ * @param master 轮询主站
+ * @param timeout_ms 超时（毫秒）
+ * @return 0 请求全部完成（或无请求时正常运行到超时），-1 超时或失败
+ */
+int df1_master_run(df1_master_t* master, int timeout_ms);
+
+/**
+ * @brief 获取已提交但尚未完成的请求数
+ *
+ * @param master 轮询主站
+ * @return 请求数
+ */
+size_t df1_master_pending(const df1_master_t* master);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_MASTER_H_
@@ -0,0 +1,152 @@
+#ifndef AB_DF1_PLAN_H_
+#define AB_DF1_PLAN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "df1_serial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 单次读取的默认最大字节数
+ */
+#define DF1_PLAN_DEFAULT_MAX_READ DF1_MAX_DATA_SIZE
+
+/**
+ * @brief 合并时默认允许跨过的未请求元素数
+ */
+#define DF1_PLAN_DEFAULT_MAX_GAP 8
+
+/**
+ * @brief 读取合并规划参数
+ */
+typedef struct {
+    size_t max_read_size;      // 单次读取的最大字节数（不超过255）
+    size_t max_gap;            // 两段之间最多相隔多少个未请求的元素仍合并为一次读取
+} df1_plan_config_t;
+
+/**
+ * @brief 一个待读取的标签
+ */
+typedef struct {
+    const df1_address_t* addr; // 起始地址
+    size_t size;               // 读取字节数
+    uint8_t* data;             // 输出缓冲区
+    int status;                // 0 成功，-1 失败
+} df1_plan_item_t;
+
+/**
+ * @brief 合并后的一次块读取
+ */
+typedef struct {
+    df1_address_t addr;        // 起始地址（可带子元素），length 为涉及的元素数
+    size_t size;               // 读取字节数
+    size_t offset;             // 数据在 df1_plan_t.data 中的偏移
+    size_t first;              // 第一个分片在 df1_plan_t.slices 中的下标
+    size_t count;              // 分片数
+    df1_frame_template_t frame; // 预编译的读命令帧，由 df1_plan_compile 生成
+} df1_plan_block_t;
+
+/**
+ * @brief 标签在块数据中的位置
+ */
+typedef struct {
+    size_t item;               // 标签在输入数组中的下标
+    size_t offset;             // 在块数据中的偏移
+} df1_plan_slice_t;
+
+/**
+ * @brief 读取合并计划
+ *
+ * 标签按数据类型与文件号分组，组内按起始元素排序，相邻或间隔不超过 max_gap 个元素的
+ * 标签在不超过 max_read_size 的前提下合并为一次块读取。读取结果按分片散布回各标签。
+ * 定时器、计数器、控制元素的子元素（如 T4:0.ACC）按字合并，单独的子元素只读取该字。
+ */
+typedef struct {
+    df1_plan_block_t* blocks;  // 块读取
+    size_t block_count;
+    df1_plan_slice_t* slices;  // 按块顺序排列的分片，每个标签一个
+    size_t slice_count;
+    uint8_t* data;             // 所有块的读取缓冲区
+    size_t data_size;
+} df1_plan_t;
+
+/**
+ * @brief 初始化规划参数为默认值
+ *
+ * @param config 规划参数
+ */
+void df1_plan_config_default(df1_plan_config_t* config);
+
+/**
+ * @brief 初始化为空计划
+ *
+ * @param plan 计划
+ */
+void df1_plan_init(df1_plan_t* plan);
+
+/**
+ * @brief 释放计划占用的内存
+ *
+ * @param plan 计划
+ */
+void df1_plan_free(df1_plan_t* plan);
+
+/**
+ * @brief 为一组标签生成读取合并计划
+ *
+ * 计划中原有的内容被替换。
+ *
+ * @param plan 计划
+ * @param config 规划参数，NULL 使用默认值
+ * @param items 标签数组
+ * @param count 标签数量
+ * @return 0 成功，-1 参数无效、单个标签超过 max_read_size 或内存不足
+ */
+int df1_plan_build(df1_plan_t* plan, const df1_plan_config_t* config, const df1_plan_item_t* items, size_t count);
+
+/**
+ * @brief 将一次块读取的结果散布到该块包含的标签
+ *
+ * @param plan 计划
+ * @param block 块下标
+ * @param status 块读取结果，0 成功
+ * @param data 块数据
+ * @param size 实际读取的字节数
+ * @param items 标签数组（与生成计划时相同）
+ */
+void df1_plan_scatter(const df1_plan_t* plan, size_t block, int status, const uint8_t* data, size_t size,
+                      df1_plan_item_t* items);
+
+/**
+ * @brief 按协议配置为每个块读取生成读命令帧模板
+ *
+ * 之后每次执行只填入事务ID并修补校验。已按相同配置生成的模板保留，
+ * df1_plan_read 与扫描器在执行前自动调用，配置变化后的下一次执行重新生成。
+ *
+ * @param plan 计划
+ * @param config DF1协议配置
+ * @return 0 成功，-1 参数无效或生成失败（失败的块仍可完整编码）
+ */
+int df1_plan_compile(df1_plan_t* plan, const df1_config_t* config);
+
+/**
+ * @brief 执行计划中的全部块读取并散布结果
+ *
+ * 块读取通过 df1_serial_transact 执行，全双工方式下流水发送。
+ * 每个标签的结果写入其 status 字段。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param plan 计划
+ * @param items 标签数组（与生成计划时相同）
+ * @return 0 全部成功，-1 至少一个标签失败
+ */
+int df1_plan_read(df1_serial_t* df1_serial, df1_plan_t* plan, df1_plan_item_t* items);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_PLAN_H_
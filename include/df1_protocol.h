@@ -18,6 +18,14 @@ typedef enum {
     DF1_CHECK_CRC16 = 1   // CRC16校验
 } df1_check_type_t;
 
+/**
+ * @brief DF1链路工作方式
+ */
+typedef enum {
+    DF1_HALF_DUPLEX = 0,  // 半双工：帧头为 DLE SOH STN DLE STX，请求-响应
+    DF1_FULL_DUPLEX = 1   // 全双工：帧头为 DLE STX，链路层 ACK/NAK/ENQ，可同时有多个未完成命令
+} df1_duplex_t;
+
 /**
  * @brief DF1协议配置结构体
  */
@@ -27,6 +35,7 @@ typedef struct {
     uint8_t src_node;          // 源节点号
     df1_check_type_t check_type; // 校验类型
     uint16_t transaction_id;   // 事务ID计数器
+    df1_duplex_t duplex;       // 链路工作方式
 } df1_config_t;
 
 /**
@@ -38,6 +47,121 @@ typedef enum {
     DF1_CMD_MASK_WRITE = 0xAB  // 掩码写命令
 } df1_command_t;
 
+/**
+ * @brief 单条类型读写命令的默认最大数据字节数
+ *
+ * 命令中的长度字段只有一个字节（最大255），SLC 5/03 及以后型号单条命令最多传输236字节，
+ * 块读写按此大小分段。
+ */
+#define DF1_MAX_DATA_SIZE 236
+
+/**
+ * @brief 解码器可容纳的最大应用层数据长度（去除转义后）
+ */
+#define DF1_MAX_PDU_SIZE 512
+
+/**
+ * @brief 最大应用层数据全部转义后的帧长度上限
+ */
+#define DF1_MAX_FRAME_SIZE (2 * DF1_MAX_PDU_SIZE + 16)
+
+/**
+ * @brief DF1链路控制字符（跟在DLE之后）
+ */
+#define DF1_DLE 0x10
+#define DF1_SOH 0x01
+#define DF1_STX 0x02
+#define DF1_ETX 0x03
+#define DF1_EOT 0x04
+#define DF1_ENQ 0x05
+#define DF1_ACK 0x06
+#define DF1_NAK 0x15
+
+/**
+ * @brief 流式解码结果
+ */
+typedef enum {
+    DF1_DECODE_NEED_MORE = 0,      // 需要更多数据
+    DF1_DECODE_FRAME = 1,          // 得到一个完整且校验正确的帧
+    DF1_DECODE_ACK = 2,            // 收到 DLE ACK
+    DF1_DECODE_NAK = 3,            // 收到 DLE NAK
+    DF1_DECODE_ENQ = 4,            // 收到 DLE ENQ
+    DF1_DECODE_EOT = 5,            // 收到 DLE EOT
+    DF1_DECODE_BAD_CHECKSUM = -1,  // 帧校验错误
+    DF1_DECODE_OVERFLOW = -2,      // 帧超过 DF1_MAX_PDU_SIZE
+    DF1_DECODE_MALFORMED = -3      // 帧格式错误或过短
+} df1_decode_result_t;
+
+/**
+ * @brief 解码得到的DF1帧
+ *
+ * 帧中没有DLE转义且完整位于一次输入中时，pdu 直接指向输入缓冲区（零拷贝），
+ * 否则指向解码器内部缓冲区。两种情况下视图都只在下一次调用解码器之前有效。
+ */
+typedef struct {
+    const uint8_t* pdu;        // 应用层数据：DST SRC CMD STS TNS ...
+    size_t pdu_length;         // 应用层数据长度
+    const uint8_t* data;       // TNS之后的数据
+    size_t data_length;        // TNS之后的数据长度
+    uint8_t station;           // 帧头中的站号
+    bool has_station;          // 帧头是否包含 DLE SOH STN
+    uint8_t dst;               // 目标节点
+    uint8_t src;               // 源节点
+    uint8_t cmd;               // 命令字节
+    uint8_t sts;               // 状态字节
+    uint8_t ext_sts;           // 扩展状态（仅当 sts 为 0xF0 时有效）
+    uint16_t tns;              // 事务ID
+    bool zero_copy;            // pdu 是否指向输入缓冲区
+} df1_frame_t;
+
+/**
+ * @brief 帧模板可容纳的最大帧长度，足够容纳任意读命令
+ */
+#define DF1_FRAME_TEMPLATE_SIZE 64
+
+/**
+ * @brief 预编译的命令帧模板
+ *
+ * 扫描循环反复发送相同的读命令，各次之间只有事务ID不同。模板保存事务ID为0时的完整帧，
+ * 发送时只写入事务ID两个字节（需要时加DLE转义）并修补校验：BCC直接加上两个字节；
+ * CRC16（初值为0、无输出异或）对数据是线性的，修补量等于事务ID两个字节经过其后的
+ * 固定字节数推移的结果。推移是16位状态上的线性变换，预先按4位一组展开为4张16项的表，
+ * 修补只需4次查表，与命令长度无关。
+ */
+typedef struct {
+    uint8_t frame[DF1_FRAME_TEMPLATE_SIZE]; // 事务ID为0时的完整帧
+    size_t size;               // 帧长度，0 表示模板未生成
+    size_t tns_offset;         // 事务ID低字节在帧中的位置
+    uint8_t station;           // 生成模板时的站号（仅半双工帧头使用）
+    uint8_t dst_node;          // 生成模板时的目标节点号
+    uint8_t src_node;          // 生成模板时的源节点号
+    df1_check_type_t check_type; // 生成模板时的校验类型
+    df1_duplex_t duplex;       // 生成模板时的链路工作方式
+    uint8_t sum;               // 事务ID为0时的BCC累加和
+    uint16_t crc;              // 事务ID为0时的CRC16
+    uint16_t crc_shift[4][16]; // CRC状态经过事务ID之后各字节（全为0）的推移结果，按4位一组查表
+} df1_frame_template_t;
+
+/**
+ * @brief 流式DF1帧解码器
+ *
+ * 以任意长度分段输入字节，解码器负责查找帧边界、去除DLE转义并在接收过程中累加校验。
+ */
+typedef struct {
+    int state;                   // 状态机当前状态
+    df1_check_type_t check_type; // 校验类型
+    uint16_t crc;                // 帧头中计入校验部分的CRC16，应用层数据在帧结束时整段计算
+    uint8_t sum;                 // 帧头中计入校验部分的BCC累加和
+    uint8_t station;             // 帧头站号
+    bool has_station;            // 帧头是否包含站号
+    uint8_t check_bytes[2];      // 接收到的校验字节
+    size_t check_pos;            // 已接收的校验字节数
+    const uint8_t* pdu_src;      // 零拷贝时应用层数据在输入中的起始位置
+    size_t pdu_length;           // 已接收的应用层数据长度
+    bool in_place;               // 应用层数据是否仍位于输入缓冲区中
+    uint8_t buffer[DF1_MAX_PDU_SIZE]; // 跨输入或含转义时的应用层数据
+} df1_decoder_t;
+
 /**
  * @brief 初始化DF1配置
  * 
@@ -53,7 +177,7 @@ void df1_config_init(df1_config_t* config, uint8_t station, uint8_t dst_node, ui
  * 
  * @param config DF1配置
  * @param address 地址字符串
- * @param length 读取长度
+ * @param length 读取长度（字节，不超过255）
  * @param buffer 输出缓冲区
  * @param buffer_size 缓冲区大小
  * @param actual_size 实际生成的命令大小
@@ -69,7 +193,7 @@ int df1_build_read_command(const df1_config_t* config, const char* address,
  * @param config DF1配置
  * @param address 地址字符串
  * @param data 写入数据
- * @param data_length 数据长度
+ * @param data_length 数据长度（字节，不超过255）
  * @param buffer 输出缓冲区
  * @param buffer_size 缓冲区大小
  * @param actual_size 实际生成的命令大小
@@ -80,6 +204,224 @@ int df1_build_write_command(const df1_config_t* config, const char* address,
                            uint8_t* buffer, size_t buffer_size, 
                            size_t* actual_size);
 
+/**
+ * @brief 使用已解析的地址构建DF1读取命令
+ *
+ * 与 df1_build_read_command 相同，但跳过地址字符串解析，适用于扫描循环等热路径。
+ *
+ * @param config DF1配置
+ * @param addr 已解析的地址
+ * @param length 读取长度
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param actual_size 实际生成的命令大小
+ * @return 0 成功，-1 失败
+ */
+int df1_build_read_command_addr(const df1_config_t* config, const df1_address_t* addr,
+                               uint16_t length, uint8_t* buffer, size_t buffer_size,
+                               size_t* actual_size);
+
+/**
+ * @brief 使用已解析的地址构建DF1写入命令
+ *
+ * @param config DF1配置
+ * @param addr 已解析的地址
+ * @param data 写入数据
+ * @param data_length 数据长度
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param actual_size 实际生成的命令大小
+ * @return 0 成功，-1 失败
+ */
+int df1_build_write_command_addr(const df1_config_t* config, const df1_address_t* addr,
+                                const uint8_t* data, uint16_t data_length,
+                                uint8_t* buffer, size_t buffer_size,
+                                size_t* actual_size);
+
+/**
+ * @brief 将任意应用层数据封装为DF1帧
+ *
+ * 按配置的链路工作方式写入帧头，对应用层数据做DLE转义并追加校验。
+ * 可用于构建响应帧或本库没有直接提供的命令。
+ *
+ * @param config DF1配置（使用其中的站号、校验类型与链路工作方式）
+ * @param pdu 应用层数据
+ * @param pdu_length 应用层数据长度
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param actual_size 实际生成的帧大小
+ * @return 0 成功，-1 失败
+ */
+int df1_build_frame(const df1_config_t* config, const uint8_t* pdu, size_t pdu_length,
+                   uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+
+/**
+ * @brief 由应用层数据生成帧模板
+ *
+ * 应用层数据中的事务ID（第4、5字节）被忽略，发送时由 df1_frame_template_emit 填入。
+ *
+ * @param tmpl 模板
+ * @param config DF1配置（使用其中的站号、节点号、校验类型与链路工作方式）
+ * @param pdu 应用层数据：DST SRC CMD STS TNS ...
+ * @param pdu_length 应用层数据长度，不少于6
+ * @return 0 成功，-1 参数无效或帧超过 DF1_FRAME_TEMPLATE_SIZE
+ */
+int df1_frame_template_init(df1_frame_template_t* tmpl, const df1_config_t* config, const uint8_t* pdu,
+                            size_t pdu_length);
+
+/**
+ * @brief 使用已解析的地址生成读命令帧模板
+ *
+ * 生成的帧与相同参数下的 df1_build_read_command_addr 逐字节相同。
+ *
+ * @param tmpl 模板
+ * @param config DF1配置
+ * @param addr 已解析的地址
+ * @param length 读取长度
+ * @return 0 成功，-1 失败
+ */
+int df1_frame_template_read(df1_frame_template_t* tmpl, const df1_config_t* config, const df1_address_t* addr,
+                            uint16_t length);
+
+/**
+ * @brief 判断模板是否按给定配置生成（站号、节点号、校验类型与链路工作方式一致）
+ *
+ * @param tmpl 模板
+ * @param config DF1配置
+ * @return 一致返回 true，模板未生成或不一致返回 false
+ */
+bool df1_frame_template_matches(const df1_frame_template_t* tmpl, const df1_config_t* config);
+
+/**
+ * @brief 以给定事务ID输出模板中的帧
+ *
+ * @param tmpl 模板
+ * @param tns 事务ID
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小（事务ID含DLE时帧比模板长1~2字节）
+ * @param actual_size 实际生成的帧大小
+ * @return 0 成功，-1 模板未生成或缓冲区不足
+ */
+int df1_frame_template_emit(const df1_frame_template_t* tmpl, uint16_t tns, uint8_t* buffer, size_t buffer_size,
+                            size_t* actual_size);
+
+/**
+ * @brief 构建DF1掩码写命令（0xAB）
+ *
+ * PLC在一次扫描内只修改 mask 中置1的位为 value 中对应的位，其余位保持不变，
+ * 避免“读-改-写”两次往返期间与PLC程序的竞争。
+ *
+ * @param config DF1配置
+ * @param address 地址字符串，如 "B3:0"、"N7:2"
+ * @param mask 要修改的位
+ * @param value 新的位值
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param actual_size 实际生成的命令大小
+ * @return 0 成功，-1 失败
+ */
+int df1_build_mask_write_command(const df1_config_t* config, const char* address, uint16_t mask, uint16_t value,
+                                uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+
+/**
+ * @brief 使用已解析的地址构建DF1掩码写命令
+ *
+ * @param config DF1配置
+ * @param addr 已解析的地址
+ * @param mask 要修改的位
+ * @param value 新的位值
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param actual_size 实际生成的命令大小
+ * @return 0 成功，-1 失败
+ */
+int df1_build_mask_write_command_addr(const df1_config_t* config, const df1_address_t* addr, uint16_t mask,
+                                     uint16_t value, uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+
+/**
+ * @brief 构建半双工轮询包 DLE ENQ STN BCC
+ *
+ * @param station 被轮询的站号
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param actual_size 实际生成的大小
+ * @return 0 成功，-1 失败
+ */
+int df1_build_poll(uint8_t station, uint8_t* buffer, size_t buffer_size, size_t* actual_size);
+
+/**
+ * @brief 计算一段数据的CRC16（DF1使用的 CRC-16/ARC，多项式 0xA001 反射）
+ *
+ * 可以分段累加：将上一段的返回值作为下一段的 crc 传入。DF1帧的CRC覆盖去除DLE转义后的
+ * 应用层数据与结尾的 ETX（半双工时还包括帧头站号与 STX），初值为0。
+ * 使用 df1_crc.h 中按CPU特性选择的内核（查表分片或无进位乘法折叠）。
+ *
+ * @param crc 初值或上一段的累加值
+ * @param data 数据
+ * @param length 数据长度
+ * @return 累加后的CRC16
+ */
+uint16_t df1_crc16(uint16_t crc, const uint8_t* data, size_t length);
+
+/**
+ * @brief 计算一段数据的BCC校验字节（字节累加和的二进制补码）
+ *
+ * @param data 数据
+ * @param length 数据长度
+ * @return BCC校验字节，与数据累加后和为0
+ */
+uint8_t df1_bcc(const uint8_t* data, size_t length);
+
+/**
+ * @brief 主机是否为小端序
+ *
+ * 为1时 df1_le16_to_host 等转换函数等同于 memmove，调用者数组可以直接作为数据表收发。
+ */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define DF1_HOST_LITTLE_ENDIAN 1
+#else
+#define DF1_HOST_LITTLE_ENDIAN 0
+#endif
+
+/**
+ * @brief 将小端序的16位数据转换为主机字节序
+ *
+ * PLC数据表按小端序传输。小端主机上等同于 memmove，大端主机上逐个字交换字节（可被编译器
+ * 向量化）。dst 与 src 可以指向同一缓冲区。
+ *
+ * @param dst 输出数组（int16_t / uint16_t）
+ * @param src 小端序数据，2 * count 字节
+ * @param count 元素个数
+ */
+void df1_le16_to_host(void* dst, const uint8_t* src, size_t count);
+
+/**
+ * @brief 将小端序的32位数据（长整数、浮点数）转换为主机字节序
+ *
+ * @param dst 输出数组（int32_t / float）
+ * @param src 小端序数据，4 * count 字节
+ * @param count 元素个数
+ */
+void df1_le32_to_host(void* dst, const uint8_t* src, size_t count);
+
+/**
+ * @brief 将主机字节序的16位数组转换为小端序
+ *
+ * @param dst 输出数据，2 * count 字节
+ * @param src 输入数组
+ * @param count 元素个数
+ */
+void df1_host_to_le16(uint8_t* dst, const void* src, size_t count);
+
+/**
+ * @brief 将主机字节序的32位数组转换为小端序
+ *
+ * @param dst 输出数据，4 * count 字节
+ * @param src 输入数组
+ * @param count 元素个数
+ */
+void df1_host_to_le32(uint8_t* dst, const void* src, size_t count);
+
 /**
  * @brief 解析DF1响应数据
  * 
@@ -93,6 +435,58 @@ int df1_build_write_command(const df1_config_t* config, const char* address,
 int df1_parse_response(const uint8_t* response, size_t response_size,
                       uint8_t* data, size_t data_size, size_t* actual_data_size);
 
+/**
+ * @brief 初始化流式解码器
+ *
+ * @param decoder 解码器
+ * @param check_type 校验类型
+ */
+void df1_decoder_init(df1_decoder_t* decoder, df1_check_type_t check_type);
+
+/**
+ * @brief 丢弃解码器中未完成的帧
+ *
+ * @param decoder 解码器
+ */
+void df1_decoder_reset(df1_decoder_t* decoder);
+
+/**
+ * @brief 向解码器输入字节
+ *
+ * 解码器在得到一个完整帧、链路控制字符或检测到错误后立即返回，*consumed 为本次
+ * 消耗的字节数，调用者应处理结果后继续输入剩余字节。全双工链路允许在帧中间嵌入
+ * DLE ACK / DLE NAK，此时返回控制字符且不影响正在接收的帧。
+ *
+ * @param decoder 解码器
+ * @param data 输入数据
+ * @param length 输入数据长度
+ * @param consumed 本次消耗的字节数
+ * @param frame 输出帧（仅返回 DF1_DECODE_FRAME 时有效）
+ * @return df1_decode_result_t
+ */
+int df1_decoder_push(df1_decoder_t* decoder, const uint8_t* data, size_t length,
+                    size_t* consumed, df1_frame_t* frame);
+
+/**
+ * @brief 估计完成当前帧至少还需要输入的字节数
+ *
+ * 帧尚未开始时返回不含站号帧头的最短帧长度。接收循环可据此设置串口 VMIN，
+ * 减少每帧的唤醒次数。
+ *
+ * @param decoder 解码器
+ * @return 至少还需要的字节数（不小于1）
+ */
+size_t df1_decoder_min_remaining(const df1_decoder_t* decoder);
+
+/**
+ * @brief 检查响应帧的事务ID与状态
+ *
+ * @param frame 解码得到的帧
+ * @param expected_tns 期望的事务ID
+ * @return 0 事务ID匹配且状态成功，-1 失败
+ */
+int df1_frame_check(const df1_frame_t* frame, uint16_t expected_tns);
+
 /**
  * @brief 获取DF1错误描述
  * 
@@ -0,0 +1,123 @@
+#ifndef AB_DF1_RTT_H_
+#define AB_DF1_RTT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 自适应超时配置
+ */
+typedef struct {
+    bool enabled;              // false 时使用固定超时，不做应用层重发与离线判定
+    int min_rto_ms;            // 重发超时下限
+    int max_rto_ms;            // 重发超时上限，也是还没有往返样本时的超时
+    int max_retries;           // 无应答或响应校验错误后以新事务ID重发的最多次数
+    int offline_after;         // 连续这么多个事务无应答后判定从站离线，0 不判定
+    int probe_interval_ms;     // 离线期间每隔多久放行一个事务探测从站
+    int char_time_us;          // 线路上传输一个字符的时间，超时按帧长加上传输时间，0 不计
+} df1_rtt_config_t;
+
+/**
+ * @brief 一个从站的往返时间估计（RFC 6298 的平滑均值与平均偏差）
+ *
+ * 往返样本先扣除命令与响应在线路上的传输时间，只反映从站的处理与转发延迟，
+ * 因此大小不同的命令可以共用一个估计；等待时再按帧长加回传输时间。
+ * 只做计算，不做任何 I/O，时间由调用者传入。
+ */
+typedef struct {
+    df1_rtt_config_t config;   // 配置
+    int64_t srtt_us;           // 平滑往返时间（微秒），没有样本时为0
+    int64_t rttvar_us;         // 往返时间平均偏差（微秒）
+    int rto_ms;                // 当前重发超时（不含传输时间）
+    unsigned long samples;     // 样本数
+    int failures;              // 连续无应答的事务数
+    bool offline;              // 是否判定为离线
+    long long probe_ms;        // 离线时下一次允许探测的时间
+    unsigned long fast_fails;  // 离线期间直接失败的事务数
+} df1_rtt_t;
+
+/**
+ * @brief 初始化自适应超时配置为默认值
+ *
+ * @param config 配置
+ * @param timeout_ms 超时上限（毫秒），通常为连接的 timeout_ms
+ */
+void df1_rtt_config_default(df1_rtt_config_t* config, int timeout_ms);
+
+/**
+ * @brief 由串口参数计算每个字符的传输时间
+ *
+ * @param baud_rate 波特率
+ * @param data_bits 数据位
+ * @param parity 校验位（0 无校验）
+ * @param stop_bits 停止位
+ * @return 微秒，波特率无效时返回0
+ */
+int df1_rtt_char_time_us(int baud_rate, int data_bits, int parity, int stop_bits);
+
+/**
+ * @brief 初始化往返时间估计
+ *
+ * @param rtt 往返时间估计
+ * @param config 配置，NULL 表示1秒上限的默认配置
+ */
+void df1_rtt_init(df1_rtt_t* rtt, const df1_rtt_config_t* config);
+
+/**
+ * @brief 加入一个往返样本（只用一次发送就得到应答的事务，避免重发造成的歧义）
+ *
+ * @param rtt 往返时间估计
+ * @param elapsed_us 从命令写出到收到应答的时间（微秒）
+ * @param wire_bytes 命令与应答在线路上的总字节数
+ */
+void df1_rtt_sample(df1_rtt_t* rtt, int64_t elapsed_us, size_t wire_bytes);
+
+/**
+ * @brief 计算一次等待的超时
+ *
+ * 第 attempt 次重发的超时为 rto 的 2^attempt 倍（不超过 max_rto_ms），再加上
+ * wire_bytes 个字符的传输时间。
+ *
+ * @param rtt 往返时间估计
+ * @param attempt 已重发的次数
+ * @param wire_bytes 命令与期望应答在线路上的总字节数
+ * @return 超时（毫秒）
+ */
+int df1_rtt_timeout(const df1_rtt_t* rtt, int attempt, size_t wire_bytes);
+
+/**
+ * @brief 事务开始前检查从站状态
+ *
+ * 从站在线时总是放行；离线时每 probe_interval_ms 放行一个事务作为探测，其余直接失败。
+ *
+ * @param rtt 往返时间估计
+ * @param now_ms 当前单调时间（毫秒）
+ * @return true 放行，false 应直接失败
+ */
+bool df1_rtt_allow(df1_rtt_t* rtt, long long now_ms);
+
+/**
+ * @brief 记录从站有应答（应答帧、DLE ACK 或错误状态的响应），恢复为在线
+ *
+ * @param rtt 往返时间估计
+ */
+void df1_rtt_success(df1_rtt_t* rtt);
+
+/**
+ * @brief 记录一个事务在全部重发后仍无应答
+ *
+ * @param rtt 往返时间估计
+ * @param now_ms 当前单调时间（毫秒）
+ */
+void df1_rtt_failure(df1_rtt_t* rtt, long long now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_RTT_H_
@@ -0,0 +1,154 @@
+#ifndef AB_DF1_SCAN_H_
+#define AB_DF1_SCAN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "df1_serial.h"
+#include "df1_plan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 扫描类数量上限
+ */
+#define DF1_SCAN_MAX_CLASSES 8
+
+/**
+ * @brief 标签读取完成回调，每个扫描周期调用一次
+ *
+ * 回调在遍历扫描类的读取计划与标签表时调用，不能销毁扫描引擎，
+ * 其中调用 df1_scanner_add_tag 返回失败。
+ *
+ * @param user_data 注册标签时传入的用户数据
+ * @param tag 标签编号（df1_scanner_add_tag 的返回值）
+ * @param status 0 成功，-1 失败
+ * @param data 读取到的数据，失败时为NULL
+ * @param size 数据大小
+ */
+typedef void (*df1_scan_callback_t)(void* user_data, int tag, int status, const uint8_t* data, size_t size);
+
+/**
+ * @brief 扫描类统计
+ */
+typedef struct {
+    int period_ms;             // 扫描周期
+    unsigned long scans;       // 完成的扫描周期数
+    unsigned long overruns;    // 超过截止时间才完成或被跳过的周期数
+    unsigned long errors;      // 失败的读取次数
+    long long jitter_max_ms;   // 周期开始时间相对计划时间的最大延迟
+    long long jitter_total_ms; // 累计延迟，除以 scans 为平均抖动
+    long long duration_max_ms; // 从计划时间到周期完成的最长时间
+    long long duration_last_ms; // 最近一次周期从计划时间到完成的时间
+} df1_scan_stats_t;
+
+/**
+ * @brief 周期扫描引擎
+ *
+ * 标签注册到不同周期的扫描类中。每个扫描类按周期释放一次扫描，截止时间为下一次释放时间；
+ * 多个扫描类同时就绪时按最早截止时间优先（EDF）逐批执行读取，慢周期的扫描可以在批次之间
+ * 被快周期的扫描抢占，线路繁忙时快周期标签仍能保持周期。每个扫描类的标签经读取合并
+ * 规划为尽量少的块读取，一批为若干个块读取。
+ */
+typedef struct df1_scanner df1_scanner_t;
+
+/**
+ * @brief 创建扫描引擎
+ *
+ * @param port 已打开的连接
+ * @return 扫描引擎指针，失败返回NULL
+ */
+df1_scanner_t* df1_scanner_create(df1_serial_t* port);
+
+/**
+ * @brief 销毁扫描引擎
+ *
+ * @param scanner 扫描引擎
+ */
+void df1_scanner_destroy(df1_scanner_t* scanner);
+
+/**
+ * @brief 添加扫描类
+ *
+ * @param scanner 扫描引擎
+ * @param period_ms 扫描周期（毫秒）
+ * @return 扫描类编号，失败返回-1
+ */
+int df1_scanner_add_class(df1_scanner_t* scanner, int period_ms);
+
+/**
+ * @brief 注册标签
+ *
+ * @param scanner 扫描引擎
+ * @param scan_class 扫描类编号
+ * @param address 地址字符串，如 "N7:0"
+ * @param size 读取字节数
+ * @param callback 读取完成回调，可以为NULL
+ * @param user_data 回调用户数据
+ * @return 标签编号，失败（含在标签回调中调用）返回-1
+ */
+int df1_scanner_add_tag(df1_scanner_t* scanner, int scan_class, const char* address, size_t size,
+                        df1_scan_callback_t callback, void* user_data);
+
+/**
+ * @brief 获取标签最近一次读取到的数据
+ *
+ * @param scanner 扫描引擎
+ * @param tag 标签编号
+ * @param size 输出数据大小
+ * @return 数据指针，标签无效或尚未成功读取时返回NULL
+ */
+const uint8_t* df1_scanner_value(const df1_scanner_t* scanner, int tag, size_t* size);
+
+/**
+ * @brief 执行一批读取（最早截止时间的就绪扫描类）
+ *
+ * @param scanner 扫描引擎
+ * @return 1 执行了读取，0 没有就绪的扫描类，-1 失败
+ */
+int df1_scanner_step(df1_scanner_t* scanner);
+
+/**
+ * @brief 运行扫描引擎
+ *
+ * @param scanner 扫描引擎
+ * @param duration_ms 运行时间（毫秒）
+ * @return 0 成功，-1 失败
+ */
+int df1_scanner_run(df1_scanner_t* scanner, int duration_ms);
+
+/**
+ * @brief 设置读取合并参数
+ *
+ * 新参数从各扫描类的下一个周期开始生效。已注册的标签若超过新的 max_read_size，
+ * 之后的 df1_scanner_step 将返回失败。
+ *
+ * @param scanner 扫描引擎
+ * @param config 读取合并参数
+ * @return 0 成功，-1 失败
+ */
+int df1_scanner_set_plan_config(df1_scanner_t* scanner, const df1_plan_config_t* config);
+
+/**
+ * @brief 获取扫描类统计
+ *
+ * @param scanner 扫描引擎
+ * @param scan_class 扫描类编号
+ * @param stats 输出统计
+ * @return 0 成功，-1 扫描类无效
+ */
+int df1_scanner_get_stats(const df1_scanner_t* scanner, int scan_class, df1_scan_stats_t* stats);
+
+/**
+ * @brief 清零所有扫描类的统计
+ *
+ * @param scanner 扫描引擎
+ */
+void df1_scanner_reset_stats(df1_scanner_t* scanner);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_SCAN_H_
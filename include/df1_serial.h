@@ -5,33 +5,96 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include "df1_protocol.h"
+#include "df1_tag.h"
+#include "df1_link.h"
+#include "df1_transport.h"
+#include "df1_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief 串口配置结构体
+ * @brief 每个连接的接收环形缓冲区大小（2的幂）
  */
-typedef struct {
-    char port_name[64];        // 串口名称，如 "/dev/ttyUSB0"
-    int baud_rate;             // 波特率
-    int data_bits;             // 数据位
-    int stop_bits;             // 停止位
-    int parity;                // 校验位: 0=None, 1=Odd, 2=Even
-    int timeout_ms;            // 超时时间（毫秒）
-} df1_serial_config_t;
+#define DF1_RX_RING_SIZE 1024
 
 /**
  * @brief DF1串口通信结构体
  */
 typedef struct {
-    int fd;                    // 文件描述符
+    df1_transport_t transport; // 传输层（串口、TCP、伪终端或内存回环）
     df1_serial_config_t serial_config; // 串口配置
     df1_config_t df1_config;   // DF1协议配置
     bool is_open;              // 连接状态
+    df1_tag_table_t* tag_table; // 地址字符串解析缓存
+    df1_decoder_t decoder;     // 接收帧解码器
+    uint8_t rx_ring[DF1_RX_RING_SIZE]; // 接收环形缓冲区，保留上一帧之后多余的字节
+    size_t rx_head;            // 环形缓冲区写入计数
+    size_t rx_tail;            // 环形缓冲区读取计数
+    df1_link_config_t link_config; // 链路层配置，max_outstanding 为0时打开连接时取默认值
+    df1_link_t link;           // 全双工链路层
+    df1_rtt_config_t rtt_config; // 自适应超时配置，max_rto_ms 为0时打开连接时取默认值
+    df1_rtt_t rtt;             // 从站往返时间估计
+#ifdef DF1_ENABLE_STATS
+    df1_stats_t stats;         // 统计计数与分阶段延迟直方图
+#endif
 } df1_serial_t;
 
+/**
+ * @brief 批量事务中的一条读写请求
+ */
+typedef struct {
+    df1_command_t command;     // DF1_CMD_READ、DF1_CMD_WRITE 或 DF1_CMD_MASK_WRITE
+    const df1_address_t* addr; // 已解析的地址
+    uint8_t* read_data;        // 读：输出缓冲区
+    const uint8_t* write_data; // 写：写入数据；掩码写：2字节小端序新位值
+    size_t size;               // 读：读取字节数；写：写入字节数；掩码写：2
+    uint16_t mask;             // 掩码写：要修改的位
+    size_t actual_size;        // 读：实际读取的字节数
+    int status;                // 0 成功，-1 失败，DF1_REQUEST_PENDING 处理中
+    uint8_t sts;               // 响应状态字节
+    uint8_t ext_sts;           // 响应扩展状态字节
+    const df1_frame_template_t* frame_template; // 可选：预编译的命令帧，与协议配置一致时只填入事务ID
+} df1_request_t;
+
+/**
+ * @brief 请求尚未完成时的 status 取值
+ */
+#define DF1_REQUEST_PENDING 1
+
+/**
+ * @brief 按给定协议配置（站号、节点号、事务ID）编码一条请求
+ *
+ * 请求带有与配置一致的帧模板时由模板输出，否则完整编码。
+ *
+ * @param config DF1协议配置
+ * @param request 请求
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param actual_size 实际生成的大小
+ * @return 0 成功，-1 失败
+ */
+int df1_request_encode(const df1_config_t* config, const df1_request_t* request, uint8_t* buffer,
+                       size_t buffer_size, size_t* actual_size);
+
+/**
+ * @brief 估计请求的响应帧在线路上的字节数（帧头、状态、数据与校验，不计转义）
+ *
+ * @param request 请求
+ * @return 字节数
+ */
+size_t df1_request_reply_size(const df1_request_t* request);
+
+/**
+ * @brief 根据响应帧填写请求结果
+ *
+ * @param request 请求
+ * @param status 0 收到响应帧，-1 链路失败
+ * @param reply 响应帧，失败时为NULL
+ */
+void df1_request_finish(df1_request_t* request, int status, const df1_frame_t* reply);
+
 /**
  * @brief 初始化串口配置为默认值
  * 
@@ -55,6 +118,8 @@ void df1_serial_destroy(df1_serial_t* df1_serial);
 
 /**
  * @brief 打开串口连接
+ *
+ * 端口名以 DF1_TCP_PREFIX 开头时经TCP连接终端服务器，否则打开终端设备。
  * 
  * @param df1_serial DF1串口通信实例
  * @param serial_config 串口配置
@@ -64,6 +129,20 @@ void df1_serial_destroy(df1_serial_t* df1_serial);
 int df1_serial_open(df1_serial_t* df1_serial, const df1_serial_config_t* serial_config,
                    const df1_config_t* df1_config);
 
+/**
+ * @brief 使用已打开的传输层建立连接
+ *
+ * 传输层按值接管，之后由 df1_serial_close 关闭，调用者不再使用原结构。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param transport 已打开的传输层
+ * @param serial_config 串口配置（使用其中的超时时间）
+ * @param df1_config DF1协议配置
+ * @return 0 成功，-1 失败（失败时传输层仍由调用者关闭）
+ */
+int df1_serial_open_transport(df1_serial_t* df1_serial, const df1_transport_t* transport,
+                              const df1_serial_config_t* serial_config, const df1_config_t* df1_config);
+
 /**
  * @brief 关闭串口连接
  * 
@@ -97,9 +176,253 @@ int df1_serial_read(df1_serial_t* df1_serial, const char* address,
 int df1_serial_write(df1_serial_t* df1_serial, const char* address,
                     const uint8_t* data, size_t data_size);
 
+/**
+ * @brief 获取地址字符串对应的已解析地址
+ *
+ * 地址在连接的标签表中只解析一次，返回的指针在实例销毁前有效，
+ * 可直接传给 df1_serial_read_addr / df1_serial_write_addr。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 地址字符串
+ * @return 地址指针，失败返回NULL
+ */
+const df1_address_t* df1_serial_tag(df1_serial_t* df1_serial, const char* address);
+
+/**
+ * @brief 使用已解析的地址读取PLC数据
+ * 
+ * @param df1_serial DF1串口通信实例
+ * @param addr 已解析的地址
+ * @param data 输出数据缓冲区
+ * @param data_size 数据缓冲区大小
+ * @param actual_size 实际读取的数据大小
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_read_addr(df1_serial_t* df1_serial, const df1_address_t* addr,
+                        uint8_t* data, size_t data_size, size_t* actual_size);
+
+/**
+ * @brief 使用已解析的地址写入PLC数据
+ * 
+ * @param df1_serial DF1串口通信实例
+ * @param addr 已解析的地址
+ * @param data 写入数据
+ * @param data_size 数据大小
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_write_addr(df1_serial_t* df1_serial, const df1_address_t* addr,
+                         const uint8_t* data, size_t data_size);
+
+/**
+ * @brief 读取任意长度的连续元素
+ *
+ * 按 DF1_MAX_DATA_SIZE 以整元素分段，各段作为一批请求执行，全双工方式下流水发送，
+ * 结果按顺序拼接到 data。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param data 输出数据缓冲区
+ * @param data_size 读取字节数
+ * @param actual_size 从起始地址开始连续读到的字节数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_read_block(df1_serial_t* df1_serial, const char* address,
+                         uint8_t* data, size_t data_size, size_t* actual_size);
+
+/**
+ * @brief 写入任意长度的连续元素
+ *
+ * 分段方式与 df1_serial_read_block 相同。失败时已确认的分段可能已经写入。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param data 写入数据
+ * @param data_size 数据大小
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_write_block(df1_serial_t* df1_serial, const char* address,
+                          const uint8_t* data, size_t data_size);
+
+/**
+ * @brief 使用已解析的地址读取任意长度的连续元素
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param addr 已解析的起始地址
+ * @param data 输出数据缓冲区
+ * @param data_size 读取字节数
+ * @param actual_size 从起始地址开始连续读到的字节数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_read_block_addr(df1_serial_t* df1_serial, const df1_address_t* addr,
+                              uint8_t* data, size_t data_size, size_t* actual_size);
+
+/**
+ * @brief 使用已解析的地址写入任意长度的连续元素
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param addr 已解析的起始地址
+ * @param data 写入数据
+ * @param data_size 数据大小
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_write_block_addr(df1_serial_t* df1_serial, const df1_address_t* addr,
+                               const uint8_t* data, size_t data_size);
+
+/**
+ * @brief 掩码写：一次往返修改一个字中的若干位
+ *
+ * mask 中置1的位被设置为 value 中对应的位，其余位由PLC保持不变。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 地址字符串，如 "B3:0"、"N7:2"
+ * @param mask 要修改的位
+ * @param value 新的位值
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_mask_write(df1_serial_t* df1_serial, const char* address, uint16_t mask, uint16_t value);
+
+/**
+ * @brief 将一个字中 mask 指定的位置1
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 地址字符串
+ * @param mask 要置1的位
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_set_bits(df1_serial_t* df1_serial, const char* address, uint16_t mask);
+
+/**
+ * @brief 将一个字中 mask 指定的位清0
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 地址字符串
+ * @param mask 要清0的位
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_clear_bits(df1_serial_t* df1_serial, const char* address, uint16_t mask);
+
+/**
+ * @brief 读取一个位
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 位地址，如 "B3:0/5"、"B3/37"、"T4:0/DN"
+ * @param value 输出位值
+ * @return 0 成功，-1 失败（包括地址不是位地址）
+ */
+int df1_serial_read_bit(df1_serial_t* df1_serial, const char* address, bool* value);
+
+/**
+ * @brief 写入一个位（掩码写，一次往返）
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 位地址
+ * @param value 位值
+ * @return 0 成功，-1 失败（包括地址不是位地址）
+ */
+int df1_serial_write_bit(df1_serial_t* df1_serial, const char* address, bool value);
+
+/**
+ * @brief 设置链路层参数
+ *
+ * 全双工方式下 max_outstanding 决定同时在途的命令数。连接已打开时立即生效，
+ * 未完成的命令将以失败结束。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param link_config 链路层配置
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_set_link_config(df1_serial_t* df1_serial, const df1_link_config_t* link_config);
+
+/**
+ * @brief 设置自适应超时参数
+ *
+ * 默认启用：等待应答与响应的超时按测得的往返时间计算（上限为 timeout_ms），
+ * 无应答或响应校验错误时以新的事务ID重发，连续无应答后判定从站离线，离线期间的请求
+ * 直接失败并定期放行一条探测。一个事务的总时间不超过 timeout_ms。char_time_us 为0时
+ * 打开连接时按串口参数计算。连接已打开时立即生效，已有的往返样本被清除。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param rtt_config 自适应超时配置，enabled 为 false 时恢复固定超时
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_set_rtt_config(df1_serial_t* df1_serial, const df1_rtt_config_t* rtt_config);
+
+/**
+ * @brief 获取连接统计的快照
+ *
+ * 可以在驱动该连接的线程之外调用。计数覆盖同步读写、批量事务与事件循环；
+ * 分阶段延迟中，半双工逐条执行时每个阶段对应一条命令，全双工流水时
+ * 首字节与帧接收按响应到达的先后计算。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param stats 输出快照
+ * @return 0 成功，-1 参数无效或编译时未定义 DF1_ENABLE_STATS
+ */
+int df1_serial_get_stats(df1_serial_t* df1_serial, df1_stats_t* stats);
+
+/**
+ * @brief 清零连接统计，应在连接空闲时调用
+ *
+ * @param df1_serial DF1串口通信实例
+ */
+void df1_serial_reset_stats(df1_serial_t* df1_serial);
+
+/**
+ * @brief 设置连接的线路抓包，之后收发的所有字节连同时间戳写入抓包缓冲区
+ *
+ * 事件循环与工作线程驱动的连接同样适用。抓包缓冲区由调用者创建并定期调用
+ * df1_capture_flush 写出，关闭连接时自动取消。
+ *
+ * @param df1_serial DF1串口通信实例（已打开）
+ * @param capture 抓包缓冲区，NULL 取消
+ * @return 0 成功，-1 连接未打开
+ */
+int df1_serial_set_capture(df1_serial_t* df1_serial, df1_capture_t* capture);
+
+/**
+ * @brief 执行一批读写请求
+ *
+ * 全双工方式下请求通过链路层流水发送：命令一经确认即发送下一条，最多同时有
+ * link_config.max_outstanding 条未完成，响应按事务ID匹配；半双工方式下依次执行。
+ * 每条请求的结果写入其 status / actual_size 字段。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param requests 请求数组
+ * @param count 请求数量
+ * @return 0 全部成功，-1 至少一条失败
+ */
+int df1_serial_transact(df1_serial_t* df1_serial, df1_request_t* requests, size_t count);
+
+/**
+ * @brief 直接向线路发送字节
+ *
+ * 供在连接之上实现轮询主站等链路流程使用，在 timeout_ms 内写完全部数据。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param data 待发送数据
+ * @param size 数据大小
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_send_raw(df1_serial_t* df1_serial, const uint8_t* data, size_t size);
+
+/**
+ * @brief 接收下一个链路事件（帧或控制字符）
+ *
+ * 使用连接自身的接收缓冲区与解码器，多余的字节保留给下一次调用。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param timeout_ms 超时（毫秒）
+ * @param frame 输出帧（仅返回 DF1_DECODE_FRAME 时有效，在下一次接收前有效）
+ * @return df1_decode_result_t；超时返回 DF1_DECODE_NEED_MORE
+ */
+int df1_serial_receive_event(df1_serial_t* df1_serial, int timeout_ms, df1_frame_t* frame);
+
 /**
  * @brief 读取16位整数
  * 
+ * 以下类型化读写检查地址的文件类型：16位整数与16位字只用于 N、B、S、I、O、T、C、R 文件，
+ * 32位长整数只用于 L 文件，浮点数只用于 F 文件，不符时失败，不按其他类型重新解释数据。
+ *
  * @param df1_serial DF1串口通信实例
  * @param address 地址字符串
  * @param value 输出值
@@ -137,6 +460,102 @@ int df1_serial_read_float(df1_serial_t* df1_serial, const char* address, float*
  */
 int df1_serial_write_float(df1_serial_t* df1_serial, const char* address, float value);
 
+/**
+ * @brief 读取16位整数数组（N 文件）
+ *
+ * 按块读写分段，数据直接读入 values 后原地转换为主机字节序。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 输出数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_read_int16_array(df1_serial_t* df1_serial, const char* address, int16_t* values, size_t count);
+
+/**
+ * @brief 写入16位整数数组（N 文件）
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 写入数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_write_int16_array(df1_serial_t* df1_serial, const char* address, const int16_t* values, size_t count);
+
+/**
+ * @brief 读取16位字数组（S / B 文件）
+ *
+ * 按块读写分段，数据直接读入 values 后原地转换为主机字节序。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 输出数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_read_uint16_array(df1_serial_t* df1_serial, const char* address, uint16_t* values, size_t count);
+
+/**
+ * @brief 写入16位字数组（S / B 文件）
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 写入数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_write_uint16_array(df1_serial_t* df1_serial, const char* address, const uint16_t* values, size_t count);
+
+/**
+ * @brief 读取32位长整数数组（L 文件）
+ *
+ * 按块读写分段，数据直接读入 values 后原地转换为主机字节序。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 输出数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_read_int32_array(df1_serial_t* df1_serial, const char* address, int32_t* values, size_t count);
+
+/**
+ * @brief 写入32位长整数数组（L 文件）
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 写入数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_write_int32_array(df1_serial_t* df1_serial, const char* address, const int32_t* values, size_t count);
+
+/**
+ * @brief 读取32位浮点数数组（F 文件）
+ *
+ * 按块读写分段，数据直接读入 values 后原地转换为主机字节序。
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 输出数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_read_float_array(df1_serial_t* df1_serial, const char* address, float* values, size_t count);
+
+/**
+ * @brief 写入32位浮点数数组（F 文件）
+ *
+ * @param df1_serial DF1串口通信实例
+ * @param address 起始地址字符串
+ * @param values 写入数组
+ * @param count 元素个数
+ * @return 0 成功，-1 失败
+ */
+int df1_serial_write_float_array(df1_serial_t* df1_serial, const char* address, const float* values, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,221 @@
+#ifndef AB_DF1_SIM_H_
+#define AB_DF1_SIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "df1_protocol.h"
+#include "df1_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 一条线路上模拟的从站数量上限
+ */
+#define DF1_SIM_MAX_STATIONS 32
+
+/**
+ * @brief 每个从站的数据文件数量上限
+ */
+#define DF1_SIM_MAX_FILES 32
+
+/**
+ * @brief 半双工轮询方式下每个从站等待轮询发送的响应数量上限
+ */
+#define DF1_SIM_OUTBOX_SIZE 8
+
+/**
+ * @brief 模拟从站配置
+ */
+typedef struct {
+    df1_duplex_t duplex;       // 链路工作方式
+    df1_check_type_t check_type; // 校验类型
+    bool polled;               // 半双工：响应等待主站轮询后发送（df1_master），否则确认后立即发送（df1_serial）
+    int latency_us;            // 处理命令的固定延迟（微秒）
+    int jitter_us;             // 在固定延迟上附加的 0~jitter_us 随机延迟
+    double drop_rate;          // 不应答命令的概率（模拟线路丢帧）
+    double nak_rate;           // 对校验正确的命令回复 DLE NAK 的概率
+    double corrupt_rate;       // 响应帧校验字节被破坏的概率
+    unsigned int seed;         // 随机数种子，相同种子得到相同的故障序列
+} df1_sim_config_t;
+
+/**
+ * @brief 模拟从站统计
+ */
+typedef struct {
+    unsigned long commands;    // 执行的命令数
+    unsigned long errors;      // 以错误状态应答的命令数（文件不存在、越界、不支持的命令）
+    unsigned long duplicates;  // 重复收到而未再次执行的命令数
+    unsigned long bad_frames;  // 收到的校验错误或格式错误的帧数
+    unsigned long dropped;     // 注入：不应答的命令数
+    unsigned long naks;        // 注入：回复 DLE NAK 的命令数
+    unsigned long corrupted;   // 注入：校验被破坏的响应数
+    unsigned long retransmits; // 主站 NAK 后重发的响应数
+    unsigned long polls;       // 收到的本线路从站的轮询数
+    unsigned long eots;        // 回复 DLE EOT 的轮询数
+} df1_sim_stats_t;
+
+/**
+ * @brief DF1 从站模拟器
+ *
+ * 在一条线路上模拟一个或多个从站，每个从站持有若干数据文件（N、F、B、T、C、L 等），
+ * 执行读（0xA2）、写（0xAA）与掩码写（0xAB）命令。全双工方式下按 DF1 链路规程应答
+ * DLE ACK/NAK 并在主站 NAK 时重发响应；半双工方式下按帧头站号区分从站，轮询方式下
+ * 应答 DLE ENQ 轮询。可注入处理延迟、丢帧、NAK 与校验错误，用于在没有PLC时测试和
+ * 测量库的吞吐量与尾延迟。
+ */
+typedef struct df1_sim df1_sim_t;
+
+/**
+ * @brief 初始化模拟从站配置为默认值（全双工、CRC16、无延迟、无故障）
+ *
+ * @param config 配置
+ */
+void df1_sim_config_default(df1_sim_config_t* config);
+
+/**
+ * @brief 创建模拟器
+ *
+ * @param config 配置，NULL 使用默认值
+ * @return 模拟器指针，失败返回NULL
+ */
+df1_sim_t* df1_sim_create(const df1_sim_config_t* config);
+
+/**
+ * @brief 销毁模拟器，停止服务线程并关闭传输层
+ *
+ * @param sim 模拟器
+ */
+void df1_sim_destroy(df1_sim_t* sim);
+
+/**
+ * @brief 添加从站
+ *
+ * @param sim 模拟器
+ * @param station 站号（半双工帧头中的 STN，全双工命令中的 DST）
+ * @return 0 成功，-1 已存在或超过上限
+ */
+int df1_sim_add_station(df1_sim_t* sim, uint8_t station);
+
+/**
+ * @brief 为从站添加数据文件，内容初始化为0
+ *
+ * @param sim 模拟器
+ * @param station 站号
+ * @param type 数据类型
+ * @param file 文件号
+ * @param elements 元素数
+ * @return 0 成功，-1 从站不存在、文件已存在或超过上限
+ */
+int df1_sim_add_file(df1_sim_t* sim, uint8_t station, df1_addr_type_t type, uint16_t file, size_t elements);
+
+/**
+ * @brief 读取从站数据表
+ *
+ * @param sim 模拟器
+ * @param station 站号
+ * @param address 地址字符串，如 "N7:0"、"T4:0.ACC"
+ * @param data 输出缓冲区
+ * @param size 读取字节数
+ * @return 0 成功，-1 地址无效或越界
+ */
+int df1_sim_get(df1_sim_t* sim, uint8_t station, const char* address, uint8_t* data, size_t size);
+
+/**
+ * @brief 写入从站数据表
+ *
+ * @param sim 模拟器
+ * @param station 站号
+ * @param address 地址字符串
+ * @param data 写入数据
+ * @param size 写入字节数
+ * @return 0 成功，-1 地址无效或越界
+ */
+int df1_sim_set(df1_sim_t* sim, uint8_t station, const char* address, const uint8_t* data, size_t size);
+
+/**
+ * @brief 更新故障注入参数（延迟、丢帧、NAK、校验错误），运行中可以调用
+ *
+ * @param sim 模拟器
+ * @param config 配置，其中的链路方式与校验类型被忽略
+ */
+void df1_sim_set_faults(df1_sim_t* sim, const df1_sim_config_t* config);
+
+/**
+ * @brief 使用已打开的传输层（如 TCP 连接），按值接管
+ *
+ * @param sim 模拟器
+ * @param transport 已打开的传输层
+ * @return 0 成功，-1 已连接传输层
+ */
+int df1_sim_attach(df1_sim_t* sim, const df1_transport_t* transport);
+
+/**
+ * @brief 在伪终端主设备一侧模拟从站，连接通过 df1_sim_port_name 打开从设备
+ *
+ * @param sim 模拟器
+ * @return 0 成功，-1 失败
+ */
+int df1_sim_open_pty(df1_sim_t* sim);
+
+/**
+ * @brief 通过内存回环模拟从站
+ *
+ * 命令在主站发送时同步处理，单线程即可完成往返，不经过内核。
+ * 主站一端用于 df1_serial_open_transport。
+ *
+ * @param sim 模拟器
+ * @param master 输出主站一端
+ * @return 0 成功，-1 失败
+ */
+int df1_sim_open_loopback(df1_sim_t* sim, df1_transport_t* master);
+
+/**
+ * @brief 获取伪终端从设备名称
+ *
+ * @param sim 模拟器
+ * @return 从设备名称，不是伪终端时返回NULL
+ */
+const char* df1_sim_port_name(const df1_sim_t* sim);
+
+/**
+ * @brief 处理已到达的数据，最多等待 timeout_ms
+ *
+ * 供调用者在自己的循环中驱动模拟器；与 df1_sim_start 二选一。
+ *
+ * @param sim 模拟器
+ * @param timeout_ms 等待时间（毫秒）
+ * @return 0 成功，-1 传输层出错
+ */
+int df1_sim_process(df1_sim_t* sim, int timeout_ms);
+
+/**
+ * @brief 启动服务线程（伪终端或已接管的传输层）
+ *
+ * @param sim 模拟器
+ * @return 0 成功，-1 失败
+ */
+int df1_sim_start(df1_sim_t* sim);
+
+/**
+ * @brief 停止服务线程
+ *
+ * @param sim 模拟器
+ */
+void df1_sim_stop(df1_sim_t* sim);
+
+/**
+ * @brief 获取统计
+ *
+ * @param sim 模拟器
+ * @param stats 输出统计
+ */
+void df1_sim_get_stats(df1_sim_t* sim, df1_sim_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_SIM_H_
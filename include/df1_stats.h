@@ -0,0 +1,162 @@
+#ifndef AB_DF1_STATS_H_
+#define AB_DF1_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 直方图每个2的幂区间内的子区间位数，相对误差不超过 1/16
+ */
+#define DF1_HISTOGRAM_SUB_BITS 4
+
+/**
+ * @brief 直方图每个2的幂区间内的子区间数
+ */
+#define DF1_HISTOGRAM_SUB_BUCKETS (1 << DF1_HISTOGRAM_SUB_BITS)
+
+/**
+ * @brief 直方图可区分的最大值的位数（2^40 纳秒约18分钟），更大的值计入最后一个区间
+ */
+#define DF1_HISTOGRAM_MAX_BITS 40
+
+/**
+ * @brief 直方图区间数：小值区间、各2的幂区间与最后一个超出范围的区间
+ */
+#define DF1_HISTOGRAM_BUCKETS ((DF1_HISTOGRAM_MAX_BITS - DF1_HISTOGRAM_SUB_BITS + 2) * DF1_HISTOGRAM_SUB_BUCKETS + 1)
+
+/**
+ * @brief 对数-线性延迟直方图（HDR 风格），单位纳秒
+ *
+ * 小于 DF1_HISTOGRAM_SUB_BUCKETS 的值各占一个区间，之后每个2的幂区间等分为
+ * DF1_HISTOGRAM_SUB_BUCKETS 个子区间。记录只需一次最高位计算与一次计数。
+ */
+typedef struct {
+    uint64_t count;            // 样本数
+    uint64_t sum_ns;           // 样本总和
+    uint64_t min_ns;           // 最小值（count 为0时无效）
+    uint64_t max_ns;           // 最大值
+    uint64_t buckets[DF1_HISTOGRAM_BUCKETS]; // 各区间计数
+} df1_histogram_t;
+
+/**
+ * @brief 事务的计时阶段
+ */
+typedef enum {
+    DF1_PHASE_ENCODE = 0,      // 命令编码
+    DF1_PHASE_TRANSMIT,        // 命令帧写入传输层（等待发送缓冲区排空）
+    DF1_PHASE_FIRST_BYTE,      // 命令写完到收到第一个应答字节（ACK 或响应帧）
+    DF1_PHASE_FRAME,           // 第一个应答字节到响应帧接收完整
+    DF1_PHASE_DECODE,          // 解码得到响应帧（去转义、校验）
+    DF1_PHASE_TOTAL,           // 事务开始到完成
+    DF1_PHASE_COUNT
+} df1_phase_t;
+
+/**
+ * @brief 连接的统计计数与分阶段延迟直方图
+ *
+ * 每个连接一份，由驱动该连接的线程单独写入，写入为不加锁的原子读加写，
+ * 其他线程可随时通过 df1_serial_get_stats 取得快照。定义 DF1_ENABLE_STATS
+ * 时编译统计，否则记录宏为空且连接中不包含统计。
+ */
+typedef struct {
+    uint64_t transactions;     // 完成的事务数（含失败）
+    uint64_t errors;           // 失败的事务数（含错误状态应答）
+    uint64_t bytes_sent;       // 写入传输层的字节数
+    uint64_t bytes_received;   // 从传输层读取的字节数
+    uint64_t crc_errors;       // 校验错误的帧数
+    uint64_t naks_received;    // 收到的 DLE NAK 数
+    uint64_t naks_sent;        // 发送的 DLE NAK 数
+    uint64_t timeouts;         // 超时（ACK 询问次数用尽或等待响应超时）
+    uint64_t retries;          // 重试（NAK 后重发与 ACK 超时后发送 DLE ENQ）
+    df1_histogram_t phases[DF1_PHASE_COUNT]; // 各阶段延迟
+    uint64_t tx_start_ns;      // 链路层：发送缓冲区开始有数据的时间
+    uint64_t awaiting_ns;      // 链路层：命令写完、等待应答的开始时间
+    uint64_t first_byte_ns;    // 链路层：收到第一个应答字节的时间
+} df1_stats_t;
+
+/**
+ * @brief 清零统计
+ *
+ * @param stats 统计
+ */
+void df1_stats_reset(df1_stats_t* stats);
+
+/**
+ * @brief 复制统计快照，逐项原子读取，可与写入线程并发调用
+ *
+ * @param dst 输出快照
+ * @param src 统计
+ */
+void df1_stats_snapshot(df1_stats_t* dst, const df1_stats_t* src);
+
+/**
+ * @brief 获取单调时钟（纳秒）
+ *
+ * @return 纳秒
+ */
+uint64_t df1_stats_now_ns(void);
+
+/**
+ * @brief 记录一个样本（单一写入线程）
+ *
+ * @param histogram 直方图
+ * @param value_ns 样本（纳秒）
+ */
+void df1_histogram_record(df1_histogram_t* histogram, uint64_t value_ns);
+
+/**
+ * @brief 计算分位数
+ *
+ * @param histogram 直方图
+ * @param quantile 分位，如 0.5、0.99、0.999
+ * @return 该分位所在区间的上界（纳秒），不超过记录的最大值；没有样本时返回0
+ */
+uint64_t df1_histogram_percentile(const df1_histogram_t* histogram, double quantile);
+
+/**
+ * @brief 计算平均值
+ *
+ * @param histogram 直方图
+ * @return 平均值（纳秒），没有样本时返回0
+ */
+double df1_histogram_mean(const df1_histogram_t* histogram);
+
+/**
+ * @brief 获取阶段名称
+ *
+ * @param phase 阶段
+ * @return 名称，如 "encode"
+ */
+const char* df1_phase_name(df1_phase_t phase);
+
+/**
+ * @brief 单一写入者的计数累加：原子读加写，不需要总线锁
+ */
+static inline void df1_stats_add(uint64_t* counter, uint64_t value)
+{
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+#ifdef DF1_ENABLE_STATS
+#define DF1_STATS_ADD(stats, field, value) df1_stats_add(&(stats)->field, (uint64_t)(value))
+#define DF1_STATS_TIME(name) uint64_t name = df1_stats_now_ns()
+#define DF1_STATS_MARK(name) ((name) = df1_stats_now_ns())
+#define DF1_STATS_RECORD(stats, phase, start, end) \
+    df1_histogram_record(&(stats)->phases[(phase)], (end) - (start))
+#else
+#define DF1_STATS_ADD(stats, field, value) ((void)0)
+#define DF1_STATS_TIME(name) ((void)0)
+#define DF1_STATS_MARK(name) ((void)0)
+#define DF1_STATS_RECORD(stats, phase, start, end) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_STATS_H_
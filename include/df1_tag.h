@@ -0,0 +1,96 @@
+#ifndef AB_DF1_TAG_H_
+#define AB_DF1_TAG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "df1_address.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 标签句柄，小于0表示无效
+ */
+typedef int32_t df1_tag_t;
+
+#define DF1_TAG_INVALID (-1)
+
+/**
+ * @brief 标签表默认容量上限，超出后不再缓存新标签
+ */
+#define DF1_TAG_TABLE_DEFAULT_LIMIT 4096
+
+/**
+ * @brief 标签表：将地址字符串一次性解析并缓存为 df1_address_t
+ *
+ * 返回的地址指针在标签表销毁前始终有效，可长期保存在扫描循环中。
+ */
+typedef struct df1_tag_table df1_tag_table_t;
+
+/**
+ * @brief 创建标签表
+ *
+ * @param limit 最多缓存的标签数量，0 表示使用默认值
+ * @return 标签表指针，失败返回NULL
+ */
+df1_tag_table_t* df1_tag_table_create(size_t limit);
+
+/**
+ * @brief 销毁标签表
+ *
+ * @param table 标签表指针
+ */
+void df1_tag_table_destroy(df1_tag_table_t* table);
+
+/**
+ * @brief 将地址字符串加入标签表
+ *
+ * 同一字符串重复加入时返回同一个句柄，只在第一次加入时解析。
+ *
+ * @param table 标签表
+ * @param address_str 地址字符串，如 "N7:0"
+ * @return 标签句柄，地址无效或标签表已满时返回 DF1_TAG_INVALID
+ */
+df1_tag_t df1_tag_table_intern(df1_tag_table_t* table, const char* address_str);
+
+/**
+ * @brief 查找或加入地址字符串并返回解析后的地址
+ *
+ * @param table 标签表
+ * @param address_str 地址字符串
+ * @return 地址指针，失败返回NULL
+ */
+const df1_address_t* df1_tag_table_lookup(df1_tag_table_t* table, const char* address_str);
+
+/**
+ * @brief 通过句柄获取解析后的地址
+ *
+ * @param table 标签表
+ * @param tag 标签句柄
+ * @return 地址指针，句柄无效返回NULL
+ */
+const df1_address_t* df1_tag_table_get(const df1_tag_table_t* table, df1_tag_t tag);
+
+/**
+ * @brief 通过句柄获取原始地址字符串
+ *
+ * @param table 标签表
+ * @param tag 标签句柄
+ * @return 地址字符串，句柄无效返回NULL
+ */
+const char* df1_tag_table_name(const df1_tag_table_t* table, df1_tag_t tag);
+
+/**
+ * @brief 获取标签表中的标签数量
+ *
+ * @param table 标签表
+ * @return 标签数量
+ */
+size_t df1_tag_table_count(const df1_tag_table_t* table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_TAG_H_
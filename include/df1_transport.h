@@ -0,0 +1,230 @@
+#ifndef AB_DF1_TRANSPORT_H_
+#define AB_DF1_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "df1_capture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief TCP 连接的端口名前缀，如 "tcp://192.168.1.20:4001"
+ */
+#define DF1_TCP_PREFIX "tcp://"
+
+/**
+ * @brief 内存回环每个方向的缓冲区大小
+ */
+#define DF1_LOOPBACK_BUFFER_SIZE 4096
+
+/**
+ * @brief 等待事件
+ */
+#define DF1_TRANSPORT_READ 0x01    // 有数据可读（或对端关闭）
+#define DF1_TRANSPORT_WRITE 0x02   // 可以写入
+
+/**
+ * @brief 串口配置结构体
+ */
+typedef struct {
+    char port_name[64];        // 串口名称，如 "/dev/ttyUSB0"；"tcp://主机:端口" 表示经终端服务器的TCP连接
+    int baud_rate;             // 波特率
+    int data_bits;             // 数据位
+    int stop_bits;             // 停止位
+    int parity;                // 校验位: 0=None, 1=Odd, 2=Even
+    int timeout_ms;            // 超时时间（毫秒）
+    bool low_latency;          // 终端设备：设置内核低延迟标志，USB 转串口不再等待延迟定时器；驱动不支持时忽略
+    bool rs485;                // 终端设备：由驱动控制 RS-485 收发方向（发送期间 RTS 有效）；驱动不支持时打开失败
+    int rs485_delay_before_ms; // RS-485：RTS 有效后到开始发送的延迟
+    int rs485_delay_after_ms;  // RS-485：发送结束后到释放 RTS 的延迟
+    bool drain;                // 终端设备：每次写入后 tcdrain 等到最后一个字节移出串口；等待失败时写入失败；false 时写入内核缓冲区即返回
+} df1_serial_config_t;
+
+typedef struct df1_transport df1_transport_t;
+
+/**
+ * @brief 传输层操作表
+ *
+ * send 与 recv 的语义与非阻塞的 write/readv 相同：返回传输的字节数，-1 表示失败，
+ * 此时 errno 为 EAGAIN 表示暂时无法传输。recv 返回0表示对端已关闭。
+ */
+typedef struct {
+    const char* name;          // 后端名称
+    int (*open)(df1_transport_t* transport, const df1_serial_config_t* config); // 可以为NULL
+    ssize_t (*send)(df1_transport_t* transport, const uint8_t* data, size_t size);
+    ssize_t (*recv)(df1_transport_t* transport, const struct iovec* iov, int count);
+    int (*wait)(df1_transport_t* transport, int events, int timeout_ms); // 1 就绪，0 超时，-1 失败
+    int (*set_min_read)(df1_transport_t* transport, size_t size); // 可以为NULL
+    void (*close)(df1_transport_t* transport);
+} df1_transport_ops_t;
+
+/**
+ * @brief 传输层连接
+ *
+ * 作为值嵌入在连接结构中，不单独分配。
+ */
+struct df1_transport {
+    const df1_transport_ops_t* ops; // 后端，NULL 表示未打开
+    int fd;                    // 可供 poll/epoll 等待的文件描述符，内存回环为-1
+    int vmin;                  // 串口当前的 VMIN，-1 表示不是终端设备
+    bool drain;                // 终端设备每次写入后等待发送完成
+    void* context;             // 后端私有数据
+    df1_capture_t* capture;    // 线路抓包，NULL 表示不抓包
+};
+
+/**
+ * @brief 终端设备（串口、USB 转串口、伪终端从设备），按配置设置波特率等参数
+ *
+ * 标准波特率经 cfsetspeed 设置；其他波特率在 Linux 上经 termios2 的 BOTHER 设置任意值
+ * （由驱动取最接近的分频），其他平台上打开失败。
+ */
+extern const df1_transport_ops_t df1_transport_serial;
+
+/**
+ * @brief TCP 连接，端口名为 "tcp://主机:端口"，IPv6 地址写作 "tcp://[::1]:端口"
+ */
+extern const df1_transport_ops_t df1_transport_tcp;
+
+/**
+ * @brief 伪终端主设备，从设备名称由 df1_transport_pty_name 获取，忽略配置
+ */
+extern const df1_transport_ops_t df1_transport_pty;
+
+/**
+ * @brief 进程内的内存回环，由 df1_transport_loopback_pair 创建
+ */
+extern const df1_transport_ops_t df1_transport_loopback;
+
+/**
+ * @brief 内存回环收到数据时的处理函数
+ *
+ * 在发送方的线程中、发送完成后同步调用，处理函数可以在其中读取并应答，
+ * 单线程即可完成一次往返，不经过内核。
+ *
+ * @param user_data 用户数据
+ * @param transport 收到数据的一端
+ */
+typedef void (*df1_loopback_handler_t)(void* user_data, df1_transport_t* transport);
+
+/**
+ * @brief 将传输层初始化为未打开状态
+ *
+ * @param transport 传输层
+ */
+void df1_transport_init(df1_transport_t* transport);
+
+/**
+ * @brief 使用指定后端打开传输层
+ *
+ * @param transport 传输层
+ * @param ops 后端
+ * @param config 串口配置（端口名、波特率、超时等）
+ * @return 0 成功，-1 失败
+ */
+int df1_transport_open(df1_transport_t* transport, const df1_transport_ops_t* ops,
+                       const df1_serial_config_t* config);
+
+/**
+ * @brief 按端口名选择后端并打开：DF1_TCP_PREFIX 开头为 TCP，否则为终端设备
+ *
+ * @param transport 传输层
+ * @param config 串口配置
+ * @return 0 成功，-1 失败
+ */
+int df1_transport_open_auto(df1_transport_t* transport, const df1_serial_config_t* config);
+
+/**
+ * @brief 创建一对相连的内存回环
+ *
+ * 一端发送的数据由另一端接收。两端可以在同一线程中配合处理函数使用，也可以分属不同线程。
+ *
+ * @param a 一端
+ * @param b 另一端
+ * @return 0 成功，-1 内存不足
+ */
+int df1_transport_loopback_pair(df1_transport_t* a, df1_transport_t* b);
+
+/**
+ * @brief 设置内存回环一端的收到数据处理函数
+ *
+ * @param transport 内存回环的一端
+ * @param handler 处理函数，NULL 取消
+ * @param user_data 用户数据
+ * @return 0 成功，-1 不是内存回环
+ */
+int df1_transport_loopback_set_handler(df1_transport_t* transport, df1_loopback_handler_t handler,
+                                       void* user_data);
+
+/**
+ * @brief 获取伪终端从设备名称
+ *
+ * @param transport 伪终端主设备
+ * @return 从设备名称，不是伪终端时返回NULL
+ */
+const char* df1_transport_pty_name(const df1_transport_t* transport);
+
+/**
+ * @brief 设置线路抓包：之后每次成功的收发都写入抓包缓冲区
+ *
+ * 关闭传输层时取消。一个抓包缓冲区只能用于一个传输层。
+ *
+ * @param transport 传输层
+ * @param capture 抓包缓冲区，NULL 取消
+ */
+void df1_transport_set_capture(df1_transport_t* transport, df1_capture_t* capture);
+
+/**
+ * @brief 发送数据，见 df1_transport_ops_t
+ */
+ssize_t df1_transport_send(df1_transport_t* transport, const uint8_t* data, size_t size);
+
+/**
+ * @brief 接收数据到一组缓冲区，见 df1_transport_ops_t
+ */
+ssize_t df1_transport_recv(df1_transport_t* transport, const struct iovec* iov, int count);
+
+/**
+ * @brief 等待可读或可写
+ *
+ * @param transport 传输层
+ * @param events DF1_TRANSPORT_READ 和/或 DF1_TRANSPORT_WRITE
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 1 就绪，0 超时，-1 失败
+ */
+int df1_transport_wait(df1_transport_t* transport, int events, int timeout_ms);
+
+/**
+ * @brief 提示下一次等待可读时至少需要的字节数
+ *
+ * 终端设备据此设置 VMIN，减少唤醒次数；其他后端忽略。
+ *
+ * @param transport 传输层
+ * @param size 字节数（1-255）
+ */
+void df1_transport_set_min_read(df1_transport_t* transport, size_t size);
+
+/**
+ * @brief 获取可供 poll/epoll 等待的文件描述符
+ *
+ * @param transport 传输层
+ * @return 文件描述符，内存回环等没有文件描述符的后端返回-1
+ */
+int df1_transport_poll_fd(const df1_transport_t* transport);
+
+/**
+ * @brief 关闭传输层
+ *
+ * @param transport 传输层
+ */
+void df1_transport_close(df1_transport_t* transport);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_TRANSPORT_H_
@@ -0,0 +1,96 @@
+#ifndef AB_DF1_WORKER_H_
+#define AB_DF1_WORKER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "df1_serial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 请求优先级，数值越小越先执行
+ */
+typedef enum {
+    DF1_PRIORITY_HIGH = 0,     // 操作员写入等需要立即执行的请求
+    DF1_PRIORITY_NORMAL = 1,   // 普通请求
+    DF1_PRIORITY_LOW = 2,      // 后台扫描读取
+    DF1_PRIORITY_COUNT = 3
+} df1_priority_t;
+
+/**
+ * @brief 异步请求完成回调，在工作线程中调用
+ *
+ * @param user_data 提交请求时传入的用户数据
+ * @param request 已完成的请求
+ */
+typedef void (*df1_worker_callback_t)(void* user_data, df1_request_t* request);
+
+/**
+ * @brief 共享连接的工作线程
+ *
+ * 任意线程都可以向同一个连接提交请求：入队为无锁多生产者单消费者队列，每个优先级一条，
+ * 由该连接独占的工作线程按优先级取出并执行。全双工方式下一次最多取出
+ * link_config.max_outstanding 条请求流水执行。事务ID与串口读写只在工作线程中访问。
+ */
+typedef struct df1_worker df1_worker_t;
+
+/**
+ * @brief 为已打开的连接创建工作线程
+ *
+ * 创建后该连接只能通过工作线程访问，直到 df1_worker_destroy 返回。
+ *
+ * @param port 已打开的连接
+ * @return 工作线程指针，失败返回NULL
+ */
+df1_worker_t* df1_worker_create(df1_serial_t* port);
+
+/**
+ * @brief 停止并销毁工作线程
+ *
+ * 正在执行的请求完成后停止，队列中尚未执行的请求以失败状态完成。
+ * 调用前须确保其他线程不再提交请求。
+ *
+ * @param worker 工作线程
+ */
+void df1_worker_destroy(df1_worker_t* worker);
+
+/**
+ * @brief 提交一条异步请求（线程安全）
+ *
+ * 完成之前请求及其缓冲区必须保持有效。
+ *
+ * @param worker 工作线程
+ * @param request 请求
+ * @param priority 优先级
+ * @param callback 完成回调，可以为NULL
+ * @param user_data 回调用户数据
+ * @return 0 成功，-1 失败
+ */
+int df1_worker_submit(df1_worker_t* worker, df1_request_t* request, df1_priority_t priority,
+                      df1_worker_callback_t callback, void* user_data);
+
+/**
+ * @brief 提交一条请求并等待完成（线程安全）
+ *
+ * @param worker 工作线程
+ * @param request 请求
+ * @param priority 优先级
+ * @return 0 成功，-1 失败
+ */
+int df1_worker_execute(df1_worker_t* worker, df1_request_t* request, df1_priority_t priority);
+
+/**
+ * @brief 获取已提交但尚未取出执行的请求数
+ *
+ * @param worker 工作线程
+ * @return 请求数
+ */
+size_t df1_worker_queued(const df1_worker_t* worker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_DF1_WORKER_H_
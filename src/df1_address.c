@@ -4,6 +4,126 @@
 #include <stdio.h>
 #include <ctype.h>
 
+// 定时器、计数器、控制元素的子元素与控制位助记符
+typedef struct {
+    df1_addr_type_t data_code;
+    const char* name;
+    uint16_t sub_element;
+    int bit;                     // -1 表示整个子元素
+} mnemonic_t;
+
+static const mnemonic_t mnemonics[] = {
+    {DF1_ADDR_T, "EN", 0, 15}, {DF1_ADDR_T, "TT", 0, 14}, {DF1_ADDR_T, "DN", 0, 13},
+    {DF1_ADDR_T, "PRE", 1, -1}, {DF1_ADDR_T, "ACC", 2, -1},
+    {DF1_ADDR_C, "CU", 0, 15}, {DF1_ADDR_C, "CD", 0, 14}, {DF1_ADDR_C, "DN", 0, 13},
+    {DF1_ADDR_C, "OV", 0, 12}, {DF1_ADDR_C, "UN", 0, 11}, {DF1_ADDR_C, "UA", 0, 10},
+    {DF1_ADDR_C, "PRE", 1, -1}, {DF1_ADDR_C, "ACC", 2, -1},
+    {DF1_ADDR_R, "EN", 0, 15}, {DF1_ADDR_R, "EU", 0, 14}, {DF1_ADDR_R, "DN", 0, 13},
+    {DF1_ADDR_R, "EM", 0, 12}, {DF1_ADDR_R, "ER", 0, 11}, {DF1_ADDR_R, "UL", 0, 10},
+    {DF1_ADDR_R, "IN", 0, 9}, {DF1_ADDR_R, "FD", 0, 8},
+    {DF1_ADDR_R, "LEN", 1, -1}, {DF1_ADDR_R, "POS", 2, -1},
+};
+
+#define MNEMONIC_COUNT (sizeof(mnemonics) / sizeof(mnemonics[0]))
+
+// 解析十进制数，至少一位数字
+static int parse_number(const char** p, unsigned long limit, unsigned long* value)
+{
+    if (!isdigit((unsigned char)**p))
+    {
+        return -1;
+    }
+
+    unsigned long result = 0;
+    while (isdigit((unsigned char)**p))
+    {
+        result = result * 10 + (unsigned long)(**p - '0');
+        if (result > limit)
+        {
+            return -1;
+        }
+        (*p)++;
+    }
+
+    *value = result;
+    return 0;
+}
+
+// 解析助记符，*p 指向助记符首字母
+static const mnemonic_t* parse_mnemonic(const char** p, df1_addr_type_t data_code)
+{
+    char name[4] = {0};
+    size_t length = 0;
+    while (isalpha((unsigned char)(*p)[length]))
+    {
+        if (length >= 3)
+        {
+            return NULL;
+        }
+        name[length] = (char)toupper((unsigned char)(*p)[length]);
+        length++;
+    }
+
+    for (size_t i = 0; i < MNEMONIC_COUNT; i++)
+    {
+        if (mnemonics[i].data_code == data_code && strcmp(mnemonics[i].name, name) == 0)
+        {
+            *p += length;
+            return &mnemonics[i];
+        }
+    }
+    return NULL;
+}
+
+// 解析元素号之后的 .子元素 与 /位
+// 只有定时器、计数器、控制元素（3个字）有子元素；位只能寻址16位字，F、L、ST 文件没有位地址
+static int parse_suffix(const char* p, df1_address_t* addr)
+{
+    unsigned long value;
+    size_t element_size = df1_address_element_size(addr->data_code);
+
+    if (*p == '.' || (*p == '/' && isalpha((unsigned char)p[1])))
+    {
+        p++;
+        if (isdigit((unsigned char)*p))
+        {
+            if (element_size != 6 || parse_number(&p, element_size / 2 - 1, &value) != 0)
+            {
+                return -1;
+            }
+            addr->sub_element = (uint16_t)value;
+        }
+        else
+        {
+            const mnemonic_t* mnemonic = parse_mnemonic(&p, addr->data_code);
+            if (!mnemonic)
+            {
+                return -1;
+            }
+            addr->sub_element = mnemonic->sub_element;
+            if (mnemonic->bit >= 0)
+            {
+                addr->bit = (uint8_t)mnemonic->bit;
+                addr->has_bit = true;
+                return *p == '\0' ? 0 : -1;
+            }
+        }
+    }
+
+    if (*p == '/')
+    {
+        p++;
+        if ((element_size != 2 && element_size != 6) || parse_number(&p, 15, &value) != 0)
+        {
+            return -1;
+        }
+        addr->bit = (uint8_t)value;
+        addr->has_bit = true;
+    }
+
+    return *p == '\0' ? 0 : -1;
+}
+
 int df1_address_parse(const char* address_str, df1_address_t* addr)
 {
     if (!address_str || !addr)
@@ -11,22 +131,24 @@ int df1_address_parse(const char* address_str, df1_address_t* addr)
         return -1;
     }
 
-    // 查找冒号分隔符
+    // 查找冒号分隔符；B 文件的位地址可以省略元素，如 B3/37
     const char* colon = strchr(address_str, ':');
-    if (!colon)
+    const char* separator = colon ? colon : strchr(address_str, '/');
+    if (!separator)
     {
         return -1; // 地址格式错误，必须包含':'
     }
 
     // 解析地址类型和文件号
-    size_t prefix_len = colon - address_str;
+    size_t prefix_len = separator - address_str;
     char prefix[16] = {0};
-    if (prefix_len >= sizeof(prefix))
+    if (prefix_len == 0 || prefix_len >= sizeof(prefix))
     {
         return -1; // 前缀太长
     }
 
     strncpy(prefix, address_str, prefix_len);
+    memset(addr, 0, sizeof(df1_address_t));
 
     // 解析地址类型
     char addr_type = toupper(prefix[0]);
@@ -90,11 +212,49 @@ int df1_address_parse(const char* address_str, df1_address_t* addr)
         return -1; // 不支持的地址类型
     }
 
+    unsigned long value;
+    const char* p = separator + 1;
+    if (!colon)
+    {
+        // 按位编号的 B 文件地址，每个元素16位
+        if (addr->data_code != DF1_ADDR_B || parse_number(&p, 0xFFFFF, &value) != 0 || *p != '\0' ||
+            value / 16 > 0xFFFF)
+        {
+            return -1;
+        }
+        addr->address_start = (uint16_t)(value / 16);
+        addr->bit = (uint8_t)(value % 16);
+        addr->has_bit = true;
+        return 0;
+    }
+
     // 解析起始地址
-    addr->address_start = (uint16_t)atoi(colon + 1);
+    if (parse_number(&p, 0xFFFF, &value) != 0)
+    {
+        return -1;
+    }
+    addr->address_start = (uint16_t)value;
     addr->length = 0; // 默认长度为0，由调用者设置
 
-    return 0;
+    return parse_suffix(p, addr);
+}
+
+// 查找地址对应的助记符：控制位按位号，其余按子元素号
+static const mnemonic_t* find_mnemonic(const df1_address_t* addr)
+{
+    for (size_t i = 0; i < MNEMONIC_COUNT; i++)
+    {
+        const mnemonic_t* mnemonic = &mnemonics[i];
+        if (mnemonic->data_code != addr->data_code || mnemonic->sub_element != addr->sub_element)
+        {
+            continue;
+        }
+        if (mnemonic->bit >= 0 ? (addr->has_bit && mnemonic->bit == addr->bit) : addr->sub_element != 0)
+        {
+            return mnemonic;
+        }
+    }
+    return NULL;
 }
 
 int df1_address_to_string(const df1_address_t* addr, char* buffer, size_t buffer_size)
@@ -148,6 +308,61 @@ int df1_address_to_string(const df1_address_t* addr, char* buffer, size_t buffer
     }
 
     int result = snprintf(buffer, buffer_size, "%s%u:%u", type_str, addr->db_block, addr->address_start);
+    if (result < 0 || result >= (int)buffer_size)
+    {
+        return -1;
+    }
 
-    return (result >= 0 && result < (int)buffer_size) ? 0 : -1;
+    // 子元素与控制位优先使用助记符
+    size_t used = (size_t)result;
+    const mnemonic_t* mnemonic = find_mnemonic(addr);
+    result = 0;
+    if (mnemonic && mnemonic->bit >= 0)
+    {
+        result = snprintf(buffer + used, buffer_size - used, "/%s", mnemonic->name);
+    }
+    else
+    {
+        if (mnemonic)
+        {
+            result = snprintf(buffer + used, buffer_size - used, ".%s", mnemonic->name);
+        }
+        else if (addr->sub_element != 0)
+        {
+            result = snprintf(buffer + used, buffer_size - used, ".%u", addr->sub_element);
+        }
+
+        if (addr->has_bit && result >= 0 && used + (size_t)result < buffer_size)
+        {
+            used += (size_t)result;
+            result = snprintf(buffer + used, buffer_size - used, "/%u", addr->bit);
+        }
+    }
+
+    return (result >= 0 && used + (size_t)result < buffer_size) ? 0 : -1;
+}
+
+size_t df1_address_element_size(df1_addr_type_t data_code)
+{
+    switch (data_code)
+    {
+    case DF1_ADDR_A:
+    case DF1_ADDR_B:
+    case DF1_ADDR_N:
+    case DF1_ADDR_S:
+    case DF1_ADDR_I:
+    case DF1_ADDR_O:
+        return 2;
+    case DF1_ADDR_F:
+    case DF1_ADDR_L:
+        return 4;
+    case DF1_ADDR_C:
+    case DF1_ADDR_R:
+    case DF1_ADDR_T:
+        return 6;
+    case DF1_ADDR_ST:
+        return 84;
+    default:
+        return 0;
+    }
 }
@@ -0,0 +1,348 @@
+#define _POSIX_C_SOURCE 200809L
+#include "df1_capture.h"
+#include "df1_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+// 缓冲区中每条记录的头：时间戳、数据长度、方向，数据按8字节对齐
+typedef struct {
+    uint64_t timestamp_ns;
+    uint32_t size;
+    uint32_t direction;
+} ring_record_t;
+
+// 文件中的记录头：时间戳(8) 长度(2) 方向(1)，小端序
+#define TRACE_RECORD_HEADER_SIZE 11
+#define TRACE_HEADER_SIZE 32
+#define CAPTURE_MIN_SIZE 4096
+
+struct df1_capture {
+    uint8_t* ring;               // 环形缓冲区
+    size_t size;                 // 缓冲区大小（2的幂）
+    uint64_t head;               // 写入位置，只由写入方修改
+    uint64_t tail;               // 读取位置，只由 flush 修改
+    uint64_t dropped;            // 缓冲区满时丢弃的记录数
+    pthread_mutex_t mutex;       // flush 之间互斥
+    FILE* file;                  // 抓包文件
+};
+
+static size_t record_space(size_t size)
+{
+    return sizeof(ring_record_t) + ((size + 7) & ~(size_t)7);
+}
+
+// 按环形方式复制，位置可以跨越缓冲区末尾
+static void ring_write(df1_capture_t* capture, uint64_t position, const void* data, size_t size)
+{
+    size_t offset = (size_t)(position & (capture->size - 1));
+    size_t first = capture->size - offset < size ? capture->size - offset : size;
+    memcpy(capture->ring + offset, data, first);
+    memcpy(capture->ring, (const uint8_t*)data + first, size - first);
+}
+
+static void ring_read(const df1_capture_t* capture, uint64_t position, void* data, size_t size)
+{
+    size_t offset = (size_t)(position & (capture->size - 1));
+    size_t first = capture->size - offset < size ? capture->size - offset : size;
+    memcpy(data, capture->ring + offset, first);
+    memcpy((uint8_t*)data + first, capture->ring, size - first);
+}
+
+df1_capture_t* df1_capture_create(size_t size)
+{
+    if (size == 0)
+    {
+        size = DF1_CAPTURE_DEFAULT_SIZE;
+    }
+    size_t rounded = CAPTURE_MIN_SIZE;
+    while (rounded < size)
+    {
+        if (rounded > SIZE_MAX / 2)
+        {
+            return NULL;
+        }
+        rounded <<= 1;
+    }
+
+    df1_capture_t* capture = (df1_capture_t*)calloc(1, sizeof(df1_capture_t));
+    if (!capture)
+    {
+        return NULL;
+    }
+    capture->ring = (uint8_t*)malloc(rounded);
+    if (!capture->ring)
+    {
+        free(capture);
+        return NULL;
+    }
+    capture->size = rounded;
+    pthread_mutex_init(&capture->mutex, NULL);
+    return capture;
+}
+
+void df1_capture_destroy(df1_capture_t* capture)
+{
+    if (!capture)
+        return;
+
+    df1_capture_flush(capture);
+    if (capture->file)
+    {
+        fclose(capture->file);
+    }
+    pthread_mutex_destroy(&capture->mutex);
+    free(capture->ring);
+    free(capture);
+}
+
+static void put_le(uint8_t* dst, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        dst[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t* src, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        value |= (uint64_t)src[i] << (8 * i);
+    }
+    return value;
+}
+
+int df1_capture_open_file(df1_capture_t* capture, const char* path, const df1_config_t* config)
+{
+    if (!capture || !path || !config)
+    {
+        return -1;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return -1;
+    }
+
+    struct timespec realtime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, DF1_TRACE_MAGIC, 8);
+    put_le(header + 8, DF1_TRACE_VERSION, 2);
+    header[10] = (uint8_t)config->duplex;
+    header[11] = (uint8_t)config->check_type;
+    put_le(header + 16, df1_stats_now_ns(), 8);
+    put_le(header + 24, (uint64_t)realtime.tv_sec * 1000000000ull + (uint64_t)realtime.tv_nsec, 8);
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header))
+    {
+        fclose(file);
+        return -1;
+    }
+
+    pthread_mutex_lock(&capture->mutex);
+    if (capture->file)
+    {
+        fclose(capture->file);
+    }
+    capture->file = file;
+    pthread_mutex_unlock(&capture->mutex);
+    return 0;
+}
+
+int df1_capture_flush(df1_capture_t* capture)
+{
+    if (!capture)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&capture->mutex);
+    uint64_t tail = capture->tail;
+    uint64_t head = __atomic_load_n(&capture->head, __ATOMIC_ACQUIRE);
+    int written = 0;
+    int result = 0;
+    uint8_t buffer[TRACE_RECORD_HEADER_SIZE + DF1_CAPTURE_MAX_RECORD];
+
+    while (tail != head)
+    {
+        ring_record_t record;
+        ring_read(capture, tail, &record, sizeof(record));
+        if (capture->file && result == 0)
+        {
+            put_le(buffer, record.timestamp_ns, 8);
+            put_le(buffer + 8, record.size, 2);
+            buffer[10] = (uint8_t)record.direction;
+            ring_read(capture, tail + sizeof(record), buffer + TRACE_RECORD_HEADER_SIZE, record.size);
+            size_t length = TRACE_RECORD_HEADER_SIZE + record.size;
+            if (fwrite(buffer, 1, length, capture->file) != length)
+            {
+                result = -1; // 继续释放缓冲区，避免写入方一直丢弃
+            }
+            written++;
+        }
+        tail += record_space(record.size);
+        __atomic_store_n(&capture->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    if (capture->file && written > 0 && fflush(capture->file) != 0)
+    {
+        result = -1;
+    }
+    pthread_mutex_unlock(&capture->mutex);
+    return result == 0 ? written : -1;
+}
+
+// 写入一条记录，数据从 iov 的当前位置取 size 字节
+static void record_chunk(df1_capture_t* capture, df1_capture_dir_t direction, uint64_t timestamp_ns,
+                         const struct iovec** iov, size_t* iov_offset, size_t size)
+{
+    uint64_t head = capture->head;
+    uint64_t tail = __atomic_load_n(&capture->tail, __ATOMIC_ACQUIRE);
+    size_t space = record_space(size);
+
+    if (capture->size - (size_t)(head - tail) < space)
+    {
+        df1_stats_add(&capture->dropped, 1);
+        // 跳过这段数据，后续分段仍从正确的位置开始
+        while (size > 0)
+        {
+            size_t take = (*iov)->iov_len - *iov_offset < size ? (*iov)->iov_len - *iov_offset : size;
+            size -= take;
+            *iov_offset += take;
+            if (*iov_offset == (*iov)->iov_len)
+            {
+                (*iov)++;
+                *iov_offset = 0;
+            }
+        }
+        return;
+    }
+
+    ring_record_t record;
+    record.timestamp_ns = timestamp_ns;
+    record.size = (uint32_t)size;
+    record.direction = (uint32_t)direction;
+    ring_write(capture, head, &record, sizeof(record));
+
+    uint64_t position = head + sizeof(record);
+    while (size > 0)
+    {
+        size_t take = (*iov)->iov_len - *iov_offset < size ? (*iov)->iov_len - *iov_offset : size;
+        ring_write(capture, position, (const uint8_t*)(*iov)->iov_base + *iov_offset, take);
+        position += take;
+        size -= take;
+        *iov_offset += take;
+        if (*iov_offset == (*iov)->iov_len)
+        {
+            (*iov)++;
+            *iov_offset = 0;
+        }
+    }
+
+    __atomic_store_n(&capture->head, head + space, __ATOMIC_RELEASE);
+}
+
+void df1_capture_record_iov(df1_capture_t* capture, df1_capture_dir_t direction, const struct iovec* iov,
+                            int count, size_t size)
+{
+    if (!capture || !iov || count <= 0 || size == 0)
+        return;
+
+    size_t available = 0;
+    for (int i = 0; i < count; i++)
+    {
+        available += iov[i].iov_len;
+    }
+    if (size > available)
+    {
+        size = available;
+    }
+
+    uint64_t timestamp_ns = df1_stats_now_ns();
+    size_t iov_offset = 0;
+    while (size > 0)
+    {
+        while (iov->iov_len == 0)
+        {
+            iov++;
+        }
+        size_t chunk = size < DF1_CAPTURE_MAX_RECORD ? size : DF1_CAPTURE_MAX_RECORD;
+        record_chunk(capture, direction, timestamp_ns, &iov, &iov_offset, chunk);
+        size -= chunk;
+    }
+}
+
+void df1_capture_record(df1_capture_t* capture, df1_capture_dir_t direction, const uint8_t* data, size_t size)
+{
+    if (!data)
+        return;
+
+    struct iovec iov;
+    iov.iov_base = (void*)data;
+    iov.iov_len = size;
+    df1_capture_record_iov(capture, direction, &iov, 1, size);
+}
+
+uint64_t df1_capture_dropped(const df1_capture_t* capture)
+{
+    if (!capture)
+    {
+        return 0;
+    }
+    return __atomic_load_n(&capture->dropped, __ATOMIC_RELAXED);
+}
+
+int df1_trace_read_header(FILE* file, df1_trace_header_t* header)
+{
+    if (!file || !header)
+    {
+        return -1;
+    }
+
+    uint8_t buffer[TRACE_HEADER_SIZE];
+    if (fread(buffer, 1, sizeof(buffer), file) != sizeof(buffer) || memcmp(buffer, DF1_TRACE_MAGIC, 8) != 0 ||
+        get_le(buffer + 8, 2) != DF1_TRACE_VERSION)
+    {
+        return -1;
+    }
+
+    header->duplex = buffer[10] == DF1_FULL_DUPLEX ? DF1_FULL_DUPLEX : DF1_HALF_DUPLEX;
+    header->check_type = buffer[11] == DF1_CHECK_CRC16 ? DF1_CHECK_CRC16 : DF1_CHECK_BCC;
+    header->start_ns = get_le(buffer + 16, 8);
+    header->start_realtime_ns = get_le(buffer + 24, 8);
+    return 0;
+}
+
+int df1_trace_read_record(FILE* file, df1_trace_record_t* record)
+{
+    if (!file || !record)
+    {
+        return -1;
+    }
+
+    uint8_t buffer[TRACE_RECORD_HEADER_SIZE];
+    size_t n = fread(buffer, 1, sizeof(buffer), file);
+    if (n == 0 && feof(file))
+    {
+        return 0;
+    }
+    if (n != sizeof(buffer))
+    {
+        return -1;
+    }
+
+    record->timestamp_ns = get_le(buffer, 8);
+    record->size = (size_t)get_le(buffer + 8, 2);
+    record->direction = buffer[10] == DF1_CAPTURE_RX ? DF1_CAPTURE_RX : DF1_CAPTURE_TX;
+    if (record->size > DF1_CAPTURE_MAX_RECORD || fread(record->data, 1, record->size, file) != record->size)
+    {
+        return -1;
+    }
+    return 1;
+}
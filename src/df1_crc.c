@@ -0,0 +1,280 @@
+#include "df1_crc.h"
+#include <pthread.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define DF1_CRC_HAVE_PCLMUL 1
+#include <immintrin.h>
+#endif
+
+// CRC-16/ARC 反射多项式；非反射形式为 x^16 + x^15 + x^2 + 1
+#define CRC16_POLY_REFLECTED 0xA001
+#define CRC16_POLY 0x18005
+
+// 短于此长度时逐字节计算，查表与折叠的准备开销不划算
+#define CRC16_BULK_MIN 16
+
+// 折叠内核每次处理64字节，更短时交给每次16字节的查表内核
+#define CRC16_FOLD_MIN 64
+
+// slice[k][i]：字节 i 之后再经过 k 个0字节的CRC（初值为0）；slice[0] 即逐字节查表
+static uint16_t crc16_slice[16][256];
+
+#ifdef DF1_CRC_HAVE_PCLMUL
+// 折叠常数（反射形式）：fold4 跨64字节，fold1 跨16字节
+static uint64_t crc16_fold4[2];
+static uint64_t crc16_fold1[2];
+#endif
+
+static pthread_once_t crc16_once = PTHREAD_ONCE_INIT;
+static int crc16_kernel = DF1_CRC16_AUTO; // df1_crc16_select 选择的内核，AUTO 使用检测结果
+static df1_crc16_kernel_t crc16_detected = DF1_CRC16_SLICE16;
+
+static uint16_t crc16_bytewise(uint16_t crc, const uint8_t* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = (uint16_t)((crc >> 8) ^ crc16_slice[0][(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+// 每次8字节：把当前CRC异或进前两个字节，8个字节各自查对应推移的表后异或
+static uint16_t crc16_slice8(uint16_t crc, const uint8_t* data, size_t length)
+{
+    while (length >= 8)
+    {
+        crc = (uint16_t)(crc16_slice[7][(data[0] ^ crc) & 0xFF] ^ crc16_slice[6][data[1] ^ (crc >> 8)]
+                         ^ crc16_slice[5][data[2]] ^ crc16_slice[4][data[3]] ^ crc16_slice[3][data[4]]
+                         ^ crc16_slice[2][data[5]] ^ crc16_slice[1][data[6]] ^ crc16_slice[0][data[7]]);
+        data += 8;
+        length -= 8;
+    }
+    return crc16_bytewise(crc, data, length);
+}
+
+static uint16_t crc16_slice16(uint16_t crc, const uint8_t* data, size_t length)
+{
+    while (length >= 16)
+    {
+        crc = (uint16_t)(crc16_slice[15][(data[0] ^ crc) & 0xFF] ^ crc16_slice[14][data[1] ^ (crc >> 8)]
+                         ^ crc16_slice[13][data[2]] ^ crc16_slice[12][data[3]] ^ crc16_slice[11][data[4]]
+                         ^ crc16_slice[10][data[5]] ^ crc16_slice[9][data[6]] ^ crc16_slice[8][data[7]]
+                         ^ crc16_slice[7][data[8]] ^ crc16_slice[6][data[9]] ^ crc16_slice[5][data[10]]
+                         ^ crc16_slice[4][data[11]] ^ crc16_slice[3][data[12]] ^ crc16_slice[2][data[13]]
+                         ^ crc16_slice[1][data[14]] ^ crc16_slice[0][data[15]]);
+        data += 16;
+        length -= 16;
+    }
+    return crc16_bytewise(crc, data, length);
+}
+
+#ifdef DF1_CRC_HAVE_PCLMUL
+// x^n mod P（非反射形式）
+static uint16_t crc16_xpow(unsigned n)
+{
+    uint32_t r = 1;
+    for (unsigned i = 0; i < n; i++)
+    {
+        r <<= 1;
+        if (r & 0x10000)
+        {
+            r ^= CRC16_POLY;
+        }
+    }
+    return (uint16_t)r;
+}
+
+// 把次数小于16的多项式放到64位反射表示中：x^d 对应第 63-d 位
+static uint64_t crc16_reflect64(uint16_t poly)
+{
+    uint64_t r = 0;
+    for (int d = 0; d < 16; d++)
+    {
+        if (poly & (1u << d))
+        {
+            r |= (uint64_t)1 << (63 - d);
+        }
+    }
+    return r;
+}
+
+// 128位寄存器按小端载入时第 j 位是 x^(127-j) 的系数（首字节最低位次数最高）。寄存器乘以 x^n 后
+// 模 P 等于低64位乘 x^(n+63) mod P 与高64位乘 x^(n-1) mod P 之和：反射表示下无进位乘法的结果
+// 恰好右移一位，常数少乘一个 x 即可直接得到128位反射表示，与下一块异或后继续折叠
+__attribute__((target("pclmul,sse2"))) static inline __m128i crc16_fold(__m128i x, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+__attribute__((target("pclmul,sse2"))) static uint16_t crc16_pclmul(uint16_t crc, const uint8_t* data,
+                                                                     size_t length)
+{
+    if (length < CRC16_FOLD_MIN)
+    {
+        return crc16_slice16(crc, data, length);
+    }
+
+    // 初值异或进前两个字节后，等价于从0开始计算
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)data), _mm_cvtsi32_si128(crc));
+    __m128i x1 = _mm_loadu_si128((const __m128i*)(data + 16));
+    __m128i x2 = _mm_loadu_si128((const __m128i*)(data + 32));
+    __m128i x3 = _mm_loadu_si128((const __m128i*)(data + 48));
+    data += 64;
+    length -= 64;
+
+    // 四路并行，每路跨64字节折叠
+    __m128i k4 = _mm_set_epi64x((long long)crc16_fold4[1], (long long)crc16_fold4[0]);
+    while (length >= 64)
+    {
+        x0 = _mm_xor_si128(crc16_fold(x0, k4), _mm_loadu_si128((const __m128i*)data));
+        x1 = _mm_xor_si128(crc16_fold(x1, k4), _mm_loadu_si128((const __m128i*)(data + 16)));
+        x2 = _mm_xor_si128(crc16_fold(x2, k4), _mm_loadu_si128((const __m128i*)(data + 32)));
+        x3 = _mm_xor_si128(crc16_fold(x3, k4), _mm_loadu_si128((const __m128i*)(data + 48)));
+        data += 64;
+        length -= 64;
+    }
+
+    // 合并为一路，再逐块折叠剩余的整16字节
+    __m128i k1 = _mm_set_epi64x((long long)crc16_fold1[1], (long long)crc16_fold1[0]);
+    __m128i x = _mm_xor_si128(crc16_fold(x0, k1), x1);
+    x = _mm_xor_si128(crc16_fold(x, k1), x2);
+    x = _mm_xor_si128(crc16_fold(x, k1), x3);
+    while (length >= 16)
+    {
+        x = _mm_xor_si128(crc16_fold(x, k1), _mm_loadu_si128((const __m128i*)data));
+        data += 16;
+        length -= 16;
+    }
+
+    // 折叠结果与已处理的数据模 P 同余，其CRC即已处理数据的CRC
+    uint8_t folded[16];
+    _mm_storeu_si128((__m128i*)folded, x);
+    crc = crc16_slice16(0x0000, folded, sizeof(folded));
+    return crc16_bytewise(crc, data, length);
+}
+#endif
+
+static void crc16_init(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        uint16_t crc = (uint16_t)i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ CRC16_POLY_REFLECTED) : (uint16_t)(crc >> 1);
+        }
+        crc16_slice[0][i] = crc;
+    }
+    for (int k = 1; k < 16; k++)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            uint16_t prev = crc16_slice[k - 1][i];
+            crc16_slice[k][i] = (uint16_t)((prev >> 8) ^ crc16_slice[0][prev & 0xFF]);
+        }
+    }
+
+    crc16_detected = DF1_CRC16_SLICE16;
+#ifdef DF1_CRC_HAVE_PCLMUL
+    crc16_fold4[0] = crc16_reflect64(crc16_xpow(512 + 63));
+    crc16_fold4[1] = crc16_reflect64(crc16_xpow(512 - 1));
+    crc16_fold1[0] = crc16_reflect64(crc16_xpow(128 + 63));
+    crc16_fold1[1] = crc16_reflect64(crc16_xpow(128 - 1));
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2"))
+    {
+        crc16_detected = DF1_CRC16_PCLMUL;
+    }
+#endif
+}
+
+static void crc16_ensure_init(void)
+{
+    pthread_once(&crc16_once, crc16_init);
+}
+
+bool df1_crc16_supported(df1_crc16_kernel_t kernel)
+{
+    crc16_ensure_init();
+    switch (kernel)
+    {
+    case DF1_CRC16_AUTO:
+    case DF1_CRC16_BYTEWISE:
+    case DF1_CRC16_SLICE8:
+    case DF1_CRC16_SLICE16:
+        return true;
+    case DF1_CRC16_PCLMUL:
+        return crc16_detected == DF1_CRC16_PCLMUL;
+    default:
+        return false;
+    }
+}
+
+int df1_crc16_select(df1_crc16_kernel_t kernel)
+{
+    if (!df1_crc16_supported(kernel))
+    {
+        return -1;
+    }
+    __atomic_store_n(&crc16_kernel, (int)kernel, __ATOMIC_RELAXED);
+    return 0;
+}
+
+df1_crc16_kernel_t df1_crc16_active(void)
+{
+    crc16_ensure_init();
+    int kernel = __atomic_load_n(&crc16_kernel, __ATOMIC_RELAXED);
+    return kernel == DF1_CRC16_AUTO ? crc16_detected : (df1_crc16_kernel_t)kernel;
+}
+
+const char* df1_crc16_kernel_name(df1_crc16_kernel_t kernel)
+{
+    switch (kernel)
+    {
+    case DF1_CRC16_AUTO:
+        return "auto";
+    case DF1_CRC16_BYTEWISE:
+        return "bytewise";
+    case DF1_CRC16_SLICE8:
+        return "slice8";
+    case DF1_CRC16_SLICE16:
+        return "slice16";
+    case DF1_CRC16_PCLMUL:
+        return "pclmul";
+    default:
+        return "unknown";
+    }
+}
+
+uint16_t df1_crc16_compute(df1_crc16_kernel_t kernel, uint16_t crc, const uint8_t* data, size_t length)
+{
+    if (!data)
+    {
+        return crc;
+    }
+
+    if (length < CRC16_BULK_MIN)
+    {
+        crc16_ensure_init();
+        return crc16_bytewise(crc, data, length);
+    }
+    if (kernel == DF1_CRC16_AUTO || !df1_crc16_supported(kernel))
+    {
+        kernel = df1_crc16_active();
+    }
+
+    switch (kernel)
+    {
+    case DF1_CRC16_SLICE8:
+        return crc16_slice8(crc, data, length);
+    case DF1_CRC16_SLICE16:
+        return crc16_slice16(crc, data, length);
+#ifdef DF1_CRC_HAVE_PCLMUL
+    case DF1_CRC16_PCLMUL:
+        return crc16_pclmul(crc, data, length);
+#endif
+    default:
+        return crc16_bytewise(crc, data, length);
+    }
+}
@@ -0,0 +1,214 @@
+#include "df1_dle.h"
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define DF1_DLE_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#define DLE 0x10
+
+typedef size_t (*dle_find_fn)(const uint8_t* data, size_t length);
+
+static size_t dle_find_resolve(const uint8_t* data, size_t length);
+
+// 当前内核；第一次调用时经 dle_find_resolve 按CPU特性选择。各线程选择的结果相同，竞争无害
+static dle_find_fn dle_find_active = dle_find_resolve;
+static int dle_kernel = DF1_DLE_AUTO; // df1_dle_select 选择的内核，AUTO 使用检测结果
+
+static size_t dle_find_tail(const uint8_t* data, size_t length, size_t pos)
+{
+    while (pos < length && data[pos] != DLE)
+    {
+        pos++;
+    }
+    return pos;
+}
+
+// 每次8字节：与 0x10 异或后检测是否有为0的字节（经典的 haszero 位运算）
+static size_t dle_find_scalar(const uint8_t* data, size_t length)
+{
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    const uint64_t pattern = ones * DLE;
+
+    size_t pos = 0;
+    while (pos + 8 <= length)
+    {
+        uint64_t word;
+        memcpy(&word, data + pos, sizeof(word));
+        word ^= pattern;
+        if ((word - ones) & ~word & highs)
+        {
+            break; // 这8字节中有DLE，逐字节确定位置
+        }
+        pos += 8;
+    }
+    return dle_find_tail(data, length, pos);
+}
+
+#ifdef DF1_DLE_HAVE_X86
+__attribute__((target("sse2"))) static size_t dle_find_sse2(const uint8_t* data, size_t length)
+{
+    const __m128i pattern = _mm_set1_epi8(DLE);
+    size_t pos = 0;
+    while (pos + 16 <= length)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern));
+        if (mask)
+        {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+    return dle_find_tail(data, length, pos);
+}
+
+__attribute__((target("avx2"))) static size_t dle_find_avx2(const uint8_t* data, size_t length)
+{
+    const __m256i pattern = _mm256_set1_epi8(DLE);
+    size_t pos = 0;
+    while (pos + 32 <= length)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(data + pos));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern));
+        if (mask)
+        {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 32;
+    }
+    if (pos + 16 <= length)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + pos));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm256_castsi256_si128(pattern)));
+        if (mask)
+        {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+    return dle_find_tail(data, length, pos);
+}
+#endif
+
+// CPU支持的最快内核，检测一次后缓存
+static df1_dle_kernel_t dle_detect(void)
+{
+    static int detected = DF1_DLE_AUTO;
+    int kernel = __atomic_load_n(&detected, __ATOMIC_RELAXED);
+    if (kernel != DF1_DLE_AUTO)
+    {
+        return (df1_dle_kernel_t)kernel;
+    }
+
+    kernel = DF1_DLE_SCALAR;
+#ifdef DF1_DLE_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernel = DF1_DLE_AVX2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        kernel = DF1_DLE_SSE2;
+    }
+#endif
+    __atomic_store_n(&detected, kernel, __ATOMIC_RELAXED);
+    return (df1_dle_kernel_t)kernel;
+}
+
+static dle_find_fn dle_kernel_fn(df1_dle_kernel_t kernel)
+{
+    switch (kernel)
+    {
+#ifdef DF1_DLE_HAVE_X86
+    case DF1_DLE_SSE2:
+        return dle_find_sse2;
+    case DF1_DLE_AVX2:
+        return dle_find_avx2;
+#endif
+    default:
+        return dle_find_scalar;
+    }
+}
+
+static size_t dle_find_resolve(const uint8_t* data, size_t length)
+{
+    dle_find_fn fn = dle_kernel_fn(df1_dle_active());
+    __atomic_store_n(&dle_find_active, fn, __ATOMIC_RELAXED);
+    return fn(data, length);
+}
+
+size_t df1_dle_find(const uint8_t* data, size_t length)
+{
+    if (!data)
+    {
+        return length;
+    }
+    return __atomic_load_n(&dle_find_active, __ATOMIC_RELAXED)(data, length);
+}
+
+bool df1_dle_supported(df1_dle_kernel_t kernel)
+{
+    switch (kernel)
+    {
+    case DF1_DLE_AUTO:
+    case DF1_DLE_SCALAR:
+        return true;
+    case DF1_DLE_SSE2:
+        return dle_detect() != DF1_DLE_SCALAR;
+    case DF1_DLE_AVX2:
+        return dle_detect() == DF1_DLE_AVX2;
+    default:
+        return false;
+    }
+}
+
+int df1_dle_select(df1_dle_kernel_t kernel)
+{
+    if (!df1_dle_supported(kernel))
+    {
+        return -1;
+    }
+    __atomic_store_n(&dle_kernel, (int)kernel, __ATOMIC_RELAXED);
+    __atomic_store_n(&dle_find_active, dle_kernel_fn(df1_dle_active()), __ATOMIC_RELAXED);
+    return 0;
+}
+
+df1_dle_kernel_t df1_dle_active(void)
+{
+    int kernel = __atomic_load_n(&dle_kernel, __ATOMIC_RELAXED);
+    return kernel == DF1_DLE_AUTO ? dle_detect() : (df1_dle_kernel_t)kernel;
+}
+
+const char* df1_dle_kernel_name(df1_dle_kernel_t kernel)
+{
+    switch (kernel)
+    {
+    case DF1_DLE_AUTO:
+        return "auto";
+    case DF1_DLE_SCALAR:
+        return "scalar";
+    case DF1_DLE_SSE2:
+        return "sse2";
+    case DF1_DLE_AVX2:
+        return "avx2";
+    default:
+        return "unknown";
+    }
+}
+
+size_t df1_dle_scan(df1_dle_kernel_t kernel, const uint8_t* data, size_t length)
+{
+    if (!data)
+    {
+        return length;
+    }
+    if (kernel == DF1_DLE_AUTO || !df1_dle_supported(kernel))
+    {
+        kernel = df1_dle_active();
+    }
+    return dle_kernel_fn(kernel)(data, length);
+}
@@ -0,0 +1,687 @@
+#include "df1_link.h"
+#include <string.h>
+
+#ifdef DF1_ENABLE_STATS
+#define LINK_STATS_ADD(link, field, value) \
+    do \
+    { \
+        if ((link)->stats) \
+            DF1_STATS_ADD((link)->stats, field, value); \
+    } while (0)
+
+// 命令帧进入发送缓冲区：开始计时写出
+static void stats_frame_queued(df1_link_t* link)
+{
+    if (link->stats && link->stats->tx_start_ns == 0)
+    {
+        link->stats->tx_start_ns = df1_stats_now_ns();
+    }
+}
+
+// 发送缓冲区排空：命令已写出，开始等待应答
+static void stats_output_drained(df1_link_t* link)
+{
+    df1_stats_t* stats = link->stats;
+    if (!stats || stats->tx_start_ns == 0)
+    {
+        return;
+    }
+
+    uint64_t now = df1_stats_now_ns();
+    DF1_STATS_RECORD(stats, DF1_PHASE_TRANSMIT, stats->tx_start_ns, now);
+    stats->tx_start_ns = 0;
+    if (link->outstanding > 0 && stats->awaiting_ns == 0)
+    {
+        stats->awaiting_ns = now;
+    }
+}
+
+// 收到字节：等待应答时记录第一个字节的到达
+static void stats_input(df1_link_t* link, uint64_t now)
+{
+    df1_stats_t* stats = link->stats;
+    if (stats && stats->awaiting_ns != 0 && stats->first_byte_ns == 0)
+    {
+        stats->first_byte_ns = now;
+        DF1_STATS_RECORD(stats, DF1_PHASE_FIRST_BYTE, stats->awaiting_ns, now);
+    }
+}
+
+// 得到响应帧：记录接收与解码时间，下一条响应从此刻开始等待
+static void stats_frame_decoded(df1_link_t* link, uint64_t push_start)
+{
+    df1_stats_t* stats = link->stats;
+    if (!stats)
+    {
+        return;
+    }
+
+    uint64_t now = df1_stats_now_ns();
+    DF1_STATS_RECORD(stats, DF1_PHASE_DECODE, push_start, now);
+    if (stats->first_byte_ns != 0)
+    {
+        DF1_STATS_RECORD(stats, DF1_PHASE_FRAME, stats->first_byte_ns, push_start);
+    }
+    stats->first_byte_ns = 0;
+    stats->awaiting_ns = stats->awaiting_ns != 0 ? now : 0;
+}
+
+static void stats_slot_completed(df1_link_t* link, const df1_link_slot_t* slot, int status, const df1_frame_t* reply)
+{
+    df1_stats_t* stats = link->stats;
+    if (!stats)
+    {
+        return;
+    }
+
+    DF1_STATS_RECORD(stats, DF1_PHASE_TOTAL, slot->submit_ns, df1_stats_now_ns());
+    DF1_STATS_ADD(stats, transactions, 1);
+    if (status != 0 || !reply || reply->sts != 0x00)
+    {
+        DF1_STATS_ADD(stats, errors, 1);
+    }
+    if (link->outstanding == 0)
+    {
+        stats->awaiting_ns = 0;
+        stats->first_byte_ns = 0;
+    }
+}
+#else
+#define LINK_STATS_ADD(link, field, value) ((void)0)
+#endif
+
+// 调用者没有给出期望的响应长度时，自适应超时按最大数据长度的响应帧计传输时间
+#define LINK_MAX_REPLY_BYTES (DF1_MAX_DATA_SIZE + 16)
+
+// 等待 DLE ACK 的超时：从命令进入发送缓冲区开始计时，含命令帧的传输时间，每次 ENQ 或重发加倍
+static int ack_timeout(const df1_link_t* link, const df1_link_slot_t* slot)
+{
+    if (!link->rtt)
+    {
+        return link->config.ack_timeout_ms;
+    }
+    return df1_rtt_timeout(link->rtt, slot->enq_count + slot->nak_count, slot->frame_size + 2);
+}
+
+// 开始等待响应，返回截止时间。半双工从命令进入发送缓冲区开始计时，需要加上命令帧的传输时间；
+// 第一次等待时确定最终期限，重发的等待不超过它，最坏情况与固定超时相同
+static long long reply_deadline(const df1_link_t* link, df1_link_slot_t* slot, long long now_ms)
+{
+    if (slot->retries == 0)
+    {
+        slot->expire_ms = now_ms + link->config.reply_timeout_ms;
+    }
+    if (!link->rtt)
+    {
+        return slot->expire_ms;
+    }
+
+    size_t wire_bytes = slot->reply_bytes + (link->duplex == DF1_HALF_DUPLEX ? slot->frame_size : 0);
+    long long deadline = now_ms + df1_rtt_timeout(link->rtt, slot->retries, wire_bytes);
+    return deadline < slot->expire_ms ? deadline : slot->expire_ms;
+}
+
+void df1_link_config_default(df1_link_config_t* config, int timeout_ms)
+{
+    if (!config)
+        return;
+
+    config->max_outstanding = 4;
+    config->ack_timeout_ms = timeout_ms;
+    config->reply_timeout_ms = timeout_ms;
+    config->max_nak = 3;
+    config->max_enq = 3;
+}
+
+void df1_link_init(df1_link_t* link, const df1_link_config_t* config, df1_duplex_t duplex, df1_check_type_t check_type)
+{
+    if (!link)
+        return;
+
+    memset(link, 0, sizeof(df1_link_t));
+    if (config)
+    {
+        link->config = *config;
+    }
+    else
+    {
+        df1_link_config_default(&link->config, 1000);
+    }
+
+    if (link->config.max_outstanding < 1)
+    {
+        link->config.max_outstanding = 1;
+    }
+    if (link->config.max_outstanding > DF1_LINK_MAX_OUTSTANDING)
+    {
+        link->config.max_outstanding = DF1_LINK_MAX_OUTSTANDING;
+    }
+
+    link->duplex = duplex;
+    link->awaiting_ack = -1;
+    link->last_response = DF1_NAK;
+    df1_decoder_init(&link->decoder, check_type);
+}
+
+// 追加待发送字节，空间不足时先整理缓冲区
+static int output_append(df1_link_t* link, const uint8_t* data, size_t length)
+{
+    if (link->tx_len + length > DF1_LINK_TX_BUFFER_SIZE && link->tx_pos > 0)
+    {
+        memmove(link->tx_buffer, &link->tx_buffer[link->tx_pos], link->tx_len - link->tx_pos);
+        link->tx_len -= link->tx_pos;
+        link->tx_pos = 0;
+    }
+    if (link->tx_len + length > DF1_LINK_TX_BUFFER_SIZE)
+    {
+        return -1;
+    }
+
+    memcpy(&link->tx_buffer[link->tx_len], data, length);
+    link->tx_len += length;
+    return 0;
+}
+
+// 发送链路应答。缓冲区已满时放弃，对方会通过 ENQ 重新询问
+static void send_control(df1_link_t* link, uint8_t symbol)
+{
+    uint8_t control[2] = {DF1_DLE, symbol};
+    output_append(link, control, sizeof(control));
+}
+
+// 释放命令槽并回调。先释放再回调，回调中可以直接提交新命令
+static void complete_slot(df1_link_t* link, int index, int status, const df1_frame_t* reply)
+{
+    df1_link_slot_t* slot = &link->slots[index];
+    df1_link_callback_t callback = slot->callback;
+    void* user_data = slot->user_data;
+
+    slot->in_use = false;
+    link->outstanding--;
+    if (link->awaiting_ack == index)
+    {
+        link->awaiting_ack = -1;
+    }
+#ifdef DF1_ENABLE_STATS
+    stats_slot_completed(link, slot, status, reply);
+#endif
+
+    if (callback)
+    {
+        callback(user_data, status, reply);
+    }
+}
+
+// 链路空闲时发送队列中的下一条命令
+static void start_next_transmit(df1_link_t* link, long long now_ms)
+{
+    while (link->awaiting_ack < 0 && link->tx_queue_head != link->tx_queue_tail)
+    {
+        int index = link->tx_queue[link->tx_queue_head % DF1_LINK_MAX_OUTSTANDING];
+        df1_link_slot_t* slot = &link->slots[index];
+
+        if (link->tx_len - link->tx_pos + slot->frame_size > DF1_LINK_TX_BUFFER_SIZE)
+        {
+            return; // 等待调用者取走已有的待发送字节
+        }
+        link->tx_queue_head++;
+
+        // 从站离线：不发送，由下一次 tick 使命令失败，避免在提交过程中回调
+        if (!df1_rtt_allow(link->rtt, now_ms))
+        {
+            slot->fast_fail = true;
+            slot->acked = true;
+            slot->deadline_ms = now_ms;
+            continue;
+        }
+        output_append(link, slot->frame, slot->frame_size);
+#ifdef DF1_ENABLE_STATS
+        stats_frame_queued(link);
+#endif
+        slot->sent_ms = now_ms;
+        slot->nak_count = 0;
+        slot->enq_count = 0;
+
+        if (link->duplex == DF1_FULL_DUPLEX)
+        {
+            link->awaiting_ack = index;
+            slot->deadline_ms = now_ms + ack_timeout(link, slot);
+        }
+        else
+        {
+            // 半双工没有链路应答，发送即视为确认
+            slot->acked = true;
+            slot->deadline_ms = reply_deadline(link, slot, now_ms);
+        }
+    }
+}
+
+void df1_link_reset(df1_link_t* link)
+{
+    if (!link)
+        return;
+
+    link->tx_queue_head = link->tx_queue_tail = 0;
+    link->tx_pos = link->tx_len = 0;
+#ifdef DF1_ENABLE_STATS
+    if (link->stats)
+    {
+        link->stats->tx_start_ns = 0;
+    }
+#endif
+    df1_decoder_reset(&link->decoder);
+
+    for (int i = 0; i < DF1_LINK_MAX_OUTSTANDING; i++)
+    {
+        if (link->slots[i].in_use)
+        {
+            complete_slot(link, i, -1, NULL);
+        }
+    }
+    link->awaiting_ack = -1;
+}
+
+bool df1_link_can_submit(const df1_link_t* link)
+{
+    if (!link)
+    {
+        return false;
+    }
+
+    size_t window = (link->duplex == DF1_FULL_DUPLEX) ? (size_t)link->config.max_outstanding : 1;
+    return link->outstanding < window;
+}
+
+int df1_link_submit(df1_link_t* link, const uint8_t* frame, size_t frame_size, uint16_t tns, long long now_ms,
+                    df1_link_callback_t callback, void* user_data)
+{
+    return df1_link_submit_expect(link, frame, frame_size, tns, 0, now_ms, callback, user_data);
+}
+
+int df1_link_submit_expect(df1_link_t* link, const uint8_t* frame, size_t frame_size, uint16_t tns,
+                           size_t reply_bytes, long long now_ms, df1_link_callback_t callback, void* user_data)
+{
+    if (!link || !frame || frame_size == 0 || frame_size > DF1_MAX_FRAME_SIZE || !df1_link_can_submit(link))
+    {
+        return -1;
+    }
+
+    int index = -1;
+    for (int i = 0; i < DF1_LINK_MAX_OUTSTANDING; i++)
+    {
+        if (!link->slots[i].in_use)
+        {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    df1_link_slot_t* slot = &link->slots[index];
+    slot->in_use = true;
+    slot->acked = false;
+    slot->tns = tns;
+    slot->deadline_ms = 0;
+    slot->nak_count = 0;
+    slot->enq_count = 0;
+    slot->retries = 0;
+    slot->fast_fail = false;
+    slot->reply_bytes = reply_bytes > 0 ? reply_bytes : LINK_MAX_REPLY_BYTES;
+    slot->callback = callback;
+    slot->user_data = user_data;
+    slot->frame_size = frame_size;
+    memcpy(slot->frame, frame, frame_size);
+#ifdef DF1_ENABLE_STATS
+    slot->submit_ns = df1_stats_now_ns();
+#endif
+
+    link->now_ms = now_ms;
+    link->tx_queue[link->tx_queue_tail % DF1_LINK_MAX_OUTSTANDING] = index;
+    link->tx_queue_tail++;
+    link->outstanding++;
+
+    start_next_transmit(link, now_ms);
+    return 0;
+}
+
+static void handle_ack(df1_link_t* link, long long now_ms)
+{
+    if (link->awaiting_ack < 0)
+    {
+        return;
+    }
+
+    df1_link_slot_t* slot = &link->slots[link->awaiting_ack];
+    slot->acked = true;
+    slot->deadline_ms = reply_deadline(link, slot, now_ms);
+    link->awaiting_ack = -1;
+    df1_rtt_success(link->rtt);
+
+    start_next_transmit(link, now_ms);
+}
+
+static void handle_nak(df1_link_t* link, long long now_ms)
+{
+    if (link->awaiting_ack < 0)
+    {
+        return;
+    }
+
+    int index = link->awaiting_ack;
+    df1_link_slot_t* slot = &link->slots[index];
+    LINK_STATS_ADD(link, naks_received, 1);
+    if (++slot->nak_count > link->config.max_nak)
+    {
+        complete_slot(link, index, -1, NULL);
+        start_next_transmit(link, now_ms);
+        return;
+    }
+
+    // 重发命令帧
+    if (output_append(link, slot->frame, slot->frame_size) == 0)
+    {
+        slot->enq_count = 0;
+        LINK_STATS_ADD(link, retries, 1);
+#ifdef DF1_ENABLE_STATS
+        stats_frame_queued(link);
+#endif
+    }
+    slot->deadline_ms = now_ms + ack_timeout(link, slot);
+}
+
+// 只用一次写出就得到响应的命令作为往返样本（Karn 算法），重发过的命令无法确定响应对应哪一次
+static void sample_round_trip(df1_link_t* link, const df1_link_slot_t* slot, const df1_frame_t* frame, long long now_ms)
+{
+    if (!link->rtt)
+    {
+        return;
+    }
+
+    df1_rtt_success(link->rtt);
+    if (slot->nak_count == 0 && slot->enq_count == 0)
+    {
+        // 命令帧、DLE ACK 与响应帧（帧头、DLE ETX 与校验，转义忽略不计）
+        size_t wire_bytes = slot->frame_size + 2 + frame->pdu_length + (frame->has_station ? 9 : 6);
+        df1_rtt_sample(link->rtt, (int64_t)(now_ms - slot->sent_ms) * 1000, wire_bytes);
+    }
+}
+
+// 以新的事务ID重建命令帧并重新排队。从站对事务ID相同的命令只应答不执行，重发必须换号；
+// 新事务ID取自连接的计数器，之后的新命令不会再用到它
+static int requeue_with_new_tns(df1_link_t* link, int index)
+{
+    if (!link->tns_counter)
+    {
+        return -1;
+    }
+
+    df1_link_slot_t* slot = &link->slots[index];
+    df1_decoder_t decoder;
+    df1_decoder_init(&decoder, link->decoder.check_type);
+
+    size_t consumed = 0;
+    df1_frame_t frame;
+    if (df1_decoder_push(&decoder, slot->frame, slot->frame_size, &consumed, &frame) != DF1_DECODE_FRAME ||
+        frame.pdu_length < 6)
+    {
+        return -1;
+    }
+
+    uint16_t tns = ++*link->tns_counter;
+    for (int i = 0; i < DF1_LINK_MAX_OUTSTANDING; i++)
+    {
+        if (i != index && link->slots[i].in_use && link->slots[i].tns == tns)
+        {
+            tns = ++*link->tns_counter;
+            i = -1;
+        }
+    }
+
+    uint8_t pdu[DF1_MAX_PDU_SIZE];
+    memcpy(pdu, frame.pdu, frame.pdu_length);
+    pdu[4] = (uint8_t)(tns & 0xFF);
+    pdu[5] = (uint8_t)(tns >> 8);
+
+    df1_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.station = frame.station;
+    config.check_type = link->decoder.check_type;
+    config.duplex = link->duplex;
+    if (df1_build_frame(&config, pdu, frame.pdu_length, slot->frame, sizeof(slot->frame), &slot->frame_size) != 0)
+    {
+        return -1;
+    }
+
+    slot->tns = tns;
+    slot->acked = false;
+    slot->retries++;
+    link->tx_queue[link->tx_queue_tail % DF1_LINK_MAX_OUTSTANDING] = index;
+    link->tx_queue_tail++;
+    return 0;
+}
+
+static void handle_frame(df1_link_t* link, const df1_frame_t* frame, long long now_ms)
+{
+    if (link->duplex == DF1_FULL_DUPLEX)
+    {
+        send_control(link, DF1_ACK);
+        link->last_response = DF1_ACK;
+
+        // 对方没有收到我们的 ACK 而重发的消息：再次确认但不重复处理
+        if (link->has_last_message && frame->src == link->last_src && frame->cmd == link->last_cmd &&
+            frame->tns == link->last_tns)
+        {
+            link->duplicates++;
+            return;
+        }
+        link->has_last_message = true;
+        link->last_src = frame->src;
+        link->last_cmd = frame->cmd;
+        link->last_tns = frame->tns;
+    }
+
+    for (int i = 0; i < DF1_LINK_MAX_OUTSTANDING; i++)
+    {
+        df1_link_slot_t* slot = &link->slots[i];
+        if (!slot->in_use || slot->tns != frame->tns)
+        {
+            continue;
+        }
+
+        // 响应先于 ACK 到达时视为命令已被确认
+        if (!slot->acked && link->awaiting_ack != i)
+        {
+            continue; // 尚未发送
+        }
+
+        sample_round_trip(link, slot, frame, now_ms);
+        complete_slot(link, i, 0, frame);
+        start_next_transmit(link, now_ms);
+        return;
+    }
+}
+
+void df1_link_input(df1_link_t* link, const uint8_t* data, size_t length, long long now_ms)
+{
+    if (!link || !data)
+        return;
+
+    link->now_ms = now_ms;
+#ifdef DF1_ENABLE_STATS
+    if (length > 0)
+    {
+        stats_input(link, df1_stats_now_ns());
+    }
+#endif
+    size_t offset = 0;
+    while (offset < length)
+    {
+        size_t consumed = 0;
+        df1_frame_t frame;
+        DF1_STATS_TIME(push_start);
+        int result = df1_decoder_push(&link->decoder, data + offset, length - offset, &consumed, &frame);
+        offset += consumed;
+
+        switch (result)
+        {
+        case DF1_DECODE_FRAME:
+#ifdef DF1_ENABLE_STATS
+            stats_frame_decoded(link, push_start);
+#endif
+            handle_frame(link, &frame, now_ms);
+            break;
+        case DF1_DECODE_ACK:
+            handle_ack(link, now_ms);
+            break;
+        case DF1_DECODE_NAK:
+            handle_nak(link, now_ms);
+            break;
+        case DF1_DECODE_ENQ:
+            // 对方没有收到我们的应答，重发最近一次应答
+            if (link->duplex == DF1_FULL_DUPLEX)
+            {
+                send_control(link, link->last_response);
+            }
+            break;
+        case DF1_DECODE_BAD_CHECKSUM:
+        case DF1_DECODE_OVERFLOW:
+        case DF1_DECODE_MALFORMED:
+            if (result == DF1_DECODE_BAD_CHECKSUM)
+            {
+                LINK_STATS_ADD(link, crc_errors, 1);
+            }
+            if (link->duplex == DF1_FULL_DUPLEX)
+            {
+                send_control(link, DF1_NAK);
+                link->last_response = DF1_NAK;
+                link->naks_sent++;
+                LINK_STATS_ADD(link, naks_sent, 1);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void df1_link_tick(df1_link_t* link, long long now_ms)
+{
+    if (!link)
+        return;
+
+    link->now_ms = now_ms;
+
+    // ACK 超时：发送 ENQ 询问，次数用尽则放弃该命令
+    if (link->awaiting_ack >= 0)
+    {
+        int index = link->awaiting_ack;
+        df1_link_slot_t* slot = &link->slots[index];
+        if (now_ms >= slot->deadline_ms)
+        {
+            if (slot->enq_count >= link->config.max_enq)
+            {
+                LINK_STATS_ADD(link, timeouts, 1);
+                df1_rtt_failure(link->rtt, now_ms);
+                complete_slot(link, index, -1, NULL);
+            }
+            else
+            {
+                send_control(link, DF1_ENQ);
+                LINK_STATS_ADD(link, retries, 1);
+                slot->enq_count++;
+                slot->deadline_ms = now_ms + ack_timeout(link, slot);
+            }
+        }
+    }
+
+    // 响应超时：自适应超时下以新的事务ID重发，次数用尽或从站离线则放弃该命令
+    for (int i = 0; i < DF1_LINK_MAX_OUTSTANDING; i++)
+    {
+        df1_link_slot_t* slot = &link->slots[i];
+        if (!slot->in_use || !slot->acked || now_ms < slot->deadline_ms)
+        {
+            continue;
+        }
+
+        if (slot->fast_fail)
+        {
+            complete_slot(link, i, -1, NULL);
+        }
+        else if (link->rtt && link->rtt->config.enabled && slot->retries < link->rtt->config.max_retries &&
+                 now_ms < slot->expire_ms && requeue_with_new_tns(link, i) == 0)
+        {
+            LINK_STATS_ADD(link, retries, 1);
+        }
+        else
+        {
+            LINK_STATS_ADD(link, timeouts, 1);
+            df1_rtt_failure(link->rtt, now_ms);
+            complete_slot(link, i, -1, NULL);
+        }
+    }
+
+    start_next_transmit(link, now_ms);
+}
+
+long long df1_link_next_deadline(const df1_link_t* link)
+{
+    if (!link)
+    {
+        return -1;
+    }
+
+    long long deadline = -1;
+    for (int i = 0; i < DF1_LINK_MAX_OUTSTANDING; i++)
+    {
+        const df1_link_slot_t* slot = &link->slots[i];
+        if (slot->in_use && (slot->acked || link->awaiting_ack == i))
+        {
+            if (deadline < 0 || slot->deadline_ms < deadline)
+            {
+                deadline = slot->deadline_ms;
+            }
+        }
+    }
+    return deadline;
+}
+
+size_t df1_link_output(const df1_link_t* link, const uint8_t** data)
+{
+    if (!link || !data)
+    {
+        return 0;
+    }
+
+    *data = &link->tx_buffer[link->tx_pos];
+    return link->tx_len - link->tx_pos;
+}
+
+void df1_link_output_done(df1_link_t* link, size_t length)
+{
+    if (!link)
+        return;
+
+    if (length > link->tx_len - link->tx_pos)
+    {
+        length = link->tx_len - link->tx_pos;
+    }
+    link->tx_pos += length;
+    if (link->tx_pos == link->tx_len)
+    {
+        link->tx_pos = link->tx_len = 0;
+#ifdef DF1_ENABLE_STATS
+        stats_output_drained(link);
+#endif
+    }
+
+    // 之前因缓冲区已满而推迟的命令
+    start_next_transmit(link, link->now_ms);
+}
+
+size_t df1_link_outstanding(const df1_link_t* link)
+{
+    return link ? link->outstanding : 0;
+}
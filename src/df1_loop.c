@@ -0,0 +1,677 @@
+#define _DEFAULT_SOURCE
+#include "df1_loop.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#define LOOP_MAX_EVENTS 64
+#define LOOP_NOT_IN_HEAP SIZE_MAX
+
+typedef struct loop_port loop_port_t;
+
+// 一条已提交的请求
+typedef struct loop_op {
+    df1_request_t* request;      // 请求
+    df1_loop_callback_t callback; // 完成回调
+    void* user_data;             // 回调用户数据
+    loop_port_t* port;           // 所属连接
+    struct loop_op* next;        // 等待队列或空闲链表中的下一条
+} loop_op_t;
+
+// 事件循环中的一个连接
+struct loop_port {
+    df1_loop_t* loop;            // 所属事件循环
+    df1_serial_t* serial;        // 连接
+    loop_op_t* queue_head;       // 等待链路层窗口的请求
+    loop_op_t* queue_tail;
+    size_t heap_index;           // 在定时器堆中的位置，LOOP_NOT_IN_HEAP 表示不在堆中
+    long long deadline_ms;       // 链路层最近的截止时间
+    bool want_write;             // 是否已注册 EPOLLOUT
+    bool broken;                 // 读写出错，已从 epoll 中移除
+};
+
+struct df1_loop {
+    int epoll_fd;                // epoll 实例
+    int timer_fd;                // 指向定时器堆顶的 timerfd
+    long long armed_ms;          // timerfd 当前的到期时间，-1 表示未设置
+    loop_port_t** ports;         // 连接列表
+    size_t port_count;
+    size_t port_capacity;
+    loop_port_t** heap;          // 按 deadline_ms 排序的最小堆
+    size_t heap_size;
+    loop_op_t* free_ops;         // 空闲请求节点
+    size_t pending;              // 未完成的请求数
+    size_t completed;            // 当前一轮处理中完成的请求数
+};
+
+static long long monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 定时器堆
+
+static void heap_swap(df1_loop_t* loop, size_t a, size_t b)
+{
+    loop_port_t* tmp = loop->heap[a];
+    loop->heap[a] = loop->heap[b];
+    loop->heap[b] = tmp;
+    loop->heap[a]->heap_index = a;
+    loop->heap[b]->heap_index = b;
+}
+
+static void heap_sift_up(df1_loop_t* loop, size_t index)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (loop->heap[parent]->deadline_ms <= loop->heap[index]->deadline_ms)
+        {
+            break;
+        }
+        heap_swap(loop, parent, index);
+        index = parent;
+    }
+}
+
+static void heap_sift_down(df1_loop_t* loop, size_t index)
+{
+    for (;;)
+    {
+        size_t smallest = index;
+        size_t left = index * 2 + 1;
+        size_t right = left + 1;
+        if (left < loop->heap_size && loop->heap[left]->deadline_ms < loop->heap[smallest]->deadline_ms)
+        {
+            smallest = left;
+        }
+        if (right < loop->heap_size && loop->heap[right]->deadline_ms < loop->heap[smallest]->deadline_ms)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        heap_swap(loop, index, smallest);
+        index = smallest;
+    }
+}
+
+static void heap_remove(df1_loop_t* loop, loop_port_t* port)
+{
+    size_t index = port->heap_index;
+    if (index == LOOP_NOT_IN_HEAP)
+    {
+        return;
+    }
+
+    port->heap_index = LOOP_NOT_IN_HEAP;
+    loop->heap_size--;
+    if (index == loop->heap_size)
+    {
+        return;
+    }
+
+    loop->heap[index] = loop->heap[loop->heap_size];
+    loop->heap[index]->heap_index = index;
+    heap_sift_up(loop, index);
+    heap_sift_down(loop, loop->heap[index]->heap_index);
+}
+
+// 按链路层最近的截止时间更新连接在堆中的位置
+static void update_timer(df1_loop_t* loop, loop_port_t* port)
+{
+    long long deadline = df1_link_next_deadline(&port->serial->link);
+    if (deadline < 0)
+    {
+        heap_remove(loop, port);
+        return;
+    }
+
+    if (port->heap_index == LOOP_NOT_IN_HEAP)
+    {
+        port->deadline_ms = deadline;
+        port->heap_index = loop->heap_size;
+        loop->heap[loop->heap_size++] = port;
+        heap_sift_up(loop, port->heap_index);
+        return;
+    }
+
+    long long previous = port->deadline_ms;
+    port->deadline_ms = deadline;
+    if (deadline < previous)
+    {
+        heap_sift_up(loop, port->heap_index);
+    }
+    else if (deadline > previous)
+    {
+        heap_sift_down(loop, port->heap_index);
+    }
+}
+
+// 将 timerfd 设置为堆顶的截止时间
+static void arm_timer(df1_loop_t* loop)
+{
+    long long deadline = loop->heap_size > 0 ? loop->heap[0]->deadline_ms : -1;
+    if (deadline == loop->armed_ms)
+    {
+        return;
+    }
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (deadline >= 0)
+    {
+        // 全零表示停止定时器，已经到期的截止时间至少设置为1纳秒
+        spec.it_value.tv_sec = (time_t)(deadline / 1000);
+        spec.it_value.tv_nsec = (long)(deadline % 1000) * 1000000L;
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+        {
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    if (timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0)
+    {
+        loop->armed_ms = deadline;
+    }
+}
+
+// 请求节点
+
+static loop_op_t* op_alloc(df1_loop_t* loop)
+{
+    loop_op_t* op = loop->free_ops;
+    if (op)
+    {
+        loop->free_ops = op->next;
+        return op;
+    }
+    return (loop_op_t*)malloc(sizeof(loop_op_t));
+}
+
+static void op_complete(df1_loop_t* loop, loop_op_t* op, int status, const df1_frame_t* reply)
+{
+    df1_request_t* request = op->request;
+    df1_loop_callback_t callback = op->callback;
+    void* user_data = op->user_data;
+    df1_serial_t* serial = op->port->serial;
+
+    // 先归还节点再回调，回调中可以直接提交新请求
+    op->next = loop->free_ops;
+    loop->free_ops = op;
+    loop->pending--;
+    loop->completed++;
+
+    df1_request_finish(request, status, reply);
+    if (request->status != 0)
+    {
+        request->status = -1;
+    }
+    if (callback)
+    {
+        callback(user_data, serial, request);
+    }
+}
+
+static void link_complete(void* user_data, int status, const df1_frame_t* reply)
+{
+    loop_op_t* op = (loop_op_t*)user_data;
+    op_complete(op->port->loop, op, status, reply);
+}
+
+// 连接
+
+static loop_port_t* find_port(const df1_loop_t* loop, const df1_serial_t* serial, size_t* index)
+{
+    for (size_t i = 0; i < loop->port_count; i++)
+    {
+        if (loop->ports[i]->serial == serial)
+        {
+            if (index)
+            {
+                *index = i;
+            }
+            return loop->ports[i];
+        }
+    }
+    return NULL;
+}
+
+static void set_want_write(df1_loop_t* loop, loop_port_t* port, bool want_write)
+{
+    if (port->want_write == want_write)
+    {
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0);
+    event.data.ptr = port;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, df1_transport_poll_fd(&port->serial->transport), &event) == 0)
+    {
+        port->want_write = want_write;
+    }
+}
+
+// 在途与排队的请求全部失败
+static void port_abort(df1_loop_t* loop, loop_port_t* port)
+{
+    df1_link_reset(&port->serial->link);
+
+    while (port->queue_head)
+    {
+        loop_op_t* op = port->queue_head;
+        port->queue_head = op->next;
+        if (!port->queue_head)
+        {
+            port->queue_tail = NULL;
+        }
+        op_complete(loop, op, -1, NULL);
+    }
+    heap_remove(loop, port);
+}
+
+// 连接读写出错：不再监听该连接，之后提交的请求直接失败
+static void port_fail(df1_loop_t* loop, loop_port_t* port)
+{
+    if (!port->broken)
+    {
+        port->broken = true;
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, df1_transport_poll_fd(&port->serial->transport), NULL);
+    }
+    port_abort(loop, port);
+}
+
+// 写出链路层待发送的字节，写不完时等待 EPOLLOUT
+static int port_flush(df1_loop_t* loop, loop_port_t* port)
+{
+    df1_link_t* link = &port->serial->link;
+    const uint8_t* data;
+    size_t size;
+
+    while ((size = df1_link_output(link, &data)) > 0)
+    {
+        ssize_t written = df1_transport_send(&port->serial->transport, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                set_want_write(loop, port, true);
+                return 0;
+            }
+            return -1;
+        }
+        DF1_STATS_ADD(&port->serial->stats, bytes_sent, written);
+        df1_link_output_done(link, (size_t)written);
+    }
+
+    set_want_write(loop, port, false);
+    return 0;
+}
+
+// 在链路层窗口允许的范围内提交排队的请求
+static void port_pump(df1_loop_t* loop, loop_port_t* port, long long now)
+{
+    df1_serial_t* serial = port->serial;
+    uint8_t command[DF1_MAX_FRAME_SIZE];
+
+    while (port->queue_head && df1_link_can_submit(&serial->link))
+    {
+        loop_op_t* op = port->queue_head;
+        port->queue_head = op->next;
+        if (!port->queue_head)
+        {
+            port->queue_tail = NULL;
+        }
+
+        size_t command_size;
+        uint16_t tns = ++serial->df1_config.transaction_id;
+        DF1_STATS_TIME(encode_start);
+        if (df1_request_encode(&serial->df1_config, op->request, command, sizeof(command), &command_size) != 0)
+        {
+            op_complete(loop, op, -1, NULL);
+            continue;
+        }
+        DF1_STATS_RECORD(&serial->stats, DF1_PHASE_ENCODE, encode_start, df1_stats_now_ns());
+        if (df1_link_submit_expect(&serial->link, command, command_size, tns, df1_request_reply_size(op->request),
+                                   now, link_complete, op) != 0)
+        {
+            op_complete(loop, op, -1, NULL);
+        }
+    }
+}
+
+// 一个连接上有事件后：提交请求、写出数据并更新定时器
+static void port_service(df1_loop_t* loop, loop_port_t* port, long long now)
+{
+    port_pump(loop, port, now);
+    if (port_flush(loop, port) != 0)
+    {
+        port_fail(loop, port);
+        return;
+    }
+    update_timer(loop, port);
+}
+
+static void port_read(df1_loop_t* loop, loop_port_t* port)
+{
+    uint8_t buffer[512];
+
+    for (;;)
+    {
+        struct iovec iov = {buffer, sizeof(buffer)};
+        ssize_t n = df1_transport_recv(&port->serial->transport, &iov, 1);
+        if (n > 0)
+        {
+            DF1_STATS_ADD(&port->serial->stats, bytes_received, n);
+            df1_link_input(&port->serial->link, buffer, (size_t)n, monotonic_ms());
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            // 读到0字节表示对端已关闭（TCP），不再可读
+            port_fail(loop, port);
+        }
+        return;
+    }
+}
+
+// 处理所有到期的链路层超时
+static void expire_timers(df1_loop_t* loop)
+{
+    long long now = monotonic_ms();
+    while (loop->heap_size > 0 && loop->heap[0]->deadline_ms <= now)
+    {
+        loop_port_t* port = loop->heap[0];
+        df1_link_tick(&port->serial->link, now);
+        port_service(loop, port, now);
+
+        // 链路层没有推进截止时间时避免空转
+        if (port->heap_index == 0 && port->deadline_ms <= now)
+        {
+            heap_remove(loop, port);
+        }
+    }
+}
+
+df1_loop_t* df1_loop_create(void)
+{
+    df1_loop_t* loop = (df1_loop_t*)malloc(sizeof(df1_loop_t));
+    if (!loop)
+    {
+        return NULL;
+    }
+
+    memset(loop, 0, sizeof(df1_loop_t));
+    loop->armed_ms = -1;
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->epoll_fd < 0 || loop->timer_fd < 0)
+    {
+        df1_loop_destroy(loop);
+        return NULL;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = NULL; // 定时器
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->timer_fd, &event) != 0)
+    {
+        df1_loop_destroy(loop);
+        return NULL;
+    }
+
+    return loop;
+}
+
+void df1_loop_destroy(df1_loop_t* loop)
+{
+    if (!loop)
+        return;
+
+    while (loop->port_count > 0)
+    {
+        df1_loop_remove(loop, loop->ports[loop->port_count - 1]->serial);
+    }
+
+    while (loop->free_ops)
+    {
+        loop_op_t* op = loop->free_ops;
+        loop->free_ops = op->next;
+        free(op);
+    }
+
+    if (loop->epoll_fd >= 0)
+    {
+        close(loop->epoll_fd);
+    }
+    if (loop->timer_fd >= 0)
+    {
+        close(loop->timer_fd);
+    }
+    free(loop->ports);
+    free(loop->heap);
+    free(loop);
+}
+
+int df1_loop_add(df1_loop_t* loop, df1_serial_t* serial)
+{
+    // 事件循环通过 epoll 等待，内存回环等没有文件描述符的传输层不能加入
+    int fd = serial ? df1_transport_poll_fd(&serial->transport) : -1;
+    if (!loop || !serial || !serial->is_open || fd < 0 || find_port(loop, serial, NULL))
+    {
+        return -1;
+    }
+
+    if (loop->port_count == loop->port_capacity)
+    {
+        size_t capacity = loop->port_capacity ? loop->port_capacity * 2 : 8;
+        loop_port_t** ports = (loop_port_t**)realloc(loop->ports, capacity * sizeof(loop_port_t*));
+        if (!ports)
+        {
+            return -1;
+        }
+        loop->ports = ports;
+
+        loop_port_t** heap = (loop_port_t**)realloc(loop->heap, capacity * sizeof(loop_port_t*));
+        if (!heap)
+        {
+            return -1;
+        }
+        loop->heap = heap;
+        loop->port_capacity = capacity;
+    }
+
+    loop_port_t* port = (loop_port_t*)malloc(sizeof(loop_port_t));
+    if (!port)
+    {
+        return -1;
+    }
+    memset(port, 0, sizeof(loop_port_t));
+    port->loop = loop;
+    port->serial = serial;
+    port->heap_index = LOOP_NOT_IN_HEAP;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.ptr = port;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        free(port);
+        return -1;
+    }
+
+    // 同步接口可能调高了 VMIN，事件循环按字节读取
+    df1_transport_set_min_read(&serial->transport, 1);
+
+    // 同步接口遗留的接收数据不属于任何异步请求
+    serial->rx_tail = serial->rx_head;
+    df1_decoder_reset(&serial->decoder);
+    df1_link_reset(&serial->link);
+
+    loop->ports[loop->port_count++] = port;
+    return 0;
+}
+
+int df1_loop_remove(df1_loop_t* loop, df1_serial_t* serial)
+{
+    size_t index;
+    loop_port_t* port = loop && serial ? find_port(loop, serial, &index) : NULL;
+    if (!port)
+    {
+        return -1;
+    }
+
+    port_fail(loop, port);
+    loop->ports[index] = loop->ports[--loop->port_count];
+    free(port);
+    arm_timer(loop);
+    return 0;
+}
+
+int df1_loop_submit(df1_loop_t* loop, df1_serial_t* serial, df1_request_t* request, df1_loop_callback_t callback,
+                    void* user_data)
+{
+    if (!loop || !request)
+    {
+        return -1;
+    }
+
+    loop_port_t* port = serial ? find_port(loop, serial, NULL) : NULL;
+    if (!port || port->broken)
+    {
+        return -1;
+    }
+
+    loop_op_t* op = op_alloc(loop);
+    if (!op)
+    {
+        return -1;
+    }
+
+    request->status = DF1_REQUEST_PENDING;
+    request->actual_size = 0;
+    request->sts = 0;
+    request->ext_sts = 0;
+
+    op->request = request;
+    op->callback = callback;
+    op->user_data = user_data;
+    op->port = port;
+    op->next = NULL;
+    if (port->queue_tail)
+    {
+        port->queue_tail->next = op;
+    }
+    else
+    {
+        port->queue_head = op;
+    }
+    port->queue_tail = op;
+    loop->pending++;
+
+    port_service(loop, port, monotonic_ms());
+    arm_timer(loop);
+    return 0;
+}
+
+int df1_loop_fd(const df1_loop_t* loop)
+{
+    return loop ? loop->epoll_fd : -1;
+}
+
+int df1_loop_process(df1_loop_t* loop, int timeout_ms)
+{
+    if (!loop)
+    {
+        return -1;
+    }
+
+    struct epoll_event events[LOOP_MAX_EVENTS];
+    int count = epoll_wait(loop->epoll_fd, events, LOOP_MAX_EVENTS, timeout_ms);
+    if (count < 0)
+    {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    loop->completed = 0;
+    for (int i = 0; i < count; i++)
+    {
+        loop_port_t* port = (loop_port_t*)events[i].data.ptr;
+        if (!port)
+        {
+            uint64_t expirations;
+            ssize_t n = read(loop->timer_fd, &expirations, sizeof(expirations));
+            (void)n;
+            loop->armed_ms = -1;
+            continue;
+        }
+
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+        {
+            port_read(loop, port);
+        }
+        // 先读完对端关闭前发出的数据再放弃连接。伪终端的对端关闭时读取返回 EAGAIN，
+        // 只能由挂断事件判断；事件是水平触发的，不放弃连接会一直空转
+        if (!port->broken && (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)))
+        {
+            port_fail(loop, port);
+        }
+        if (port->broken)
+        {
+            continue;
+        }
+        port_service(loop, port, monotonic_ms());
+    }
+
+    expire_timers(loop);
+    arm_timer(loop);
+    return (int)loop->completed;
+}
+
+int df1_loop_run(df1_loop_t* loop, int timeout_ms)
+{
+    if (!loop)
+    {
+        return -1;
+    }
+
+    long long deadline = monotonic_ms() + timeout_ms;
+    while (loop->pending > 0)
+    {
+        long long now = monotonic_ms();
+        if (now >= deadline)
+        {
+            return -1;
+        }
+        if (df1_loop_process(loop, (int)(deadline - now)) < 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+size_t df1_loop_pending(const df1_loop_t* loop)
+{
+    return loop ? loop->pending : 0;
+}
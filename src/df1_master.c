@@ -0,0 +1,504 @@
+#define _DEFAULT_SOURCE
+#include "df1_master.h"
+#include <string.h>
+#include <poll.h>
+#include <time.h>
+
+static long long monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void df1_master_config_default(df1_master_config_t* config, int timeout_ms)
+{
+    if (!config)
+        return;
+
+    config->ack_timeout_ms = timeout_ms;
+    config->poll_timeout_ms = timeout_ms;
+    config->reply_timeout_ms = timeout_ms;
+    config->busy_poll_ms = 5;
+    config->idle_poll_min_ms = 50;
+    config->idle_poll_max_ms = 2000;
+    config->max_retries = 3;
+    config->max_outstanding = 4;
+}
+
+int df1_master_init(df1_master_t* master, df1_serial_t* port, const df1_master_config_t* config)
+{
+    if (!master || !port || !port->is_open || port->df1_config.duplex != DF1_HALF_DUPLEX)
+    {
+        return -1;
+    }
+
+    memset(master, 0, sizeof(df1_master_t));
+    master->port = port;
+    if (config)
+    {
+        master->config = *config;
+    }
+    else
+    {
+        df1_master_config_default(&master->config, port->serial_config.timeout_ms);
+    }
+
+    if (master->config.max_outstanding < 1)
+    {
+        master->config.max_outstanding = 1;
+    }
+    if (master->config.max_outstanding > DF1_MASTER_QUEUE_SIZE)
+    {
+        master->config.max_outstanding = DF1_MASTER_QUEUE_SIZE;
+    }
+    if (master->config.idle_poll_max_ms < master->config.idle_poll_min_ms)
+    {
+        master->config.idle_poll_max_ms = master->config.idle_poll_min_ms;
+    }
+
+    return 0;
+}
+
+static df1_master_station_t* find_station(df1_master_t* master, uint8_t station)
+{
+    for (size_t i = 0; i < master->station_count; i++)
+    {
+        if (master->stations[i].station == station)
+        {
+            return &master->stations[i];
+        }
+    }
+    return NULL;
+}
+
+int df1_master_add_station(df1_master_t* master, uint8_t station, uint8_t dst_node)
+{
+    if (!master || master->station_count >= DF1_MASTER_MAX_STATIONS || find_station(master, station))
+    {
+        return -1;
+    }
+
+    df1_master_station_t* st = &master->stations[master->station_count++];
+    memset(st, 0, sizeof(df1_master_station_t));
+    st->station = station;
+    st->dst_node = dst_node;
+    st->poll_interval_ms = master->config.idle_poll_min_ms;
+    st->next_poll_ms = 0; // 加入后立即轮询一次
+    df1_rtt_init(&st->rtt, &master->port->rtt.config);
+    return 0;
+}
+
+void df1_master_set_message_callback(df1_master_t* master, df1_master_message_callback_t callback, void* user_data)
+{
+    if (!master)
+        return;
+
+    master->on_message = callback;
+    master->on_message_user = user_data;
+}
+
+int df1_master_submit(df1_master_t* master, uint8_t station, df1_request_t* request)
+{
+    if (!master || !request)
+    {
+        return -1;
+    }
+
+    df1_master_station_t* st = find_station(master, station);
+    if (!st || st->queue_tail - st->queue_head >= DF1_MASTER_QUEUE_SIZE)
+    {
+        return -1;
+    }
+
+    request->status = DF1_REQUEST_PENDING;
+    request->actual_size = 0;
+    request->sts = 0;
+    request->ext_sts = 0;
+
+    st->queue[st->queue_tail % DF1_MASTER_QUEUE_SIZE] = request;
+    st->queue_tail++;
+    master->pending_requests++;
+    return 0;
+}
+
+static void complete_request(df1_master_t* master, df1_request_t* request, int status, const df1_frame_t* reply)
+{
+    df1_request_finish(request, status, reply);
+    master->pending_requests--;
+}
+
+// 按从站的往返时间估计等待，不超过配置的固定超时
+static int station_timeout(const df1_master_station_t* st, int timeout_ms, int attempt, size_t wire_bytes)
+{
+    if (!st->rtt.config.enabled)
+    {
+        return timeout_ms;
+    }
+    int adaptive = df1_rtt_timeout(&st->rtt, attempt, wire_bytes);
+    return adaptive < timeout_ms ? adaptive : timeout_ms;
+}
+
+static void send_control(df1_master_t* master, uint8_t symbol)
+{
+    uint8_t control[2] = {DF1_DLE, symbol};
+    df1_serial_send_raw(master->port, control, sizeof(control));
+}
+
+// 响应超时的命令以失败结束
+static void expire_pending(df1_master_t* master, df1_master_station_t* st, long long now)
+{
+    size_t i = 0;
+    while (i < st->pending_count)
+    {
+        if (now >= st->pending[i].deadline_ms)
+        {
+            complete_request(master, st->pending[i].request, -1, NULL);
+            st->timeouts++;
+            st->pending[i] = st->pending[--st->pending_count];
+            continue;
+        }
+        i++;
+    }
+}
+
+// 发送队首命令并等待从站 DLE ACK
+static int send_command(df1_master_t* master, df1_master_station_t* st)
+{
+    df1_request_t* request = st->queue[st->queue_head % DF1_MASTER_QUEUE_SIZE];
+    df1_serial_t* port = master->port;
+
+    // 从站离线：不占用线路，直接失败
+    if (!df1_rtt_allow(&st->rtt, monotonic_ms()))
+    {
+        st->queue_head++;
+        st->send_retries = 0;
+        complete_request(master, request, -1, NULL);
+        return 0;
+    }
+
+    df1_config_t config = port->df1_config;
+    config.station = st->station;
+    config.dst_node = st->dst_node;
+    config.transaction_id = ++port->df1_config.transaction_id;
+
+    uint8_t command[DF1_MAX_FRAME_SIZE];
+    size_t command_size = 0;
+    if (df1_request_encode(&config, request, command, sizeof(command), &command_size) != 0)
+    {
+        st->queue_head++;
+        st->send_retries = 0;
+        complete_request(master, request, -1, NULL);
+        return 0;
+    }
+
+    if (df1_serial_send_raw(port, command, command_size) != 0)
+    {
+        return -1;
+    }
+
+    // 等待 ACK，期间的其他字节（残留帧、EOT）不是对本命令的应答
+    long long sent = monotonic_ms();
+    long long deadline = sent + station_timeout(st, master->config.ack_timeout_ms, st->send_retries, command_size + 2);
+    int result = DF1_DECODE_NEED_MORE;
+    for (;;)
+    {
+        long long now = monotonic_ms();
+        if (now >= deadline)
+        {
+            result = DF1_DECODE_NEED_MORE;
+            break;
+        }
+
+        df1_frame_t frame;
+        result = df1_serial_receive_event(port, (int)(deadline - now), &frame);
+        if (result == DF1_DECODE_ACK || result == DF1_DECODE_NAK || result == DF1_DECODE_NEED_MORE)
+        {
+            break;
+        }
+    }
+
+    long long now = monotonic_ms();
+    if (result != DF1_DECODE_NEED_MORE)
+    {
+        df1_rtt_success(&st->rtt);
+    }
+    if (result == DF1_DECODE_ACK)
+    {
+        // DLE ACK 不带事务ID，只用没有重发过的命令作为样本
+        if (st->send_retries == 0)
+        {
+            df1_rtt_sample(&st->rtt, (int64_t)(now - sent) * 1000, command_size + 2);
+        }
+        st->queue_head++;
+        st->send_retries = 0;
+
+        df1_master_pending_t* pending = &st->pending[st->pending_count++];
+        pending->request = request;
+        pending->tns = config.transaction_id;
+        pending->deadline_ms = now + master->config.reply_timeout_ms;
+
+        // 给从站处理时间，期间线路用于其他从站
+        long long next_poll = now + master->config.busy_poll_ms;
+        if (st->next_poll_ms > next_poll || st->pending_count == 1)
+        {
+            st->next_poll_ms = next_poll;
+        }
+        return 0;
+    }
+
+    if (result == DF1_DECODE_NEED_MORE)
+    {
+        st->timeouts++;
+    }
+    if (++st->send_retries > master->config.max_retries)
+    {
+        st->queue_head++;
+        st->send_retries = 0;
+        if (result == DF1_DECODE_NEED_MORE)
+        {
+            df1_rtt_failure(&st->rtt, now);
+        }
+        complete_request(master, request, -1, NULL);
+    }
+    return 0;
+}
+
+// 处理从站在轮询后发来的消息
+static void handle_message(df1_master_t* master, df1_master_station_t* st, const df1_frame_t* frame)
+{
+    st->messages++;
+
+    // 从站没有收到我们的 ACK 而重发的消息
+    if (st->has_last_message && frame->cmd == st->last_cmd && frame->tns == st->last_tns)
+    {
+        return;
+    }
+    st->has_last_message = true;
+    st->last_cmd = frame->cmd;
+    st->last_tns = frame->tns;
+
+    for (size_t i = 0; i < st->pending_count; i++)
+    {
+        if (st->pending[i].tns == frame->tns)
+        {
+            complete_request(master, st->pending[i].request, 0, frame);
+            st->pending[i] = st->pending[--st->pending_count];
+            return;
+        }
+    }
+
+    master->unsolicited++;
+    if (master->on_message)
+    {
+        master->on_message(master->on_message_user, st->station, frame);
+    }
+}
+
+// 轮询从站：DLE ENQ STN BCC，从站应答消息或 DLE EOT
+static int poll_station(df1_master_t* master, df1_master_station_t* st)
+{
+    uint8_t poll[8];
+    size_t poll_size = 0;
+    if (df1_build_poll(st->station, poll, sizeof(poll), &poll_size) != 0 ||
+        df1_serial_send_raw(master->port, poll, poll_size) != 0)
+    {
+        return -1;
+    }
+    st->polls++;
+
+    // 从站可能以一条最长的消息应答轮询
+    long long sent = monotonic_ms();
+    int timeout_ms = station_timeout(st, master->config.poll_timeout_ms, 0, poll_size + DF1_MAX_DATA_SIZE + 16);
+    df1_frame_t frame;
+    int result = df1_serial_receive_event(master->port, timeout_ms, &frame);
+    long long now = monotonic_ms();
+
+    if (result == DF1_DECODE_FRAME || result == DF1_DECODE_EOT)
+    {
+        size_t reply_bytes = result == DF1_DECODE_FRAME ? frame.pdu_length + 9 : 2;
+        df1_rtt_sample(&st->rtt, (int64_t)(now - sent) * 1000, poll_size + reply_bytes);
+    }
+    if (result != DF1_DECODE_NEED_MORE)
+    {
+        df1_rtt_success(&st->rtt);
+    }
+
+    switch (result)
+    {
+    case DF1_DECODE_FRAME:
+        send_control(master, DF1_ACK);
+        handle_message(master, st, &frame);
+        // 从站每次轮询只发送一条消息，可能还有更多待发送
+        st->poll_interval_ms = master->config.idle_poll_min_ms;
+        st->next_poll_ms = now;
+        break;
+    case DF1_DECODE_BAD_CHECKSUM:
+    case DF1_DECODE_OVERFLOW:
+    case DF1_DECODE_MALFORMED:
+        // 从站在下一次轮询时重发
+        send_control(master, DF1_NAK);
+        st->next_poll_ms = now;
+        break;
+    case DF1_DECODE_EOT:
+        st->eots++;
+        if (st->pending_count > 0)
+        {
+            st->next_poll_ms = now + master->config.busy_poll_ms;
+        }
+        else
+        {
+            st->next_poll_ms = now + st->poll_interval_ms;
+            st->poll_interval_ms *= 2;
+            if (st->poll_interval_ms > master->config.idle_poll_max_ms)
+            {
+                st->poll_interval_ms = master->config.idle_poll_max_ms;
+            }
+        }
+        break;
+    default:
+        // 无应答：按空闲间隔退避，避免离线从站占用线路
+        st->timeouts++;
+        df1_rtt_failure(&st->rtt, now);
+        st->next_poll_ms = now + st->poll_interval_ms;
+        st->poll_interval_ms *= 2;
+        if (st->poll_interval_ms > master->config.idle_poll_max_ms)
+        {
+            st->poll_interval_ms = master->config.idle_poll_max_ms;
+        }
+        break;
+    }
+    return 0;
+}
+
+// 从 cursor 开始轮转查找可以发送命令的从站
+static int select_send(df1_master_t* master)
+{
+    for (size_t n = 0; n < master->station_count; n++)
+    {
+        size_t i = (master->send_cursor + n) % master->station_count;
+        df1_master_station_t* st = &master->stations[i];
+        if (st->queue_head != st->queue_tail && st->pending_count < (size_t)master->config.max_outstanding)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// 从 cursor 开始轮转查找轮询已到期的从站
+static int select_poll(df1_master_t* master, long long now)
+{
+    for (size_t n = 0; n < master->station_count; n++)
+    {
+        size_t i = (master->poll_cursor + n) % master->station_count;
+        if (master->stations[i].next_poll_ms <= now)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int df1_master_step(df1_master_t* master)
+{
+    if (!master || !master->port || !master->port->is_open)
+    {
+        return -1;
+    }
+
+    long long now = monotonic_ms();
+    for (size_t i = 0; i < master->station_count; i++)
+    {
+        expire_pending(master, &master->stations[i], now);
+    }
+
+    int send_index = select_send(master);
+    int poll_index = select_poll(master, now);
+
+    // 发送与轮询交替进行，使多个从站的命令处理时间相互重叠
+    if (poll_index >= 0 && (master->last_was_send || send_index < 0))
+    {
+        master->poll_cursor = (size_t)poll_index + 1;
+        master->last_was_send = false;
+        return poll_station(master, &master->stations[poll_index]) == 0 ? 1 : -1;
+    }
+    if (send_index >= 0)
+    {
+        master->send_cursor = (size_t)send_index + 1;
+        master->last_was_send = true;
+        return send_command(master, &master->stations[send_index]) == 0 ? 1 : -1;
+    }
+    return 0;
+}
+
+// 最近一次到期的轮询或响应超时
+static long long next_due(const df1_master_t* master)
+{
+    long long due = -1;
+    for (size_t i = 0; i < master->station_count; i++)
+    {
+        const df1_master_station_t* st = &master->stations[i];
+        if (due < 0 || st->next_poll_ms < due)
+        {
+            due = st->next_poll_ms;
+        }
+        for (size_t j = 0; j < st->pending_count; j++)
+        {
+            if (st->pending[j].deadline_ms < due)
+            {
+                due = st->pending[j].deadline_ms;
+            }
+        }
+    }
+    return due;
+}
+
+int df1_master_run(df1_master_t* master, int timeout_ms)
+{
+    if (!master)
+    {
+        return -1;
+    }
+
+    bool had_requests = master->pending_requests > 0;
+    long long deadline = monotonic_ms() + timeout_ms;
+
+    for (;;)
+    {
+        if (had_requests && master->pending_requests == 0)
+        {
+            return 0;
+        }
+
+        long long now = monotonic_ms();
+        if (now >= deadline)
+        {
+            return had_requests ? -1 : 0;
+        }
+
+        int result = df1_master_step(master);
+        if (result < 0)
+        {
+            return -1;
+        }
+        if (result == 0)
+        {
+            // 没有到期的操作，等待到最近的到期时间
+            long long wake = next_due(master);
+            if (wake < 0 || wake > deadline)
+            {
+                wake = deadline;
+            }
+            if (wake > now)
+            {
+                poll(NULL, 0, (int)(wake - now));
+            }
+        }
+    }
+}
+
+size_t df1_master_pending(const df1_master_t* master)
+{
+    return master ? master->pending_requests : 0;
+}
@@ -0,0 +1,309 @@
+#include "df1_plan.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 排序用的标签区间，以字为单位（元素号 × 每元素字数 + 子元素号）
+typedef struct {
+    df1_addr_type_t data_code;
+    uint16_t db_block;
+    size_t start;                // 起始字
+    size_t end;                  // 结束字（不含）
+    size_t item;                 // 标签下标
+} plan_span_t;
+
+static int compare_spans(const void* a, const void* b)
+{
+    const plan_span_t* x = (const plan_span_t*)a;
+    const plan_span_t* y = (const plan_span_t*)b;
+
+    if (x->data_code != y->data_code)
+        return x->data_code < y->data_code ? -1 : 1;
+    if (x->db_block != y->db_block)
+        return x->db_block < y->db_block ? -1 : 1;
+    if (x->start != y->start)
+        return x->start < y->start ? -1 : 1;
+    if (x->item != y->item)
+        return x->item < y->item ? -1 : 1; // 保持稳定
+    return 0;
+}
+
+// 定时器、计数器、控制元素的各个字可以作为子元素单独读取
+static bool has_sub_elements(df1_addr_type_t data_code)
+{
+    return data_code == DF1_ADDR_T || data_code == DF1_ADDR_C || data_code == DF1_ADDR_R;
+}
+
+// 按起始字与结束字填写块地址与大小
+static void close_block(df1_plan_block_t* block, size_t start, size_t end, size_t words)
+{
+    block->addr.address_start = (uint16_t)(start / words);
+    block->addr.sub_element = (uint16_t)(start % words);
+    block->addr.length = (uint16_t)((end - start + words - 1) / words);
+    block->size = (end - start) * 2;
+}
+
+void df1_plan_config_default(df1_plan_config_t* config)
+{
+    if (!config)
+        return;
+
+    config->max_read_size = DF1_PLAN_DEFAULT_MAX_READ;
+    config->max_gap = DF1_PLAN_DEFAULT_MAX_GAP;
+}
+
+void df1_plan_init(df1_plan_t* plan)
+{
+    if (!plan)
+        return;
+
+    memset(plan, 0, sizeof(df1_plan_t));
+}
+
+void df1_plan_free(df1_plan_t* plan)
+{
+    if (!plan)
+        return;
+
+    free(plan->blocks);
+    free(plan->slices);
+    free(plan->data);
+    memset(plan, 0, sizeof(df1_plan_t));
+}
+
+int df1_plan_build(df1_plan_t* plan, const df1_plan_config_t* config, const df1_plan_item_t* items, size_t count)
+{
+    if (!plan || (!items && count > 0))
+    {
+        return -1;
+    }
+
+    df1_plan_config_t defaults;
+    if (!config)
+    {
+        df1_plan_config_default(&defaults);
+        config = &defaults;
+    }
+
+    // 读取长度字段只有一个字节
+    size_t max_read = config->max_read_size < 255 ? config->max_read_size : 255;
+
+    df1_plan_free(plan);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    plan_span_t* spans = (plan_span_t*)malloc(count * sizeof(plan_span_t));
+    plan->blocks = (df1_plan_block_t*)malloc(count * sizeof(df1_plan_block_t));
+    plan->slices = (df1_plan_slice_t*)malloc(count * sizeof(df1_plan_slice_t));
+    if (!spans || !plan->blocks || !plan->slices)
+    {
+        free(spans);
+        df1_plan_free(plan);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const df1_address_t* addr = items[i].addr;
+        size_t words = addr ? df1_address_element_size(addr->data_code) / 2 : 0;
+        if (words == 0 || items[i].size == 0 || addr->sub_element >= words)
+        {
+            free(spans);
+            df1_plan_free(plan);
+            return -1;
+        }
+
+        spans[i].data_code = addr->data_code;
+        spans[i].db_block = addr->db_block;
+        spans[i].start = (size_t)addr->address_start * words + addr->sub_element;
+        spans[i].end = spans[i].start + (items[i].size + 1) / 2;
+        if (!has_sub_elements(addr->data_code))
+        {
+            // 浮点、长整数、字符串只按整元素读取
+            spans[i].end = (spans[i].end + words - 1) / words * words;
+        }
+        spans[i].item = i;
+
+        if ((spans[i].end - spans[i].start) * 2 > max_read)
+        {
+            free(spans);
+            df1_plan_free(plan);
+            return -1;
+        }
+    }
+
+    qsort(spans, count, sizeof(plan_span_t), compare_spans);
+
+    df1_plan_block_t* block = NULL;
+    size_t start = 0;
+    size_t block_end = 0;
+    size_t words = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const plan_span_t* span = &spans[i];
+        bool merge = false;
+        size_t merged_start = start;
+        if (block && span->data_code == block->addr.data_code && span->db_block == block->addr.db_block &&
+            span->start <= block_end + config->max_gap * words)
+        {
+            size_t end = span->end > block_end ? span->end : block_end;
+
+            // 从子元素开始的块只能在该元素之内，跨元素时退回到元素起点
+            if (merged_start % words != 0 && (end - 1) / words != merged_start / words)
+            {
+                merged_start -= merged_start % words;
+            }
+            merge = (end - merged_start) * 2 <= max_read;
+        }
+
+        if (merge)
+        {
+            start = merged_start;
+            if (span->end > block_end)
+            {
+                block_end = span->end;
+            }
+            block->count++;
+        }
+        else
+        {
+            if (block)
+            {
+                close_block(block, start, block_end, words);
+            }
+
+            block = &plan->blocks[plan->block_count++];
+            memset(block, 0, sizeof(df1_plan_block_t));
+            block->addr.data_code = span->data_code;
+            block->addr.db_block = span->db_block;
+            block->first = i;
+            block->count = 1;
+            words = df1_address_element_size(span->data_code) / 2;
+            start = span->start;
+            block_end = span->end;
+        }
+
+        plan->slices[i].item = span->item;
+    }
+    close_block(block, start, block_end, words);
+    plan->slice_count = count;
+
+    // 块确定后计算分片偏移（合并时块起点可能前移）
+    for (size_t i = 0; i < plan->block_count; i++)
+    {
+        df1_plan_block_t* entry = &plan->blocks[i];
+        size_t block_words = df1_address_element_size(entry->addr.data_code) / 2;
+        size_t block_start = (size_t)entry->addr.address_start * block_words + entry->addr.sub_element;
+        for (size_t j = entry->first; j < entry->first + entry->count; j++)
+        {
+            plan->slices[j].offset = (spans[j].start - block_start) * 2;
+        }
+        entry->offset = plan->data_size;
+        plan->data_size += entry->size;
+    }
+    free(spans);
+
+    plan->data = (uint8_t*)malloc(plan->data_size);
+    if (!plan->data)
+    {
+        df1_plan_free(plan);
+        return -1;
+    }
+
+    return 0;
+}
+
+void df1_plan_scatter(const df1_plan_t* plan, size_t block, int status, const uint8_t* data, size_t size,
+                      df1_plan_item_t* items)
+{
+    if (!plan || !items || block >= plan->block_count)
+        return;
+
+    const df1_plan_block_t* entry = &plan->blocks[block];
+    for (size_t i = entry->first; i < entry->first + entry->count; i++)
+    {
+        const df1_plan_slice_t* slice = &plan->slices[i];
+        df1_plan_item_t* item = &items[slice->item];
+
+        // 响应短于请求时，未完整覆盖的标签视为失败
+        if (status != 0 || !data || slice->offset + item->size > size)
+        {
+            item->status = -1;
+            continue;
+        }
+
+        if (item->data)
+        {
+            memcpy(item->data, data + slice->offset, item->size);
+        }
+        item->status = 0;
+    }
+}
+
+int df1_plan_compile(df1_plan_t* plan, const df1_config_t* config)
+{
+    if (!plan || !config)
+    {
+        return -1;
+    }
+
+    int result = 0;
+    for (size_t i = 0; i < plan->block_count; i++)
+    {
+        df1_plan_block_t* block = &plan->blocks[i];
+        if (!df1_frame_template_matches(&block->frame, config)
+            && df1_frame_template_read(&block->frame, config, &block->addr, (uint16_t)block->size) != 0)
+        {
+            result = -1;
+        }
+    }
+    return result;
+}
+
+int df1_plan_read(df1_serial_t* df1_serial, df1_plan_t* plan, df1_plan_item_t* items)
+{
+    if (!df1_serial || !plan || (!items && plan->slice_count > 0))
+    {
+        return -1;
+    }
+
+    if (plan->block_count == 0)
+    {
+        return 0;
+    }
+
+    df1_request_t* requests = (df1_request_t*)calloc(plan->block_count, sizeof(df1_request_t));
+    if (!requests)
+    {
+        return -1;
+    }
+
+    df1_plan_compile(plan, &df1_serial->df1_config);
+    for (size_t i = 0; i < plan->block_count; i++)
+    {
+        requests[i].command = DF1_CMD_READ;
+        requests[i].addr = &plan->blocks[i].addr;
+        requests[i].read_data = plan->data + plan->blocks[i].offset;
+        requests[i].size = plan->blocks[i].size;
+        requests[i].frame_template = &plan->blocks[i].frame;
+    }
+
+    df1_serial_transact(df1_serial, requests, plan->block_count);
+
+    int result = 0;
+    for (size_t i = 0; i < plan->block_count; i++)
+    {
+        df1_plan_scatter(plan, i, requests[i].status, requests[i].read_data, requests[i].actual_size, items);
+    }
+    for (size_t i = 0; i < plan->slice_count; i++)
+    {
+        if (items[i].status != 0)
+        {
+            result = -1;
+        }
+    }
+
+    free(requests);
+    return result;
+}
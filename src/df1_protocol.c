@@ -1,5 +1,7 @@
 #include "df1_protocol.h"
 #include "df1_address.h"
+#include "df1_crc.h"
+#include "df1_dle.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,162 +28,243 @@ static const uint16_t crc16_table[256]
        0x4C80, 0x8C41, 0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641, 0x8201, 0x42C0, 0x4380, 0x8341,
        0x4100, 0x81C1, 0x8081, 0x4040};
 
-// 计算CRC16
-static uint16_t calculate_crc16(const uint8_t* data, size_t length)
+// CRC16 累加一个字节
+static inline uint16_t crc16_update(uint16_t crc, uint8_t value)
 {
-    uint16_t crc = 0x0000;
-    for (size_t i = 0; i < length; i++)
+    return (crc >> 8) ^ crc16_table[(crc ^ value) & 0xFF];
+}
+
+// 帧编码器：一次遍历内完成DLE转义、校验累加与越界检查，直接写入调用者缓冲区
+typedef struct {
+    uint8_t* buffer;             // 输出缓冲区
+    size_t size;                 // 输出缓冲区大小
+    size_t pos;                  // 当前写入位置
+    df1_check_type_t check_type; // 校验类型
+    uint16_t crc;                // CRC16累加值
+    uint8_t sum;                 // BCC累加和
+    bool overflow;               // 是否已越界
+} frame_encoder_t;
+
+// 写入一个不参与校验、不转义的字节
+static inline void encoder_put_raw(frame_encoder_t* enc, uint8_t value)
+{
+    if (enc->pos < enc->size)
+    {
+        enc->buffer[enc->pos++] = value;
+    }
+    else
     {
-        crc = (crc >> 8) ^ crc16_table[(crc ^ data[i]) & 0xFF];
+        enc->overflow = true;
     }
-    return crc;
 }
 
-// 计算BCC校验
-static uint8_t calculate_bcc(uint8_t station, const uint8_t* data, size_t length)
+// 整段写入不参与校验、不转义的字节
+static inline void encoder_put_run(frame_encoder_t* enc, const uint8_t* data, size_t length)
 {
-    int sum = station;
+    if (length <= enc->size - enc->pos)
+    {
+        memcpy(enc->buffer + enc->pos, data, length);
+        enc->pos += length;
+    }
+    else
+    {
+        enc->pos = enc->size;
+        enc->overflow = true;
+    }
+}
+
+// 写入一个应用层字节：累加校验并进行DLE转义
+static inline void encoder_put(frame_encoder_t* enc, uint8_t value)
+{
+    enc->crc = crc16_update(enc->crc, value);
+    enc->sum = (uint8_t)(enc->sum + value);
+
+    encoder_put_raw(enc, value);
+    if (value == 0x10)
+    {
+        encoder_put_raw(enc, 0x10); // DLE转义
+    }
+}
+
+// 写入一段应用层数据：校验整段计算（CRC16 使用 df1_crc16 的内核），之后按向量宽度查找DLE，
+// 两个DLE之间的数据整段复制
+static void encoder_put_bytes(frame_encoder_t* enc, const uint8_t* data, size_t length)
+{
+    enc->crc = df1_crc16_compute(DF1_CRC16_AUTO, enc->crc, data, length);
+    uint8_t sum = enc->sum;
     for (size_t i = 0; i < length; i++)
     {
-        sum += data[i];
+        sum = (uint8_t)(sum + data[i]);
+    }
+    enc->sum = sum;
+
+    while (length > 0)
+    {
+        size_t run = df1_dle_find(data, length);
+        encoder_put_run(enc, data, run);
+        if (run == length)
+        {
+            break;
+        }
+        encoder_put_raw(enc, 0x10);
+        encoder_put_raw(enc, 0x10); // DLE转义
+        data += run + 1;
+        length -= run + 1;
     }
-    return (uint8_t)(~sum + 1);
 }
 
-// 添加长度到缓冲区
-static size_t add_length_to_buffer(uint8_t* buffer, uint16_t value)
+// 写入地址字段，>=255 时使用 0xFF + 两字节小端格式
+static void encoder_put_length(frame_encoder_t* enc, uint16_t value)
 {
     if (value < 255)
     {
-        buffer[0] = (uint8_t)value;
-        return 1;
+        encoder_put(enc, (uint8_t)value);
     }
     else
     {
-        buffer[0] = 0xFF;
-        buffer[1] = (uint8_t)(value & 0xFF);
-        buffer[2] = (uint8_t)(value >> 8);
-        return 3;
+        encoder_put(enc, 0xFF);
+        encoder_put(enc, (uint8_t)(value & 0xFF));
+        encoder_put(enc, (uint8_t)(value >> 8));
     }
 }
 
-void df1_config_init(df1_config_t* config, uint8_t station, uint8_t dst_node, uint8_t src_node)
+// 写入帧头。半双工为 DLE SOH STN DLE STX，站号计入BCC，站号与STX计入CRC；
+// 全双工为 DLE STX，只对应用层数据与ETX校验
+static void encoder_begin(frame_encoder_t* enc, const df1_config_t* config, uint8_t* buffer, size_t buffer_size)
 {
-    if (!config)
+    enc->buffer = buffer;
+    enc->size = buffer_size;
+    enc->pos = 0;
+    enc->check_type = config->check_type;
+    enc->crc = 0x0000;
+    enc->sum = 0;
+    enc->overflow = false;
+
+    if (config->duplex == DF1_FULL_DUPLEX)
+    {
+        encoder_put_raw(enc, 0x10);
+        encoder_put_raw(enc, 0x02);
         return;
+    }
 
-    config->station = station;
-    config->dst_node = dst_node;
-    config->src_node = src_node;
-    config->check_type = DF1_CHECK_CRC16;
-    config->transaction_id = 0;
+    encoder_put_raw(enc, 0x10);
+    encoder_put_raw(enc, 0x01);
+
+    encoder_put(enc, config->station);
+
+    encoder_put_raw(enc, 0x10);
+    encoder_put_raw(enc, 0x02);
+    enc->crc = crc16_update(enc->crc, 0x02);
 }
 
-int df1_build_read_command(const df1_config_t* config, const char* address, uint16_t length, uint8_t* buffer,
-                           size_t buffer_size, size_t* actual_size)
+// 写入帧尾 DLE ETX 与校验
+static int encoder_finish(frame_encoder_t* enc, size_t* actual_size)
 {
-    if (!config || !address || !buffer || !actual_size)
+    encoder_put_raw(enc, 0x10);
+    encoder_put_raw(enc, 0x03);
+
+    if (enc->check_type == DF1_CHECK_BCC)
+    {
+        encoder_put_raw(enc, (uint8_t)(~enc->sum + 1));
+    }
+    else
+    {
+        uint16_t crc = crc16_update(enc->crc, 0x03);
+        encoder_put_raw(enc, (uint8_t)(crc >> 8));
+        encoder_put_raw(enc, (uint8_t)(crc & 0xFF));
+    }
+
+    if (enc->overflow)
     {
         return -1;
     }
 
-    // 解析地址
-    df1_address_t addr;
-    if (df1_address_parse(address, &addr) != 0)
+    *actual_size = enc->pos;
+    return 0;
+}
+
+// 构建带类型逻辑地址的命令帧（读/写共用）
+static int build_typed_command(const df1_config_t* config, uint8_t function, const df1_address_t* addr,
+                               uint16_t length, const uint8_t* data, size_t data_length, uint8_t* buffer,
+                               size_t buffer_size, size_t* actual_size)
+{
+    // 长度字段只有一个字节，更长的传输须由调用者分段
+    if (length > 0xFF)
     {
         return -1;
     }
 
-    // 构建命令内容
-    uint8_t cmd_buffer[256];
-    size_t cmd_pos = 0;
+    frame_encoder_t enc;
+    encoder_begin(&enc, config, buffer, buffer_size);
 
     // 目标节点和源节点
-    cmd_buffer[cmd_pos++] = config->dst_node;
-    cmd_buffer[cmd_pos++] = config->src_node;
+    encoder_put(&enc, config->dst_node);
+    encoder_put(&enc, config->src_node);
 
     // 命令头
-    cmd_buffer[cmd_pos++] = 0x0F; // Command
-    cmd_buffer[cmd_pos++] = 0x00; // Status
+    encoder_put(&enc, 0x0F); // Command
+    encoder_put(&enc, 0x00); // Status
 
     // 事务ID
-    cmd_buffer[cmd_pos++] = (uint8_t)(config->transaction_id & 0xFF);
-    cmd_buffer[cmd_pos++] = (uint8_t)(config->transaction_id >> 8);
+    encoder_put(&enc, (uint8_t)(config->transaction_id & 0xFF));
+    encoder_put(&enc, (uint8_t)(config->transaction_id >> 8));
 
-    // 读命令
-    cmd_buffer[cmd_pos++] = DF1_CMD_READ;
+    // 功能码
+    encoder_put(&enc, function);
 
     // 数据长度
-    cmd_buffer[cmd_pos++] = (uint8_t)(length & 0xFF);
+    encoder_put(&enc, (uint8_t)length);
 
     // 文件号
-    cmd_pos += add_length_to_buffer(&cmd_buffer[cmd_pos], addr.db_block);
+    encoder_put_length(&enc, addr->db_block);
 
     // 数据类型
-    cmd_buffer[cmd_pos++] = (uint8_t)addr.data_code;
+    encoder_put(&enc, (uint8_t)addr->data_code);
 
     // 起始地址
-    cmd_pos += add_length_to_buffer(&cmd_buffer[cmd_pos], addr.address_start);
-
-    // 子元素地址（通常为0）
-    cmd_pos += add_length_to_buffer(&cmd_buffer[cmd_pos], 0);
+    encoder_put_length(&enc, addr->address_start);
 
-    // 打包命令
-    size_t packed_pos = 0;
+    // 子元素地址，如 T4:0.ACC 为2，只传输该子元素
+    encoder_put_length(&enc, addr->sub_element);
 
-    // DLE STX
-    buffer[packed_pos++] = 0x10;
-    buffer[packed_pos++] = 0x01;
-
-    // 站号
-    buffer[packed_pos++] = config->station;
-    if (config->station == 0x10)
+    // 写入数据
+    if (data_length > 0)
     {
-        buffer[packed_pos++] = config->station; // DLE转义
+        encoder_put_bytes(&enc, data, data_length);
     }
 
-    // DLE STX
-    buffer[packed_pos++] = 0x10;
-    buffer[packed_pos++] = 0x02;
+    return encoder_finish(&enc, actual_size);
+}
 
-    // 命令数据（需要DLE转义）
-    for (size_t i = 0; i < cmd_pos; i++)
-    {
-        buffer[packed_pos++] = cmd_buffer[i];
-        if (cmd_buffer[i] == 0x10)
-        {
-            buffer[packed_pos++] = 0x10; // DLE转义
-        }
-    }
+void df1_config_init(df1_config_t* config, uint8_t station, uint8_t dst_node, uint8_t src_node)
+{
+    if (!config)
+        return;
 
-    // DLE ETX
-    buffer[packed_pos++] = 0x10;
-    buffer[packed_pos++] = 0x03;
+    config->station = station;
+    config->dst_node = dst_node;
+    config->src_node = src_node;
+    config->check_type = DF1_CHECK_CRC16;
+    config->transaction_id = 0;
+    config->duplex = DF1_HALF_DUPLEX;
+}
 
-    // 计算校验
-    if (config->check_type == DF1_CHECK_BCC)
+int df1_build_read_command(const df1_config_t* config, const char* address, uint16_t length, uint8_t* buffer,
+                           size_t buffer_size, size_t* actual_size)
+{
+    if (!config || !address || !buffer || !actual_size)
     {
-        uint8_t bcc = calculate_bcc(config->station, cmd_buffer, cmd_pos);
-        buffer[packed_pos++] = bcc;
+        return -1;
     }
-    else
-    {
-        // CRC16校验
-        uint8_t crc_data[256];
-        size_t crc_pos = 0;
-        crc_data[crc_pos++] = config->station;
-        crc_data[crc_pos++] = 0x02;
-        memcpy(&crc_data[crc_pos], cmd_buffer, cmd_pos);
-        crc_pos += cmd_pos;
-        crc_data[crc_pos++] = 0x03;
 
-        uint16_t crc = calculate_crc16(crc_data, crc_pos);
-        buffer[packed_pos++] = (uint8_t)(crc >> 8);
-        buffer[packed_pos++] = (uint8_t)(crc & 0xFF);
+    // 解析地址
+    df1_address_t addr;
+    if (df1_address_parse(address, &addr) != 0)
+    {
+        return -1;
     }
 
-    *actual_size = packed_pos;
-    return (packed_pos <= buffer_size) ? 0 : -1;
+    return build_typed_command(config, DF1_CMD_READ, &addr, length, NULL, 0, buffer, buffer_size, actual_size);
 }
 
 int df1_build_write_command(const df1_config_t* config, const char* address, const uint8_t* data, uint16_t data_length,
@@ -199,99 +282,328 @@ int df1_build_write_command(const df1_config_t* config, const char* address, con
         return -1;
     }
 
-    // 构建命令内容
-    uint8_t cmd_buffer[512];
-    size_t cmd_pos = 0;
+    return build_typed_command(config, DF1_CMD_WRITE, &addr, data_length, data, data_length, buffer, buffer_size,
+                               actual_size);
+}
 
-    // 目标节点和源节点
-    cmd_buffer[cmd_pos++] = config->dst_node;
-    cmd_buffer[cmd_pos++] = config->src_node;
+int df1_build_read_command_addr(const df1_config_t* config, const df1_address_t* addr, uint16_t length,
+                                uint8_t* buffer, size_t buffer_size, size_t* actual_size)
+{
+    if (!config || !addr || !buffer || !actual_size)
+    {
+        return -1;
+    }
 
-    // 命令头
-    cmd_buffer[cmd_pos++] = 0x0F; // Command
-    cmd_buffer[cmd_pos++] = 0x00; // Status
+    return build_typed_command(config, DF1_CMD_READ, addr, length, NULL, 0, buffer, buffer_size, actual_size);
+}
 
-    // 事务ID
-    cmd_buffer[cmd_pos++] = (uint8_t)(config->transaction_id & 0xFF);
-    cmd_buffer[cmd_pos++] = (uint8_t)(config->transaction_id >> 8);
+int df1_build_write_command_addr(const df1_config_t* config, const df1_address_t* addr, const uint8_t* data,
+                                 uint16_t data_length, uint8_t* buffer, size_t buffer_size, size_t* actual_size)
+{
+    if (!config || !addr || !data || !buffer || !actual_size)
+    {
+        return -1;
+    }
 
-    // 写命令
-    cmd_buffer[cmd_pos++] = DF1_CMD_WRITE;
+    return build_typed_command(config, DF1_CMD_WRITE, addr, data_length, data, data_length, buffer, buffer_size,
+                               actual_size);
+}
 
-    // 数据长度
-    cmd_buffer[cmd_pos++] = (uint8_t)(data_length & 0xFF);
+int df1_build_mask_write_command_addr(const df1_config_t* config, const df1_address_t* addr, uint16_t mask,
+                                      uint16_t value, uint8_t* buffer, size_t buffer_size, size_t* actual_size)
+{
+    if (!config || !addr || !buffer || !actual_size)
+    {
+        return -1;
+    }
 
-    // 文件号
-    cmd_pos += add_length_to_buffer(&cmd_buffer[cmd_pos], addr.db_block);
+    // 长度字段为一个字，其后依次为掩码与数据（小端序）
+    const uint8_t data[4] = {(uint8_t)(mask & 0xFF), (uint8_t)(mask >> 8), (uint8_t)(value & 0xFF),
+                             (uint8_t)(value >> 8)};
+    return build_typed_command(config, DF1_CMD_MASK_WRITE, addr, 2, data, sizeof(data), buffer, buffer_size,
+                               actual_size);
+}
 
-    // 数据类型
-    cmd_buffer[cmd_pos++] = (uint8_t)addr.data_code;
+int df1_build_mask_write_command(const df1_config_t* config, const char* address, uint16_t mask, uint16_t value,
+                                 uint8_t* buffer, size_t buffer_size, size_t* actual_size)
+{
+    if (!config || !address || !buffer || !actual_size)
+    {
+        return -1;
+    }
 
-    // 起始地址
-    cmd_pos += add_length_to_buffer(&cmd_buffer[cmd_pos], addr.address_start);
+    df1_address_t addr;
+    if (df1_address_parse(address, &addr) != 0)
+    {
+        return -1;
+    }
 
-    // 子元素地址（通常为0）
-    cmd_pos += add_length_to_buffer(&cmd_buffer[cmd_pos], 0);
+    return df1_build_mask_write_command_addr(config, &addr, mask, value, buffer, buffer_size, actual_size);
+}
 
-    // 写入数据
-    memcpy(&cmd_buffer[cmd_pos], data, data_length);
-    cmd_pos += data_length;
+int df1_build_frame(const df1_config_t* config, const uint8_t* pdu, size_t pdu_length, uint8_t* buffer,
+                    size_t buffer_size, size_t* actual_size)
+{
+    if (!config || (!pdu && pdu_length > 0) || !buffer || !actual_size)
+    {
+        return -1;
+    }
 
-    // 打包命令（类似读命令的打包过程）
-    size_t packed_pos = 0;
+    frame_encoder_t enc;
+    encoder_begin(&enc, config, buffer, buffer_size);
+    encoder_put_bytes(&enc, pdu, pdu_length);
+    return encoder_finish(&enc, actual_size);
+}
 
-    // DLE STX
-    buffer[packed_pos++] = 0x10;
-    buffer[packed_pos++] = 0x01;
+// 由事务ID为0的帧求出模板的其余字段：事务ID的位置、基准校验与CRC推移矩阵
+static int template_finish(df1_frame_template_t* tmpl, const df1_config_t* config)
+{
+    const uint8_t* frame = tmpl->frame;
+    size_t check_size = config->check_type == DF1_CHECK_BCC ? 1 : 2;
+    size_t pos = 2;
+    if (config->duplex != DF1_FULL_DUPLEX)
+    {
+        pos = config->station == DF1_DLE ? 6 : 5; // DLE SOH STN [DLE] DLE STX
+    }
 
-    // 站号
-    buffer[packed_pos++] = config->station;
-    if (config->station == 0x10)
+    // 去除转义遍历应用层数据，直到 DLE ETX
+    size_t index = 0;
+    size_t tns_offset = 0;
+    while (pos + 1 < tmpl->size && !(frame[pos] == DF1_DLE && frame[pos + 1] != DF1_DLE))
     {
-        buffer[packed_pos++] = config->station;
+        if (index == 4)
+        {
+            tns_offset = pos;
+        }
+        pos += frame[pos] == DF1_DLE ? 2 : 1;
+        index++;
+    }
+    if (index < 6 || pos + 2 + check_size != tmpl->size)
+    {
+        return -1;
     }
 
-    // DLE STX
-    buffer[packed_pos++] = 0x10;
-    buffer[packed_pos++] = 0x02;
+    tmpl->tns_offset = tns_offset;
+    tmpl->station = config->station;
+    tmpl->dst_node = config->dst_node;
+    tmpl->src_node = config->src_node;
+    tmpl->check_type = config->check_type;
+    tmpl->duplex = config->duplex;
+    tmpl->sum = (uint8_t)(0 - frame[tmpl->size - 1]);
+    tmpl->crc = (uint16_t)((frame[tmpl->size - 2] << 8) | frame[tmpl->size - 1]);
 
-    // 命令数据（需要DLE转义）
-    for (size_t i = 0; i < cmd_pos; i++)
+    // 事务ID之后参与CRC的字节：其余应用层数据与ETX
+    size_t trailing = index - 6 + 1;
+    uint16_t columns[16];
+    for (int bit = 0; bit < 16; bit++)
     {
-        buffer[packed_pos++] = cmd_buffer[i];
-        if (cmd_buffer[i] == 0x10)
+        uint16_t crc = (uint16_t)(1u << bit);
+        for (size_t i = 0; i < trailing; i++)
         {
-            buffer[packed_pos++] = 0x10;
+            crc = crc16_update(crc, 0x00);
         }
+        columns[bit] = crc;
+    }
+
+    // 按4位一组展开为查表：每组16种取值对应的列异或
+    for (int nibble = 0; nibble < 4; nibble++)
+    {
+        for (int value = 0; value < 16; value++)
+        {
+            uint16_t crc = 0;
+            for (int bit = 0; bit < 4; bit++)
+            {
+                if (value & (1 << bit))
+                {
+                    crc ^= columns[nibble * 4 + bit];
+                }
+            }
+            tmpl->crc_shift[nibble][value] = crc;
+        }
+    }
+    return 0;
+}
+
+int df1_frame_template_init(df1_frame_template_t* tmpl, const df1_config_t* config, const uint8_t* pdu,
+                            size_t pdu_length)
+{
+    if (!tmpl || !config || !pdu || pdu_length < 6 || pdu_length > DF1_MAX_PDU_SIZE)
+    {
+        return -1;
     }
 
-    // DLE ETX
-    buffer[packed_pos++] = 0x10;
-    buffer[packed_pos++] = 0x03;
+    uint8_t zeroed[DF1_MAX_PDU_SIZE];
+    memcpy(zeroed, pdu, pdu_length);
+    zeroed[4] = 0x00;
+    zeroed[5] = 0x00;
 
-    // 计算校验
-    if (config->check_type == DF1_CHECK_BCC)
+    tmpl->size = 0;
+    size_t size = 0;
+    if (df1_build_frame(config, zeroed, pdu_length, tmpl->frame, sizeof(tmpl->frame), &size) != 0)
     {
-        uint8_t bcc = calculate_bcc(config->station, cmd_buffer, cmd_pos);
-        buffer[packed_pos++] = bcc;
+        return -1;
+    }
+    tmpl->size = size;
+    if (template_finish(tmpl, config) != 0)
+    {
+        tmpl->size = 0;
+        return -1;
+    }
+    return 0;
+}
+
+int df1_frame_template_read(df1_frame_template_t* tmpl, const df1_config_t* config, const df1_address_t* addr,
+                            uint16_t length)
+{
+    if (!tmpl || !config || !addr)
+    {
+        return -1;
+    }
+
+    df1_config_t zeroed = *config;
+    zeroed.transaction_id = 0;
+
+    tmpl->size = 0;
+    size_t size = 0;
+    if (build_typed_command(&zeroed, DF1_CMD_READ, addr, length, NULL, 0, tmpl->frame, sizeof(tmpl->frame), &size)
+        != 0)
+    {
+        return -1;
+    }
+    tmpl->size = size;
+    if (template_finish(tmpl, config) != 0)
+    {
+        tmpl->size = 0;
+        return -1;
+    }
+    return 0;
+}
+
+bool df1_frame_template_matches(const df1_frame_template_t* tmpl, const df1_config_t* config)
+{
+    if (!tmpl || !config || tmpl->size == 0)
+    {
+        return false;
+    }
+
+    return tmpl->dst_node == config->dst_node && tmpl->src_node == config->src_node
+           && tmpl->check_type == config->check_type && tmpl->duplex == config->duplex
+           && (config->duplex == DF1_FULL_DUPLEX || tmpl->station == config->station);
+}
+
+int df1_frame_template_emit(const df1_frame_template_t* tmpl, uint16_t tns, uint8_t* buffer, size_t buffer_size,
+                            size_t* actual_size)
+{
+    if (!tmpl || tmpl->size == 0 || !buffer || !actual_size)
+    {
+        return -1;
+    }
+
+    uint8_t lo = (uint8_t)(tns & 0xFF);
+    uint8_t hi = (uint8_t)(tns >> 8);
+    size_t size = tmpl->size + (lo == DF1_DLE) + (hi == DF1_DLE);
+    if (size > buffer_size)
+    {
+        return -1;
+    }
+
+    // 事务ID之前与之后的字节原样复制，事务ID需要时转义
+    size_t check_size = tmpl->check_type == DF1_CHECK_BCC ? 1 : 2;
+    size_t suffix = tmpl->tns_offset + 2;
+    memcpy(buffer, tmpl->frame, tmpl->tns_offset);
+    size_t pos = tmpl->tns_offset;
+    buffer[pos++] = lo;
+    if (lo == DF1_DLE)
+    {
+        buffer[pos++] = DF1_DLE;
+    }
+    buffer[pos++] = hi;
+    if (hi == DF1_DLE)
+    {
+        buffer[pos++] = DF1_DLE;
+    }
+    memcpy(buffer + pos, tmpl->frame + suffix, tmpl->size - check_size - suffix);
+    pos += tmpl->size - check_size - suffix;
+
+    if (tmpl->check_type == DF1_CHECK_BCC)
+    {
+        buffer[pos++] = (uint8_t)(0 - (uint8_t)(tmpl->sum + lo + hi));
     }
     else
     {
-        uint8_t crc_data[512];
-        size_t crc_pos = 0;
-        crc_data[crc_pos++] = config->station;
-        crc_data[crc_pos++] = 0x02;
-        memcpy(&crc_data[crc_pos], cmd_buffer, cmd_pos);
-        crc_pos += cmd_pos;
-        crc_data[crc_pos++] = 0x03;
+        // CRC(模板) 异或 CRC(只有事务ID非0的同长数据)
+        uint16_t state = crc16_update(crc16_update(0x0000, lo), hi);
+        uint16_t crc = tmpl->crc ^ tmpl->crc_shift[0][state & 0x0F] ^ tmpl->crc_shift[1][(state >> 4) & 0x0F]
+                       ^ tmpl->crc_shift[2][(state >> 8) & 0x0F] ^ tmpl->crc_shift[3][state >> 12];
+        buffer[pos++] = (uint8_t)(crc >> 8);
+        buffer[pos++] = (uint8_t)(crc & 0xFF);
+    }
+
+    *actual_size = pos;
+    return 0;
+}
+
+int df1_build_poll(uint8_t station, uint8_t* buffer, size_t buffer_size, size_t* actual_size)
+{
+    if (!buffer || !actual_size)
+    {
+        return -1;
+    }
+
+    frame_encoder_t enc;
+    memset(&enc, 0, sizeof(enc));
+    enc.buffer = buffer;
+    enc.size = buffer_size;
 
-        uint16_t crc = calculate_crc16(crc_data, crc_pos);
-        buffer[packed_pos++] = (uint8_t)(crc >> 8);
-        buffer[packed_pos++] = (uint8_t)(crc & 0xFF);
+    encoder_put_raw(&enc, DF1_DLE);
+    encoder_put_raw(&enc, DF1_ENQ);
+    encoder_put(&enc, station);
+    encoder_put_raw(&enc, (uint8_t)(~enc.sum + 1));
+
+    if (enc.overflow)
+    {
+        return -1;
     }
 
-    *actual_size = packed_pos;
-    return (packed_pos <= buffer_size) ? 0 : -1;
+    *actual_size = enc.pos;
+    return 0;
+}
+
+uint16_t df1_crc16(uint16_t crc, const uint8_t* data, size_t length)
+{
+    return df1_crc16_compute(DF1_CRC16_AUTO, crc, data, length);
+}
+
+uint8_t df1_bcc(const uint8_t* data, size_t length)
+{
+    uint8_t sum = 0;
+    if (!data)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        sum = (uint8_t)(sum + data[i]);
+    }
+    return (uint8_t)(~sum + 1);
+}
+
+// 内联后的整段复制会拖慢 df1_parse_response 中短响应的逐字节路径
+#if defined(__GNUC__)
+#define DF1_NOINLINE __attribute__((noinline))
+#else
+#define DF1_NOINLINE
+#endif
+
+// 复制到下一个DLE之前的一段数据，超出输出缓冲区的部分丢弃；返回这一段的长度
+static DF1_NOINLINE size_t response_copy_run(const uint8_t* response, size_t length, uint8_t* data,
+                                             size_t data_size, size_t* data_pos)
+{
+    size_t run = df1_dle_find(response, length);
+    size_t copy = run < data_size - *data_pos ? run : data_size - *data_pos;
+    memcpy(data + *data_pos, response, copy);
+    *data_pos += copy;
+    return run;
 }
 
 int df1_parse_response(const uint8_t* response, size_t response_size, uint8_t* data, size_t data_size,
@@ -303,77 +615,450 @@ int df1_parse_response(const uint8_t* response, size_t response_size, uint8_t* d
     }
 
     // 查找DLE STX (0x10 0x02)
-    int data_start = -1;
-    for (size_t i = 0; i < response_size - 1; i++)
+    size_t pos = 0;
+    while (pos + 1 < response_size && !(response[pos] == 0x10 && response[pos + 1] == 0x02))
     {
-        if (response[i] == 0x10 && response[i + 1] == 0x02)
-        {
-            data_start = i + 2;
-            break;
-        }
+        pos++;
     }
-
-    if (data_start < 0 || data_start >= (int)response_size - 6)
+    if (pos + 1 >= response_size)
     {
         return -1; // 没有找到有效的数据开始位置
     }
+    pos += 2;
 
-    // 提取数据部分（去除DLE转义）
-    uint8_t temp_buffer[512];
-    size_t temp_pos = 0;
+    // 边去除DLE转义边提取：前6字节为 DST SRC CMD STS TNS，之后为数据
+    uint8_t header[6];
+    size_t pdu_pos = 0;
+    size_t data_pos = 0;
+    bool terminated = false;
 
-    for (size_t i = data_start; i < response_size - 1; i++)
+    while (pos < response_size)
     {
-        if (response[i] == 0x10)
+        uint8_t value = response[pos++];
+        if (value == 0x10)
         {
-            if (response[i + 1] == 0x10)
+            if (pos >= response_size)
             {
-                // DLE转义
-                temp_buffer[temp_pos++] = 0x10;
-                i++; // 跳过下一个字节
+                break;
             }
-            else if (response[i + 1] == 0x03)
+            uint8_t next = response[pos++];
+            if (next == 0x03)
             {
                 // DLE ETX，数据结束
+                terminated = true;
                 break;
             }
+            if (next != 0x10)
+            {
+                return -1; // 非法的DLE序列
+            }
         }
-        else
+
+        if (pdu_pos < sizeof(header))
+        {
+            header[pdu_pos] = value;
+        }
+        else if (data_pos < data_size)
+        {
+            data[data_pos++] = value;
+        }
+        pdu_pos++;
+
+        // 帧头结束或数据中的DLE之后，剩余较长时整段复制到下一个DLE
+        if ((pdu_pos == sizeof(header) || (value == 0x10 && pdu_pos > sizeof(header))) && response_size - pos >= 16)
         {
-            temp_buffer[temp_pos++] = response[i];
+            size_t run = response_copy_run(response + pos, response_size - pos, data, data_size, &data_pos);
+            pdu_pos += run;
+            pos += run;
         }
     }
 
-    if (temp_pos < 6)
+    if (!terminated || pdu_pos < sizeof(header))
     {
-        return -1; // 数据太短
+        return -1; // 帧不完整或数据太短
     }
 
     // 检查状态码
-    if (temp_buffer[3] == 0xF0)
+    if (header[3] == 0xF0)
     {
         return -1; // 扩展错误状态
     }
 
-    if (temp_buffer[3] != 0x00)
+    if (header[3] != 0x00)
     {
         return -1; // 错误状态
     }
 
-    // 提取实际数据
-    if (temp_pos > 6)
+    *actual_data_size = data_pos;
+    return 0;
+}
+
+// 流式解码器状态
+enum {
+    DECODE_IDLE = 0,     // 等待DLE
+    DECODE_DLE,          // 帧外收到DLE
+    DECODE_STATION,      // DLE SOH 之后等待站号
+    DECODE_STATION_DLE,  // 站号为DLE，等待转义字节
+    DECODE_HEADER_DLE,   // 站号之后等待DLE
+    DECODE_HEADER_STX,   // 站号之后等待STX
+    DECODE_DATA,         // 接收应用层数据
+    DECODE_DATA_DLE,     // 应用层数据中收到DLE
+    DECODE_CHECK         // 接收校验字节
+};
+
+void df1_decoder_init(df1_decoder_t* decoder, df1_check_type_t check_type)
+{
+    if (!decoder)
+        return;
+
+    decoder->check_type = check_type;
+    df1_decoder_reset(decoder);
+}
+
+void df1_decoder_reset(df1_decoder_t* decoder)
+{
+    if (!decoder)
+        return;
+
+    decoder->state = DECODE_IDLE;
+    decoder->has_station = false;
+    decoder->pdu_src = NULL;
+    decoder->pdu_length = 0;
+    decoder->in_place = false;
+    decoder->check_pos = 0;
+}
+
+// 开始接收应用层数据。帧头带站号时站号与STX计入校验，与编码器一致；
+// 不带站号时按全双工格式仅对数据与ETX校验
+static void decoder_begin_pdu(df1_decoder_t* decoder, const uint8_t* next)
+{
+    decoder->crc = 0x0000;
+    decoder->sum = 0;
+    if (decoder->has_station)
+    {
+        decoder->crc = crc16_update(decoder->crc, decoder->station);
+        decoder->crc = crc16_update(decoder->crc, 0x02);
+        decoder->sum = decoder->station;
+    }
+
+    decoder->pdu_src = next;
+    decoder->pdu_length = 0;
+    decoder->in_place = true;
+    decoder->check_pos = 0;
+    decoder->state = DECODE_DATA;
+}
+
+// 将仍位于输入缓冲区中的数据复制到内部缓冲区
+static void decoder_materialize(df1_decoder_t* decoder)
+{
+    if (decoder->in_place)
+    {
+        memcpy(decoder->buffer, decoder->pdu_src, decoder->pdu_length);
+        decoder->in_place = false;
+    }
+}
+
+// 追加一个应用层字节，contiguous 表示该字节紧接在已接收数据之后
+static int decoder_append(df1_decoder_t* decoder, uint8_t value, bool contiguous)
+{
+    if (decoder->pdu_length >= DF1_MAX_PDU_SIZE)
     {
-        size_t actual_len = temp_pos - 6;
-        if (actual_len > data_size)
+        return -1;
+    }
+
+    if (decoder->in_place && !contiguous)
+    {
+        decoder_materialize(decoder);
+    }
+    if (!decoder->in_place)
+    {
+        decoder->buffer[decoder->pdu_length] = value;
+    }
+    decoder->pdu_length++;
+    return 0;
+}
+
+// 追加一段紧接在已接收数据之后、不含DLE的应用层数据，返回接收的字节数（超过上限时少于 length）
+static size_t decoder_append_run(df1_decoder_t* decoder, const uint8_t* data, size_t length)
+{
+    size_t room = DF1_MAX_PDU_SIZE - decoder->pdu_length;
+    if (length > room)
+    {
+        length = room;
+    }
+    if (!decoder->in_place)
+    {
+        memcpy(decoder->buffer + decoder->pdu_length, data, length);
+    }
+    decoder->pdu_length += length;
+    return length;
+}
+
+// 帧接收完整后对整段应用层数据校验，CRC16 使用 df1_crc16 的内核
+static int decoder_finish(df1_decoder_t* decoder, df1_frame_t* frame)
+{
+    const uint8_t* pdu = decoder->in_place ? decoder->pdu_src : decoder->buffer;
+    bool valid;
+    if (decoder->check_type == DF1_CHECK_BCC)
+    {
+        uint8_t sum = decoder->sum;
+        for (size_t i = 0; i < decoder->pdu_length; i++)
         {
-            actual_len = data_size;
+            sum = (uint8_t)(sum + pdu[i]);
         }
-        memcpy(data, &temp_buffer[6], actual_len);
-        *actual_data_size = actual_len;
+        valid = (uint8_t)(sum + decoder->check_bytes[0]) == 0;
     }
     else
     {
-        *actual_data_size = 0;
+        uint16_t crc = df1_crc16_compute(DF1_CRC16_AUTO, decoder->crc, pdu, decoder->pdu_length);
+        crc = crc16_update(crc, 0x03);
+        valid = decoder->check_bytes[0] == (uint8_t)(crc >> 8) && decoder->check_bytes[1] == (uint8_t)(crc & 0xFF);
+    }
+
+    decoder->state = DECODE_IDLE;
+    if (!valid)
+    {
+        return DF1_DECODE_BAD_CHECKSUM;
+    }
+    if (decoder->pdu_length < 6)
+    {
+        return DF1_DECODE_MALFORMED;
+    }
+
+    frame->pdu = pdu;
+    frame->pdu_length = decoder->pdu_length;
+    frame->data = pdu + 6;
+    frame->data_length = decoder->pdu_length - 6;
+    frame->station = decoder->station;
+    frame->has_station = decoder->has_station;
+    frame->dst = pdu[0];
+    frame->src = pdu[1];
+    frame->cmd = pdu[2];
+    frame->sts = pdu[3];
+    frame->tns = (uint16_t)(pdu[4] | (pdu[5] << 8));
+    frame->ext_sts = (frame->sts == 0xF0 && frame->data_length > 0) ? frame->data[0] : 0;
+    frame->zero_copy = decoder->in_place;
+    return DF1_DECODE_FRAME;
+}
+
+// 帧外 DLE 之后的链路控制字符
+static int control_result(uint8_t value)
+{
+    switch (value)
+    {
+    case DF1_ACK:
+        return DF1_DECODE_ACK;
+    case DF1_NAK:
+        return DF1_DECODE_NAK;
+    case DF1_ENQ:
+        return DF1_DECODE_ENQ;
+    case DF1_EOT:
+        return DF1_DECODE_EOT;
+    default:
+        return DF1_DECODE_NEED_MORE;
+    }
+}
+
+int df1_decoder_push(df1_decoder_t* decoder, const uint8_t* data, size_t length, size_t* consumed, df1_frame_t* frame)
+{
+    if (!decoder || (!data && length > 0) || !consumed || !frame)
+    {
+        return DF1_DECODE_MALFORMED;
+    }
+
+    // 上一次输入中的零拷贝视图已经失效
+    decoder->in_place = false;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        uint8_t value = data[i];
+
+        switch (decoder->state)
+        {
+        case DECODE_IDLE:
+            if (value == 0x10)
+            {
+                decoder->state = DECODE_DLE;
+            }
+            break;
+
+        case DECODE_DLE:
+            if (value == 0x01)
+            {
+                decoder->state = DECODE_STATION;
+            }
+            else if (value == 0x02)
+            {
+                decoder->has_station = false;
+                decoder_begin_pdu(decoder, &data[i + 1]);
+            }
+            else if (value != 0x10)
+            {
+                decoder->state = DECODE_IDLE;
+                int control = control_result(value);
+                if (control != DF1_DECODE_NEED_MORE)
+                {
+                    *consumed = i + 1;
+                    return control;
+                }
+            }
+            break;
+
+        case DECODE_STATION:
+            decoder->station = value;
+            decoder->has_station = true;
+            decoder->state = (value == 0x10) ? DECODE_STATION_DLE : DECODE_HEADER_DLE;
+            break;
+
+        case DECODE_STATION_DLE:
+            decoder->state = (value == 0x10) ? DECODE_HEADER_DLE : DECODE_IDLE;
+            break;
+
+        case DECODE_HEADER_DLE:
+            decoder->state = (value == 0x10) ? DECODE_HEADER_STX : DECODE_IDLE;
+            break;
+
+        case DECODE_HEADER_STX:
+            if (value == 0x02)
+            {
+                decoder_begin_pdu(decoder, &data[i + 1]);
+            }
+            else
+            {
+                decoder->state = DECODE_IDLE;
+            }
+            break;
+
+        case DECODE_DATA:
+            if (value == 0x10)
+            {
+                decoder->state = DECODE_DATA_DLE;
+            }
+            else
+            {
+                // 到下一个DLE之前的数据整段接收
+                size_t run = 1 + df1_dle_find(&data[i + 1], length - i - 1);
+                size_t accepted = decoder_append_run(decoder, &data[i], run);
+                if (accepted < run)
+                {
+                    decoder->state = DECODE_IDLE;
+                    *consumed = i + accepted + 1;
+                    return DF1_DECODE_OVERFLOW;
+                }
+                i += run - 1;
+            }
+            break;
+
+        case DECODE_DATA_DLE:
+            if (value == 0x10)
+            {
+                // DLE转义：两个输入字节对应一个数据字节，零拷贝视图不再连续
+                if (decoder_append(decoder, value, false) != 0)
+                {
+                    decoder->state = DECODE_IDLE;
+                    *consumed = i + 1;
+                    return DF1_DECODE_OVERFLOW;
+                }
+                decoder->state = DECODE_DATA;
+            }
+            else if (value == 0x03)
+            {
+                decoder->state = DECODE_CHECK;
+            }
+            else if (value == 0x02)
+            {
+                // 帧中出现新的 DLE STX，按新帧重新同步
+                decoder->has_station = false;
+                decoder_begin_pdu(decoder, &data[i + 1]);
+            }
+            else if (value == DF1_ACK || value == DF1_NAK)
+            {
+                // 嵌入在帧中的链路应答，帧继续接收，之后的数据不再与之前连续
+                decoder_materialize(decoder);
+                decoder->state = DECODE_DATA;
+                *consumed = i + 1;
+                return control_result(value);
+            }
+            else
+            {
+                decoder->state = DECODE_IDLE;
+                *consumed = i + 1;
+                return DF1_DECODE_MALFORMED;
+            }
+            break;
+
+        case DECODE_CHECK:
+            decoder->check_bytes[decoder->check_pos++] = value;
+            if (decoder->check_pos == (decoder->check_type == DF1_CHECK_BCC ? 1u : 2u))
+            {
+                *consumed = i + 1;
+                return decoder_finish(decoder, frame);
+            }
+            break;
+
+        default:
+            decoder->state = DECODE_IDLE;
+            break;
+        }
+    }
+
+    // 帧跨越多次输入时，将已接收的数据保存到内部缓冲区
+    if (decoder->state == DECODE_DATA || decoder->state == DECODE_DATA_DLE || decoder->state == DECODE_CHECK)
+    {
+        decoder_materialize(decoder);
+    }
+
+    *consumed = length;
+    return DF1_DECODE_NEED_MORE;
+}
+
+size_t df1_decoder_min_remaining(const df1_decoder_t* decoder)
+{
+    if (!decoder)
+    {
+        return 1;
+    }
+
+    size_t check_size = (decoder->check_type == DF1_CHECK_BCC) ? 1 : 2;
+    size_t pdu_needed = (decoder->pdu_length < 6) ? 6 - decoder->pdu_length : 0;
+
+    switch (decoder->state)
+    {
+    case DECODE_IDLE:
+        return 2 + 6 + 2 + check_size; // DLE STX + PDU + DLE ETX + 校验
+    case DECODE_DLE:
+        return 1 + 6 + 2 + check_size;
+    case DECODE_STATION:
+    case DECODE_STATION_DLE:
+    case DECODE_HEADER_DLE:
+    case DECODE_HEADER_STX:
+        return 1 + 6 + 2 + check_size;
+    case DECODE_DATA:
+        return pdu_needed + 2 + check_size;
+    case DECODE_DATA_DLE:
+        return pdu_needed + 1 + check_size;
+    case DECODE_CHECK:
+        return check_size - decoder->check_pos;
+    default:
+        return 1;
+    }
+}
+
+int df1_frame_check(const df1_frame_t* frame, uint16_t expected_tns)
+{
+    if (!frame)
+    {
+        return -1;
+    }
+
+    if (frame->tns != expected_tns)
+    {
+        return -1; // 事务ID不匹配
+    }
+
+    if (frame->sts != 0x00)
+    {
+        return -1; // 错误状态（含扩展错误状态）
     }
 
     return 0;
@@ -511,3 +1196,92 @@ const char* df1_get_ext_error_description(uint8_t ext_error_code)
         return "Unknown extended error";
     }
 }
+
+#if !DF1_HOST_LITTLE_ENDIAN
+// 逐元素交换字节序，经 memcpy 读写避免对齐与别名问题
+static void swap16(void* dst, const void* src, size_t count)
+{
+    const uint8_t* in = (const uint8_t*)src;
+    uint8_t* out = (uint8_t*)dst;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint16_t value;
+        memcpy(&value, in + 2 * i, 2);
+        value = __builtin_bswap16(value);
+        memcpy(out + 2 * i, &value, 2);
+    }
+}
+
+static void swap32(void* dst, const void* src, size_t count)
+{
+    const uint8_t* in = (const uint8_t*)src;
+    uint8_t* out = (uint8_t*)dst;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t value;
+        memcpy(&value, in + 4 * i, 4);
+        value = __builtin_bswap32(value);
+        memcpy(out + 4 * i, &value, 4);
+    }
+}
+#endif
+
+void df1_le16_to_host(void* dst, const uint8_t* src, size_t count)
+{
+    if (!dst || !src)
+        return;
+
+#if DF1_HOST_LITTLE_ENDIAN
+    if (dst != src)
+    {
+        memmove(dst, src, 2 * count);
+    }
+#else
+    swap16(dst, src, count);
+#endif
+}
+
+void df1_le32_to_host(void* dst, const uint8_t* src, size_t count)
+{
+    if (!dst || !src)
+        return;
+
+#if DF1_HOST_LITTLE_ENDIAN
+    if (dst != src)
+    {
+        memmove(dst, src, 4 * count);
+    }
+#else
+    swap32(dst, src, count);
+#endif
+}
+
+void df1_host_to_le16(uint8_t* dst, const void* src, size_t count)
+{
+    if (!dst || !src)
+        return;
+
+#if DF1_HOST_LITTLE_ENDIAN
+    if ((const void*)dst != src)
+    {
+        memmove(dst, src, 2 * count);
+    }
+#else
+    swap16(dst, src, count);
+#endif
+}
+
+void df1_host_to_le32(uint8_t* dst, const void* src, size_t count)
+{
+    if (!dst || !src)
+        return;
+
+#if DF1_HOST_LITTLE_ENDIAN
+    if ((const void*)dst != src)
+    {
+        memmove(dst, src, 4 * count);
+    }
+#else
+    swap32(dst, src, count);
+#endif
+}
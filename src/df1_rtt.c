@@ -0,0 +1,158 @@
+#include "df1_rtt.h"
+#include <string.h>
+
+void df1_rtt_config_default(df1_rtt_config_t* config, int timeout_ms)
+{
+    if (!config)
+        return;
+
+    config->enabled = true;
+    config->min_rto_ms = 20;
+    config->max_rto_ms = timeout_ms > config->min_rto_ms ? timeout_ms : config->min_rto_ms;
+    config->max_retries = 2;
+    config->offline_after = 3;
+    config->probe_interval_ms = config->max_rto_ms;
+    config->char_time_us = 0;
+}
+
+int df1_rtt_char_time_us(int baud_rate, int data_bits, int parity, int stop_bits)
+{
+    if (baud_rate <= 0)
+    {
+        return 0;
+    }
+
+    int bits = 1 + data_bits + (parity ? 1 : 0) + stop_bits;
+    return (bits * 1000000 + baud_rate - 1) / baud_rate;
+}
+
+void df1_rtt_init(df1_rtt_t* rtt, const df1_rtt_config_t* config)
+{
+    if (!rtt)
+        return;
+
+    memset(rtt, 0, sizeof(df1_rtt_t));
+    if (config)
+    {
+        rtt->config = *config;
+    }
+    else
+    {
+        df1_rtt_config_default(&rtt->config, 1000);
+    }
+
+    if (rtt->config.min_rto_ms < 1)
+    {
+        rtt->config.min_rto_ms = 1;
+    }
+    if (rtt->config.max_rto_ms < rtt->config.min_rto_ms)
+    {
+        rtt->config.max_rto_ms = rtt->config.min_rto_ms;
+    }
+    if (rtt->config.max_retries < 0)
+    {
+        rtt->config.max_retries = 0;
+    }
+    rtt->rto_ms = rtt->config.max_rto_ms;
+}
+
+static int64_t wire_time_us(const df1_rtt_t* rtt, size_t wire_bytes)
+{
+    return (int64_t)wire_bytes * rtt->config.char_time_us;
+}
+
+void df1_rtt_sample(df1_rtt_t* rtt, int64_t elapsed_us, size_t wire_bytes)
+{
+    if (!rtt || !rtt->config.enabled)
+        return;
+
+    int64_t sample = elapsed_us - wire_time_us(rtt, wire_bytes);
+    if (sample < 0)
+    {
+        sample = 0;
+    }
+
+    if (rtt->samples == 0)
+    {
+        rtt->srtt_us = sample;
+        rtt->rttvar_us = sample / 2;
+    }
+    else
+    {
+        int64_t delta = rtt->srtt_us > sample ? rtt->srtt_us - sample : sample - rtt->srtt_us;
+        rtt->rttvar_us = (3 * rtt->rttvar_us + delta) / 4;
+        rtt->srtt_us = (7 * rtt->srtt_us + sample) / 8;
+    }
+    rtt->samples++;
+
+    // RTO = SRTT + max(G, 4 * RTTVAR)，时钟粒度 G 取1毫秒
+    int64_t variance = 4 * rtt->rttvar_us > 1000 ? 4 * rtt->rttvar_us : 1000;
+    int64_t rto_ms = (rtt->srtt_us + variance + 999) / 1000;
+    if (rto_ms < rtt->config.min_rto_ms)
+    {
+        rto_ms = rtt->config.min_rto_ms;
+    }
+    if (rto_ms > rtt->config.max_rto_ms)
+    {
+        rto_ms = rtt->config.max_rto_ms;
+    }
+    rtt->rto_ms = (int)rto_ms;
+}
+
+int df1_rtt_timeout(const df1_rtt_t* rtt, int attempt, size_t wire_bytes)
+{
+    if (!rtt)
+    {
+        return 0;
+    }
+
+    int timeout = rtt->config.enabled ? rtt->rto_ms : rtt->config.max_rto_ms;
+    for (int i = 0; i < attempt && timeout < rtt->config.max_rto_ms; i++)
+    {
+        timeout *= 2;
+    }
+    if (timeout > rtt->config.max_rto_ms)
+    {
+        timeout = rtt->config.max_rto_ms;
+    }
+    return timeout + (int)((wire_time_us(rtt, wire_bytes) + 999) / 1000);
+}
+
+bool df1_rtt_allow(df1_rtt_t* rtt, long long now_ms)
+{
+    if (!rtt || !rtt->config.enabled || !rtt->offline)
+    {
+        return true;
+    }
+
+    if (now_ms >= rtt->probe_ms)
+    {
+        rtt->probe_ms = now_ms + rtt->config.probe_interval_ms;
+        return true;
+    }
+    rtt->fast_fails++;
+    return false;
+}
+
+void df1_rtt_success(df1_rtt_t* rtt)
+{
+    if (!rtt)
+        return;
+
+    rtt->failures = 0;
+    rtt->offline = false;
+}
+
+void df1_rtt_failure(df1_rtt_t* rtt, long long now_ms)
+{
+    if (!rtt || !rtt->config.enabled)
+        return;
+
+    rtt->failures++;
+    if (rtt->config.offline_after > 0 && rtt->failures >= rtt->config.offline_after)
+    {
+        // 判定离线或探测失败：下一次探测在一个间隔之后
+        rtt->offline = true;
+        rtt->probe_ms = now_ms + rtt->config.probe_interval_ms;
+    }
+}
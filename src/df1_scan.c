@@ -0,0 +1,447 @@
+#define _DEFAULT_SOURCE
+#include "df1_scan.h"
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <time.h>
+
+// 一个已注册的标签
+typedef struct {
+    const df1_address_t* addr;   // 已解析地址（连接标签表中）
+    size_t size;                 // 读取字节数
+    uint8_t* data;               // 最近一次读取的数据
+    bool valid;                  // data 是否为成功读取的数据
+    df1_scan_callback_t callback; // 读取完成回调
+    void* user_data;             // 回调用户数据
+} scan_tag_t;
+
+// 一个扫描类
+typedef struct {
+    int period_ms;               // 扫描周期
+    int* tags;                   // 标签编号
+    df1_plan_item_t* items;      // 与 tags 一一对应的读取合并输入
+    size_t tag_count;
+    size_t tag_capacity;
+    df1_plan_t plan;             // 读取合并计划
+    bool dirty;                  // 标签有变化，下一个周期开始前重新规划
+    long long release_ms;        // 当前（或下一次）周期的计划开始时间
+    bool active;                 // 当前周期是否正在执行
+    size_t cursor;               // 当前周期中下一个要执行的块读取
+    df1_scan_stats_t stats;      // 统计
+} scan_class_t;
+
+struct df1_scanner {
+    df1_serial_t* port;          // 连接
+    scan_class_t classes[DF1_SCAN_MAX_CLASSES];
+    size_t class_count;
+    scan_tag_t* tags;
+    size_t tag_count;
+    size_t tag_capacity;
+    df1_plan_config_t plan_config; // 读取合并参数
+    long long start_ms;          // 第一个周期的计划开始时间，0 表示尚未开始
+    bool in_callback;            // 正在执行标签回调，此时注册标签会使遍历中的数组失效
+};
+
+static long long monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+df1_scanner_t* df1_scanner_create(df1_serial_t* port)
+{
+    if (!port)
+    {
+        return NULL;
+    }
+
+    df1_scanner_t* scanner = (df1_scanner_t*)malloc(sizeof(df1_scanner_t));
+    if (!scanner)
+    {
+        return NULL;
+    }
+
+    memset(scanner, 0, sizeof(df1_scanner_t));
+    scanner->port = port;
+    df1_plan_config_default(&scanner->plan_config);
+    return scanner;
+}
+
+void df1_scanner_destroy(df1_scanner_t* scanner)
+{
+    if (!scanner)
+        return;
+
+    for (size_t i = 0; i < scanner->class_count; i++)
+    {
+        free(scanner->classes[i].tags);
+        free(scanner->classes[i].items);
+        df1_plan_free(&scanner->classes[i].plan);
+    }
+    for (size_t i = 0; i < scanner->tag_count; i++)
+    {
+        free(scanner->tags[i].data);
+    }
+    free(scanner->tags);
+    free(scanner);
+}
+
+int df1_scanner_add_class(df1_scanner_t* scanner, int period_ms)
+{
+    if (!scanner || period_ms <= 0 || scanner->class_count >= DF1_SCAN_MAX_CLASSES)
+    {
+        return -1;
+    }
+
+    scan_class_t* scan_class = &scanner->classes[scanner->class_count];
+    memset(scan_class, 0, sizeof(scan_class_t));
+    scan_class->period_ms = period_ms;
+    scan_class->stats.period_ms = period_ms;
+    scan_class->release_ms = scanner->start_ms ? monotonic_ms() : 0; // 运行中添加的扫描类立即释放
+    return (int)scanner->class_count++;
+}
+
+int df1_scanner_add_tag(df1_scanner_t* scanner, int scan_class, const char* address, size_t size,
+                        df1_scan_callback_t callback, void* user_data)
+{
+    if (!scanner || scanner->in_callback || scan_class < 0 || (size_t)scan_class >= scanner->class_count ||
+        !address || size == 0)
+    {
+        return -1;
+    }
+
+    const df1_address_t* addr = df1_serial_tag(scanner->port, address);
+    if (!addr)
+    {
+        return -1;
+    }
+
+    // 单个标签必须能放进一次读取
+    df1_plan_item_t item = {addr, size, NULL, 0};
+    df1_plan_t check;
+    df1_plan_init(&check);
+    int valid = df1_plan_build(&check, &scanner->plan_config, &item, 1);
+    df1_plan_free(&check);
+    if (valid != 0)
+    {
+        return -1;
+    }
+
+    if (scanner->tag_count == scanner->tag_capacity)
+    {
+        size_t capacity = scanner->tag_capacity ? scanner->tag_capacity * 2 : 16;
+        scan_tag_t* tags = (scan_tag_t*)realloc(scanner->tags, capacity * sizeof(scan_tag_t));
+        if (!tags)
+        {
+            return -1;
+        }
+        scanner->tags = tags;
+        scanner->tag_capacity = capacity;
+    }
+
+    scan_class_t* cls = &scanner->classes[scan_class];
+    if (cls->tag_count == cls->tag_capacity)
+    {
+        size_t capacity = cls->tag_capacity ? cls->tag_capacity * 2 : 16;
+        int* tags = (int*)realloc(cls->tags, capacity * sizeof(int));
+        if (!tags)
+        {
+            return -1;
+        }
+        cls->tags = tags;
+        df1_plan_item_t* items = (df1_plan_item_t*)realloc(cls->items, capacity * sizeof(df1_plan_item_t));
+        if (!items)
+        {
+            return -1;
+        }
+        cls->items = items;
+        cls->tag_capacity = capacity;
+    }
+
+    uint8_t* data = (uint8_t*)malloc(size);
+    if (!data)
+    {
+        return -1;
+    }
+
+    int tag = (int)scanner->tag_count++;
+    scan_tag_t* entry = &scanner->tags[tag];
+    entry->addr = addr;
+    entry->size = size;
+    entry->data = data;
+    entry->valid = false;
+    entry->callback = callback;
+    entry->user_data = user_data;
+
+    cls->items[cls->tag_count].addr = addr;
+    cls->items[cls->tag_count].size = size;
+    cls->items[cls->tag_count].data = data;
+    cls->items[cls->tag_count].status = 0;
+    cls->tags[cls->tag_count++] = tag;
+    cls->dirty = true;
+    return tag;
+}
+
+const uint8_t* df1_scanner_value(const df1_scanner_t* scanner, int tag, size_t* size)
+{
+    if (!scanner || tag < 0 || (size_t)tag >= scanner->tag_count || !scanner->tags[tag].valid)
+    {
+        return NULL;
+    }
+
+    if (size)
+    {
+        *size = scanner->tags[tag].size;
+    }
+    return scanner->tags[tag].data;
+}
+
+// 周期完成：记录统计并计算下一次释放时间，已经错过的周期直接跳过
+static void finish_cycle(scan_class_t* cls, long long now)
+{
+    long long deadline = cls->release_ms + cls->period_ms;
+    long long duration = now - cls->release_ms;
+
+    cls->active = false;
+    cls->stats.scans++;
+    cls->stats.duration_last_ms = duration;
+    if (duration > cls->stats.duration_max_ms)
+    {
+        cls->stats.duration_max_ms = duration;
+    }
+    if (now > deadline)
+    {
+        cls->stats.overruns++;
+    }
+
+    cls->release_ms = deadline;
+    while (cls->release_ms + cls->period_ms <= now)
+    {
+        cls->release_ms += cls->period_ms;
+        cls->stats.overruns++;
+    }
+}
+
+// 按最早截止时间选择就绪的扫描类
+static scan_class_t* select_class(df1_scanner_t* scanner, long long now)
+{
+    scan_class_t* best = NULL;
+    for (size_t i = 0; i < scanner->class_count; i++)
+    {
+        scan_class_t* cls = &scanner->classes[i];
+        if (cls->tag_count == 0 || (!cls->active && now < cls->release_ms))
+        {
+            continue;
+        }
+        if (!best || cls->release_ms + cls->period_ms < best->release_ms + best->period_ms)
+        {
+            best = cls;
+        }
+    }
+    return best;
+}
+
+int df1_scanner_step(df1_scanner_t* scanner)
+{
+    if (!scanner || !scanner->port->is_open)
+    {
+        return -1;
+    }
+
+    long long now = monotonic_ms();
+    if (scanner->start_ms == 0)
+    {
+        // 所有扫描类从第一次调用开始同时释放
+        scanner->start_ms = now;
+        for (size_t i = 0; i < scanner->class_count; i++)
+        {
+            scanner->classes[i].release_ms = now;
+        }
+    }
+
+    scan_class_t* cls = select_class(scanner, now);
+    if (!cls)
+    {
+        return 0;
+    }
+
+    if (!cls->active)
+    {
+        if (cls->dirty)
+        {
+            if (df1_plan_build(&cls->plan, &scanner->plan_config, cls->items, cls->tag_count) != 0)
+            {
+                return -1;
+            }
+            cls->dirty = false;
+        }
+
+        long long jitter = now - cls->release_ms;
+        cls->active = true;
+        cls->cursor = 0;
+        cls->stats.jitter_total_ms += jitter;
+        if (jitter > cls->stats.jitter_max_ms)
+        {
+            cls->stats.jitter_max_ms = jitter;
+        }
+    }
+
+    // 一批最多为链路层窗口大小，批次之间可以切换到截止时间更早的扫描类
+    size_t batch = 1;
+    if (scanner->port->df1_config.duplex == DF1_FULL_DUPLEX)
+    {
+        batch = (size_t)scanner->port->link.config.max_outstanding;
+    }
+    if (batch > DF1_LINK_MAX_OUTSTANDING)
+    {
+        batch = DF1_LINK_MAX_OUTSTANDING;
+    }
+    if (batch > cls->plan.block_count - cls->cursor)
+    {
+        batch = cls->plan.block_count - cls->cursor;
+    }
+
+    if (cls->cursor == 0)
+    {
+        df1_plan_compile(&cls->plan, &scanner->port->df1_config);
+    }
+
+    df1_request_t requests[DF1_LINK_MAX_OUTSTANDING];
+    memset(requests, 0, batch * sizeof(df1_request_t));
+    for (size_t i = 0; i < batch; i++)
+    {
+        const df1_plan_block_t* block = &cls->plan.blocks[cls->cursor + i];
+        requests[i].command = DF1_CMD_READ;
+        requests[i].addr = &block->addr;
+        requests[i].read_data = cls->plan.data + block->offset;
+        requests[i].size = block->size;
+        requests[i].frame_template = &block->frame;
+    }
+
+    df1_serial_transact(scanner->port, requests, batch);
+
+    for (size_t i = 0; i < batch; i++)
+    {
+        size_t index = cls->cursor + i;
+        df1_plan_scatter(&cls->plan, index, requests[i].status, requests[i].read_data, requests[i].actual_size,
+                         cls->items);
+
+        const df1_plan_block_t* block = &cls->plan.blocks[index];
+        for (size_t j = block->first; j < block->first + block->count; j++)
+        {
+            size_t item = cls->plan.slices[j].item;
+            int status = cls->items[item].status;
+            scan_tag_t* tag = &scanner->tags[cls->tags[item]];
+
+            tag->valid = (status == 0);
+            if (status != 0)
+            {
+                cls->stats.errors++;
+            }
+            if (tag->callback)
+            {
+                scanner->in_callback = true;
+                tag->callback(tag->user_data, cls->tags[item], status, status == 0 ? tag->data : NULL, tag->size);
+                scanner->in_callback = false;
+            }
+        }
+    }
+
+    cls->cursor += batch;
+    if (cls->cursor >= cls->plan.block_count)
+    {
+        finish_cycle(cls, monotonic_ms());
+    }
+    return 1;
+}
+
+// 最近一次释放时间
+static long long next_release(const df1_scanner_t* scanner)
+{
+    long long release = -1;
+    for (size_t i = 0; i < scanner->class_count; i++)
+    {
+        const scan_class_t* cls = &scanner->classes[i];
+        if (cls->tag_count > 0 && (release < 0 || cls->release_ms < release))
+        {
+            release = cls->release_ms;
+        }
+    }
+    return release;
+}
+
+int df1_scanner_run(df1_scanner_t* scanner, int duration_ms)
+{
+    if (!scanner)
+    {
+        return -1;
+    }
+
+    long long deadline = monotonic_ms() + duration_ms;
+    for (;;)
+    {
+        long long now = monotonic_ms();
+        if (now >= deadline)
+        {
+            return 0;
+        }
+
+        int result = df1_scanner_step(scanner);
+        if (result < 0)
+        {
+            return -1;
+        }
+        if (result == 0)
+        {
+            long long wake = next_release(scanner);
+            if (wake < 0 || wake > deadline)
+            {
+                wake = deadline;
+            }
+            if (wake > now)
+            {
+                poll(NULL, 0, (int)(wake - now));
+            }
+        }
+    }
+}
+
+int df1_scanner_set_plan_config(df1_scanner_t* scanner, const df1_plan_config_t* config)
+{
+    if (!scanner || !config)
+    {
+        return -1;
+    }
+
+    scanner->plan_config = *config;
+    for (size_t i = 0; i < scanner->class_count; i++)
+    {
+        scanner->classes[i].dirty = true;
+    }
+    return 0;
+}
+
+int df1_scanner_get_stats(const df1_scanner_t* scanner, int scan_class, df1_scan_stats_t* stats)
+{
+    if (!scanner || scan_class < 0 || (size_t)scan_class >= scanner->class_count || !stats)
+    {
+        return -1;
+    }
+
+    *stats = scanner->classes[scan_class].stats;
+    return 0;
+}
+
+void df1_scanner_reset_stats(df1_scanner_t* scanner)
+{
+    if (!scanner)
+        return;
+
+    for (size_t i = 0; i < scanner->class_count; i++)
+    {
+        scan_class_t* cls = &scanner->classes[i];
+        memset(&cls->stats, 0, sizeof(df1_scan_stats_t));
+        cls->stats.period_ms = cls->period_ms;
+    }
+}
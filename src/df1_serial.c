@@ -1,10 +1,9 @@
+#define _DEFAULT_SOURCE
 #include "df1_serial.h"
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <termios.h>
-#include <sys/select.h>
+#include <time.h>
+#include <sys/uio.h>
 #include <errno.h>
 
 void df1_serial_config_default(df1_serial_config_t* config)
@@ -18,6 +17,11 @@ void df1_serial_config_default(df1_serial_config_t* config)
     config->stop_bits = 1;
     config->parity = 0; // None
     config->timeout_ms = 1000;
+    config->low_latency = true;
+    config->rs485 = false;
+    config->rs485_delay_before_ms = 0;
+    config->rs485_delay_after_ms = 0;
+    config->drain = false;
 }
 
 df1_serial_t* df1_serial_create(void)
@@ -29,9 +33,16 @@ df1_serial_t* df1_serial_create(void)
     }
 
     memset(df1_serial, 0, sizeof(df1_serial_t));
-    df1_serial->fd = -1;
+    df1_transport_init(&df1_serial->transport);
     df1_serial->is_open = false;
 
+    df1_serial->tag_table = df1_tag_table_create(0);
+    if (!df1_serial->tag_table)
+    {
+        free(df1_serial);
+        return NULL;
+    }
+
     return df1_serial;
 }
 
@@ -45,348 +56,1221 @@ void df1_serial_destroy(df1_serial_t* df1_serial)
         df1_serial_close(df1_serial);
     }
 
+    df1_tag_table_destroy(df1_serial->tag_table);
     free(df1_serial);
 }
 
-static int configure_serial_port(int fd, const df1_serial_config_t* config)
+// 初始化往返时间估计并交给链路层，链路层不使用时保持固定超时
+static void attach_rtt(df1_serial_t* df1_serial)
 {
-    struct termios options;
+    df1_rtt_config_t config = df1_serial->rtt_config;
+    if (config.char_time_us == 0)
+    {
+        const df1_serial_config_t* serial_config = &df1_serial->serial_config;
+        config.char_time_us = df1_rtt_char_time_us(serial_config->baud_rate, serial_config->data_bits,
+                                                   serial_config->parity, serial_config->stop_bits);
+    }
+    df1_rtt_init(&df1_serial->rtt, &config);
+    df1_serial->link.rtt = config.enabled ? &df1_serial->rtt : NULL;
+}
+
+// 保存配置并初始化接收路径与链路层
+static void finish_open(df1_serial_t* df1_serial, const df1_serial_config_t* serial_config,
+                        const df1_config_t* df1_config)
+{
+    df1_serial->serial_config = *serial_config;
+    df1_serial->df1_config = *df1_config;
+    df1_serial->is_open = true;
+
+    df1_decoder_init(&df1_serial->decoder, df1_config->check_type);
+    df1_serial->rx_head = 0;
+    df1_serial->rx_tail = 0;
 
-    if (tcgetattr(fd, &options) != 0)
+    if (df1_serial->link_config.max_outstanding == 0)
+    {
+        df1_link_config_default(&df1_serial->link_config, serial_config->timeout_ms);
+    }
+    df1_link_init(&df1_serial->link, &df1_serial->link_config, df1_config->duplex, df1_config->check_type);
+    df1_serial->link.tns_counter = &df1_serial->df1_config.transaction_id;
+#ifdef DF1_ENABLE_STATS
+    df1_serial->link.stats = &df1_serial->stats;
+#endif
+
+    if (df1_serial->rtt_config.max_rto_ms == 0)
+    {
+        df1_rtt_config_default(&df1_serial->rtt_config, serial_config->timeout_ms);
+    }
+    attach_rtt(df1_serial);
+}
+
+int df1_serial_open(df1_serial_t* df1_serial, const df1_serial_config_t* serial_config, const df1_config_t* df1_config)
+{
+    if (!df1_serial || !serial_config || !df1_config)
     {
         return -1;
     }
 
-    // 设置波特率
-    speed_t baud;
-    switch (config->baud_rate)
+    if (df1_serial->is_open)
+    {
+        return -1; // 已经打开
+    }
+
+    // 按端口名打开串口或TCP连接
+    if (df1_transport_open_auto(&df1_serial->transport, serial_config) != 0)
     {
-    case 9600:
-        baud = B9600;
-        break;
-    case 19200:
-        baud = B19200;
-        break;
-    case 38400:
-        baud = B38400;
-        break;
-    case 57600:
-        baud = B57600;
-        break;
-    case 115200:
-        baud = B115200;
-        break;
-    default:
         return -1;
     }
 
-    cfsetispeed(&options, baud);
-    cfsetospeed(&options, baud);
+    finish_open(df1_serial, serial_config, df1_config);
+    return 0;
+}
 
-    // 设置数据位
-    options.c_cflag &= ~CSIZE;
-    switch (config->data_bits)
+int df1_serial_open_transport(df1_serial_t* df1_serial, const df1_transport_t* transport,
+                              const df1_serial_config_t* serial_config, const df1_config_t* df1_config)
+{
+    if (!df1_serial || !transport || !transport->ops || !serial_config || !df1_config || df1_serial->is_open)
     {
-    case 7:
-        options.c_cflag |= CS7;
-        break;
-    case 8:
-        options.c_cflag |= CS8;
-        break;
-    default:
         return -1;
     }
 
-    // 设置停止位
-    if (config->stop_bits == 1)
+    df1_serial->transport = *transport;
+    finish_open(df1_serial, serial_config, df1_config);
+    return 0;
+}
+
+int df1_serial_set_link_config(df1_serial_t* df1_serial, const df1_link_config_t* link_config)
+{
+    if (!df1_serial || !link_config || link_config->max_outstanding < 1)
     {
-        options.c_cflag &= ~CSTOPB;
+        return -1;
     }
-    else if (config->stop_bits == 2)
+
+    df1_serial->link_config = *link_config;
+    if (df1_serial->is_open)
     {
-        options.c_cflag |= CSTOPB;
+        df1_link_reset(&df1_serial->link);
+        df1_link_init(&df1_serial->link, link_config, df1_serial->df1_config.duplex,
+                      df1_serial->df1_config.check_type);
+        df1_serial->link.tns_counter = &df1_serial->df1_config.transaction_id;
+#ifdef DF1_ENABLE_STATS
+        df1_serial->link.stats = &df1_serial->stats;
+#endif
+        df1_serial->link.rtt = df1_serial->rtt.config.enabled ? &df1_serial->rtt : NULL;
     }
-    else
+    return 0;
+}
+
+int df1_serial_set_rtt_config(df1_serial_t* df1_serial, const df1_rtt_config_t* rtt_config)
+{
+    if (!df1_serial || !rtt_config || rtt_config->max_rto_ms < 1)
     {
         return -1;
     }
 
-    // 设置校验位
-    switch (config->parity)
+    df1_serial->rtt_config = *rtt_config;
+    if (df1_serial->is_open)
+    {
+        attach_rtt(df1_serial);
+    }
+    return 0;
+}
+
+int df1_serial_close(df1_serial_t* df1_serial)
+{
+    if (!df1_serial || !df1_serial->is_open)
     {
-    case 0: // None
-        options.c_cflag &= ~PARENB;
-        break;
-    case 1: // Odd
-        options.c_cflag |= PARENB;
-        options.c_cflag |= PARODD;
-        break;
-    case 2: // Even
-        options.c_cflag |= PARENB;
-        options.c_cflag &= ~PARODD;
-        break;
-    default:
         return -1;
     }
 
-    // 其他设置
-    options.c_cflag |= (CLOCAL | CREAD);
-    options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
-    options.c_iflag &= ~(IXON | IXOFF | IXANY);
-    options.c_oflag &= ~OPOST;
+    df1_transport_close(&df1_serial->transport);
 
-    // 设置超时
-    options.c_cc[VMIN] = 0;
-    options.c_cc[VTIME] = config->timeout_ms / 100; // 以0.1秒为单位
+    df1_serial->is_open = false;
+    return 0;
+}
 
-    return tcsetattr(fd, TCSANOW, &options);
+static long long monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
-int df1_serial_open(df1_serial_t* df1_serial, const df1_serial_config_t* serial_config, const df1_config_t* df1_config)
+// 等待传输层就绪，被信号打断时按剩余时间继续等待。返回 1 就绪，0 超时，-1 连接出错
+static int wait_ready(df1_serial_t* df1_serial, int events, long long deadline)
 {
-    if (!df1_serial || !serial_config || !df1_config)
+    for (;;)
+    {
+        long long remaining = deadline - monotonic_ms();
+        if (remaining <= 0)
+        {
+            return 0;
+        }
+
+        int result = df1_transport_wait(&df1_serial->transport, events, (int)remaining);
+        if (result != 0)
+        {
+            return result;
+        }
+    }
+}
+
+static int write_all(df1_serial_t* df1_serial, const uint8_t* data, size_t size, long long deadline)
+{
+    size_t written = 0;
+    while (written < size)
+    {
+        ssize_t result = df1_transport_send(&df1_serial->transport, data + written, size - written);
+        if (result > 0)
+        {
+            written += (size_t)result;
+            DF1_STATS_ADD(&df1_serial->stats, bytes_sent, result);
+        }
+        else if (result < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            return -1;
+        }
+        else if (wait_ready(df1_serial, DF1_TRANSPORT_WRITE, deadline) <= 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 将环形缓冲区中的字节送入解码器，直到得到期望事务ID的帧或缓冲区为空。
+// 返回 1 表示得到帧，0 表示需要更多数据，-1 表示校验错误等帧错误
+static int drain_rx_ring(df1_serial_t* df1_serial, uint16_t expected_tns, df1_frame_t* frame)
+{
+    while (df1_serial->rx_tail != df1_serial->rx_head)
+    {
+        size_t offset = df1_serial->rx_tail & (DF1_RX_RING_SIZE - 1);
+        size_t span = df1_serial->rx_head - df1_serial->rx_tail;
+        if (span > DF1_RX_RING_SIZE - offset)
+        {
+            span = DF1_RX_RING_SIZE - offset;
+        }
+
+        size_t consumed = 0;
+        int result = df1_decoder_push(&df1_serial->decoder, &df1_serial->rx_ring[offset], span, &consumed, frame);
+        df1_serial->rx_tail += consumed;
+
+        if (result == DF1_DECODE_FRAME)
+        {
+            if (frame->tns == expected_tns)
+            {
+                return 1;
+            }
+            // 之前超时事务的迟到响应，丢弃
+        }
+        else if (result < 0)
+        {
+            if (result == DF1_DECODE_BAD_CHECKSUM)
+            {
+                DF1_STATS_ADD(&df1_serial->stats, crc_errors, 1);
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 从传输层读取到环形缓冲区的空闲区域，一次读取覆盖回绕的两段
+static int fill_rx_ring(df1_serial_t* df1_serial)
+{
+    size_t used = df1_serial->rx_head - df1_serial->rx_tail;
+    size_t free_size = DF1_RX_RING_SIZE - used;
+    size_t offset = df1_serial->rx_head & (DF1_RX_RING_SIZE - 1);
+    size_t first = DF1_RX_RING_SIZE - offset;
+    if (first > free_size)
+    {
+        first = free_size;
+    }
+
+    struct iovec iov[2];
+    iov[0].iov_base = &df1_serial->rx_ring[offset];
+    iov[0].iov_len = first;
+    iov[1].iov_base = df1_serial->rx_ring;
+    iov[1].iov_len = free_size - first;
+
+    ssize_t received = df1_transport_recv(&df1_serial->transport, iov, iov[1].iov_len ? 2 : 1);
+    if (received < 0)
+    {
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    }
+    if (received == 0)
+    {
+        return -1; // 对端关闭
+    }
+
+    df1_serial->rx_head += (size_t)received;
+    DF1_STATS_ADD(&df1_serial->stats, bytes_received, received);
+    return 0;
+}
+
+// send_and_receive 的结果：超时与帧错误可以重发，连接出错不能
+enum {
+    EXCHANGE_OK = 0,
+    EXCHANGE_TIMEOUT = 1,
+    EXCHANGE_BAD_FRAME = 2,
+    EXCHANGE_ERROR = -1
+};
+
+// 发送命令并在 deadline 之前等待事务ID匹配的完整响应帧。多余的字节保留在环形缓冲区中供下一次
+// 事务使用，返回的帧视图在下一次收发之前有效
+static int send_and_receive(df1_serial_t* df1_serial, const uint8_t* send_data, size_t send_size,
+                            uint16_t expected_tns, long long deadline, df1_frame_t* frame)
+{
+    if (!df1_serial->is_open)
+    {
+        return EXCHANGE_ERROR;
+    }
+
+    // 发送数据
+    DF1_STATS_TIME(send_start);
+    if (write_all(df1_serial, send_data, send_size, deadline) != 0)
+    {
+        return EXCHANGE_ERROR;
+    }
+#ifdef DF1_ENABLE_STATS
+    uint64_t sent = df1_stats_now_ns();
+    uint64_t first_byte = 0;
+    DF1_STATS_RECORD(&df1_serial->stats, DF1_PHASE_TRANSMIT, send_start, sent);
+#endif
+
+    for (;;)
+    {
+        DF1_STATS_TIME(drain_start);
+        int result = drain_rx_ring(df1_serial, expected_tns, frame);
+        if (result != 0)
+        {
+#ifdef DF1_ENABLE_STATS
+            if (result > 0)
+            {
+                DF1_STATS_RECORD(&df1_serial->stats, DF1_PHASE_DECODE, drain_start, df1_stats_now_ns());
+                if (first_byte != 0)
+                {
+                    DF1_STATS_RECORD(&df1_serial->stats, DF1_PHASE_FRAME, first_byte, drain_start);
+                }
+            }
+#endif
+            return result > 0 ? EXCHANGE_OK : EXCHANGE_BAD_FRAME;
+        }
+
+        // 等待响应
+        size_t pending = df1_decoder_min_remaining(&df1_serial->decoder);
+        df1_transport_set_min_read(&df1_serial->transport, pending);
+        int ready = wait_ready(df1_serial, DF1_TRANSPORT_READ, deadline);
+        if (ready <= 0)
+        {
+            return ready == 0 ? EXCHANGE_TIMEOUT : EXCHANGE_ERROR;
+        }
+
+        // 接收数据
+        if (fill_rx_ring(df1_serial) != 0)
+        {
+            return EXCHANGE_ERROR;
+        }
+#ifdef DF1_ENABLE_STATS
+        if (first_byte == 0 && df1_serial->rx_head != df1_serial->rx_tail)
+        {
+            first_byte = df1_stats_now_ns();
+            DF1_STATS_RECORD(&df1_serial->stats, DF1_PHASE_FIRST_BYTE, sent, first_byte);
+        }
+#endif
+    }
+}
+
+int df1_serial_send_raw(df1_serial_t* df1_serial, const uint8_t* data, size_t size)
+{
+    if (!df1_serial || !df1_serial->is_open || (!data && size > 0))
     {
         return -1;
     }
 
-    if (df1_serial->is_open)
+    return write_all(df1_serial, data, size, monotonic_ms() + df1_serial->serial_config.timeout_ms);
+}
+
+int df1_serial_receive_event(df1_serial_t* df1_serial, int timeout_ms, df1_frame_t* frame)
+{
+    if (!df1_serial || !df1_serial->is_open || !frame)
     {
-        return -1; // 已经打开
+        return DF1_DECODE_MALFORMED;
+    }
+
+    long long deadline = monotonic_ms() + timeout_ms;
+    for (;;)
+    {
+        while (df1_serial->rx_tail != df1_serial->rx_head)
+        {
+            size_t offset = df1_serial->rx_tail & (DF1_RX_RING_SIZE - 1);
+            size_t span = df1_serial->rx_head - df1_serial->rx_tail;
+            if (span > DF1_RX_RING_SIZE - offset)
+            {
+                span = DF1_RX_RING_SIZE - offset;
+            }
+
+            size_t consumed = 0;
+            int result = df1_decoder_push(&df1_serial->decoder, &df1_serial->rx_ring[offset], span, &consumed, frame);
+            df1_serial->rx_tail += consumed;
+            if (result == DF1_DECODE_BAD_CHECKSUM)
+            {
+                DF1_STATS_ADD(&df1_serial->stats, crc_errors, 1);
+            }
+            if (result != DF1_DECODE_NEED_MORE)
+            {
+                return result;
+            }
+        }
+
+        // 控制字符只有两个字节
+        size_t pending = df1_decoder_min_remaining(&df1_serial->decoder);
+        df1_transport_set_min_read(&df1_serial->transport, pending < 2 ? pending : 2);
+        if (wait_ready(df1_serial, DF1_TRANSPORT_READ, deadline) <= 0 || fill_rx_ring(df1_serial) != 0)
+        {
+            return DF1_DECODE_NEED_MORE;
+        }
+    }
+}
+
+// 解析地址字符串：优先使用标签表缓存，标签表已满时退回到临时解析
+static const df1_address_t* resolve_address(df1_serial_t* df1_serial, const char* address, df1_address_t* scratch)
+{
+    const df1_address_t* addr = df1_tag_table_lookup(df1_serial->tag_table, address);
+    if (addr)
+    {
+        return addr;
     }
 
-    // 打开串口
-    df1_serial->fd = open(serial_config->port_name, O_RDWR | O_NOCTTY | O_NDELAY);
-    if (df1_serial->fd < 0)
+    if (df1_address_parse(address, scratch) != 0)
+    {
+        return NULL;
+    }
+    return scratch;
+}
+
+const df1_address_t* df1_serial_tag(df1_serial_t* df1_serial, const char* address)
+{
+    if (!df1_serial || !address)
+    {
+        return NULL;
+    }
+
+    return df1_tag_table_lookup(df1_serial->tag_table, address);
+}
+
+int df1_serial_read(df1_serial_t* df1_serial, const char* address, uint8_t* data, size_t data_size, size_t* actual_size)
+{
+    if (!df1_serial || !address || !data || !actual_size)
     {
         return -1;
     }
 
-    // 配置串口
-    if (configure_serial_port(df1_serial->fd, serial_config) != 0)
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_address(df1_serial, address, &scratch);
+    if (!addr)
     {
-        close(df1_serial->fd);
-        df1_serial->fd = -1;
         return -1;
     }
 
-    // 保存配置
-    df1_serial->serial_config = *serial_config;
-    df1_serial->df1_config = *df1_config;
-    df1_serial->is_open = true;
+    return df1_serial_read_addr(df1_serial, addr, data, data_size, actual_size);
+}
 
-    return 0;
+int df1_serial_write(df1_serial_t* df1_serial, const char* address, const uint8_t* data, size_t data_size)
+{
+    if (!df1_serial || !address || !data)
+    {
+        return -1;
+    }
+
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_address(df1_serial, address, &scratch);
+    if (!addr)
+    {
+        return -1;
+    }
+
+    return df1_serial_write_addr(df1_serial, addr, data, data_size);
 }
 
-int df1_serial_close(df1_serial_t* df1_serial)
+int df1_request_encode(const df1_config_t* config, const df1_request_t* request, uint8_t* buffer,
+                       size_t buffer_size, size_t* actual_size)
 {
-    if (!df1_serial || !df1_serial->is_open)
+    if (!config || !request || !request->addr || request->size > 0xFFFF)
     {
         return -1;
     }
 
-    if (df1_serial->fd >= 0)
+    if (request->frame_template && df1_frame_template_matches(request->frame_template, config))
     {
-        close(df1_serial->fd);
-        df1_serial->fd = -1;
+        return df1_frame_template_emit(request->frame_template, config->transaction_id, buffer, buffer_size,
+                                       actual_size);
     }
 
-    df1_serial->is_open = false;
+    if (request->command == DF1_CMD_READ)
+    {
+        return df1_build_read_command_addr(config, request->addr, (uint16_t)request->size, buffer, buffer_size,
+                                           actual_size);
+    }
+    if (request->command == DF1_CMD_WRITE && request->write_data)
+    {
+        return df1_build_write_command_addr(config, request->addr, request->write_data, (uint16_t)request->size,
+                                            buffer, buffer_size, actual_size);
+    }
+    if (request->command == DF1_CMD_MASK_WRITE && request->write_data && request->size == 2)
+    {
+        uint16_t value = (uint16_t)(request->write_data[0] | (request->write_data[1] << 8));
+        return df1_build_mask_write_command_addr(config, request->addr, request->mask, value, buffer, buffer_size,
+                                                 actual_size);
+    }
+    return -1;
+}
+
+size_t df1_request_reply_size(const df1_request_t* request)
+{
+    if (!request)
+    {
+        return 0;
+    }
+    return 16 + (request->command == DF1_CMD_READ ? request->size : 0);
+}
+
+void df1_request_finish(df1_request_t* request, int status, const df1_frame_t* reply)
+{
+    if (!request)
+        return;
+
+    if (status != 0 || !reply)
+    {
+        request->status = -1;
+        return;
+    }
+
+    request->sts = reply->sts;
+    request->ext_sts = reply->ext_sts;
+    if (reply->sts != 0x00)
+    {
+        request->status = -1;
+        return;
+    }
+
+    if (request->command == DF1_CMD_READ)
+    {
+        size_t copy_size = reply->data_length < request->size ? reply->data_length : request->size;
+        memcpy(request->read_data, reply->data, copy_size);
+        request->actual_size = copy_size;
+    }
+    request->status = 0;
+}
+
+static void link_request_complete(void* user_data, int status, const df1_frame_t* reply)
+{
+    df1_request_finish((df1_request_t*)user_data, status, reply);
+}
+
+// 半双工：逐条发送并等待响应。无应答或响应校验错误时按自适应超时以新的事务ID重发，
+// 从站对事务ID相同的命令只应答不执行；每次重发换号也使迟到的响应不会被误认，
+// 因此每个收到的响应都可以作为往返样本
+static void execute_sequential(df1_serial_t* df1_serial, df1_request_t* request)
+{
+    df1_rtt_t* rtt = &df1_serial->rtt;
+    uint8_t command[DF1_MAX_FRAME_SIZE];
+    size_t command_size;
+
+    DF1_STATS_TIME(start);
+    long long now = monotonic_ms();
+    long long give_up = now + df1_serial->serial_config.timeout_ms;
+    int result = EXCHANGE_ERROR;
+
+    // 从站离线时直接失败，不占用线路
+    if (df1_rtt_allow(rtt, now))
+    {
+        for (int attempt = 0;; attempt++)
+        {
+            // 增加事务ID
+            uint16_t tns = ++df1_serial->df1_config.transaction_id;
+
+            DF1_STATS_TIME(encode_start);
+            if (df1_request_encode(&df1_serial->df1_config, request, command, sizeof(command), &command_size) != 0)
+            {
+                result = EXCHANGE_ERROR;
+                break;
+            }
+            DF1_STATS_RECORD(&df1_serial->stats, DF1_PHASE_ENCODE, encode_start, df1_stats_now_ns());
+
+            // 发送命令并接收响应
+            long long sent = monotonic_ms();
+            long long deadline = give_up;
+            if (rtt->config.enabled)
+            {
+                deadline = sent + df1_rtt_timeout(rtt, attempt, command_size + df1_request_reply_size(request));
+                deadline = deadline < give_up ? deadline : give_up;
+            }
+
+            df1_frame_t frame;
+            result = send_and_receive(df1_serial, command, command_size, tns, deadline, &frame);
+            if (result == EXCHANGE_OK)
+            {
+                long long elapsed_ms = monotonic_ms() - sent;
+                df1_rtt_sample(rtt, (int64_t)elapsed_ms * 1000, command_size + frame.pdu_length + 9);
+                df1_rtt_success(rtt);
+                df1_request_finish(request, 0, &frame);
+                break;
+            }
+            if (result == EXCHANGE_BAD_FRAME)
+            {
+                df1_rtt_success(rtt);
+            }
+
+            if (result == EXCHANGE_ERROR || !rtt->config.enabled || attempt >= rtt->config.max_retries ||
+                monotonic_ms() >= give_up)
+            {
+                break;
+            }
+            DF1_STATS_ADD(&df1_serial->stats, retries, 1);
+        }
+    }
+
+    if (result != EXCHANGE_OK)
+    {
+        request->status = -1;
+    }
+    if (result == EXCHANGE_TIMEOUT)
+    {
+        DF1_STATS_ADD(&df1_serial->stats, timeouts, 1);
+        df1_rtt_failure(rtt, monotonic_ms());
+    }
+
+    DF1_STATS_RECORD(&df1_serial->stats, DF1_PHASE_TOTAL, start, df1_stats_now_ns());
+    DF1_STATS_ADD(&df1_serial->stats, transactions, 1);
+    if (request->status != 0)
+    {
+        DF1_STATS_ADD(&df1_serial->stats, errors, 1);
+    }
+}
+
+// 将链路层待发送的字节全部写出
+static int flush_link_output(df1_serial_t* df1_serial, long long deadline)
+{
+    const uint8_t* data;
+    size_t size;
+    while ((size = df1_link_output(&df1_serial->link, &data)) > 0)
+    {
+        if (write_all(df1_serial, data, size, deadline) != 0)
+        {
+            return -1;
+        }
+        df1_link_output_done(&df1_serial->link, size);
+    }
     return 0;
 }
 
-static int send_and_receive(df1_serial_t* df1_serial, const uint8_t* send_data, size_t send_size, uint8_t* recv_data,
-                            size_t recv_size, size_t* actual_recv_size)
+// 将环形缓冲区中的字节全部交给链路层
+static void feed_link(df1_serial_t* df1_serial)
 {
-    if (!df1_serial->is_open)
+    while (df1_serial->rx_tail != df1_serial->rx_head)
+    {
+        size_t offset = df1_serial->rx_tail & (DF1_RX_RING_SIZE - 1);
+        size_t span = df1_serial->rx_head - df1_serial->rx_tail;
+        if (span > DF1_RX_RING_SIZE - offset)
+        {
+            span = DF1_RX_RING_SIZE - offset;
+        }
+
+        df1_link_input(&df1_serial->link, &df1_serial->rx_ring[offset], span, monotonic_ms());
+        df1_serial->rx_tail += span;
+    }
+}
+
+// 全双工：通过链路层流水执行，命令被确认后即发送下一条
+static void execute_pipelined(df1_serial_t* df1_serial, df1_request_t* requests, size_t count)
+{
+    df1_link_t* link = &df1_serial->link;
+    uint8_t command[DF1_MAX_FRAME_SIZE];
+    size_t next = 0;
+
+    for (;;)
+    {
+        long long now = monotonic_ms();
+
+        // 在窗口允许的范围内提交命令
+        while (next < count && df1_link_can_submit(link))
+        {
+            df1_request_t* request = &requests[next++];
+            size_t command_size;
+            uint16_t tns = ++df1_serial->df1_config.transaction_id;
+
+            DF1_STATS_TIME(encode_start);
+            if (df1_request_encode(&df1_serial->df1_config, request, command, sizeof(command), &command_size) != 0)
+            {
+                request->status = -1;
+                continue;
+            }
+            DF1_STATS_RECORD(&df1_serial->stats, DF1_PHASE_ENCODE, encode_start, df1_stats_now_ns());
+            if (df1_link_submit_expect(link, command, command_size, tns, df1_request_reply_size(request), now,
+                                       link_request_complete, request) != 0)
+            {
+                request->status = -1;
+            }
+        }
+
+        if (flush_link_output(df1_serial, now + df1_serial->serial_config.timeout_ms) != 0)
+        {
+            df1_link_reset(link);
+            break;
+        }
+
+        if (next >= count && df1_link_outstanding(link) == 0)
+        {
+            break;
+        }
+
+        // 等待应答、响应或下一次超时
+        long long deadline = df1_link_next_deadline(link);
+        if (deadline < 0)
+        {
+            deadline = now + df1_serial->serial_config.timeout_ms;
+        }
+
+        size_t pending = df1_decoder_min_remaining(&link->decoder);
+        df1_transport_set_min_read(&df1_serial->transport, pending < 2 ? pending : 2); // DLE ACK 只有两个字节
+        // 连接出错（如TCP对端复位）时不再等待链路层超时重发
+        int ready = wait_ready(df1_serial, DF1_TRANSPORT_READ, deadline);
+        if (ready != 0)
+        {
+            if (ready < 0 || fill_rx_ring(df1_serial) != 0)
+            {
+                df1_link_reset(link);
+                break;
+            }
+            feed_link(df1_serial);
+        }
+
+        df1_link_tick(link, monotonic_ms());
+    }
+
+    // 链路出错而未提交的请求
+    while (next < count)
+    {
+        requests[next++].status = -1;
+    }
+}
+
+int df1_serial_get_stats(df1_serial_t* df1_serial, df1_stats_t* stats)
+{
+#ifdef DF1_ENABLE_STATS
+    if (!df1_serial || !stats)
     {
         return -1;
     }
 
-    // 发送数据
-    ssize_t written = write(df1_serial->fd, send_data, send_size);
-    if (written != (ssize_t)send_size)
+    df1_stats_snapshot(stats, &df1_serial->stats);
+    return 0;
+#else
+    (void)df1_serial;
+    (void)stats;
+    return -1;
+#endif
+}
+
+void df1_serial_reset_stats(df1_serial_t* df1_serial)
+{
+#ifdef DF1_ENABLE_STATS
+    if (df1_serial)
+    {
+        df1_stats_reset(&df1_serial->stats);
+    }
+#else
+    (void)df1_serial;
+#endif
+}
+
+int df1_serial_set_capture(df1_serial_t* df1_serial, df1_capture_t* capture)
+{
+    if (!df1_serial || !df1_serial->is_open)
     {
         return -1;
     }
 
-    // 等待响应
-    fd_set read_fds;
-    struct timeval timeout;
+    df1_transport_set_capture(&df1_serial->transport, capture);
+    return 0;
+}
 
-    FD_ZERO(&read_fds);
-    FD_SET(df1_serial->fd, &read_fds);
+int df1_serial_transact(df1_serial_t* df1_serial, df1_request_t* requests, size_t count)
+{
+    if (!df1_serial || !requests || !df1_serial->is_open)
+    {
+        return -1;
+    }
 
-    timeout.tv_sec = df1_serial->serial_config.timeout_ms / 1000;
-    timeout.tv_usec = (df1_serial->serial_config.timeout_ms % 1000) * 1000;
+    for (size_t i = 0; i < count; i++)
+    {
+        requests[i].status = DF1_REQUEST_PENDING;
+        requests[i].actual_size = 0;
+        requests[i].sts = 0;
+        requests[i].ext_sts = 0;
+    }
 
-    int result = select(df1_serial->fd + 1, &read_fds, NULL, NULL, &timeout);
-    if (result <= 0)
+    if (df1_serial->df1_config.duplex == DF1_FULL_DUPLEX)
+    {
+        execute_pipelined(df1_serial, requests, count);
+    }
+    else
     {
-        return -1; // 超时或错误
+        for (size_t i = 0; i < count; i++)
+        {
+            execute_sequential(df1_serial, &requests[i]);
+        }
     }
 
-    // 接收数据
-    ssize_t received = read(df1_serial->fd, recv_data, recv_size);
-    if (received < 0)
+    int result = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (requests[i].status != 0)
+        {
+            requests[i].status = -1;
+            result = -1;
+        }
+    }
+    return result;
+}
+
+int df1_serial_read_addr(df1_serial_t* df1_serial, const df1_address_t* addr, uint8_t* data, size_t data_size,
+                         size_t* actual_size)
+{
+    if (!df1_serial || !addr || !data || !actual_size)
+    {
+        return -1;
+    }
+
+    df1_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.command = DF1_CMD_READ;
+    request.addr = addr;
+    request.read_data = data;
+    request.size = data_size;
+
+    if (df1_serial_transact(df1_serial, &request, 1) != 0)
     {
         return -1;
     }
 
-    *actual_recv_size = (size_t)received;
+    *actual_size = request.actual_size;
     return 0;
 }
 
-int df1_serial_read(df1_serial_t* df1_serial, const char* address, uint8_t* data, size_t data_size, size_t* actual_size)
+int df1_serial_write_addr(df1_serial_t* df1_serial, const df1_address_t* addr, const uint8_t* data, size_t data_size)
 {
-    if (!df1_serial || !address || !data || !actual_size)
+    if (!df1_serial || !addr || !data)
     {
         return -1;
     }
 
-    // 构建读取命令
-    uint8_t command[512];
-    size_t command_size;
+    df1_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.command = DF1_CMD_WRITE;
+    request.addr = addr;
+    request.write_data = data;
+    request.size = data_size;
 
-    // 增加事务ID
-    df1_serial->df1_config.transaction_id++;
+    return df1_serial_transact(df1_serial, &request, 1);
+}
 
-    int result = df1_build_read_command(&df1_serial->df1_config, address, (uint16_t)data_size, command, sizeof(command),
-                                        &command_size);
-    if (result != 0)
+// 将连续元素的读写分为不超过 DF1_MAX_DATA_SIZE 的整元素分段并作为一批执行
+static int transact_block(df1_serial_t* df1_serial, df1_command_t command, const df1_address_t* addr,
+                          uint8_t* read_data, const uint8_t* write_data, size_t data_size, size_t* actual_size)
+{
+    size_t element = df1_address_element_size(addr->data_code);
+    if (element == 0 || element > DF1_MAX_DATA_SIZE)
     {
         return -1;
     }
 
-    // 发送命令并接收响应
-    uint8_t response[512];
-    size_t response_size;
+    size_t chunk = (DF1_MAX_DATA_SIZE / element) * element;
+    size_t count = (data_size + chunk - 1) / chunk;
+    if (count == 0)
+    {
+        if (actual_size)
+        {
+            *actual_size = 0;
+        }
+        return 0;
+    }
+    if (addr->sub_element != 0 && count > 1)
+    {
+        return -1; // 从子元素开始的传输不跨分段
+    }
+    if ((size_t)addr->address_start + (count - 1) * (chunk / element) > 0xFFFF)
+    {
+        return -1;
+    }
 
-    result = send_and_receive(df1_serial, command, command_size, response, sizeof(response), &response_size);
-    if (result != 0)
+    df1_request_t* requests = (df1_request_t*)calloc(count, sizeof(df1_request_t));
+    df1_address_t* addrs = (df1_address_t*)malloc(count * sizeof(df1_address_t));
+    if (!requests || !addrs)
     {
+        free(requests);
+        free(addrs);
         return -1;
     }
 
-    // 解析响应
-    return df1_parse_response(response, response_size, data, data_size, actual_size);
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t offset = i * chunk;
+        addrs[i] = *addr;
+        addrs[i].address_start = (uint16_t)(addr->address_start + i * (chunk / element));
+
+        requests[i].command = command;
+        requests[i].addr = &addrs[i];
+        requests[i].size = (data_size - offset < chunk) ? data_size - offset : chunk;
+        if (command == DF1_CMD_READ)
+        {
+            requests[i].read_data = read_data + offset;
+        }
+        else
+        {
+            requests[i].write_data = write_data + offset;
+        }
+    }
+
+    int result = df1_serial_transact(df1_serial, requests, count);
+
+    if (actual_size)
+    {
+        // 只统计从起始地址开始连续成功的部分
+        *actual_size = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (requests[i].status != 0)
+                break;
+            *actual_size += requests[i].actual_size;
+            if (requests[i].actual_size != requests[i].size)
+                break;
+        }
+        if (*actual_size != data_size)
+        {
+            result = -1;
+        }
+    }
+
+    free(requests);
+    free(addrs);
+    return result;
 }
 
-int df1_serial_write(df1_serial_t* df1_serial, const char* address, const uint8_t* data, size_t data_size)
+int df1_serial_read_block_addr(df1_serial_t* df1_serial, const df1_address_t* addr, uint8_t* data,
+                               size_t data_size, size_t* actual_size)
 {
-    if (!df1_serial || !address || !data)
+    if (!df1_serial || !addr || !data || !actual_size)
     {
         return -1;
     }
 
-    // 构建写入命令
-    uint8_t command[512];
-    size_t command_size;
+    return transact_block(df1_serial, DF1_CMD_READ, addr, data, NULL, data_size, actual_size);
+}
 
-    // 增加事务ID
-    df1_serial->df1_config.transaction_id++;
+int df1_serial_write_block_addr(df1_serial_t* df1_serial, const df1_address_t* addr, const uint8_t* data,
+                                size_t data_size)
+{
+    if (!df1_serial || !addr || !data)
+    {
+        return -1;
+    }
+
+    return transact_block(df1_serial, DF1_CMD_WRITE, addr, NULL, data, data_size, NULL);
+}
 
-    int result = df1_build_write_command(&df1_serial->df1_config, address, data, (uint16_t)data_size, command,
-                                         sizeof(command), &command_size);
-    if (result != 0)
+int df1_serial_read_block(df1_serial_t* df1_serial, const char* address, uint8_t* data, size_t data_size,
+                          size_t* actual_size)
+{
+    if (!df1_serial || !address || !data || !actual_size)
     {
         return -1;
     }
 
-    // 发送命令并接收响应
-    uint8_t response[512];
-    size_t response_size;
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_address(df1_serial, address, &scratch);
+    if (!addr)
+    {
+        return -1;
+    }
+
+    return df1_serial_read_block_addr(df1_serial, addr, data, data_size, actual_size);
+}
+
+int df1_serial_write_block(df1_serial_t* df1_serial, const char* address, const uint8_t* data, size_t data_size)
+{
+    if (!df1_serial || !address || !data)
+    {
+        return -1;
+    }
 
-    result = send_and_receive(df1_serial, command, command_size, response, sizeof(response), &response_size);
-    if (result != 0)
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_address(df1_serial, address, &scratch);
+    if (!addr)
     {
         return -1;
     }
 
-    // 解析响应（写入命令通常只返回状态）
-    uint8_t dummy_data[1];
-    size_t dummy_size;
-    return df1_parse_response(response, response_size, dummy_data, sizeof(dummy_data), &dummy_size);
+    return df1_serial_write_block_addr(df1_serial, addr, data, data_size);
 }
 
-int df1_serial_read_int16(df1_serial_t* df1_serial, const char* address, int16_t* value)
+int df1_serial_mask_write(df1_serial_t* df1_serial, const char* address, uint16_t mask, uint16_t value)
+{
+    if (!df1_serial || !address)
+    {
+        return -1;
+    }
+
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_address(df1_serial, address, &scratch);
+    if (!addr)
+    {
+        return -1;
+    }
+
+    uint8_t data[2] = {(uint8_t)(value & 0xFF), (uint8_t)(value >> 8)};
+    df1_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.command = DF1_CMD_MASK_WRITE;
+    request.addr = addr;
+    request.write_data = data;
+    request.size = sizeof(data);
+    request.mask = mask;
+
+    return df1_serial_transact(df1_serial, &request, 1);
+}
+
+int df1_serial_set_bits(df1_serial_t* df1_serial, const char* address, uint16_t mask)
+{
+    return df1_serial_mask_write(df1_serial, address, mask, 0xFFFF);
+}
+
+int df1_serial_clear_bits(df1_serial_t* df1_serial, const char* address, uint16_t mask)
+{
+    return df1_serial_mask_write(df1_serial, address, mask, 0x0000);
+}
+
+int df1_serial_read_bit(df1_serial_t* df1_serial, const char* address, bool* value)
 {
     if (!df1_serial || !address || !value)
     {
         return -1;
     }
 
-    uint8_t data[2];
-    size_t actual_size;
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_address(df1_serial, address, &scratch);
+    if (!addr || !addr->has_bit)
+    {
+        return -1;
+    }
 
-    int result = df1_serial_read(df1_serial, address, data, sizeof(data), &actual_size);
-    if (result != 0 || actual_size != 2)
+    uint8_t data[2];
+    size_t actual_size = 0;
+    if (df1_serial_read_addr(df1_serial, addr, data, sizeof(data), &actual_size) != 0 || actual_size != 2)
     {
         return -1;
     }
 
-    // AB PLC使用小端序
-    *value = (int16_t)(data[0] | (data[1] << 8));
+    *value = ((data[0] | (data[1] << 8)) >> addr->bit) & 1;
     return 0;
 }
 
-int df1_serial_write_int16(df1_serial_t* df1_serial, const char* address, int16_t value)
+int df1_serial_write_bit(df1_serial_t* df1_serial, const char* address, bool value)
 {
     if (!df1_serial || !address)
     {
         return -1;
     }
 
-    uint8_t data[2];
-    data[0] = (uint8_t)(value & 0xFF);
-    data[1] = (uint8_t)(value >> 8);
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_address(df1_serial, address, &scratch);
+    if (!addr || !addr->has_bit)
+    {
+        return -1;
+    }
 
-    return df1_serial_write(df1_serial, address, data, sizeof(data));
+    uint16_t mask = (uint16_t)(1u << addr->bit);
+    return df1_serial_mask_write(df1_serial, address, mask, value ? mask : 0);
 }
 
-int df1_serial_read_float(df1_serial_t* df1_serial, const char* address, float* value)
+// 类型化读写的元素类型
+typedef enum {
+    ARRAY_WORD,  // 16位整数：N、B、S、I、O 文件与定时器、计数器、控制的字
+    ARRAY_LONG,  // 32位整数：L 文件
+    ARRAY_FLOAT  // 32位浮点数：F 文件
+} array_type_t;
+
+static size_t array_width(array_type_t type)
 {
-    if (!df1_serial || !address || !value)
+    return type == ARRAY_WORD ? 2 : 4;
+}
+
+// 地址的文件类型必须与元素类型一致，不按其他类型重新解释数据
+static const df1_address_t* resolve_array(df1_serial_t* df1_serial, const char* address, array_type_t type,
+                                          size_t count, df1_address_t* scratch)
+{
+    size_t width = array_width(type);
+    if (count > SIZE_MAX / width)
     {
-        return -1;
+        return NULL;
     }
 
-    uint8_t data[4];
-    size_t actual_size;
+    const df1_address_t* addr = resolve_address(df1_serial, address, scratch);
+    if (!addr)
+    {
+        return NULL;
+    }
 
-    int result = df1_serial_read(df1_serial, address, data, sizeof(data), &actual_size);
-    if (result != 0 || actual_size != 4)
+    switch (addr->data_code)
+    {
+    case DF1_ADDR_N:
+    case DF1_ADDR_B:
+    case DF1_ADDR_S:
+    case DF1_ADDR_I:
+    case DF1_ADDR_O:
+    case DF1_ADDR_T:
+    case DF1_ADDR_C:
+    case DF1_ADDR_R:
+        return type == ARRAY_WORD ? addr : NULL;
+    case DF1_ADDR_L:
+        return type == ARRAY_LONG ? addr : NULL;
+    case DF1_ADDR_F:
+        return type == ARRAY_FLOAT ? addr : NULL;
+    default:
+        return NULL;
+    }
+}
+
+// 读取 count 个元素，直接读入调用者数组后原地转换字节序
+static int read_array(df1_serial_t* df1_serial, const char* address, void* values, size_t count, array_type_t type)
+{
+    if (!df1_serial || !address || !values)
     {
         return -1;
     }
 
-    // AB PLC使用小端序
-    union {
-        float f;
-        uint8_t bytes[4];
-    } converter;
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_array(df1_serial, address, type, count, &scratch);
+    if (!addr)
+    {
+        return -1;
+    }
 
-    converter.bytes[0] = data[0];
-    converter.bytes[1] = data[1];
-    converter.bytes[2] = data[2];
-    converter.bytes[3] = data[3];
+    size_t width = array_width(type);
+    size_t actual_size = 0;
+    if (df1_serial_read_block_addr(df1_serial, addr, (uint8_t*)values, count * width, &actual_size) != 0)
+    {
+        return -1;
+    }
 
-    *value = converter.f;
+    if (width == 2)
+    {
+        df1_le16_to_host(values, (const uint8_t*)values, count);
+    }
+    else
+    {
+        df1_le32_to_host(values, (const uint8_t*)values, count);
+    }
     return 0;
 }
 
-int df1_serial_write_float(df1_serial_t* df1_serial, const char* address, float value)
+// 写入 count 个元素，小端主机直接发送调用者数组
+static int write_array(df1_serial_t* df1_serial, const char* address, const void* values, size_t count,
+                       array_type_t type)
 {
-    if (!df1_serial || !address)
+    if (!df1_serial || !address || !values)
     {
         return -1;
     }
 
-    union {
-        float f;
-        uint8_t bytes[4];
-    } converter;
+    df1_address_t scratch;
+    const df1_address_t* addr = resolve_array(df1_serial, address, type, count, &scratch);
+    if (!addr)
+    {
+        return -1;
+    }
+
+    size_t width = array_width(type);
+#if DF1_HOST_LITTLE_ENDIAN
+    return df1_serial_write_block_addr(df1_serial, addr, (const uint8_t*)values, count * width);
+#else
+    uint8_t* data = (uint8_t*)malloc(count * width);
+    if (!data && count > 0)
+    {
+        return -1;
+    }
+
+    if (width == 2)
+    {
+        df1_host_to_le16(data, values, count);
+    }
+    else
+    {
+        df1_host_to_le32(data, values, count);
+    }
+
+    int result = df1_serial_write_block_addr(df1_serial, addr, data, count * width);
+    free(data);
+    return result;
+#endif
+}
+
+int df1_serial_read_int16(df1_serial_t* df1_serial, const char* address, int16_t* value)
+{
+    return read_array(df1_serial, address, value, 1, ARRAY_WORD);
+}
+
+int df1_serial_write_int16(df1_serial_t* df1_serial, const char* address, int16_t value)
+{
+    return write_array(df1_serial, address, &value, 1, ARRAY_WORD);
+}
+
+int df1_serial_read_float(df1_serial_t* df1_serial, const char* address, float* value)
+{
+    return read_array(df1_serial, address, value, 1, ARRAY_FLOAT);
+}
 
-    converter.f = value;
+int df1_serial_write_float(df1_serial_t* df1_serial, const char* address, float value)
+{
+    return write_array(df1_serial, address, &value, 1, ARRAY_FLOAT);
+}
 
-    return df1_serial_write(df1_serial, address, converter.bytes, sizeof(converter.bytes));
+int df1_serial_read_int16_array(df1_serial_t* df1_serial, const char* address, int16_t* values, size_t count)
+{
+    return read_array(df1_serial, address, values, count, ARRAY_WORD);
+}
+
+int df1_serial_write_int16_array(df1_serial_t* df1_serial, const char* address, const int16_t* values, size_t count)
+{
+    return write_array(df1_serial, address, values, count, ARRAY_WORD);
+}
+
+int df1_serial_read_uint16_array(df1_serial_t* df1_serial, const char* address, uint16_t* values, size_t count)
+{
+    return read_array(df1_serial, address, values, count, ARRAY_WORD);
+}
+
+int df1_serial_write_uint16_array(df1_serial_t* df1_serial, const char* address, const uint16_t* values, size_t count)
+{
+    return write_array(df1_serial, address, values, count, ARRAY_WORD);
+}
+
+int df1_serial_read_int32_array(df1_serial_t* df1_serial, const char* address, int32_t* values, size_t count)
+{
+    return read_array(df1_serial, address, values, count, ARRAY_LONG);
+}
+
+int df1_serial_write_int32_array(df1_serial_t* df1_serial, const char* address, const int32_t* values, size_t count)
+{
+    return write_array(df1_serial, address, values, count, ARRAY_LONG);
+}
+
+int df1_serial_read_float_array(df1_serial_t* df1_serial, const char* address, float* values, size_t count)
+{
+    return read_array(df1_serial, address, values, count, ARRAY_FLOAT);
+}
+
+int df1_serial_write_float_array(df1_serial_t* df1_serial, const char* address, const float* values, size_t count)
+{
+    return write_array(df1_serial, address, values, count, ARRAY_FLOAT);
 }
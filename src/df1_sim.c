@@ -0,0 +1,822 @@
+#define _DEFAULT_SOURCE
+#include "df1_sim.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+
+// 扩展状态：地址不指向可用的数据、长度加地址超出范围
+#define SIM_EXT_NO_ADDRESS 0x06
+#define SIM_EXT_TOO_LARGE 0x0A
+
+// 主站 NAK 后最多重发响应的次数
+#define SIM_MAX_RETRANSMITS 3
+
+typedef struct {
+    df1_addr_type_t type;
+    uint16_t number;
+    uint8_t* data;
+    size_t size;
+} sim_file_t;
+
+// 半双工轮询方式下等待发送的响应
+typedef struct {
+    uint8_t frame[DF1_MAX_FRAME_SIZE];
+    size_t size;
+    long long ready_us;          // 模拟处理延迟：此时间之前的轮询应答 DLE EOT
+} sim_message_t;
+
+typedef struct {
+    uint8_t station;
+    sim_file_t files[DF1_SIM_MAX_FILES];
+    size_t file_count;
+    sim_message_t outbox[DF1_SIM_OUTBOX_SIZE];
+    size_t outbox_head;          // 读取计数
+    size_t outbox_tail;          // 写入计数
+    bool has_last;               // 重复命令检测
+    uint8_t last_src;
+    uint8_t last_cmd;
+    uint16_t last_tns;
+} sim_station_t;
+
+struct df1_sim {
+    df1_sim_config_t config;
+    pthread_mutex_t mutex;       // 保护数据表、统计与故障参数
+    df1_transport_t transport;
+    df1_decoder_t decoder;
+    uint32_t random;             // xorshift32 状态
+    sim_station_t* stations[DF1_SIM_MAX_STATIONS];
+    size_t station_count;
+    df1_sim_stats_t stats;
+
+    // 全双工：最近一次应答的控制字符与等待主站确认的响应
+    uint8_t last_control;
+    uint8_t reply[DF1_MAX_FRAME_SIZE];
+    size_t reply_size;
+    int reply_retries;
+
+    // 半双工：轮询包 DLE ENQ STN BCC 中 DLE ENQ 之后的解析状态
+    int poll_state;              // 0 无，1 等待站号，2 等待BCC
+    bool poll_escape;            // 站号为 DLE 时的转义
+    uint8_t poll_station;
+    sim_station_t* sent_station; // 已发送消息、等待主站确认的从站
+
+    pthread_t thread;
+    bool running;
+    bool stop;
+};
+
+static long long monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t sim_random(df1_sim_t* sim)
+{
+    uint32_t x = sim->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->random = x;
+    return x;
+}
+
+static bool sim_chance(df1_sim_t* sim, double rate)
+{
+    return rate > 0 && (double)sim_random(sim) / 4294967296.0 < rate;
+}
+
+// 本次命令的处理延迟（微秒）
+static long long sim_latency(df1_sim_t* sim)
+{
+    long long latency = sim->config.latency_us > 0 ? sim->config.latency_us : 0;
+    if (sim->config.jitter_us > 0)
+    {
+        latency += sim_random(sim) % ((uint32_t)sim->config.jitter_us + 1);
+    }
+    return latency;
+}
+
+static void sleep_us(long long us)
+{
+    if (us <= 0)
+    {
+        return;
+    }
+    struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+    {
+    }
+}
+
+static sim_station_t* find_station(const df1_sim_t* sim, uint8_t station)
+{
+    for (size_t i = 0; i < sim->station_count; i++)
+    {
+        if (sim->stations[i]->station == station)
+        {
+            return sim->stations[i];
+        }
+    }
+    return NULL;
+}
+
+static sim_file_t* find_file(sim_station_t* st, df1_addr_type_t type, uint16_t number)
+{
+    for (size_t i = 0; i < st->file_count; i++)
+    {
+        if (st->files[i].type == type && st->files[i].number == number)
+        {
+            return &st->files[i];
+        }
+    }
+    return NULL;
+}
+
+// 地址对应的数据区，越界或不存在时返回NULL
+static uint8_t* locate(sim_station_t* st, df1_addr_type_t type, uint16_t number, size_t element, size_t sub_element,
+                       size_t size, uint8_t* ext_sts)
+{
+    sim_file_t* file = find_file(st, type, number);
+    if (!file)
+    {
+        *ext_sts = SIM_EXT_NO_ADDRESS;
+        return NULL;
+    }
+
+    size_t offset = element * df1_address_element_size(type) + sub_element * 2;
+    if (offset + size > file->size)
+    {
+        *ext_sts = SIM_EXT_TOO_LARGE;
+        return NULL;
+    }
+    return file->data + offset;
+}
+
+static void send_all(df1_sim_t* sim, const uint8_t* data, size_t size)
+{
+    size_t sent = 0;
+    while (sent < size)
+    {
+        ssize_t n = df1_transport_send(&sim->transport, data + sent, size - sent);
+        if (n > 0)
+        {
+            sent += (size_t)n;
+        }
+        else if ((n < 0 && errno != EAGAIN && errno != EINTR) ||
+                 df1_transport_wait(&sim->transport, DF1_TRANSPORT_WRITE, 1000) <= 0)
+        {
+            return; // 主站不再接收，丢弃
+        }
+    }
+}
+
+static void send_control(df1_sim_t* sim, uint8_t control)
+{
+    const uint8_t message[2] = {DF1_DLE, control};
+    send_all(sim, message, sizeof(message));
+}
+
+// 解析类型逻辑地址中的一个字段：一个字节，0xFF 后跟两字节小端序
+static bool read_field(const uint8_t* data, size_t length, size_t* pos, size_t* value)
+{
+    if (*pos >= length)
+    {
+        return false;
+    }
+    if (data[*pos] != 0xFF)
+    {
+        *value = data[(*pos)++];
+        return true;
+    }
+    if (*pos + 3 > length)
+    {
+        return false;
+    }
+    *value = (size_t)(data[*pos + 1] | (data[*pos + 2] << 8));
+    *pos += 3;
+    return true;
+}
+
+// 执行命令并生成响应应用层数据，返回响应长度
+static size_t execute(df1_sim_t* sim, sim_station_t* st, const df1_frame_t* frame, uint8_t* pdu)
+{
+    pdu[0] = frame->src;
+    pdu[1] = frame->dst;
+    pdu[2] = (uint8_t)(frame->cmd | 0x40);
+    pdu[3] = 0x00;
+    pdu[4] = (uint8_t)(frame->tns & 0xFF);
+    pdu[5] = (uint8_t)(frame->tns >> 8);
+    sim->stats.commands++;
+
+    const uint8_t* data = frame->data;
+    size_t length = frame->data_length;
+    size_t pos = 2;
+    size_t file = 0;
+    size_t element = 0;
+    size_t sub_element = 0;
+    uint8_t function = length > 0 ? data[0] : 0;
+    bool supported = frame->cmd == 0x0F && length >= 2 &&
+                     (function == DF1_CMD_READ || function == DF1_CMD_WRITE || function == DF1_CMD_MASK_WRITE);
+    if (supported)
+    {
+        supported = read_field(data, length, &pos, &file) && pos < length;
+    }
+    df1_addr_type_t type = supported ? (df1_addr_type_t)data[pos++] : DF1_ADDR_N;
+    if (supported)
+    {
+        supported = read_field(data, length, &pos, &element) && read_field(data, length, &pos, &sub_element);
+    }
+
+    size_t size = supported ? data[1] : 0;
+    size_t payload = function == DF1_CMD_WRITE ? size : (function == DF1_CMD_MASK_WRITE ? 4 : 0);
+    if (!supported || length - pos < payload || (function == DF1_CMD_MASK_WRITE && size != 2))
+    {
+        sim->stats.errors++;
+        pdu[3] = 0x10; // 非法命令或格式
+        return 6;
+    }
+
+    uint8_t ext_sts = 0;
+    uint8_t* target = locate(st, type, (uint16_t)file, element, sub_element, size, &ext_sts);
+    if (!target)
+    {
+        sim->stats.errors++;
+        pdu[3] = 0xF0;
+        pdu[6] = ext_sts;
+        return 7;
+    }
+
+    if (function == DF1_CMD_READ)
+    {
+        memcpy(pdu + 6, target, size);
+        return 6 + size;
+    }
+
+    if (function == DF1_CMD_WRITE)
+    {
+        memcpy(target, data + pos, size);
+    }
+    else
+    {
+        // 只修改掩码中置1的位
+        for (size_t i = 0; i < 2; i++)
+        {
+            uint8_t mask = data[pos + i];
+            target[i] = (uint8_t)((target[i] & ~mask) | (data[pos + 2 + i] & mask));
+        }
+    }
+    return 6;
+}
+
+// 按从站站号封装响应帧
+static size_t build_reply(df1_sim_t* sim, uint8_t station, const uint8_t* pdu, size_t pdu_length, uint8_t* frame)
+{
+    df1_config_t config;
+    df1_config_init(&config, station, 0, 0);
+    config.check_type = sim->config.check_type;
+    config.duplex = sim->config.duplex;
+
+    size_t size = 0;
+    if (df1_build_frame(&config, pdu, pdu_length, frame, DF1_MAX_FRAME_SIZE, &size) != 0)
+    {
+        return 0;
+    }
+    return size;
+}
+
+// 发送响应帧，按概率破坏本次发送的校验字节（重发时重新抽取）
+static void send_reply(df1_sim_t* sim, const uint8_t* frame, size_t size)
+{
+    if (size == 0 || !sim_chance(sim, sim->config.corrupt_rate))
+    {
+        send_all(sim, frame, size);
+        return;
+    }
+
+    // 校验字节不做 DLE 转义，最后一个字节总是校验字节
+    uint8_t copy[DF1_MAX_FRAME_SIZE];
+    memcpy(copy, frame, size);
+    copy[size - 1] ^= 0x5A;
+    sim->stats.corrupted++;
+    send_all(sim, copy, size);
+}
+
+static bool is_duplicate(df1_sim_t* sim, sim_station_t* st, const df1_frame_t* frame)
+{
+    if (st->has_last && st->last_src == frame->src && st->last_cmd == frame->cmd && st->last_tns == frame->tns)
+    {
+        sim->stats.duplicates++;
+        return true;
+    }
+    st->has_last = true;
+    st->last_src = frame->src;
+    st->last_cmd = frame->cmd;
+    st->last_tns = frame->tns;
+    return false;
+}
+
+static void handle_command(df1_sim_t* sim, const df1_frame_t* frame)
+{
+    bool half = sim->config.duplex == DF1_HALF_DUPLEX;
+    sim_station_t* st = find_station(sim, half ? frame->station : frame->dst);
+    if (!st)
+    {
+        return; // 多点线路上其他站的命令
+    }
+
+    if (sim_chance(sim, sim->config.drop_rate))
+    {
+        sim->stats.dropped++;
+        return;
+    }
+    if (sim_chance(sim, sim->config.nak_rate))
+    {
+        sim->stats.naks++;
+        sim->last_control = DF1_NAK;
+        send_control(sim, DF1_NAK);
+        return;
+    }
+
+    if (half && sim->config.polled && st->outbox_tail - st->outbox_head >= DF1_SIM_OUTBOX_SIZE)
+    {
+        send_control(sim, DF1_NAK); // 无法缓存更多响应
+        return;
+    }
+
+    sim->last_control = DF1_ACK;
+    send_control(sim, DF1_ACK);
+    if (is_duplicate(sim, st, frame))
+    {
+        return;
+    }
+
+    uint8_t pdu[DF1_MAX_PDU_SIZE];
+    size_t pdu_length = execute(sim, st, frame, pdu);
+    long long latency = sim_latency(sim);
+
+    if (half && sim->config.polled)
+    {
+        sim_message_t* message = &st->outbox[st->outbox_tail % DF1_SIM_OUTBOX_SIZE];
+        message->size = build_reply(sim, st->station, pdu, pdu_length, message->frame);
+        message->ready_us = monotonic_us() + latency;
+        if (message->size > 0)
+        {
+            st->outbox_tail++;
+        }
+        return;
+    }
+
+    sleep_us(latency);
+    sim->reply_size = build_reply(sim, st->station, pdu, pdu_length, sim->reply);
+    sim->reply_retries = 0;
+    send_reply(sim, sim->reply, sim->reply_size);
+}
+
+// 半双工轮询：发送该从站最早的已就绪响应，没有时应答 DLE EOT
+static void handle_poll(df1_sim_t* sim, uint8_t station)
+{
+    sim_station_t* st = find_station(sim, station);
+    if (!st)
+    {
+        return;
+    }
+
+    sim->stats.polls++;
+    sim_message_t* message = &st->outbox[st->outbox_head % DF1_SIM_OUTBOX_SIZE];
+    if (st->outbox_head == st->outbox_tail || message->ready_us > monotonic_us())
+    {
+        sim->stats.eots++;
+        sim->sent_station = NULL;
+        send_control(sim, DF1_EOT);
+        return;
+    }
+
+    sim->sent_station = st;
+    send_reply(sim, message->frame, message->size);
+}
+
+static void handle_ack(df1_sim_t* sim)
+{
+    if (sim->config.duplex == DF1_FULL_DUPLEX)
+    {
+        sim->reply_size = 0;
+    }
+    else if (sim->sent_station)
+    {
+        sim->sent_station->outbox_head++;
+        sim->sent_station = NULL;
+    }
+}
+
+static void handle_nak(df1_sim_t* sim)
+{
+    // 半双工的响应保留在队首，下一次轮询时重发
+    if (sim->config.duplex == DF1_FULL_DUPLEX && sim->reply_size > 0)
+    {
+        if (sim->reply_retries++ < SIM_MAX_RETRANSMITS)
+        {
+            sim->stats.retransmits++;
+            send_reply(sim, sim->reply, sim->reply_size);
+        }
+        else
+        {
+            sim->reply_size = 0;
+        }
+    }
+    sim->sent_station = NULL;
+}
+
+static void handle_bad_frame(df1_sim_t* sim)
+{
+    sim->stats.bad_frames++;
+
+    // 半双工只应答发给本线路从站的帧
+    if (sim->config.duplex == DF1_FULL_DUPLEX ||
+        (sim->decoder.has_station && find_station(sim, sim->decoder.station)))
+    {
+        sim->last_control = DF1_NAK;
+        send_control(sim, DF1_NAK);
+    }
+}
+
+// 解析 DLE ENQ 之后的站号与BCC，返回消耗的字节数
+static size_t parse_poll(df1_sim_t* sim, const uint8_t* data, size_t length)
+{
+    size_t pos = 0;
+    while (pos < length && sim->poll_state != 0)
+    {
+        uint8_t byte = data[pos++];
+        if (sim->poll_state == 1)
+        {
+            if (byte == DF1_DLE && !sim->poll_escape)
+            {
+                sim->poll_escape = true;
+                continue;
+            }
+            sim->poll_station = byte;
+            sim->poll_state = 2;
+        }
+        else
+        {
+            sim->poll_state = 0;
+            if ((uint8_t)(sim->poll_station + byte) == 0)
+            {
+                handle_poll(sim, sim->poll_station);
+            }
+        }
+    }
+    return pos;
+}
+
+static void sim_input(df1_sim_t* sim, const uint8_t* data, size_t length)
+{
+    size_t pos = 0;
+    while (pos < length)
+    {
+        if (sim->poll_state != 0)
+        {
+            pos += parse_poll(sim, data + pos, length - pos);
+            continue;
+        }
+
+        size_t consumed = 0;
+        df1_frame_t frame;
+        int result = df1_decoder_push(&sim->decoder, data + pos, length - pos, &consumed, &frame);
+        pos += consumed;
+
+        switch (result)
+        {
+        case DF1_DECODE_FRAME:
+            handle_command(sim, &frame);
+            break;
+        case DF1_DECODE_ACK:
+            handle_ack(sim);
+            break;
+        case DF1_DECODE_NAK:
+            handle_nak(sim);
+            break;
+        case DF1_DECODE_ENQ:
+            if (sim->config.duplex == DF1_FULL_DUPLEX)
+            {
+                // 主站没有收到应答，重发最近一次的 ACK/NAK
+                send_control(sim, sim->last_control);
+            }
+            else
+            {
+                sim->poll_state = 1;
+                sim->poll_escape = false;
+            }
+            break;
+        case DF1_DECODE_NEED_MORE:
+        case DF1_DECODE_EOT:
+            break;
+        default:
+            handle_bad_frame(sim);
+            break;
+        }
+    }
+}
+
+// 读取全部可读数据，返回 -1 表示传输层出错或对端关闭
+static int sim_drain(df1_sim_t* sim)
+{
+    uint8_t input[512];
+    for (;;)
+    {
+        struct iovec iov = {input, sizeof(input)};
+        ssize_t n = df1_transport_recv(&sim->transport, &iov, 1);
+        if (n > 0)
+        {
+            pthread_mutex_lock(&sim->mutex);
+            sim_input(sim, input, (size_t)n);
+            pthread_mutex_unlock(&sim->mutex);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            return 0;
+        }
+        return -1;
+    }
+}
+
+static void loopback_handler(void* user_data, df1_transport_t* transport)
+{
+    (void)transport;
+    sim_drain((df1_sim_t*)user_data);
+}
+
+static void* sim_main(void* arg)
+{
+    df1_sim_t* sim = (df1_sim_t*)arg;
+
+    pthread_mutex_lock(&sim->mutex);
+    while (!sim->stop)
+    {
+        pthread_mutex_unlock(&sim->mutex);
+        if (df1_sim_process(sim, 10) != 0)
+        {
+            sleep_us(10000); // 对端已关闭，等待停止
+        }
+        pthread_mutex_lock(&sim->mutex);
+    }
+    pthread_mutex_unlock(&sim->mutex);
+    return NULL;
+}
+
+void df1_sim_config_default(df1_sim_config_t* config)
+{
+    if (!config)
+        return;
+
+    memset(config, 0, sizeof(df1_sim_config_t));
+    config->duplex = DF1_FULL_DUPLEX;
+    config->check_type = DF1_CHECK_CRC16;
+    config->seed = 1;
+}
+
+df1_sim_t* df1_sim_create(const df1_sim_config_t* config)
+{
+    df1_sim_t* sim = (df1_sim_t*)calloc(1, sizeof(df1_sim_t));
+    if (!sim)
+    {
+        return NULL;
+    }
+
+    if (config)
+    {
+        sim->config = *config;
+    }
+    else
+    {
+        df1_sim_config_default(&sim->config);
+    }
+    sim->random = sim->config.seed ? sim->config.seed : 1;
+    sim->last_control = DF1_ACK;
+    df1_transport_init(&sim->transport);
+    df1_decoder_init(&sim->decoder, sim->config.check_type);
+    pthread_mutex_init(&sim->mutex, NULL);
+    return sim;
+}
+
+void df1_sim_destroy(df1_sim_t* sim)
+{
+    if (!sim)
+        return;
+
+    df1_sim_stop(sim);
+    df1_transport_close(&sim->transport);
+
+    for (size_t i = 0; i < sim->station_count; i++)
+    {
+        for (size_t j = 0; j < sim->stations[i]->file_count; j++)
+        {
+            free(sim->stations[i]->files[j].data);
+        }
+        free(sim->stations[i]);
+    }
+    pthread_mutex_destroy(&sim->mutex);
+    free(sim);
+}
+
+int df1_sim_add_station(df1_sim_t* sim, uint8_t station)
+{
+    if (!sim)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sim->mutex);
+    int result = -1;
+    if (sim->station_count < DF1_SIM_MAX_STATIONS && !find_station(sim, station))
+    {
+        sim_station_t* st = (sim_station_t*)calloc(1, sizeof(sim_station_t));
+        if (st)
+        {
+            st->station = station;
+            sim->stations[sim->station_count++] = st;
+            result = 0;
+        }
+    }
+    pthread_mutex_unlock(&sim->mutex);
+    return result;
+}
+
+int df1_sim_add_file(df1_sim_t* sim, uint8_t station, df1_addr_type_t type, uint16_t file, size_t elements)
+{
+    size_t element_size = df1_address_element_size(type);
+    if (!sim || element_size == 0 || elements == 0)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sim->mutex);
+    int result = -1;
+    sim_station_t* st = find_station(sim, station);
+    if (st && st->file_count < DF1_SIM_MAX_FILES && !find_file(st, type, file))
+    {
+        uint8_t* data = (uint8_t*)calloc(elements, element_size);
+        if (data)
+        {
+            sim_file_t* entry = &st->files[st->file_count++];
+            entry->type = type;
+            entry->number = file;
+            entry->data = data;
+            entry->size = elements * element_size;
+            result = 0;
+        }
+    }
+    pthread_mutex_unlock(&sim->mutex);
+    return result;
+}
+
+// 按地址字符串访问数据表，write 为真时写入
+static int access_table(df1_sim_t* sim, uint8_t station, const char* address, uint8_t* data, size_t size,
+                        bool write)
+{
+    df1_address_t addr;
+    if (!sim || !data || size == 0 || df1_address_parse(address, &addr) != 0)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sim->mutex);
+    sim_station_t* st = find_station(sim, station);
+    uint8_t ext_sts;
+    uint8_t* target = st ? locate(st, addr.data_code, addr.db_block, addr.address_start, addr.sub_element, size,
+                                  &ext_sts)
+                         : NULL;
+    if (target && write)
+    {
+        memcpy(target, data, size);
+    }
+    else if (target)
+    {
+        memcpy(data, target, size);
+    }
+    pthread_mutex_unlock(&sim->mutex);
+    return target ? 0 : -1;
+}
+
+int df1_sim_get(df1_sim_t* sim, uint8_t station, const char* address, uint8_t* data, size_t size)
+{
+    return access_table(sim, station, address, data, size, false);
+}
+
+int df1_sim_set(df1_sim_t* sim, uint8_t station, const char* address, const uint8_t* data, size_t size)
+{
+    return access_table(sim, station, address, (uint8_t*)data, size, true);
+}
+
+void df1_sim_set_faults(df1_sim_t* sim, const df1_sim_config_t* config)
+{
+    if (!sim || !config)
+        return;
+
+    pthread_mutex_lock(&sim->mutex);
+    sim->config.latency_us = config->latency_us;
+    sim->config.jitter_us = config->jitter_us;
+    sim->config.drop_rate = config->drop_rate;
+    sim->config.nak_rate = config->nak_rate;
+    sim->config.corrupt_rate = config->corrupt_rate;
+    pthread_mutex_unlock(&sim->mutex);
+}
+
+int df1_sim_attach(df1_sim_t* sim, const df1_transport_t* transport)
+{
+    if (!sim || !transport || !transport->ops || sim->transport.ops)
+    {
+        return -1;
+    }
+
+    sim->transport = *transport;
+    return 0;
+}
+
+int df1_sim_open_pty(df1_sim_t* sim)
+{
+    if (!sim || sim->transport.ops)
+    {
+        return -1;
+    }
+
+    df1_serial_config_t config;
+    memset(&config, 0, sizeof(config));
+    return df1_transport_open(&sim->transport, &df1_transport_pty, &config);
+}
+
+int df1_sim_open_loopback(df1_sim_t* sim, df1_transport_t* master)
+{
+    if (!sim || !master || sim->transport.ops)
+    {
+        return -1;
+    }
+
+    if (df1_transport_loopback_pair(master, &sim->transport) != 0)
+    {
+        return -1;
+    }
+    return df1_transport_loopback_set_handler(&sim->transport, loopback_handler, sim);
+}
+
+const char* df1_sim_port_name(const df1_sim_t* sim)
+{
+    return sim ? df1_transport_pty_name(&sim->transport) : NULL;
+}
+
+int df1_sim_process(df1_sim_t* sim, int timeout_ms)
+{
+    if (!sim || !sim->transport.ops)
+    {
+        return -1;
+    }
+
+    int ready = df1_transport_wait(&sim->transport, DF1_TRANSPORT_READ, timeout_ms);
+    if (ready < 0)
+    {
+        return -1;
+    }
+    return ready > 0 ? sim_drain(sim) : 0;
+}
+
+int df1_sim_start(df1_sim_t* sim)
+{
+    if (!sim || !sim->transport.ops || sim->running)
+    {
+        return -1;
+    }
+
+    sim->stop = false;
+    if (pthread_create(&sim->thread, NULL, sim_main, sim) != 0)
+    {
+        return -1;
+    }
+    sim->running = true;
+    return 0;
+}
+
+void df1_sim_stop(df1_sim_t* sim)
+{
+    if (!sim || !sim->running)
+        return;
+
+    pthread_mutex_lock(&sim->mutex);
+    sim->stop = true;
+    pthread_mutex_unlock(&sim->mutex);
+    pthread_join(sim->thread, NULL);
+    sim->running = false;
+}
+
+void df1_sim_get_stats(df1_sim_t* sim, df1_sim_stats_t* stats)
+{
+    if (!sim || !stats)
+        return;
+
+    pthread_mutex_lock(&sim->mutex);
+    *stats = sim->stats;
+    pthread_mutex_unlock(&sim->mutex);
+}
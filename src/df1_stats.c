@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 200809L
+#include "df1_stats.h"
+#include <string.h>
+#include <time.h>
+
+static const char* const phase_names[DF1_PHASE_COUNT] = {
+    "encode", "transmit", "first_byte", "frame", "decode", "total",
+};
+
+void df1_stats_reset(df1_stats_t* stats)
+{
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(df1_stats_t));
+}
+
+static uint64_t load_relaxed(const uint64_t* value)
+{
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+static void histogram_snapshot(df1_histogram_t* dst, const df1_histogram_t* src)
+{
+    dst->count = load_relaxed(&src->count);
+    dst->sum_ns = load_relaxed(&src->sum_ns);
+    dst->min_ns = load_relaxed(&src->min_ns);
+    dst->max_ns = load_relaxed(&src->max_ns);
+    for (size_t i = 0; i < DF1_HISTOGRAM_BUCKETS; i++)
+    {
+        dst->buckets[i] = load_relaxed(&src->buckets[i]);
+    }
+}
+
+void df1_stats_snapshot(df1_stats_t* dst, const df1_stats_t* src)
+{
+    if (!dst || !src)
+        return;
+
+    dst->transactions = load_relaxed(&src->transactions);
+    dst->errors = load_relaxed(&src->errors);
+    dst->bytes_sent = load_relaxed(&src->bytes_sent);
+    dst->bytes_received = load_relaxed(&src->bytes_received);
+    dst->crc_errors = load_relaxed(&src->crc_errors);
+    dst->naks_received = load_relaxed(&src->naks_received);
+    dst->naks_sent = load_relaxed(&src->naks_sent);
+    dst->timeouts = load_relaxed(&src->timeouts);
+    dst->retries = load_relaxed(&src->retries);
+    for (int i = 0; i < DF1_PHASE_COUNT; i++)
+    {
+        histogram_snapshot(&dst->phases[i], &src->phases[i]);
+    }
+    dst->tx_start_ns = 0;
+    dst->awaiting_ns = 0;
+    dst->first_byte_ns = 0;
+}
+
+uint64_t df1_stats_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// 值所在的区间：最高位决定2的幂区间，其后 DF1_HISTOGRAM_SUB_BITS 位决定子区间
+static size_t bucket_index(uint64_t value)
+{
+    if (value < DF1_HISTOGRAM_SUB_BUCKETS)
+    {
+        return (size_t)value;
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+    if (msb > DF1_HISTOGRAM_MAX_BITS)
+    {
+        return DF1_HISTOGRAM_BUCKETS - 1;
+    }
+    int shift = msb - DF1_HISTOGRAM_SUB_BITS;
+    return (size_t)(shift + 1) * DF1_HISTOGRAM_SUB_BUCKETS + (size_t)((value >> shift) - DF1_HISTOGRAM_SUB_BUCKETS);
+}
+
+// 区间的上界（含）
+static uint64_t bucket_upper(size_t index)
+{
+    if (index < DF1_HISTOGRAM_SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    int shift = (int)(index / DF1_HISTOGRAM_SUB_BUCKETS) - 1;
+    uint64_t lower = (uint64_t)(DF1_HISTOGRAM_SUB_BUCKETS + index % DF1_HISTOGRAM_SUB_BUCKETS) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+void df1_histogram_record(df1_histogram_t* histogram, uint64_t value_ns)
+{
+    if (!histogram)
+        return;
+
+    uint64_t count = __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+    if (count == 0 || value_ns < __atomic_load_n(&histogram->min_ns, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&histogram->min_ns, value_ns, __ATOMIC_RELAXED);
+    }
+    if (value_ns > __atomic_load_n(&histogram->max_ns, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&histogram->max_ns, value_ns, __ATOMIC_RELAXED);
+    }
+    df1_stats_add(&histogram->buckets[bucket_index(value_ns)], 1);
+    df1_stats_add(&histogram->sum_ns, value_ns);
+    __atomic_store_n(&histogram->count, count + 1, __ATOMIC_RELAXED);
+}
+
+uint64_t df1_histogram_percentile(const df1_histogram_t* histogram, double quantile)
+{
+    if (!histogram || histogram->count == 0)
+    {
+        return 0;
+    }
+
+    if (quantile < 0.0)
+    {
+        quantile = 0.0;
+    }
+    if (quantile > 1.0)
+    {
+        quantile = 1.0;
+    }
+
+    // 第 rank 个样本（从1开始）所在的区间
+    uint64_t rank = (uint64_t)(quantile * (double)histogram->count + 0.5);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < DF1_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            if (i == DF1_HISTOGRAM_BUCKETS - 1)
+            {
+                return histogram->max_ns; // 超出范围的区间没有上界
+            }
+            uint64_t upper = bucket_upper(i);
+            return upper < histogram->max_ns ? upper : histogram->max_ns;
+        }
+    }
+    return histogram->max_ns;
+}
+
+double df1_histogram_mean(const df1_histogram_t* histogram)
+{
+    if (!histogram || histogram->count == 0)
+    {
+        return 0.0;
+    }
+    return (double)histogram->sum_ns / (double)histogram->count;
+}
+
+const char* df1_phase_name(df1_phase_t phase)
+{
+    if ((int)phase < 0 || phase >= DF1_PHASE_COUNT)
+    {
+        return "unknown";
+    }
+    return phase_names[phase];
+}
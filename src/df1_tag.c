@@ -0,0 +1,219 @@
+#include "df1_tag.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 条目按块分配，扩容时不移动已有条目，保证地址指针长期有效
+#define TAG_BLOCK_SHIFT 8
+#define TAG_BLOCK_SIZE (1u << TAG_BLOCK_SHIFT)
+#define TAG_BLOCK_MASK (TAG_BLOCK_SIZE - 1)
+
+typedef struct {
+    df1_address_t addr; // 解析后的地址
+    uint32_t hash;      // 字符串哈希
+    char* name;         // 原始地址字符串
+} tag_entry_t;
+
+struct df1_tag_table {
+    tag_entry_t** blocks; // 条目块数组
+    size_t block_count;   // 已分配的块数
+    size_t count;         // 条目数量
+    size_t limit;         // 条目数量上限
+    int32_t* slots;       // 开放寻址哈希槽，存放句柄，-1 表示空
+    size_t slot_mask;     // 槽数量减一（槽数量为2的幂）
+};
+
+// FNV-1a 哈希
+static uint32_t hash_string(const char* str, size_t* length)
+{
+    uint32_t hash = 2166136261u;
+    const char* p = str;
+    while (*p)
+    {
+        hash ^= (uint8_t)*p++;
+        hash *= 16777619u;
+    }
+    *length = (size_t)(p - str);
+    return hash;
+}
+
+static tag_entry_t* entry_at(const df1_tag_table_t* table, df1_tag_t tag)
+{
+    return &table->blocks[(size_t)tag >> TAG_BLOCK_SHIFT][(size_t)tag & TAG_BLOCK_MASK];
+}
+
+static int rehash(df1_tag_table_t* table, size_t slot_count)
+{
+    int32_t* slots = (int32_t*)malloc(slot_count * sizeof(int32_t));
+    if (!slots)
+    {
+        return -1;
+    }
+    memset(slots, 0xFF, slot_count * sizeof(int32_t));
+
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < table->count; i++)
+    {
+        size_t slot = entry_at(table, (df1_tag_t)i)->hash & mask;
+        while (slots[slot] >= 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = (int32_t)i;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->slot_mask = mask;
+    return 0;
+}
+
+df1_tag_table_t* df1_tag_table_create(size_t limit)
+{
+    df1_tag_table_t* table = (df1_tag_table_t*)malloc(sizeof(df1_tag_table_t));
+    if (!table)
+    {
+        return NULL;
+    }
+
+    memset(table, 0, sizeof(df1_tag_table_t));
+    table->limit = limit ? limit : DF1_TAG_TABLE_DEFAULT_LIMIT;
+
+    if (rehash(table, 64) != 0)
+    {
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+void df1_tag_table_destroy(df1_tag_table_t* table)
+{
+    if (!table)
+        return;
+
+    for (size_t i = 0; i < table->count; i++)
+    {
+        free(entry_at(table, (df1_tag_t)i)->name);
+    }
+    for (size_t i = 0; i < table->block_count; i++)
+    {
+        free(table->blocks[i]);
+    }
+    free(table->blocks);
+    free(table->slots);
+    free(table);
+}
+
+df1_tag_t df1_tag_table_intern(df1_tag_table_t* table, const char* address_str)
+{
+    if (!table || !address_str)
+    {
+        return DF1_TAG_INVALID;
+    }
+
+    size_t length;
+    uint32_t hash = hash_string(address_str, &length);
+
+    // 查找已有条目
+    size_t slot = hash & table->slot_mask;
+    while (table->slots[slot] >= 0)
+    {
+        tag_entry_t* entry = entry_at(table, table->slots[slot]);
+        if (entry->hash == hash && strcmp(entry->name, address_str) == 0)
+        {
+            return table->slots[slot];
+        }
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    if (table->count >= table->limit)
+    {
+        return DF1_TAG_INVALID; // 标签表已满
+    }
+
+    df1_address_t addr;
+    if (df1_address_parse(address_str, &addr) != 0)
+    {
+        return DF1_TAG_INVALID;
+    }
+
+    // 分配新块
+    size_t block = table->count >> TAG_BLOCK_SHIFT;
+    if (block >= table->block_count)
+    {
+        tag_entry_t** blocks = (tag_entry_t**)realloc(table->blocks, (block + 1) * sizeof(tag_entry_t*));
+        if (!blocks)
+        {
+            return DF1_TAG_INVALID;
+        }
+        table->blocks = blocks;
+        table->blocks[block] = (tag_entry_t*)malloc(TAG_BLOCK_SIZE * sizeof(tag_entry_t));
+        if (!table->blocks[block])
+        {
+            return DF1_TAG_INVALID;
+        }
+        table->block_count = block + 1;
+    }
+
+    // 负载因子超过1/2时扩容，扩容后重新定位空槽
+    if ((table->count + 1) * 2 > table->slot_mask + 1)
+    {
+        if (rehash(table, (table->slot_mask + 1) * 2) != 0)
+        {
+            return DF1_TAG_INVALID;
+        }
+        slot = hash & table->slot_mask;
+        while (table->slots[slot] >= 0)
+        {
+            slot = (slot + 1) & table->slot_mask;
+        }
+    }
+
+    char* name = (char*)malloc(length + 1);
+    if (!name)
+    {
+        return DF1_TAG_INVALID;
+    }
+    memcpy(name, address_str, length + 1);
+
+    df1_tag_t tag = (df1_tag_t)table->count;
+    tag_entry_t* entry = entry_at(table, tag);
+    entry->addr = addr;
+    entry->hash = hash;
+    entry->name = name;
+    table->slots[slot] = tag;
+    table->count++;
+
+    return tag;
+}
+
+const df1_address_t* df1_tag_table_lookup(df1_tag_table_t* table, const char* address_str)
+{
+    return df1_tag_table_get(table, df1_tag_table_intern(table, address_str));
+}
+
+const df1_address_t* df1_tag_table_get(const df1_tag_table_t* table, df1_tag_t tag)
+{
+    if (!table || tag < 0 || (size_t)tag >= table->count)
+    {
+        return NULL;
+    }
+
+    return &entry_at(table, tag)->addr;
+}
+
+const char* df1_tag_table_name(const df1_tag_table_t* table, df1_tag_t tag)
+{
+    if (!table || tag < 0 || (size_t)tag >= table->count)
+    {
+        return NULL;
+    }
+
+    return entry_at(table, tag)->name;
+}
+
+size_t df1_tag_table_count(const df1_tag_table_t* table)
+{
+    return table ? table->count : 0;
+}
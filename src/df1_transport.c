@@ -0,0 +1,934 @@
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include "df1_transport.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+void df1_transport_init(df1_transport_t* transport)
+{
+    if (!transport)
+        return;
+
+    memset(transport, 0, sizeof(df1_transport_t));
+    transport->fd = -1;
+    transport->vmin = -1;
+}
+
+// 文件描述符后端的公共部分
+
+static ssize_t fd_send(df1_transport_t* transport, const uint8_t* data, size_t size)
+{
+    return write(transport->fd, data, size);
+}
+
+static ssize_t fd_recv(df1_transport_t* transport, const struct iovec* iov, int count)
+{
+    return readv(transport->fd, iov, count);
+}
+
+static int fd_wait(df1_transport_t* transport, int events, int timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = transport->fd;
+    pfd.events = (short)(((events & DF1_TRANSPORT_READ) ? POLLIN : 0) | ((events & DF1_TRANSPORT_WRITE) ? POLLOUT : 0));
+    pfd.revents = 0;
+
+    int result = poll(&pfd, 1, timeout_ms);
+    if (result > 0)
+    {
+        return (pfd.revents & (POLLERR | POLLNVAL)) ? -1 : 1;
+    }
+    if (result < 0 && errno != EINTR)
+    {
+        return -1;
+    }
+    return 0; // 超时或被信号打断，由调用者按剩余时间重新等待
+}
+
+static void fd_close(df1_transport_t* transport)
+{
+    if (transport->fd >= 0)
+    {
+        close(transport->fd);
+    }
+}
+
+// 终端设备
+
+// 标准波特率对应的常量，不是标准值时返回 B0
+static speed_t standard_baud(int baud_rate)
+{
+    switch (baud_rate)
+    {
+    case 1200:
+        return B1200;
+    case 2400:
+        return B2400;
+    case 4800:
+        return B4800;
+    case 9600:
+        return B9600;
+    case 19200:
+        return B19200;
+    case 38400:
+        return B38400;
+    case 57600:
+        return B57600;
+    case 115200:
+        return B115200;
+#ifdef B230400
+    case 230400:
+        return B230400;
+#endif
+#ifdef B460800
+    case 460800:
+        return B460800;
+#endif
+#ifdef B921600
+    case 921600:
+        return B921600;
+#endif
+    default:
+        return B0;
+    }
+}
+
+// termios2 在 glibc 中没有声明，按 asm-generic 的布局定义（x86、ARM、RISC-V 等），
+// 其他布局不同的体系结构上不支持任意波特率
+#if defined(__linux__) && defined(TCGETS2) && !defined(__mips__) && !defined(__powerpc__) && !defined(__sparc__) && \
+    !defined(__alpha__)
+#define DF1_HAVE_TERMIOS2 1
+#define DF1_BOTHER 0010000
+#define DF1_KERNEL_NCCS 19
+
+struct termios2 {
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[DF1_KERNEL_NCCS];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+
+// 在其他参数已经设置好之后，把收发波特率改为任意值
+static int set_custom_baud(int fd, int baud_rate)
+{
+    struct termios2 options;
+    if (ioctl(fd, TCGETS2, &options) != 0)
+    {
+        return -1;
+    }
+    options.c_cflag &= ~(tcflag_t)CBAUD;
+    options.c_cflag |= DF1_BOTHER;
+    options.c_ispeed = (speed_t)baud_rate;
+    options.c_ospeed = (speed_t)baud_rate;
+    return ioctl(fd, TCSETS2, &options);
+}
+#endif
+
+// 内核低延迟标志：USB 转串口驱动收到数据后立即上交，不等待延迟定时器。驱动不支持时忽略
+static void set_low_latency(int fd)
+{
+#ifdef ASYNC_LOW_LATENCY
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0)
+    {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(fd, TIOCSSERIAL, &serial);
+    }
+#else
+    (void)fd;
+#endif
+}
+
+// 由驱动在发送期间置 RTS 有效，发送结束后释放，省去应用层切换方向与等待发送完成
+static int set_rs485(int fd, const df1_serial_config_t* config)
+{
+#ifdef TIOCSRS485
+    struct serial_rs485 rs485;
+    memset(&rs485, 0, sizeof(rs485));
+    rs485.flags = SER_RS485_ENABLED | SER_RS485_RTS_ON_SEND;
+    rs485.delay_rts_before_send = (uint32_t)(config->rs485_delay_before_ms > 0 ? config->rs485_delay_before_ms : 0);
+    rs485.delay_rts_after_send = (uint32_t)(config->rs485_delay_after_ms > 0 ? config->rs485_delay_after_ms : 0);
+    return ioctl(fd, TIOCSRS485, &rs485);
+#else
+    (void)fd;
+    (void)config;
+    return -1;
+#endif
+}
+
+static int configure_serial_port(int fd, const df1_serial_config_t* config)
+{
+    struct termios options;
+
+    if (tcgetattr(fd, &options) != 0)
+    {
+        return -1;
+    }
+
+    // 设置波特率：标准值直接设置，其他值先占位，其余参数设置完成后经 termios2 设置
+    speed_t baud = standard_baud(config->baud_rate);
+    if (baud == B0)
+    {
+#ifdef DF1_HAVE_TERMIOS2
+        if (config->baud_rate <= 0)
+        {
+            return -1;
+        }
+        baud = B38400;
+#else
+        return -1;
+#endif
+    }
+
+    cfsetispeed(&options, baud);
+    cfsetospeed(&options, baud);
+
+    // 设置数据位
+    options.c_cflag &= ~CSIZE;
+    switch (config->data_bits)
+    {
+    case 7:
+        options.c_cflag |= CS7;
+        break;
+    case 8:
+        options.c_cflag |= CS8;
+        break;
+    default:
+        return -1;
+    }
+
+    // 设置停止位
+    if (config->stop_bits == 1)
+    {
+        options.c_cflag &= ~CSTOPB;
+    }
+    else if (config->stop_bits == 2)
+    {
+        options.c_cflag |= CSTOPB;
+    }
+    else
+    {
+        return -1;
+    }
+
+    // 设置校验位
+    switch (config->parity)
+    {
+    case 0: // None
+        options.c_cflag &= ~PARENB;
+        break;
+    case 1: // Odd
+        options.c_cflag |= PARENB;
+        options.c_cflag |= PARODD;
+        break;
+    case 2: // Even
+        options.c_cflag |= PARENB;
+        options.c_cflag &= ~PARODD;
+        break;
+    default:
+        return -1;
+    }
+
+    // 其他设置
+    options.c_cflag |= (CLOCAL | CREAD);
+    options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG | IEXTEN);
+    options.c_iflag &= ~(IXON | IXOFF | IXANY);
+    // 二进制帧：不做回车换行转换、不剥离第8位、不标记校验错误
+    options.c_iflag &= ~(ICRNL | INLCR | IGNCR | ISTRIP | BRKINT | PARMRK | IGNBRK);
+    options.c_oflag &= ~OPOST;
+
+    // 超时由接收循环的整体截止时间控制。VTIME为0时，poll 在缓冲区中
+    // 至少有 VMIN 个字节时才返回，接收循环据此按帧的剩余长度设置 VMIN，
+    // 一帧通常只需唤醒一次
+    options.c_cc[VMIN] = 1;
+    options.c_cc[VTIME] = 0;
+
+    if (tcsetattr(fd, TCSANOW, &options) != 0)
+    {
+        return -1;
+    }
+#ifdef DF1_HAVE_TERMIOS2
+    if (standard_baud(config->baud_rate) == B0 && set_custom_baud(fd, config->baud_rate) != 0)
+    {
+        return -1;
+    }
+#endif
+
+    if (config->low_latency)
+    {
+        set_low_latency(fd);
+    }
+    if (config->rs485 && set_rs485(fd, config) != 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static int serial_open(df1_transport_t* transport, const df1_serial_config_t* config)
+{
+    int fd = open(config->port_name, O_RDWR | O_NOCTTY | O_NDELAY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (configure_serial_port(fd, config) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    transport->fd = fd;
+    transport->vmin = isatty(fd) ? 1 : -1;
+    transport->drain = config->drain;
+    return 0;
+}
+
+// 需要时等到写入的字节全部移出串口再返回，之后开始计时的应答等待不包含发送时间
+static ssize_t serial_send(df1_transport_t* transport, const uint8_t* data, size_t size)
+{
+    ssize_t written = write(transport->fd, data, size);
+    if (written > 0 && transport->drain)
+    {
+        while (tcdrain(transport->fd) != 0)
+        {
+            if (errno != EINTR)
+            {
+                // 无法确认数据已发出（如设备已拔出），按写入失败处理
+                return -1;
+            }
+        }
+    }
+    return written;
+}
+
+static ssize_t serial_recv(df1_transport_t* transport, const struct iovec* iov, int count)
+{
+    ssize_t received = readv(transport->fd, iov, count);
+    if (received == 0 && transport->vmin >= 0)
+    {
+        // 终端设备读到0字节只表示暂时没有数据
+        errno = EAGAIN;
+        return -1;
+    }
+    return received;
+}
+
+// 仅在变化时调整 VMIN，避免每次等待都产生一次 tcsetattr
+static int serial_set_min_read(df1_transport_t* transport, size_t size)
+{
+    int vmin = size > 255 ? 255 : (int)size;
+    if (transport->vmin < 0 || transport->vmin == vmin)
+    {
+        return 0;
+    }
+
+    struct termios options;
+    if (tcgetattr(transport->fd, &options) != 0)
+    {
+        return -1;
+    }
+    options.c_cc[VMIN] = (cc_t)vmin;
+    options.c_cc[VTIME] = 0;
+    if (tcsetattr(transport->fd, TCSANOW, &options) != 0)
+    {
+        return -1;
+    }
+    transport->vmin = vmin;
+    return 0;
+}
+
+const df1_transport_ops_t df1_transport_serial = {
+    "serial", serial_open, serial_send, serial_recv, fd_wait, serial_set_min_read, fd_close,
+};
+
+// TCP
+
+// 拆分 "tcp://主机:端口"，主机可以是方括号括起的 IPv6 地址
+static int split_host_port(const char* name, char* host, size_t host_size, char* port, size_t port_size)
+{
+    size_t prefix = strlen(DF1_TCP_PREFIX);
+    if (strncmp(name, DF1_TCP_PREFIX, prefix) != 0)
+    {
+        return -1;
+    }
+    name += prefix;
+
+    const char* host_end;
+    const char* colon;
+    if (*name == '[')
+    {
+        name++;
+        host_end = strchr(name, ']');
+        if (!host_end || host_end[1] != ':')
+        {
+            return -1;
+        }
+        colon = host_end + 1;
+    }
+    else
+    {
+        colon = strrchr(name, ':');
+        host_end = colon;
+    }
+
+    if (!colon || host_end == name || colon[1] == '\0')
+    {
+        return -1;
+    }
+
+    size_t host_len = (size_t)(host_end - name);
+    size_t port_len = strlen(colon + 1);
+    if (host_len >= host_size || port_len >= port_size)
+    {
+        return -1;
+    }
+    memcpy(host, name, host_len);
+    host[host_len] = '\0';
+    memcpy(port, colon + 1, port_len + 1);
+    return 0;
+}
+
+// 非阻塞连接，在超时时间内等待连接完成
+static int connect_with_timeout(int fd, const struct sockaddr* addr, socklen_t addr_len, int timeout_ms)
+{
+    if (connect(fd, addr, addr_len) == 0)
+    {
+        return 0;
+    }
+    if (errno != EINPROGRESS)
+    {
+        return -1;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int result;
+    do
+    {
+        result = poll(&pfd, 1, timeout_ms);
+    } while (result < 0 && errno == EINTR);
+    if (result <= 0)
+    {
+        return -1;
+    }
+
+    int error = 0;
+    socklen_t error_len = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_len) != 0 || error != 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static int tcp_open(df1_transport_t* transport, const df1_serial_config_t* config)
+{
+    char host[64];
+    char port[16];
+    if (split_host_port(config->port_name, host, sizeof(host), port, sizeof(port)) != 0)
+    {
+        return -1;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* list;
+    if (getaddrinfo(host, port, &hints, &list) != 0)
+    {
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo* ai = list; ai; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (connect_with_timeout(fd, ai->ai_addr, ai->ai_addrlen, config->timeout_ms) == 0)
+        {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(list);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // 命令帧很短，不等待合并
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    transport->fd = fd;
+    transport->vmin = -1;
+    return 0;
+}
+
+static ssize_t tcp_send(df1_transport_t* transport, const uint8_t* data, size_t size)
+{
+    // 对端关闭时返回 EPIPE 而不是产生 SIGPIPE
+    return send(transport->fd, data, size, MSG_NOSIGNAL);
+}
+
+const df1_transport_ops_t df1_transport_tcp = {
+    "tcp", tcp_open, tcp_send, fd_recv, fd_wait, NULL, fd_close,
+};
+
+// 伪终端主设备
+
+static int pty_open(df1_transport_t* transport, const df1_serial_config_t* config)
+{
+    (void)config;
+
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct termios options;
+    char* name = NULL;
+    if (grantpt(fd) != 0 || unlockpt(fd) != 0 || tcgetattr(fd, &options) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // 线路规程在两端共享，设置为原始模式后从设备一侧打开前发送的数据也不会被回显或转换
+    cfmakeraw(&options);
+    const char* slave = ptsname(fd);
+    if (tcsetattr(fd, TCSANOW, &options) != 0 || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0 ||
+        !slave || !(name = strdup(slave)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    transport->fd = fd;
+    transport->vmin = -1;
+    transport->context = name;
+    return 0;
+}
+
+static ssize_t pty_recv(df1_transport_t* transport, const struct iovec* iov, int count)
+{
+    ssize_t received = readv(transport->fd, iov, count);
+    if (received < 0 && errno == EIO)
+    {
+        // 从设备一侧尚未打开或已关闭，可以重新打开
+        errno = EAGAIN;
+    }
+    return received;
+}
+
+static int pty_wait(df1_transport_t* transport, int events, int timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = transport->fd;
+    pfd.events = (short)(((events & DF1_TRANSPORT_READ) ? POLLIN : 0) | ((events & DF1_TRANSPORT_WRITE) ? POLLOUT : 0));
+    pfd.revents = 0;
+
+    int result = poll(&pfd, 1, timeout_ms);
+    if (result > 0 && (pfd.revents & (POLLERR | POLLNVAL)))
+    {
+        return -1;
+    }
+    if (result > 0 && (pfd.revents & pfd.events))
+    {
+        return 1;
+    }
+    if (result > 0)
+    {
+        // 只有 POLLHUP：从设备一侧没有打开，poll 会立即返回，稍等后按超时处理
+        struct timespec pause = {0, 1000000L * (timeout_ms < 10 ? timeout_ms : 10)};
+        nanosleep(&pause, NULL);
+        return 0;
+    }
+    return result < 0 && errno != EINTR ? -1 : 0;
+}
+
+static void pty_close(df1_transport_t* transport)
+{
+    fd_close(transport);
+    free(transport->context);
+}
+
+const df1_transport_ops_t df1_transport_pty = {
+    "pty", pty_open, fd_send, pty_recv, pty_wait, NULL, pty_close,
+};
+
+// 内存回环
+
+typedef struct loopback_channel loopback_channel_t;
+
+// 回环的一端，inbox 为发往该端的数据
+typedef struct {
+    loopback_channel_t* channel;
+    int index;
+    bool closed;
+    bool in_handler;             // 正在执行处理函数，避免重入
+    df1_loopback_handler_t handler;
+    void* user_data;
+    df1_transport_t* transport;  // 调用处理函数时传入
+    uint8_t inbox[DF1_LOOPBACK_BUFFER_SIZE];
+    size_t head;                 // 写入计数
+    size_t tail;                 // 读取计数
+} loopback_end_t;
+
+struct loopback_channel {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;         // 任一端的缓冲区或关闭状态变化
+    loopback_end_t ends[2];
+    int refs;
+};
+
+static loopback_end_t* loopback_peer(loopback_end_t* end)
+{
+    return &end->channel->ends[1 - end->index];
+}
+
+static bool loopback_ready(loopback_end_t* end, int events)
+{
+    loopback_end_t* peer = loopback_peer(end);
+    if ((events & DF1_TRANSPORT_READ) && (end->head != end->tail || peer->closed))
+    {
+        return true;
+    }
+    if ((events & DF1_TRANSPORT_WRITE) && (peer->head - peer->tail < DF1_LOOPBACK_BUFFER_SIZE || peer->closed))
+    {
+        return true;
+    }
+    return false;
+}
+
+static ssize_t loopback_send(df1_transport_t* transport, const uint8_t* data, size_t size)
+{
+    loopback_end_t* end = (loopback_end_t*)transport->context;
+    loopback_channel_t* channel = end->channel;
+    loopback_end_t* peer = loopback_peer(end);
+
+    pthread_mutex_lock(&channel->mutex);
+    if (peer->closed)
+    {
+        pthread_mutex_unlock(&channel->mutex);
+        errno = EPIPE;
+        return -1;
+    }
+
+    size_t space = DF1_LOOPBACK_BUFFER_SIZE - (peer->head - peer->tail);
+    size_t count = size < space ? size : space;
+    for (size_t i = 0; i < count; i++)
+    {
+        peer->inbox[(peer->head + i) % DF1_LOOPBACK_BUFFER_SIZE] = data[i];
+    }
+    peer->head += count;
+
+    df1_loopback_handler_t handler = NULL;
+    if (count > 0)
+    {
+        pthread_cond_broadcast(&channel->cond);
+        if (peer->handler && !peer->in_handler)
+        {
+            handler = peer->handler;
+            peer->in_handler = true;
+        }
+    }
+    pthread_mutex_unlock(&channel->mutex);
+
+    if (handler)
+    {
+        handler(peer->user_data, peer->transport);
+        pthread_mutex_lock(&channel->mutex);
+        peer->in_handler = false;
+        pthread_mutex_unlock(&channel->mutex);
+    }
+
+    if (count == 0)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+    return (ssize_t)count;
+}
+
+static ssize_t loopback_recv(df1_transport_t* transport, const struct iovec* iov, int count)
+{
+    loopback_end_t* end = (loopback_end_t*)transport->context;
+    loopback_channel_t* channel = end->channel;
+
+    pthread_mutex_lock(&channel->mutex);
+    size_t received = 0;
+    for (int i = 0; i < count && end->tail != end->head; i++)
+    {
+        uint8_t* buffer = (uint8_t*)iov[i].iov_base;
+        size_t n = end->head - end->tail;
+        if (n > iov[i].iov_len)
+        {
+            n = iov[i].iov_len;
+        }
+        for (size_t j = 0; j < n; j++)
+        {
+            buffer[j] = end->inbox[(end->tail + j) % DF1_LOOPBACK_BUFFER_SIZE];
+        }
+        end->tail += n;
+        received += n;
+    }
+    bool peer_closed = loopback_peer(end)->closed;
+    if (received > 0)
+    {
+        pthread_cond_broadcast(&channel->cond);
+    }
+    pthread_mutex_unlock(&channel->mutex);
+
+    if (received == 0 && !peer_closed)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+    return (ssize_t)received;
+}
+
+static int loopback_wait(df1_transport_t* transport, int events, int timeout_ms)
+{
+    loopback_end_t* end = (loopback_end_t*)transport->context;
+    loopback_channel_t* channel = end->channel;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&channel->mutex);
+    int result = 1;
+    while (!loopback_ready(end, events))
+    {
+        if (pthread_cond_timedwait(&channel->cond, &channel->mutex, &deadline) == ETIMEDOUT)
+        {
+            result = loopback_ready(end, events) ? 1 : 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&channel->mutex);
+    return result;
+}
+
+static void loopback_close(df1_transport_t* transport)
+{
+    loopback_end_t* end = (loopback_end_t*)transport->context;
+    loopback_channel_t* channel = end->channel;
+
+    pthread_mutex_lock(&channel->mutex);
+    end->closed = true;
+    end->handler = NULL;
+    int refs = --channel->refs;
+    pthread_cond_broadcast(&channel->cond);
+    pthread_mutex_unlock(&channel->mutex);
+
+    if (refs == 0)
+    {
+        pthread_cond_destroy(&channel->cond);
+        pthread_mutex_destroy(&channel->mutex);
+        free(channel);
+    }
+}
+
+const df1_transport_ops_t df1_transport_loopback = {
+    "loopback", NULL, loopback_send, loopback_recv, loopback_wait, NULL, loopback_close,
+};
+
+int df1_transport_loopback_pair(df1_transport_t* a, df1_transport_t* b)
+{
+    if (!a || !b || a == b)
+    {
+        return -1;
+    }
+
+    loopback_channel_t* channel = (loopback_channel_t*)calloc(1, sizeof(loopback_channel_t));
+    if (!channel)
+    {
+        return -1;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&channel->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&channel->mutex, NULL);
+    channel->refs = 2;
+
+    df1_transport_t* transports[2] = {a, b};
+    for (int i = 0; i < 2; i++)
+    {
+        df1_transport_init(transports[i]);
+        channel->ends[i].channel = channel;
+        channel->ends[i].index = i;
+        channel->ends[i].transport = transports[i];
+        transports[i]->ops = &df1_transport_loopback;
+        transports[i]->context = &channel->ends[i];
+    }
+    return 0;
+}
+
+int df1_transport_loopback_set_handler(df1_transport_t* transport, df1_loopback_handler_t handler,
+                                       void* user_data)
+{
+    if (!transport || transport->ops != &df1_transport_loopback)
+    {
+        return -1;
+    }
+
+    loopback_end_t* end = (loopback_end_t*)transport->context;
+    pthread_mutex_lock(&end->channel->mutex);
+    end->handler = handler;
+    end->user_data = user_data;
+    end->transport = transport;
+    pthread_mutex_unlock(&end->channel->mutex);
+    return 0;
+}
+
+// 通用接口
+
+int df1_transport_open(df1_transport_t* transport, const df1_transport_ops_t* ops,
+                       const df1_serial_config_t* config)
+{
+    if (!transport || !ops || !ops->open || !config)
+    {
+        return -1;
+    }
+
+    df1_transport_init(transport);
+    if (ops->open(transport, config) != 0)
+    {
+        df1_transport_init(transport);
+        return -1;
+    }
+    transport->ops = ops;
+    return 0;
+}
+
+int df1_transport_open_auto(df1_transport_t* transport, const df1_serial_config_t* config)
+{
+    if (!config)
+    {
+        return -1;
+    }
+
+    bool tcp = strncmp(config->port_name, DF1_TCP_PREFIX, strlen(DF1_TCP_PREFIX)) == 0;
+    return df1_transport_open(transport, tcp ? &df1_transport_tcp : &df1_transport_serial, config);
+}
+
+const char* df1_transport_pty_name(const df1_transport_t* transport)
+{
+    if (!transport || transport->ops != &df1_transport_pty)
+    {
+        return NULL;
+    }
+    return (const char*)transport->context;
+}
+
+void df1_transport_set_capture(df1_transport_t* transport, df1_capture_t* capture)
+{
+    if (transport)
+    {
+        transport->capture = capture;
+    }
+}
+
+ssize_t df1_transport_send(df1_transport_t* transport, const uint8_t* data, size_t size)
+{
+    if (!transport || !transport->ops)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    ssize_t result = transport->ops->send(transport, data, size);
+    if (transport->capture && result > 0)
+    {
+        df1_capture_record(transport->capture, DF1_CAPTURE_TX, data, (size_t)result);
+    }
+    return result;
+}
+
+ssize_t df1_transport_recv(df1_transport_t* transport, const struct iovec* iov, int count)
+{
+    if (!transport || !transport->ops)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    ssize_t result = transport->ops->recv(transport, iov, count);
+    if (transport->capture && result > 0)
+    {
+        df1_capture_record_iov(transport->capture, DF1_CAPTURE_RX, iov, count, (size_t)result);
+    }
+    return result;
+}
+
+int df1_transport_wait(df1_transport_t* transport, int events, int timeout_ms)
+{
+    if (!transport || !transport->ops)
+    {
+        return -1;
+    }
+    return transport->ops->wait(transport, events, timeout_ms < 0 ? 0 : timeout_ms);
+}
+
+void df1_transport_set_min_read(df1_transport_t* transport, size_t size)
+{
+    if (transport && transport->ops && transport->ops->set_min_read)
+    {
+        transport->ops->set_min_read(transport, size);
+    }
+}
+
+int df1_transport_poll_fd(const df1_transport_t* transport)
+{
+    return transport && transport->ops ? transport->fd : -1;
+}
+
+void df1_transport_close(df1_transport_t* transport)
+{
+    if (!transport || !transport->ops)
+        return;
+
+    transport->ops->close(transport);
+    df1_transport_init(transport);
+}
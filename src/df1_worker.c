@@ -0,0 +1,314 @@
+#define _DEFAULT_SOURCE
+#include "df1_worker.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+// 一条已提交的请求
+typedef struct worker_job {
+    struct worker_job* next;     // 队列链接，由生产者原子写入
+    df1_request_t* request;      // 请求
+    df1_worker_callback_t callback; // 异步回调
+    void* user_data;             // 回调用户数据
+    bool owned;                  // 由工作线程释放（异步请求）
+    int done;                    // 同步请求：完成标记
+} worker_job_t;
+
+// 侵入式多生产者单消费者队列：入队一次原子交换，出队只由工作线程执行
+typedef struct {
+    worker_job_t* head;          // 最近入队的节点（生产者）
+    worker_job_t* tail;          // 下一个出队的节点（消费者）
+    worker_job_t stub;           // 哨兵节点
+} mpsc_queue_t;
+
+struct df1_worker {
+    df1_serial_t* port;          // 独占的连接
+    mpsc_queue_t lanes[DF1_PRIORITY_COUNT]; // 每个优先级一条队列
+    size_t queued;               // 已入队未取出的请求数（原子）
+    int sleeping;                // 工作线程是否在等待新请求（原子）
+    int stopping;                // 是否正在停止（原子）
+    pthread_mutex_t mutex;       // 保护唤醒与同步完成通知
+    pthread_cond_t wake;         // 唤醒工作线程
+    pthread_cond_t done;         // 通知同步请求完成
+    pthread_t thread;            // 工作线程
+};
+
+static void queue_init(mpsc_queue_t* queue)
+{
+    queue->stub.next = NULL;
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+}
+
+static void queue_push(mpsc_queue_t* queue, worker_job_t* job)
+{
+    __atomic_store_n(&job->next, NULL, __ATOMIC_RELAXED);
+    worker_job_t* prev = __atomic_exchange_n(&queue->head, job, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, job, __ATOMIC_RELEASE);
+}
+
+// 出队。生产者已交换 head 但尚未链接时返回NULL，由调用者稍后重试
+static worker_job_t* queue_pop(mpsc_queue_t* queue)
+{
+    worker_job_t* tail = queue->tail;
+    worker_job_t* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+    if (tail == &queue->stub)
+    {
+        if (!next)
+        {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+
+    if (next)
+    {
+        queue->tail = next;
+        return tail;
+    }
+
+    if (tail != __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+
+    // 队列中只剩最后一个节点：放回哨兵后才能取出它
+    queue_push(queue, &queue->stub);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next)
+    {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+static void complete_job(df1_worker_t* worker, worker_job_t* job)
+{
+    if (job->owned)
+    {
+        if (job->callback)
+        {
+            job->callback(job->user_data, job->request);
+        }
+        free(job);
+        return;
+    }
+
+    // 同步请求的节点在调用者栈上，置位后不能再访问
+    pthread_mutex_lock(&worker->mutex);
+    __atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&worker->done);
+    pthread_mutex_unlock(&worker->mutex);
+}
+
+// 按优先级取出最多 limit 条请求
+static size_t take_batch(df1_worker_t* worker, worker_job_t** batch, size_t limit)
+{
+    size_t count = 0;
+    for (int lane = 0; lane < DF1_PRIORITY_COUNT && count < limit; lane++)
+    {
+        worker_job_t* job;
+        while (count < limit && (job = queue_pop(&worker->lanes[lane])) != NULL)
+        {
+            batch[count++] = job;
+        }
+    }
+    __atomic_sub_fetch(&worker->queued, count, __ATOMIC_SEQ_CST);
+    return count;
+}
+
+static void* worker_main(void* arg)
+{
+    df1_worker_t* worker = (df1_worker_t*)arg;
+    worker_job_t* batch[DF1_LINK_MAX_OUTSTANDING];
+    df1_request_t requests[DF1_LINK_MAX_OUTSTANDING];
+
+    while (!__atomic_load_n(&worker->stopping, __ATOMIC_SEQ_CST))
+    {
+        size_t limit = 1;
+        if (worker->port->df1_config.duplex == DF1_FULL_DUPLEX)
+        {
+            limit = (size_t)worker->port->link.config.max_outstanding;
+        }
+
+        size_t count = take_batch(worker, batch, limit);
+        if (count == 0)
+        {
+            if (__atomic_load_n(&worker->queued, __ATOMIC_SEQ_CST) > 0)
+            {
+                sched_yield(); // 生产者正在入队
+                continue;
+            }
+
+            pthread_mutex_lock(&worker->mutex);
+            __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+            while (__atomic_load_n(&worker->queued, __ATOMIC_SEQ_CST) == 0 &&
+                   !__atomic_load_n(&worker->stopping, __ATOMIC_SEQ_CST))
+            {
+                pthread_cond_wait(&worker->wake, &worker->mutex);
+            }
+            __atomic_store_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&worker->mutex);
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            requests[i] = *batch[i]->request;
+        }
+        df1_serial_transact(worker->port, requests, count);
+        for (size_t i = 0; i < count; i++)
+        {
+            *batch[i]->request = requests[i];
+            complete_job(worker, batch[i]);
+        }
+    }
+
+    // 停止后队列中剩余的请求
+    worker_job_t* job;
+    for (int lane = 0; lane < DF1_PRIORITY_COUNT; lane++)
+    {
+        while ((job = queue_pop(&worker->lanes[lane])) != NULL)
+        {
+            __atomic_sub_fetch(&worker->queued, 1, __ATOMIC_SEQ_CST);
+            job->request->status = -1;
+            complete_job(worker, job);
+        }
+    }
+    return NULL;
+}
+
+df1_worker_t* df1_worker_create(df1_serial_t* port)
+{
+    if (!port || !port->is_open)
+    {
+        return NULL;
+    }
+
+    df1_worker_t* worker = (df1_worker_t*)malloc(sizeof(df1_worker_t));
+    if (!worker)
+    {
+        return NULL;
+    }
+
+    memset(worker, 0, sizeof(df1_worker_t));
+    worker->port = port;
+    for (int lane = 0; lane < DF1_PRIORITY_COUNT; lane++)
+    {
+        queue_init(&worker->lanes[lane]);
+    }
+    pthread_mutex_init(&worker->mutex, NULL);
+    pthread_cond_init(&worker->wake, NULL);
+    pthread_cond_init(&worker->done, NULL);
+
+    if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0)
+    {
+        pthread_cond_destroy(&worker->done);
+        pthread_cond_destroy(&worker->wake);
+        pthread_mutex_destroy(&worker->mutex);
+        free(worker);
+        return NULL;
+    }
+
+    return worker;
+}
+
+static void wake_worker(df1_worker_t* worker)
+{
+    if (__atomic_load_n(&worker->sleeping, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock(&worker->mutex);
+        pthread_cond_signal(&worker->wake);
+        pthread_mutex_unlock(&worker->mutex);
+    }
+}
+
+void df1_worker_destroy(df1_worker_t* worker)
+{
+    if (!worker)
+        return;
+
+    pthread_mutex_lock(&worker->mutex);
+    __atomic_store_n(&worker->stopping, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&worker->wake);
+    pthread_mutex_unlock(&worker->mutex);
+
+    pthread_join(worker->thread, NULL);
+
+    pthread_cond_destroy(&worker->done);
+    pthread_cond_destroy(&worker->wake);
+    pthread_mutex_destroy(&worker->mutex);
+    free(worker);
+}
+
+static void enqueue(df1_worker_t* worker, worker_job_t* job, df1_priority_t priority)
+{
+    job->request->status = DF1_REQUEST_PENDING;
+    job->request->actual_size = 0;
+    job->request->sts = 0;
+    job->request->ext_sts = 0;
+
+    // 先计数再入队，工作线程看到计数为0时队列一定为空
+    __atomic_add_fetch(&worker->queued, 1, __ATOMIC_SEQ_CST);
+    queue_push(&worker->lanes[priority], job);
+    wake_worker(worker);
+}
+
+int df1_worker_submit(df1_worker_t* worker, df1_request_t* request, df1_priority_t priority,
+                      df1_worker_callback_t callback, void* user_data)
+{
+    if (!worker || !request || (unsigned)priority >= DF1_PRIORITY_COUNT ||
+        __atomic_load_n(&worker->stopping, __ATOMIC_SEQ_CST))
+    {
+        return -1;
+    }
+
+    worker_job_t* job = (worker_job_t*)malloc(sizeof(worker_job_t));
+    if (!job)
+    {
+        return -1;
+    }
+
+    memset(job, 0, sizeof(worker_job_t));
+    job->request = request;
+    job->callback = callback;
+    job->user_data = user_data;
+    job->owned = true;
+
+    enqueue(worker, job, priority);
+    return 0;
+}
+
+int df1_worker_execute(df1_worker_t* worker, df1_request_t* request, df1_priority_t priority)
+{
+    if (!worker || !request || (unsigned)priority >= DF1_PRIORITY_COUNT ||
+        __atomic_load_n(&worker->stopping, __ATOMIC_SEQ_CST))
+    {
+        return -1;
+    }
+
+    worker_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.request = request;
+
+    enqueue(worker, &job, priority);
+
+    pthread_mutex_lock(&worker->mutex);
+    while (!__atomic_load_n(&job.done, __ATOMIC_ACQUIRE))
+    {
+        pthread_cond_wait(&worker->done, &worker->mutex);
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    return request->status == 0 ? 0 : -1;
+}
+
+size_t df1_worker_queued(const df1_worker_t* worker)
+{
+    return worker ? __atomic_load_n(&worker->queued, __ATOMIC_SEQ_CST) : 0;
+}
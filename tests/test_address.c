@@ -2,6 +2,7 @@
 #include <string.h>
 #include <assert.h>
 #include "df1_address.h"
+#include "df1_tag.h"
 
 // 简单的测试框架宏
 #define TEST_ASSERT(condition, message) \
@@ -77,6 +78,7 @@ int test_address_to_string() {
     
     df1_address_t addr;
     char buffer[64];
+    memset(&addr, 0, sizeof(addr));
     
     // 测试N7:0
     addr.data_code = DF1_ADDR_N;
@@ -140,7 +142,16 @@ int test_roundtrip_conversion() {
         {"ST10:123", "ST10:123"},
         {"A9:0", "A9:0"},
         {"R6:0", "R6:0"},
-        {"L9:0", "L9:0"}
+        {"L9:0", "L9:0"},
+        {"B3:0/5", "B3:0/5"},
+        {"B3/37", "B3:2/5"},  // 按位编号的地址转换为元素/位
+        {"N7:2/15", "N7:2/15"},
+        {"T4:0.ACC", "T4:0.ACC"},
+        {"C5:1.PRE", "C5:1.PRE"},
+        {"R6:0.POS", "R6:0.POS"},
+        {"T4:0.DN", "T4:0/DN"},  // 控制位统一为 /DN 形式
+        {"t4:3/en", "T4:3/EN"},
+        {"T4:0.ACC/3", "T4:0.ACC/3"}
     };
     
     size_t num_tests = sizeof(test_cases) / sizeof(test_cases[0]);
@@ -168,6 +179,116 @@ int test_roundtrip_conversion() {
     TEST_PASS("往返转换");
 }
 
+// 测试标签表缓存
+int test_tag_table() {
+    printf("测试标签表缓存...\n");
+    
+    df1_tag_table_t* table = df1_tag_table_create(0);
+    TEST_ASSERT(table != NULL, "标签表创建失败");
+    
+    df1_tag_t n7_0 = df1_tag_table_intern(table, "N7:0");
+    df1_tag_t f8_3 = df1_tag_table_intern(table, "F8:3");
+    TEST_ASSERT(n7_0 != DF1_TAG_INVALID && f8_3 != DF1_TAG_INVALID, "标签加入失败");
+    TEST_ASSERT(n7_0 != f8_3, "不同标签句柄应该不同");
+    TEST_ASSERT(df1_tag_table_intern(table, "N7:0") == n7_0, "重复加入应返回同一句柄");
+    TEST_ASSERT(df1_tag_table_intern(table, "X7:0") == DF1_TAG_INVALID, "无效地址不应加入");
+    TEST_ASSERT(df1_tag_table_count(table) == 2, "标签数量错误");
+    
+    const df1_address_t* addr = df1_tag_table_get(table, f8_3);
+    TEST_ASSERT(addr != NULL, "句柄获取地址失败");
+    TEST_ASSERT(addr->data_code == DF1_ADDR_F && addr->db_block == 8 && addr->address_start == 3,
+               "缓存的地址内容错误");
+    TEST_ASSERT(strcmp(df1_tag_table_name(table, f8_3), "F8:3") == 0, "标签名称错误");
+    TEST_ASSERT(df1_tag_table_get(table, 100) == NULL, "越界句柄应该返回NULL");
+    
+    // 大量加入后已返回的地址指针仍然有效
+    char name[32];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "N10:%d", i);
+        TEST_ASSERT(df1_tag_table_intern(table, name) != DF1_TAG_INVALID, "批量加入失败");
+    }
+    TEST_ASSERT(df1_tag_table_get(table, f8_3) == addr, "扩容后地址指针不应变化");
+    TEST_ASSERT(df1_tag_table_lookup(table, "N10:999")->address_start == 999, "扩容后查找失败");
+    df1_tag_table_destroy(table);
+    
+    // 容量上限
+    table = df1_tag_table_create(2);
+    TEST_ASSERT(df1_tag_table_intern(table, "N7:0") != DF1_TAG_INVALID, "上限内加入失败");
+    TEST_ASSERT(df1_tag_table_intern(table, "N7:1") != DF1_TAG_INVALID, "上限内加入失败");
+    TEST_ASSERT(df1_tag_table_intern(table, "N7:2") == DF1_TAG_INVALID, "超出上限应该失败");
+    TEST_ASSERT(df1_tag_table_intern(table, "N7:1") != DF1_TAG_INVALID, "已有标签在满表时仍可查找");
+    df1_tag_table_destroy(table);
+    
+    TEST_PASS("标签表缓存");
+}
+
+// 测试位与子元素地址
+int test_bit_and_sub_element() {
+    printf("测试位与子元素地址...\n");
+    
+    df1_address_t addr;
+    
+    TEST_ASSERT(df1_address_parse("B3:0/5", &addr) == 0, "B3:0/5解析失败");
+    TEST_ASSERT(addr.address_start == 0 && addr.has_bit && addr.bit == 5 && addr.sub_element == 0, "B3:0/5内容错误");
+    
+    TEST_ASSERT(df1_address_parse("B3/37", &addr) == 0, "B3/37解析失败");
+    TEST_ASSERT(addr.db_block == 3 && addr.address_start == 2 && addr.has_bit && addr.bit == 5, "B3/37应为B3:2/5");
+    
+    TEST_ASSERT(df1_address_parse("N7:2/15", &addr) == 0 && addr.bit == 15, "N7:2/15解析失败");
+    
+    TEST_ASSERT(df1_address_parse("T4:0.PRE", &addr) == 0 && addr.sub_element == 1 && !addr.has_bit, "T4:0.PRE解析失败");
+    TEST_ASSERT(df1_address_parse("T4:0.ACC", &addr) == 0 && addr.sub_element == 2, "T4:0.ACC解析失败");
+    TEST_ASSERT(df1_address_parse("C5:1.PRE", &addr) == 0 && addr.address_start == 1 && addr.sub_element == 1,
+               "C5:1.PRE解析失败");
+    TEST_ASSERT(df1_address_parse("R6:0.LEN", &addr) == 0 && addr.sub_element == 1, "R6:0.LEN解析失败");
+    TEST_ASSERT(df1_address_parse("R6:0.POS", &addr) == 0 && addr.sub_element == 2, "R6:0.POS解析失败");
+    
+    TEST_ASSERT(df1_address_parse("T4:0/DN", &addr) == 0, "T4:0/DN解析失败");
+    TEST_ASSERT(addr.sub_element == 0 && addr.has_bit && addr.bit == 13, "T4:0/DN应为控制字第13位");
+    TEST_ASSERT(df1_address_parse("C5:0.CU", &addr) == 0 && addr.bit == 15, "C5:0.CU解析失败");
+    TEST_ASSERT(df1_address_parse("R6:0/FD", &addr) == 0 && addr.bit == 8, "R6:0/FD解析失败");
+    
+    // 无效的位号、助记符与多余字符
+    TEST_ASSERT(df1_address_parse("N7:0/16", &addr) != 0, "位号超过15应该失败");
+    TEST_ASSERT(df1_address_parse("N7:0/", &addr) != 0, "缺少位号应该失败");
+    TEST_ASSERT(df1_address_parse("T4:0.XYZ", &addr) != 0, "未知助记符应该失败");
+    TEST_ASSERT(df1_address_parse("N7:0.ACC", &addr) != 0, "N文件没有子元素助记符");
+    TEST_ASSERT(df1_address_parse("C5:0/TT", &addr) != 0, "计数器没有TT位");
+    TEST_ASSERT(df1_address_parse("N7:abc", &addr) != 0, "非数字元素号应该失败");
+    TEST_ASSERT(df1_address_parse("N7:1x", &addr) != 0, "多余字符应该失败");
+    TEST_ASSERT(df1_address_parse("N7/37", &addr) != 0, "只有B文件支持按位编号");
+    TEST_ASSERT(df1_address_parse("N7:70000", &addr) != 0, "元素号超出范围应该失败");
+    
+    // 只有定时器、计数器、控制元素有子元素，F、L、ST 文件没有位地址
+    TEST_ASSERT(df1_address_parse("T4:0.2", &addr) == 0 && addr.sub_element == 2, "T4:0.2解析失败");
+    TEST_ASSERT(df1_address_parse("T4:0.3", &addr) != 0, "子元素号超出元素应该失败");
+    TEST_ASSERT(df1_address_parse("N7:0.5", &addr) != 0, "N文件没有子元素");
+    TEST_ASSERT(df1_address_parse("B3:0.1", &addr) != 0, "B文件没有子元素");
+    TEST_ASSERT(df1_address_parse("F8:0.1", &addr) != 0, "F文件没有子元素");
+    TEST_ASSERT(df1_address_parse("F8:0/3", &addr) != 0, "F文件没有位地址");
+    TEST_ASSERT(df1_address_parse("L9:0/3", &addr) != 0, "L文件没有位地址");
+    TEST_ASSERT(df1_address_parse("ST9:0/3", &addr) != 0, "ST文件没有位地址");
+    TEST_ASSERT(df1_address_parse("R6:0.1/3", &addr) == 0 && addr.sub_element == 1 && addr.bit == 3,
+               "R6:0.1/3解析失败");
+    
+    TEST_PASS("位与子元素地址");
+}
+
+// 测试元素字节数
+int test_element_size() {
+    printf("测试元素字节数...\n");
+    
+    TEST_ASSERT(df1_address_element_size(DF1_ADDR_N) == 2, "N 元素应为2字节");
+    TEST_ASSERT(df1_address_element_size(DF1_ADDR_B) == 2, "B 元素应为2字节");
+    TEST_ASSERT(df1_address_element_size(DF1_ADDR_F) == 4, "F 元素应为4字节");
+    TEST_ASSERT(df1_address_element_size(DF1_ADDR_L) == 4, "L 元素应为4字节");
+    TEST_ASSERT(df1_address_element_size(DF1_ADDR_T) == 6, "T 元素应为6字节");
+    TEST_ASSERT(df1_address_element_size(DF1_ADDR_ST) == 84, "ST 元素应为84字节");
+    TEST_ASSERT(df1_address_element_size((df1_addr_type_t)0x00) == 0, "未知类型应返回0");
+    
+    TEST_PASS("元素字节数");
+}
+
 int main() {
     printf("AB DF1 地址解析单元测试\n");
     printf("========================\n\n");
@@ -179,6 +300,9 @@ int main() {
     total++; passed += test_invalid_addresses();
     total++; passed += test_address_to_string();
     total++; passed += test_roundtrip_conversion();
+    total++; passed += test_tag_table();
+    total++; passed += test_element_size();
+    total++; passed += test_bit_and_sub_element();
     
     printf("\n测试结果: %d/%d 通过\n", passed, total);
     
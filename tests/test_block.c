@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "df1_serial.h"
+#include "test_fixture.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+// 打开经伪终端连接的模拟从站，另有 1024 字的 N10 与只有2个定时器的 T6
+static df1_serial_t* open_sim(df1_sim_t** sim, df1_duplex_t duplex) {
+    *sim = fixture_sim_create(duplex);
+    if (!*sim || df1_sim_add_file(*sim, 1, DF1_ADDR_N, 10, 1024) != 0 ||
+        df1_sim_add_file(*sim, 1, DF1_ADDR_T, 6, 2) != 0) {
+        return NULL;
+    }
+
+    df1_serial_t* port = fixture_open_pty(*sim, duplex, 1000);
+    if (port && df1_sim_start(*sim) != 0) {
+        df1_serial_destroy(port);
+        return NULL;
+    }
+    return port;
+}
+
+static unsigned long sim_commands(df1_sim_t* sim) {
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+    return stats.commands;
+}
+
+// 整个 256 字的 N 文件下载后再上传
+static int run_block_transfer(df1_duplex_t duplex) {
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, duplex);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    uint8_t written[512];
+    uint8_t read_back[512];
+    for (size_t i = 0; i < sizeof(written); i++) {
+        written[i] = (uint8_t)(i * 7 + 3); // 包含需要转义的 0x10
+    }
+
+    TEST_ASSERT(df1_serial_write_block(port, "N7:0", written, sizeof(written)) == 0, "块写入失败");
+    TEST_ASSERT(sim_commands(sim) == 3, "512字节应分为3段写入");
+    TEST_ASSERT(df1_sim_get(sim, 1, "N7:0", read_back, sizeof(read_back)) == 0 &&
+                memcmp(read_back, written, sizeof(written)) == 0, "模拟从站中的数据与写入不一致");
+
+    size_t actual_size = 0;
+    memset(read_back, 0, sizeof(read_back));
+    TEST_ASSERT(df1_serial_read_block(port, "N7:0", read_back, sizeof(read_back), &actual_size) == 0, "块读取失败");
+    TEST_ASSERT(actual_size == sizeof(read_back), "块读取长度错误");
+    TEST_ASSERT(memcmp(read_back, written, sizeof(written)) == 0, "读回的数据与写入不一致");
+
+    // 从中间开始、长度不是分段整数倍的读取
+    TEST_ASSERT(df1_serial_read_block(port, "N7:100", read_back, 300, &actual_size) == 0, "块读取失败");
+    TEST_ASSERT(actual_size == 300 && memcmp(read_back, written + 200, 300) == 0, "偏移读取的数据错误");
+
+    // 长度为0的读取不发送命令，报告长度0
+    actual_size = 1;
+    TEST_ASSERT(df1_serial_read_block(port, "N7:0", read_back, 0, &actual_size) == 0 && actual_size == 0,
+                "长度为0的块读取应报告长度0");
+
+    // 浮点元素按4字节对齐分段
+    TEST_ASSERT(df1_serial_write_block(port, "F8:0", written, 400) == 0, "浮点块写入失败");
+    TEST_ASSERT(df1_sim_get(sim, 1, "F8:0", read_back, 400) == 0 && memcmp(read_back, written, 400) == 0,
+                "浮点块数据错误");
+
+    // 超出从站文件范围的分段失败时，只报告之前连续成功的部分
+    TEST_ASSERT(df1_serial_read_block(port, "N10:900", read_back, 500, &actual_size) != 0, "越界读取应该失败");
+    TEST_ASSERT(actual_size == 236, "应只报告连续成功的部分");
+
+    // 单条读写不再截断超过一个长度字节的请求
+    TEST_ASSERT(df1_serial_read(port, "N7:0", read_back, 300, &actual_size) != 0, "单条读取超过255字节应该失败");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    return 1;
+}
+
+// 测试类型数组读写
+int test_typed_arrays() {
+    printf("测试类型数组读写...\n");
+
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, DF1_FULL_DUPLEX);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    int16_t words[256];
+    int16_t words_back[256];
+    for (int i = 0; i < 256; i++) {
+        words[i] = (int16_t)(i * 131 - 16000);
+    }
+    TEST_ASSERT(df1_serial_write_int16_array(port, "N7:0", words, 256) == 0, "整数数组写入失败");
+    TEST_ASSERT(df1_serial_read_int16_array(port, "N7:0", words_back, 256) == 0, "整数数组读取失败");
+    TEST_ASSERT(memcmp(words, words_back, sizeof(words)) == 0, "整数数组读回错误");
+
+    float reals[100];
+    float reals_back[100];
+    for (int i = 0; i < 100; i++) {
+        reals[i] = (float)i * 1.5f - 20.0f;
+    }
+    TEST_ASSERT(df1_serial_write_float_array(port, "F8:0", reals, 100) == 0, "浮点数组写入失败");
+    TEST_ASSERT(df1_serial_read_float_array(port, "F8:0", reals_back, 100) == 0, "浮点数组读取失败");
+    TEST_ASSERT(memcmp(reals, reals_back, sizeof(reals)) == 0, "浮点数组读回错误");
+
+    int32_t longs[70];
+    int32_t longs_back[70];
+    for (int i = 0; i < 70; i++) {
+        longs[i] = (int32_t)(i * 100003 - 3000000);
+    }
+    TEST_ASSERT(df1_serial_write_int32_array(port, "L9:0", longs, 70) == 0, "长整数数组写入失败");
+    TEST_ASSERT(df1_serial_read_int32_array(port, "L9:0", longs_back, 70) == 0, "长整数数组读取失败");
+    TEST_ASSERT(memcmp(longs, longs_back, sizeof(longs)) == 0, "长整数数组读回错误");
+
+    uint16_t bits[4] = {0x0001, 0x8000, 0x1010, 0xFFFF};
+    uint16_t bits_back[4];
+    TEST_ASSERT(df1_serial_write_uint16_array(port, "B3:0", bits, 4) == 0, "字数组写入失败");
+    TEST_ASSERT(df1_serial_read_uint16_array(port, "B3:0", bits_back, 4) == 0, "字数组读取失败");
+    TEST_ASSERT(memcmp(bits, bits_back, sizeof(bits)) == 0, "字数组读回错误");
+
+    // 从站中按小端序保存
+    uint8_t layout[4];
+    TEST_ASSERT(df1_sim_get(sim, 1, "B3:0", layout, sizeof(layout)) == 0 && layout[0] == 0x01 &&
+                layout[1] == 0x00 && layout[2] == 0x00 && layout[3] == 0x80, "线路上应为小端序");
+
+    // 单元素接口
+    float real = 0.0f;
+    int16_t word = 0;
+    TEST_ASSERT(df1_serial_write_float(port, "F8:5", 3.25f) == 0 && df1_serial_read_float(port, "F8:5", &real) == 0,
+                "单个浮点读写失败");
+    TEST_ASSERT(real == 3.25f, "单个浮点值错误");
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:1", &word) == 0 && word == words[1], "单个整数读取错误");
+
+    // 文件类型与元素类型不符时不发送请求
+    df1_sim_stats_t before, after;
+    df1_sim_get_stats(sim, &before);
+    TEST_ASSERT(df1_serial_read_float_array(port, "N7:0", reals_back, 10) != 0, "N 文件按浮点数读取应失败");
+    TEST_ASSERT(df1_serial_read_int16_array(port, "F8:0", words_back, 10) != 0, "F 文件按整数读取应失败");
+    TEST_ASSERT(df1_serial_read_int32_array(port, "F8:0", longs_back, 10) != 0, "F 文件按长整数读取应失败");
+    TEST_ASSERT(df1_serial_read_float_array(port, "L9:0", reals_back, 10) != 0, "L 文件按浮点数读取应失败");
+    TEST_ASSERT(df1_serial_write_uint16_array(port, "L9:0", bits, 4) != 0, "L 文件按字写入应失败");
+    TEST_ASSERT(df1_serial_write_float(port, "N7:0", 1.0f) != 0, "N 文件写入浮点数应失败");
+    TEST_ASSERT(df1_serial_read_int16(port, "F8:0", &word) != 0, "F 文件读取整数应失败");
+    TEST_ASSERT(df1_serial_read_int16_array(port, "N7:0", words_back, SIZE_MAX / 2 + 1) != 0, "元素个数溢出应失败");
+    df1_sim_get_stats(sim, &after);
+    TEST_ASSERT(after.commands == before.commands, "类型不符时不应发送请求");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("类型数组读写");
+}
+
+// 测试掩码写只修改指定的位
+int test_mask_write() {
+    printf("测试掩码写...\n");
+
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, DF1_HALF_DUPLEX);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    uint16_t word = 0x0F0F;
+    TEST_ASSERT(df1_serial_write_uint16_array(port, "B3:1", &word, 1) == 0, "初始化失败");
+
+    TEST_ASSERT(df1_serial_set_bits(port, "B3:1", 0x8020) == 0, "置位失败");
+    TEST_ASSERT(df1_serial_read_uint16_array(port, "B3:1", &word, 1) == 0 && word == 0x8F2F, "置位结果错误");
+
+    TEST_ASSERT(df1_serial_clear_bits(port, "B3:1", 0x0003) == 0, "清位失败");
+    TEST_ASSERT(df1_serial_read_uint16_array(port, "B3:1", &word, 1) == 0 && word == 0x8F2C, "清位结果错误");
+
+    TEST_ASSERT(df1_serial_mask_write(port, "B3:1", 0xFF00, 0x1234) == 0, "掩码写失败");
+    TEST_ASSERT(df1_serial_read_uint16_array(port, "B3:1", &word, 1) == 0 && word == 0x122C, "掩码写结果错误");
+
+    // 相邻的字不受影响，每次修改只有一条命令
+    TEST_ASSERT(df1_serial_read_uint16_array(port, "B3:0", &word, 1) == 0 && word == 0, "相邻字被修改");
+    TEST_ASSERT(sim_commands(sim) == 8, "每次位修改应只有一次往返");
+
+    // 位地址读写
+    bool bit = false;
+    TEST_ASSERT(df1_serial_write_bit(port, "B3/37", true) == 0, "写位失败");
+    TEST_ASSERT(df1_serial_read_bit(port, "B3:2/5", &bit) == 0 && bit, "读位错误");
+    TEST_ASSERT(df1_serial_read_uint16_array(port, "B3:2", &word, 1) == 0 && word == 0x0020, "位地址对应的字错误");
+    TEST_ASSERT(df1_serial_write_bit(port, "B3:2/5", false) == 0, "清位失败");
+    TEST_ASSERT(df1_serial_read_bit(port, "B3/37", &bit) == 0 && !bit, "清位后读位错误");
+    TEST_ASSERT(df1_serial_read_bit(port, "B3:2", &bit) != 0, "非位地址应该失败");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("掩码写");
+}
+
+// 测试定时器子元素只传输需要的字
+int test_sub_element_read() {
+    printf("测试子元素读取...\n");
+
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, DF1_HALF_DUPLEX);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    // T6:0 ~ T6:1：控制字、预设值、累计值。T6 只有这2个定时器，子元素读取若传输整个元素，
+    // T6:1.PRE 与 T6:1.ACC 会超出文件范围
+    uint16_t timers[6] = {0x2000, 100, 42, 0x8000, 200, 7};
+    TEST_ASSERT(df1_serial_write_uint16_array(port, "T6:0", timers, 6) == 0, "写入定时器失败");
+
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "T6:0.ACC", &value) == 0 && value == 42, "T6:0.ACC读取错误");
+    TEST_ASSERT(df1_serial_read_int16(port, "T6:1.PRE", &value) == 0 && value == 200, "子元素读取应只传输2字节");
+    TEST_ASSERT(df1_serial_read_int16(port, "T6:1.ACC", &value) == 0 && value == 7, "子元素读取应只传输2字节");
+
+    bool done = false;
+    TEST_ASSERT(df1_serial_read_bit(port, "T6:0/DN", &done) == 0 && done, "T6:0/DN读取错误");
+    TEST_ASSERT(df1_serial_read_bit(port, "T6:1/DN", &done) == 0 && !done, "T6:1/DN读取错误");
+
+    TEST_ASSERT(df1_serial_write_int16(port, "T6:1.ACC", 9) == 0, "写入子元素失败");
+    TEST_ASSERT(df1_serial_read_uint16_array(port, "T6:1", timers, 3) == 0, "读取定时器失败");
+    TEST_ASSERT(timers[0] == 0x8000 && timers[1] == 200 && timers[2] == 9, "子元素写入影响了其他字");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("子元素读取");
+}
+
+// 测试半双工块读写
+int test_block_half_duplex() {
+    printf("测试半双工块读写...\n");
+    TEST_ASSERT(run_block_transfer(DF1_HALF_DUPLEX), "半双工块读写失败");
+    TEST_PASS("半双工块读写");
+}
+
+// 测试全双工流水块读写
+int test_block_full_duplex() {
+    printf("测试全双工块读写...\n");
+    TEST_ASSERT(run_block_transfer(DF1_FULL_DUPLEX), "全双工块读写失败");
+    TEST_PASS("全双工块读写");
+}
+
+int main() {
+    printf("AB DF1 块读写单元测试\n");
+    printf("=====================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_block_half_duplex();
+    total++; passed += test_block_full_duplex();
+    total++; passed += test_typed_arrays();
+    total++; passed += test_mask_write();
+    total++; passed += test_sub_element_read();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,232 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "df1_serial.h"
+#include "df1_sim.h"
+#include "df1_capture.h"
+#include "test_fixture.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+static char trace_path[64];
+
+static void make_trace_path(void) {
+    snprintf(trace_path, sizeof(trace_path), "/tmp/test_capture_%ld.trace", (long)getpid());
+}
+
+// 测试记录写入文件后原样读回
+int test_record_and_read() {
+    printf("测试抓包记录与读回...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    config.duplex = DF1_FULL_DUPLEX;
+
+    df1_capture_t* capture = df1_capture_create(0);
+    TEST_ASSERT(capture != NULL, "创建抓包缓冲区失败");
+    TEST_ASSERT(df1_capture_open_file(capture, trace_path, &config) == 0, "打开抓包文件失败");
+
+    const uint8_t command[] = {0x10, 0x02, 0x01, 0x00, 0xA2};
+    df1_capture_record(capture, DF1_CAPTURE_TX, command, sizeof(command));
+
+    // 接收分散在两个缓冲区中，只记录实际收到的字节
+    uint8_t first[3] = {0x10, 0x06, 0x10};
+    uint8_t second[8] = {0x02, 0x00, 0x01, 0xE2};
+    struct iovec iov[2] = {{first, sizeof(first)}, {second, sizeof(second)}};
+    df1_capture_record_iov(capture, DF1_CAPTURE_RX, iov, 2, 7);
+
+    TEST_ASSERT(df1_capture_flush(capture) == 2, "应写出2条记录");
+    TEST_ASSERT(df1_capture_flush(capture) == 0, "没有新记录时应写出0条");
+    df1_capture_destroy(capture);
+
+    FILE* file = fopen(trace_path, "rb");
+    TEST_ASSERT(file != NULL, "无法打开抓包文件");
+    df1_trace_header_t header;
+    static df1_trace_record_t record;
+    TEST_ASSERT(df1_trace_read_header(file, &header) == 0, "读取文件头失败");
+    TEST_ASSERT(header.duplex == DF1_FULL_DUPLEX && header.check_type == DF1_CHECK_CRC16, "文件头链路参数错误");
+
+    TEST_ASSERT(df1_trace_read_record(file, &record) == 1, "读取第一条记录失败");
+    TEST_ASSERT(record.direction == DF1_CAPTURE_TX && record.size == sizeof(command)
+                && memcmp(record.data, command, sizeof(command)) == 0, "发送记录内容错误");
+    TEST_ASSERT(record.timestamp_ns >= header.start_ns, "时间戳应不早于文件开始");
+    uint64_t first_ns = record.timestamp_ns;
+
+    const uint8_t expected[] = {0x10, 0x06, 0x10, 0x02, 0x00, 0x01, 0xE2};
+    TEST_ASSERT(df1_trace_read_record(file, &record) == 1, "读取第二条记录失败");
+    TEST_ASSERT(record.direction == DF1_CAPTURE_RX && record.size == sizeof(expected)
+                && memcmp(record.data, expected, sizeof(expected)) == 0, "接收记录内容错误");
+    TEST_ASSERT(record.timestamp_ns >= first_ns, "时间戳应单调");
+    TEST_ASSERT(df1_trace_read_record(file, &record) == 0, "应到达文件结尾");
+    fclose(file);
+
+    file = fopen(trace_path, "wb");
+    TEST_ASSERT(file != NULL, "无法覆盖抓包文件");
+    fputs("not a trace", file);
+    fclose(file);
+    file = fopen(trace_path, "rb");
+    TEST_ASSERT(df1_trace_read_header(file, &header) != 0, "不是抓包文件时应失败");
+    fclose(file);
+    remove(trace_path);
+
+    TEST_PASS("抓包记录与读回");
+}
+
+// 测试缓冲区满时丢弃新记录、超长收发拆分为多条记录
+int test_overflow() {
+    printf("测试缓冲区满与拆分...\n");
+
+    df1_capture_t* capture = df1_capture_create(1);
+    TEST_ASSERT(capture != NULL, "创建抓包缓冲区失败");
+
+    static uint8_t data[DF1_CAPTURE_MAX_RECORD * 2 + 100];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+
+    // 最小缓冲区放不下三条记录：超出的部分丢弃
+    df1_capture_record(capture, DF1_CAPTURE_TX, data, sizeof(data));
+    TEST_ASSERT(df1_capture_dropped(capture) >= 1, "缓冲区满时应丢弃记录");
+
+    // 没有打开文件时 flush 只释放缓冲区
+    TEST_ASSERT(df1_capture_flush(capture) == 0, "没有文件时不应写出记录");
+    uint64_t dropped = df1_capture_dropped(capture);
+    df1_capture_record(capture, DF1_CAPTURE_RX, data, 100);
+    TEST_ASSERT(df1_capture_dropped(capture) == dropped, "释放后应可以继续记录");
+    df1_capture_destroy(capture);
+
+    // 足够大的缓冲区：按 DF1_CAPTURE_MAX_RECORD 拆分并保持顺序
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    capture = df1_capture_create(64 * 1024);
+    TEST_ASSERT(capture != NULL && df1_capture_open_file(capture, trace_path, &config) == 0, "打开抓包文件失败");
+    df1_capture_record(capture, DF1_CAPTURE_TX, data, sizeof(data));
+    TEST_ASSERT(df1_capture_flush(capture) == 3, "超长收发应拆分为3条记录");
+    df1_capture_destroy(capture);
+
+    FILE* file = fopen(trace_path, "rb");
+    df1_trace_header_t header;
+    static df1_trace_record_t record;
+    TEST_ASSERT(file != NULL && df1_trace_read_header(file, &header) == 0, "读取文件头失败");
+    size_t offset = 0;
+    while (df1_trace_read_record(file, &record) == 1) {
+        TEST_ASSERT(offset + record.size <= sizeof(data) && memcmp(record.data, data + offset, record.size) == 0,
+                    "拆分后的记录内容错误");
+        offset += record.size;
+    }
+    fclose(file);
+    remove(trace_path);
+    TEST_ASSERT(offset == sizeof(data), "拆分后的记录总长度错误");
+
+    TEST_PASS("缓冲区满与拆分");
+}
+
+// 测试连接上的抓包：命令、ACK 与应答帧都能从记录中解码
+int test_connection_capture() {
+    printf("测试连接抓包...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_FULL_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    int16_t initial = 1234;
+    df1_sim_set(sim, 1, "N7:0", (const uint8_t*)&initial, 2);
+
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_FULL_DUPLEX, 100);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    // 抓包文件头记录主站的DF1配置
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, DF1_FULL_DUPLEX, 100);
+
+    df1_capture_t* capture = df1_capture_create(0);
+    TEST_ASSERT(capture != NULL && df1_capture_open_file(capture, trace_path, &config) == 0, "打开抓包文件失败");
+    TEST_ASSERT(df1_serial_set_capture(port, capture) == 0, "设置抓包失败");
+
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0 && value == 1234, "读取失败");
+    TEST_ASSERT(df1_serial_read_int16(port, "N30:0", &value) != 0, "不存在的文件应该失败");
+    TEST_ASSERT(df1_capture_flush(capture) > 0, "应写出记录");
+    TEST_ASSERT(df1_capture_dropped(capture) == 0, "不应丢弃记录");
+
+    df1_serial_destroy(port);
+    df1_capture_destroy(capture);
+    df1_sim_destroy(sim);
+
+    FILE* file = fopen(trace_path, "rb");
+    df1_trace_header_t header;
+    static df1_trace_record_t record;
+    TEST_ASSERT(file != NULL && df1_trace_read_header(file, &header) == 0, "读取文件头失败");
+
+    static df1_decoder_t decoders[2];
+    df1_decoder_init(&decoders[DF1_CAPTURE_TX], header.check_type);
+    df1_decoder_init(&decoders[DF1_CAPTURE_RX], header.check_type);
+    int commands = 0;
+    int replies = 0;
+    int status_errors = 0;
+    int acks = 0;
+    while (df1_trace_read_record(file, &record) == 1) {
+        size_t offset = 0;
+        while (offset < record.size) {
+            size_t consumed = 0;
+            df1_frame_t frame;
+            int result = df1_decoder_push(&decoders[record.direction], record.data + offset, record.size - offset,
+                                          &consumed, &frame);
+            offset += consumed;
+            if (result == DF1_DECODE_FRAME && record.direction == DF1_CAPTURE_TX) {
+                commands++;
+            } else if (result == DF1_DECODE_FRAME) {
+                replies++;
+                status_errors += frame.sts != 0;
+            } else if (result == DF1_DECODE_ACK && record.direction == DF1_CAPTURE_RX) {
+                acks++;
+            }
+        }
+    }
+    fclose(file);
+    remove(trace_path);
+
+    TEST_ASSERT(commands == 2 && replies == 2, "应解码出2条命令与2条应答");
+    TEST_ASSERT(acks == 2, "应收到2个 DLE ACK");
+    TEST_ASSERT(status_errors == 1, "不存在的文件应以错误状态应答");
+
+    TEST_PASS("连接抓包");
+}
+
+int main() {
+    printf("AB DF1 线路抓包单元测试\n");
+    printf("=======================\n\n");
+
+    make_trace_path();
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_record_and_read();
+    total++; passed += test_overflow();
+    total++; passed += test_connection_capture();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "df1_crc.h"
+#include "df1_protocol.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+static const df1_crc16_kernel_t kernels[] = {
+    DF1_CRC16_BYTEWISE, DF1_CRC16_SLICE8, DF1_CRC16_SLICE16, DF1_CRC16_PCLMUL,
+};
+#define KERNEL_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+
+// 逐位计算的参考实现
+static uint16_t reference_crc16(uint16_t crc, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t next_random(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// 测试标准校验值与内核选择
+int test_check_value() {
+    printf("测试校验值与内核选择...\n");
+
+    const uint8_t check[] = "123456789";
+    for (size_t k = 0; k < KERNEL_COUNT; k++) {
+        if (df1_crc16_supported(kernels[k])) {
+            TEST_ASSERT(df1_crc16_compute(kernels[k], 0, check, 9) == 0xBB3D, "CRC-16/ARC 校验值错误");
+        }
+    }
+
+    TEST_ASSERT(df1_crc16_supported(DF1_CRC16_SLICE16), "查表内核应始终可用");
+    TEST_ASSERT(df1_crc16_active() != DF1_CRC16_AUTO, "应自动选出一个内核");
+    TEST_ASSERT(strcmp(df1_crc16_kernel_name(DF1_CRC16_PCLMUL), "pclmul") == 0, "内核名称错误");
+
+    TEST_ASSERT(df1_crc16_select(DF1_CRC16_SLICE8) == 0 && df1_crc16_active() == DF1_CRC16_SLICE8, "选择内核失败");
+    TEST_ASSERT(df1_crc16_select((df1_crc16_kernel_t)99) != 0, "无效内核应该失败");
+    TEST_ASSERT(df1_crc16_select(DF1_CRC16_AUTO) == 0 && df1_crc16_active() != DF1_CRC16_AUTO, "恢复自动选择失败");
+    TEST_ASSERT(df1_crc16_compute(DF1_CRC16_AUTO, 0x1234, NULL, 10) == 0x1234, "NULL数据应返回初值");
+
+    TEST_PASS("校验值与内核选择");
+}
+
+// 测试各内核在任意长度、初值与起始对齐下与逐位参考实现一致
+int test_kernels_agree() {
+    printf("测试各内核一致性...\n");
+
+    uint8_t data[4096 + 16];
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)next_random(&seed);
+    }
+
+    for (size_t length = 0; length <= 300; length++) {
+        for (size_t offset = 0; offset < 4; offset++) {
+            uint16_t init = (uint16_t)next_random(&seed);
+            uint16_t expected = reference_crc16(init, data + offset, length);
+            for (size_t k = 0; k < KERNEL_COUNT; k++) {
+                TEST_ASSERT(df1_crc16_compute(kernels[k], init, data + offset, length) == expected,
+                            "内核结果与参考实现不一致");
+            }
+        }
+    }
+
+    // 长数据与分段累加
+    uint16_t expected = reference_crc16(0, data, 4096);
+    for (size_t k = 0; k < KERNEL_COUNT; k++) {
+        TEST_ASSERT(df1_crc16_compute(kernels[k], 0, data, 4096) == expected, "长数据结果不一致");
+        uint16_t crc = df1_crc16_compute(kernels[k], 0, data, 1000);
+        crc = df1_crc16_compute(kernels[k], crc, data + 1000, 3096);
+        TEST_ASSERT(crc == expected, "分段累加结果不一致");
+    }
+
+    // 全0与全1数据
+    memset(data, 0x00, 1024);
+    TEST_ASSERT(df1_crc16_compute(DF1_CRC16_PCLMUL, 0xFFFF, data, 1024) == reference_crc16(0xFFFF, data, 1024),
+                "全0数据结果不一致");
+    memset(data, 0xFF, 1024);
+    TEST_ASSERT(df1_crc16_compute(DF1_CRC16_PCLMUL, 0, data, 1024) == reference_crc16(0, data, 1024),
+                "全1数据结果不一致");
+
+    TEST_PASS("各内核一致性");
+}
+
+// 测试编码与解码在各内核下互通：长帧经过折叠内核，含转义的帧经过内部缓冲区
+int test_frame_roundtrip() {
+    printf("测试各内核帧编解码...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    uint8_t pdu[6 + DF1_MAX_DATA_SIZE] = {0x00, 0x01, 0x4F, 0x00, 0x34, 0x12};
+    for (size_t i = 6; i < sizeof(pdu); i++) {
+        pdu[i] = (uint8_t)(i * 7);
+    }
+
+    uint8_t frame[DF1_MAX_FRAME_SIZE];
+    for (size_t k = 0; k < KERNEL_COUNT; k++) {
+        if (!df1_crc16_supported(kernels[k])) {
+            continue;
+        }
+        TEST_ASSERT(df1_crc16_select(kernels[k]) == 0, "选择内核失败");
+
+        for (int duplex = 0; duplex < 2; duplex++) {
+            config.duplex = duplex ? DF1_FULL_DUPLEX : DF1_HALF_DUPLEX;
+            size_t frame_size = 0;
+            TEST_ASSERT(df1_build_frame(&config, pdu, sizeof(pdu), frame, sizeof(frame), &frame_size) == 0,
+                        "构建帧失败");
+
+            df1_decoder_t decoder;
+            df1_decoder_init(&decoder, DF1_CHECK_CRC16);
+            df1_frame_t decoded;
+            size_t consumed = 0;
+            TEST_ASSERT(df1_decoder_push(&decoder, frame, frame_size, &consumed, &decoded) == DF1_DECODE_FRAME,
+                        "解码失败");
+            TEST_ASSERT(decoded.pdu_length == sizeof(pdu) && memcmp(decoded.pdu, pdu, sizeof(pdu)) == 0,
+                        "解码数据错误");
+
+            // 改动一个数据字节（避开DLE）后校验应失败
+            size_t pos = frame_size / 2;
+            while (frame[pos] == DF1_DLE || frame[pos] == 0x11 || frame[pos - 1] == DF1_DLE) {
+                pos++;
+            }
+            frame[pos] ^= 0x01;
+            df1_decoder_reset(&decoder);
+            TEST_ASSERT(df1_decoder_push(&decoder, frame, frame_size, &consumed, &decoded) == DF1_DECODE_BAD_CHECKSUM,
+                        "损坏的帧应校验失败");
+        }
+    }
+
+    df1_crc16_select(DF1_CRC16_AUTO);
+    TEST_PASS("各内核帧编解码");
+}
+
+int main() {
+    printf("AB DF1 CRC16内核单元测试\n");
+    printf("========================\n\n");
+    printf("自动选择的内核: %s\n\n", df1_crc16_kernel_name(df1_crc16_active()));
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_check_value();
+    total++; passed += test_kernels_agree();
+    total++; passed += test_frame_roundtrip();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "df1_dle.h"
+#include "df1_protocol.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+static const df1_dle_kernel_t kernels[] = {
+    DF1_DLE_SCALAR, DF1_DLE_SSE2, DF1_DLE_AVX2,
+};
+#define KERNEL_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+
+static size_t reference_find(const uint8_t* data, size_t length) {
+    size_t pos = 0;
+    while (pos < length && data[pos] != DF1_DLE) {
+        pos++;
+    }
+    return pos;
+}
+
+// 测试内核选择
+int test_kernel_select() {
+    printf("测试内核选择...\n");
+
+    TEST_ASSERT(df1_dle_supported(DF1_DLE_SCALAR), "整数位运算内核应始终可用");
+    TEST_ASSERT(df1_dle_active() != DF1_DLE_AUTO, "应自动选出一个内核");
+    TEST_ASSERT(strcmp(df1_dle_kernel_name(DF1_DLE_AVX2), "avx2") == 0, "内核名称错误");
+
+    const uint8_t data[] = {1, 2, 3, DF1_DLE};
+    TEST_ASSERT(df1_dle_select(DF1_DLE_SCALAR) == 0 && df1_dle_active() == DF1_DLE_SCALAR, "选择内核失败");
+    TEST_ASSERT(df1_dle_find(data, sizeof(data)) == 3, "选择后查找错误");
+    TEST_ASSERT(df1_dle_select((df1_dle_kernel_t)99) != 0, "无效内核应该失败");
+    TEST_ASSERT(df1_dle_select(DF1_DLE_AUTO) == 0 && df1_dle_active() != DF1_DLE_AUTO, "恢复自动选择失败");
+    TEST_ASSERT(df1_dle_find(NULL, 5) == 5, "NULL数据应返回长度");
+
+    TEST_PASS("内核选择");
+}
+
+// 测试各内核在任意长度、DLE位置与起始对齐下与逐字节查找一致
+int test_kernels_agree() {
+    printf("测试各内核一致性...\n");
+
+    uint8_t data[300];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 1);
+        if (data[i] == DF1_DLE) {
+            data[i] = 0x11;
+        }
+    }
+
+    for (size_t length = 0; length <= 200; length++) {
+        for (size_t offset = 0; offset < 4; offset++) {
+            // dle == length 时数据中没有DLE
+            for (size_t dle = 0; dle <= length; dle++) {
+                uint8_t* block = data + offset;
+                uint8_t saved = dle < length ? block[dle] : 0;
+                if (dle < length) {
+                    block[dle] = DF1_DLE;
+                }
+                size_t expected = reference_find(block, length);
+                for (size_t k = 0; k < KERNEL_COUNT; k++) {
+                    TEST_ASSERT(df1_dle_scan(kernels[k], block, length) == expected, "内核结果与逐字节查找不一致");
+                }
+                if (dle < length) {
+                    block[dle] = saved;
+                }
+            }
+        }
+    }
+
+    uint8_t tricky[64];
+    memset(tricky, 0x90, sizeof(tricky));
+    tricky[40] = 0x00;
+    tricky[50] = DF1_DLE;
+    for (size_t k = 0; k < KERNEL_COUNT; k++) {
+        TEST_ASSERT(df1_dle_scan(kernels[k], tricky, sizeof(tricky)) == 50, "相近字节不应误判为DLE");
+    }
+
+    TEST_PASS("各内核一致性");
+}
+
+// 测试转义与去转义：DLE密集、稀疏与没有DLE的数据，解码时按各种分段输入
+int test_escape_roundtrip() {
+    printf("测试转义与去转义...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    uint8_t pdu[6 + DF1_MAX_DATA_SIZE] = {0x00, 0x01, 0x4F, 0x00, 0x10, 0x10};
+    uint8_t frame[DF1_MAX_FRAME_SIZE];
+    uint8_t data[DF1_MAX_DATA_SIZE];
+    const size_t chunks[] = {1, 3, 17, 64, DF1_MAX_FRAME_SIZE};
+
+    for (size_t k = 0; k < KERNEL_COUNT; k++) {
+        if (!df1_dle_supported(kernels[k])) {
+            continue;
+        }
+        TEST_ASSERT(df1_dle_select(kernels[k]) == 0, "选择内核失败");
+
+        for (int pattern = 0; pattern < 3; pattern++) {
+            for (size_t i = 6; i < sizeof(pdu); i++) {
+                uint8_t value = (uint8_t)(i * 13);
+                if (pattern == 0) {
+                    value = DF1_DLE;
+                } else if (pattern == 2 && value == DF1_DLE) {
+                    value = 0x11;
+                }
+                pdu[i] = value;
+            }
+
+            size_t frame_size = 0;
+            TEST_ASSERT(df1_build_frame(&config, pdu, sizeof(pdu), frame, sizeof(frame), &frame_size) == 0,
+                        "构建帧失败");
+            if (pattern == 0) {
+                TEST_ASSERT(frame_size > 2 * DF1_MAX_DATA_SIZE, "全为DLE的数据应全部转义");
+            }
+
+            size_t actual = 0;
+            TEST_ASSERT(df1_parse_response(frame, frame_size, data, sizeof(data), &actual) == 0, "解析响应失败");
+            TEST_ASSERT(actual == DF1_MAX_DATA_SIZE && memcmp(data, pdu + 6, actual) == 0, "解析数据错误");
+
+            // 输出缓冲区小于数据时截断
+            TEST_ASSERT(df1_parse_response(frame, frame_size, data, 10, &actual) == 0 && actual == 10 &&
+                        memcmp(data, pdu + 6, 10) == 0, "截断解析错误");
+
+            for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+                df1_decoder_t decoder;
+                df1_decoder_init(&decoder, DF1_CHECK_CRC16);
+                df1_frame_t decoded;
+                int result = DF1_DECODE_NEED_MORE;
+                size_t offset = 0;
+                while (offset < frame_size && result == DF1_DECODE_NEED_MORE) {
+                    size_t size = frame_size - offset < chunks[c] ? frame_size - offset : chunks[c];
+                    size_t consumed = 0;
+                    result = df1_decoder_push(&decoder, frame + offset, size, &consumed, &decoded);
+                    offset += consumed;
+                }
+                TEST_ASSERT(result == DF1_DECODE_FRAME, "分段解码失败");
+                TEST_ASSERT(decoded.pdu_length == sizeof(pdu) && memcmp(decoded.pdu, pdu, sizeof(pdu)) == 0,
+                            "分段解码数据错误");
+            }
+        }
+
+        // 超过上限的帧在第 DF1_MAX_PDU_SIZE + 1 个字节处报告溢出
+        uint8_t huge[DF1_MAX_PDU_SIZE + 16];
+        memset(huge, 0x55, sizeof(huge));
+        huge[0] = DF1_DLE;
+        huge[1] = DF1_STX;
+        df1_decoder_t decoder;
+        df1_decoder_init(&decoder, DF1_CHECK_CRC16);
+        df1_frame_t decoded;
+        size_t consumed = 0;
+        TEST_ASSERT(df1_decoder_push(&decoder, huge, sizeof(huge), &consumed, &decoded) == DF1_DECODE_OVERFLOW,
+                    "过长的帧应报告溢出");
+        TEST_ASSERT(consumed == 2 + DF1_MAX_PDU_SIZE + 1, "溢出位置错误");
+    }
+
+    df1_dle_select(DF1_DLE_AUTO);
+    TEST_PASS("转义与去转义");
+}
+
+int main() {
+    printf("AB DF1 DLE查找内核单元测试\n");
+    printf("==========================\n\n");
+    printf("自动选择的内核: %s\n\n", df1_dle_kernel_name(df1_dle_active()));
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_kernel_select();
+    total++; passed += test_kernels_agree();
+    total++; passed += test_escape_roundtrip();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
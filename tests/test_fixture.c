@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include "test_fixture.h"
+
+df1_sim_t* fixture_sim_create(df1_duplex_t duplex) {
+    const uint8_t station = 1;
+    return fixture_sim_create_stations(duplex, false, &station, 1);
+}
+
+df1_sim_t* fixture_sim_create_stations(df1_duplex_t duplex, bool polled, const uint8_t* stations, size_t count) {
+    df1_sim_config_t config;
+    df1_sim_config_default(&config);
+    config.duplex = duplex;
+    config.polled = polled;
+
+    df1_sim_t* sim = df1_sim_create(&config);
+    for (size_t i = 0; sim && i < count; i++) {
+        if (df1_sim_add_station(sim, stations[i]) != 0 ||
+            df1_sim_add_file(sim, stations[i], DF1_ADDR_B, 3, 16) != 0 ||
+            df1_sim_add_file(sim, stations[i], DF1_ADDR_T, 4, 8) != 0 ||
+            df1_sim_add_file(sim, stations[i], DF1_ADDR_C, 5, 8) != 0 ||
+            df1_sim_add_file(sim, stations[i], DF1_ADDR_N, 7, 300) != 0 ||
+            df1_sim_add_file(sim, stations[i], DF1_ADDR_F, 8, 100) != 0 ||
+            df1_sim_add_file(sim, stations[i], DF1_ADDR_L, 9, 100) != 0) {
+            df1_sim_destroy(sim);
+            return NULL;
+        }
+    }
+    return sim;
+}
+
+void fixture_master_config(df1_serial_config_t* serial_config, df1_config_t* config, df1_duplex_t duplex,
+                           int timeout_ms) {
+    df1_serial_config_default(serial_config);
+    serial_config->timeout_ms = timeout_ms;
+    df1_config_init(config, 1, 1, 0);
+    config->duplex = duplex;
+}
+
+df1_serial_t* fixture_open_loopback(df1_sim_t* sim, df1_duplex_t duplex, int timeout_ms) {
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, duplex, timeout_ms);
+
+    df1_transport_t transport;
+    df1_serial_t* port = df1_serial_create();
+    if (!port || df1_sim_open_loopback(sim, &transport) != 0) {
+        df1_serial_destroy(port);
+        return NULL;
+    }
+    if (df1_serial_open_transport(port, &transport, &serial_config, &config) != 0) {
+        df1_transport_close(&transport);
+        df1_serial_destroy(port);
+        return NULL;
+    }
+    return port;
+}
+
+df1_serial_t* fixture_open_pty(df1_sim_t* sim, df1_duplex_t duplex, int timeout_ms) {
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, duplex, timeout_ms);
+
+    df1_serial_t* port = df1_serial_create();
+    if (!port || df1_sim_open_pty(sim) != 0) {
+        df1_serial_destroy(port);
+        return NULL;
+    }
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "%s", df1_sim_port_name(sim));
+    if (df1_serial_open(port, &serial_config, &config) != 0) {
+        df1_serial_destroy(port);
+        return NULL;
+    }
+    return port;
+}
@@ -0,0 +1,71 @@
+#ifndef AB_DF1_TEST_FIXTURE_H_
+#define AB_DF1_TEST_FIXTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "df1_serial.h"
+#include "df1_sim.h"
+
+/**
+ * @brief 测试共用的模拟从站与主站连接
+ *
+ * 各测试程序通过 df1_sim 模拟PLC，不再各自实现伪终端应答线程。每个从站带有常用数据文件：
+ * B3（16字）、T4（8个）、C5（8个）、N7（300字）、F8（100个）与 L9（100个），
+ * 测试需要的其他文件用 df1_sim_add_file 追加。
+ */
+
+/**
+ * @brief 创建站号为1、带有常用数据文件的模拟从站
+ *
+ * @param duplex 链路工作方式
+ * @return 模拟从站，失败返回NULL
+ */
+df1_sim_t* fixture_sim_create(df1_duplex_t duplex);
+
+/**
+ * @brief 创建一条线路上的多个模拟从站，每个从站带有常用数据文件
+ *
+ * @param duplex 链路工作方式
+ * @param polled 半双工：响应等待主站轮询后发送
+ * @param stations 站号
+ * @param count 站号数量
+ * @return 模拟从站，失败返回NULL
+ */
+df1_sim_t* fixture_sim_create_stations(df1_duplex_t duplex, bool polled, const uint8_t* stations, size_t count);
+
+/**
+ * @brief 初始化访问站号1的主站配置
+ *
+ * @param serial_config 连接配置
+ * @param config DF1配置
+ * @param duplex 链路工作方式
+ * @param timeout_ms 事务超时（毫秒）
+ */
+void fixture_master_config(df1_serial_config_t* serial_config, df1_config_t* config, df1_duplex_t duplex,
+                           int timeout_ms);
+
+/**
+ * @brief 经内存回环连接模拟从站，从站在主站发送时同步应答
+ *
+ * @param sim 模拟从站
+ * @param duplex 链路工作方式
+ * @param timeout_ms 事务超时（毫秒）
+ * @return 已打开的连接，失败返回NULL
+ */
+df1_serial_t* fixture_open_loopback(df1_sim_t* sim, df1_duplex_t duplex, int timeout_ms);
+
+/**
+ * @brief 经伪终端连接模拟从站
+ *
+ * 模拟从站不自动应答：调用者用 df1_sim_start 启动应答线程，或在自己的循环中调用
+ * df1_sim_process。
+ *
+ * @param sim 模拟从站
+ * @param duplex 链路工作方式
+ * @param timeout_ms 事务超时（毫秒）
+ * @return 已打开的连接，失败返回NULL
+ */
+df1_serial_t* fixture_open_pty(df1_sim_t* sim, df1_duplex_t duplex, int timeout_ms);
+
+#endif // AB_DF1_TEST_FIXTURE_H_
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "df1_link.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+// 记录回调结果
+typedef struct {
+    int calls;
+    int status;
+    uint16_t tns;
+} completion_t;
+
+static void on_complete(void* user_data, int status, const df1_frame_t* reply) {
+    completion_t* completion = (completion_t*)user_data;
+    completion->calls++;
+    completion->status = status;
+    completion->tns = reply ? reply->tns : 0;
+}
+
+// 取出链路层全部待发送字节
+static size_t take_output(df1_link_t* link, uint8_t* buffer, size_t size) {
+    const uint8_t* data;
+    size_t length = df1_link_output(link, &data);
+    if (length > size) {
+        length = size;
+    }
+    memcpy(buffer, data, length);
+    df1_link_output_done(link, length);
+    return length;
+}
+
+// 构建一个全双工命令帧
+static size_t build_command(df1_config_t* config, uint16_t tns, uint8_t* buffer, size_t size) {
+    size_t actual_size = 0;
+    config->transaction_id = tns;
+    df1_build_read_command(config, "N7:0", 2, buffer, size, &actual_size);
+    return actual_size;
+}
+
+// 构建一个全双工响应帧
+static size_t build_reply(const df1_config_t* config, uint16_t tns, uint8_t* buffer, size_t size) {
+    uint8_t pdu[] = {0x00, 0x01, 0x4F, 0x00, (uint8_t)(tns & 0xFF), (uint8_t)(tns >> 8), 0x34, 0x12};
+    size_t actual_size = 0;
+    df1_build_frame(config, pdu, sizeof(pdu), buffer, size, &actual_size);
+    return actual_size;
+}
+
+static const uint8_t ACK[] = {DF1_DLE, DF1_ACK};
+static const uint8_t NAK[] = {DF1_DLE, DF1_NAK};
+static const uint8_t ENQ[] = {DF1_DLE, DF1_ENQ};
+
+// 测试全双工流水：命令确认后立即发送下一条，响应乱序到达
+int test_pipelined_commands() {
+    printf("测试全双工流水命令...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    config.duplex = DF1_FULL_DUPLEX;
+
+    df1_link_config_t link_config;
+    df1_link_config_default(&link_config, 100);
+    link_config.max_outstanding = 3;
+
+    df1_link_t link;
+    df1_link_init(&link, &link_config, DF1_FULL_DUPLEX, DF1_CHECK_CRC16);
+
+    uint8_t frame[3][64], out[256], reply[64];
+    size_t frame_size[3];
+    completion_t done[3];
+    memset(done, 0, sizeof(done));
+
+    for (int i = 0; i < 3; i++) {
+        frame_size[i] = build_command(&config, (uint16_t)(10 + i), frame[i], sizeof(frame[i]));
+        TEST_ASSERT(frame[i][0] == DF1_DLE && frame[i][1] == DF1_STX, "全双工帧头应为 DLE STX");
+        TEST_ASSERT(df1_link_submit(&link, frame[i], frame_size[i], (uint16_t)(10 + i), 0, on_complete,
+                                    &done[i]) == 0, "提交命令失败");
+    }
+    TEST_ASSERT(!df1_link_can_submit(&link), "窗口已满时不应允许提交");
+
+    // 只发送第一条，等待 ACK
+    size_t length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == frame_size[0] && memcmp(out, frame[0], length) == 0, "应只发送第一条命令");
+
+    df1_link_input(&link, ACK, sizeof(ACK), 1);
+    length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == frame_size[1] && memcmp(out, frame[1], length) == 0, "ACK后应发送第二条命令");
+
+    df1_link_input(&link, ACK, sizeof(ACK), 2);
+    length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == frame_size[2] && memcmp(out, frame[2], length) == 0, "ACK后应发送第三条命令");
+    df1_link_input(&link, ACK, sizeof(ACK), 3);
+    TEST_ASSERT(df1_link_outstanding(&link) == 3, "三条命令应都在等待响应");
+
+    // 响应乱序到达
+    uint16_t order[] = {12, 10, 11};
+    for (int i = 0; i < 3; i++) {
+        size_t reply_size = build_reply(&config, order[i], reply, sizeof(reply));
+        df1_link_input(&link, reply, reply_size, 4);
+        length = take_output(&link, out, sizeof(out));
+        TEST_ASSERT(length == 2 && memcmp(out, ACK, 2) == 0, "收到响应后应回复 DLE ACK");
+    }
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(done[i].calls == 1 && done[i].status == 0, "命令应成功完成一次");
+        TEST_ASSERT(done[i].tns == 10 + i, "响应应按事务ID匹配");
+    }
+    TEST_ASSERT(df1_link_outstanding(&link) == 0, "所有命令应已完成");
+    TEST_ASSERT(df1_link_can_submit(&link), "完成后应允许提交");
+
+    TEST_PASS("全双工流水命令");
+}
+
+// 测试 NAK 重发、ACK 超时 ENQ 与次数用尽
+int test_nak_and_enq() {
+    printf("测试NAK重发与ENQ...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    config.duplex = DF1_FULL_DUPLEX;
+
+    df1_link_config_t link_config;
+    df1_link_config_default(&link_config, 100);
+    link_config.max_nak = 1;
+    link_config.max_enq = 2;
+
+    df1_link_t link;
+    df1_link_init(&link, &link_config, DF1_FULL_DUPLEX, DF1_CHECK_CRC16);
+
+    uint8_t frame[64], out[256];
+    size_t frame_size = build_command(&config, 1, frame, sizeof(frame));
+    completion_t done;
+    memset(&done, 0, sizeof(done));
+
+    TEST_ASSERT(df1_link_submit(&link, frame, frame_size, 1, 0, on_complete, &done) == 0, "提交命令失败");
+    take_output(&link, out, sizeof(out));
+
+    // NAK 后重发同一帧
+    df1_link_input(&link, NAK, sizeof(NAK), 10);
+    size_t length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == frame_size && memcmp(out, frame, length) == 0, "NAK后应重发命令帧");
+
+    // ACK 超时后发送 ENQ
+    TEST_ASSERT(df1_link_next_deadline(&link) == 110, "ACK超时时间错误");
+    df1_link_tick(&link, 110);
+    length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == 2 && memcmp(out, ENQ, 2) == 0, "ACK超时应发送 DLE ENQ");
+    df1_link_tick(&link, 210);
+    TEST_ASSERT(done.calls == 0, "ENQ次数未用尽前不应失败");
+    df1_link_tick(&link, 310);
+    TEST_ASSERT(done.calls == 1 && done.status == -1, "ENQ次数用尽应失败");
+
+    // NAK 次数用尽
+    memset(&done, 0, sizeof(done));
+    TEST_ASSERT(df1_link_submit(&link, frame, frame_size, 1, 400, on_complete, &done) == 0, "提交命令失败");
+    take_output(&link, out, sizeof(out));
+    df1_link_input(&link, NAK, sizeof(NAK), 401);
+    df1_link_input(&link, NAK, sizeof(NAK), 402);
+    TEST_ASSERT(done.calls == 1 && done.status == -1, "NAK次数用尽应失败");
+
+    TEST_PASS("NAK重发与ENQ");
+}
+
+// 测试接收方向：重复消息、校验错误与 ENQ 应答
+int test_receive_side() {
+    printf("测试接收方向链路应答...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    config.duplex = DF1_FULL_DUPLEX;
+
+    df1_link_t link;
+    df1_link_init(&link, NULL, DF1_FULL_DUPLEX, DF1_CHECK_CRC16);
+
+    uint8_t frame[64], out[256], reply[64];
+    size_t frame_size = build_command(&config, 7, frame, sizeof(frame));
+    completion_t done;
+    memset(&done, 0, sizeof(done));
+
+    TEST_ASSERT(df1_link_submit(&link, frame, frame_size, 7, 0, on_complete, &done) == 0, "提交命令失败");
+    take_output(&link, out, sizeof(out));
+
+    // 响应先于 ACK 到达，视为已确认
+    size_t reply_size = build_reply(&config, 7, reply, sizeof(reply));
+    df1_link_input(&link, reply, reply_size, 1);
+    TEST_ASSERT(done.calls == 1 && done.status == 0, "响应先到应视为完成");
+    take_output(&link, out, sizeof(out));
+
+    // 对方重发的重复消息：再次 ACK 但不重复处理
+    df1_link_input(&link, reply, reply_size, 2);
+    size_t length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == 2 && memcmp(out, ACK, 2) == 0, "重复消息也应回复 ACK");
+    TEST_ASSERT(link.duplicates == 1 && done.calls == 1, "重复消息应被丢弃");
+
+    // 校验错误回复 NAK，ENQ 时重发最近一次应答
+    reply[reply_size - 1] ^= 0x5A;
+    df1_link_input(&link, reply, reply_size, 3);
+    length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == 2 && memcmp(out, NAK, 2) == 0, "校验错误应回复 NAK");
+    df1_link_input(&link, ENQ, sizeof(ENQ), 4);
+    length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == 2 && memcmp(out, NAK, 2) == 0, "ENQ应重发最近一次应答");
+
+    TEST_PASS("接收方向链路应答");
+}
+
+// 测试响应超时与半双工窗口
+int test_reply_timeout_half_duplex() {
+    printf("测试响应超时与半双工窗口...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+
+    df1_link_config_t link_config;
+    df1_link_config_default(&link_config, 50);
+    link_config.max_outstanding = 4;
+
+    df1_link_t link;
+    df1_link_init(&link, &link_config, DF1_HALF_DUPLEX, DF1_CHECK_CRC16);
+
+    uint8_t frame[64], out[256];
+    size_t frame_size = build_command(&config, 3, frame, sizeof(frame));
+    completion_t done;
+    memset(&done, 0, sizeof(done));
+
+    TEST_ASSERT(df1_link_submit(&link, frame, frame_size, 3, 0, on_complete, &done) == 0, "提交命令失败");
+    TEST_ASSERT(!df1_link_can_submit(&link), "半双工同一时间只允许一条命令");
+    size_t length = take_output(&link, out, sizeof(out));
+    TEST_ASSERT(length == frame_size, "半双工应直接发送命令");
+
+    TEST_ASSERT(df1_link_next_deadline(&link) == 50, "响应超时时间错误");
+    df1_link_tick(&link, 49);
+    TEST_ASSERT(done.calls == 0, "超时前不应失败");
+    df1_link_tick(&link, 50);
+    TEST_ASSERT(done.calls == 1 && done.status == -1, "响应超时应失败");
+    TEST_ASSERT(take_output(&link, out, sizeof(out)) == 0, "半双工不应发送链路应答");
+
+    TEST_PASS("响应超时与半双工窗口");
+}
+
+int main() {
+    printf("AB DF1 链路层单元测试\n");
+    printf("=====================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_pipelined_commands();
+    total++; passed += test_nak_and_enq();
+    total++; passed += test_receive_side();
+    total++; passed += test_reply_timeout_half_duplex();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
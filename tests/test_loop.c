@@ -0,0 +1,296 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "df1_loop.h"
+#include "test_fixture.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+typedef struct {
+    int calls;
+    int failures;
+    int resubmit;
+    df1_loop_t* loop;
+    df1_request_t* extra;
+} completion_t;
+
+static void on_complete(void* user_data, df1_serial_t* port, df1_request_t* request) {
+    completion_t* completion = (completion_t*)user_data;
+    completion->calls++;
+    if (request->status != 0 || request->actual_size != 2 || request->read_data[1] != 0x55) {
+        completion->failures++;
+    }
+
+    // 回调中直接提交下一条请求
+    if (completion->resubmit > 0) {
+        completion->resubmit--;
+        df1_loop_submit(completion->loop, port, completion->extra, on_complete, completion);
+    }
+}
+
+// 测试一个事件循环同时驱动全双工与半双工连接
+int test_multiplexed_ports() {
+    printf("测试多连接事件循环...\n");
+
+    df1_serial_t* ports[2];
+    df1_sim_t* sims[2];
+    df1_duplex_t duplex[2] = {DF1_FULL_DUPLEX, DF1_HALF_DUPLEX};
+    df1_loop_t* loop = df1_loop_create();
+    TEST_ASSERT(loop != NULL, "创建事件循环失败");
+
+    for (int i = 0; i < 2; i++) {
+        // 模拟从站不启动应答线程，由下面的循环与事件循环交替驱动
+        const uint8_t value[2] = {0x00, 0x55};
+        sims[i] = fixture_sim_create(duplex[i]);
+        TEST_ASSERT(sims[i] && df1_sim_set(sims[i], 1, "N7:0", value, sizeof(value)) == 0, "创建模拟从站失败");
+        ports[i] = fixture_open_pty(sims[i], duplex[i], 500);
+        TEST_ASSERT(ports[i] != NULL, "打开伪终端失败");
+        TEST_ASSERT(df1_loop_add(loop, ports[i]) == 0, "加入事件循环失败");
+    }
+    TEST_ASSERT(df1_loop_add(loop, ports[0]) != 0, "重复加入应该失败");
+
+    df1_address_t addr;
+    df1_address_parse("N7:0", &addr);
+
+    df1_request_t requests[2][4], extra[2];
+    uint8_t data[2][5][2];
+    completion_t done[2];
+    memset(done, 0, sizeof(done));
+
+    for (int i = 0; i < 2; i++) {
+        done[i].loop = loop;
+        done[i].resubmit = 1;
+        done[i].extra = &extra[i];
+        memset(&extra[i], 0, sizeof(df1_request_t));
+        extra[i].command = DF1_CMD_READ;
+        extra[i].addr = &addr;
+        extra[i].read_data = data[i][4];
+        extra[i].size = 2;
+
+        for (int j = 0; j < 4; j++) {
+            df1_request_t* request = &requests[i][j];
+            memset(request, 0, sizeof(df1_request_t));
+            request->command = DF1_CMD_READ;
+            request->addr = &addr;
+            request->read_data = data[i][j];
+            request->size = 2;
+            TEST_ASSERT(df1_loop_submit(loop, ports[i], request, on_complete, &done[i]) == 0, "提交请求失败");
+        }
+    }
+    TEST_ASSERT(df1_loop_pending(loop) == 8, "未完成请求数错误");
+
+    long long deadline = now_ms() + 2000;
+    while (df1_loop_pending(loop) > 0 && now_ms() < deadline) {
+        df1_loop_process(loop, 5);
+        df1_sim_process(sims[0], 0);
+        df1_sim_process(sims[1], 0);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        df1_sim_stats_t stats;
+        df1_sim_get_stats(sims[i], &stats);
+        TEST_ASSERT(done[i].calls == 5 && done[i].failures == 0, "所有请求应成功完成");
+        TEST_ASSERT(stats.commands == 5, "模拟从站应收到全部命令");
+        for (int j = 0; j < 4; j++) {
+            TEST_ASSERT(requests[i][j].status == 0, "请求状态应为成功");
+        }
+    }
+
+    df1_loop_destroy(loop);
+    for (int i = 0; i < 2; i++) {
+        df1_serial_destroy(ports[i]);
+        df1_sim_destroy(sims[i]);
+    }
+
+    TEST_PASS("多连接事件循环");
+}
+
+// 测试响应超时由定时器驱动，并可通过外部事件循环等待
+int test_deadline_timer() {
+    printf("测试事件循环超时...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_HALF_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_pty(sim, DF1_HALF_DUPLEX, 40);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    df1_loop_t* loop = df1_loop_create();
+    TEST_ASSERT(loop && df1_loop_add(loop, port) == 0, "加入事件循环失败");
+
+    df1_address_t addr;
+    df1_address_parse("N7:0", &addr);
+    uint8_t data[2];
+    df1_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.command = DF1_CMD_READ;
+    request.addr = &addr;
+    request.read_data = data;
+    request.size = 2;
+
+    completion_t done;
+    memset(&done, 0, sizeof(done));
+    long long start = now_ms();
+    TEST_ASSERT(df1_loop_submit(loop, port, &request, on_complete, &done) == 0, "提交请求失败");
+    TEST_ASSERT(request.status == DF1_REQUEST_PENDING, "提交后请求应处于处理中");
+
+    // 模拟从站不应答：事件循环描述符在超时到期时变为可读
+    struct pollfd pfd = {df1_loop_fd(loop), POLLIN, 0};
+    int completed = 0;
+    while (completed == 0 && now_ms() - start < 1000) {
+        TEST_ASSERT(poll(&pfd, 1, 1000) == 1, "事件循环描述符应变为可读");
+        completed = df1_loop_process(loop, 0);
+    }
+    long long elapsed = now_ms() - start;
+
+    TEST_ASSERT(completed == 1 && done.calls == 1 && request.status == -1, "超时请求应失败");
+    TEST_ASSERT(elapsed >= 40 && elapsed < 500, "超时时间错误");
+    TEST_ASSERT(df1_loop_pending(loop) == 0, "不应有未完成请求");
+
+    // 移出后不能再提交
+    TEST_ASSERT(df1_loop_remove(loop, port) == 0, "移出连接失败");
+    TEST_ASSERT(df1_loop_submit(loop, port, &request, on_complete, &done) != 0, "移出后提交应该失败");
+
+    df1_loop_destroy(loop);
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+
+    TEST_PASS("事件循环超时");
+}
+
+// 对端关闭后在途与排队的请求应立即失败，连接不再被监听，事件循环不空转
+static int check_peer_close(df1_serial_t* port, int peer_fd) {
+    df1_loop_t* loop = df1_loop_create();
+    TEST_ASSERT(loop && df1_loop_add(loop, port) == 0, "加入事件循环失败");
+
+    df1_address_t addr;
+    df1_address_parse("N7:0", &addr);
+    uint8_t data[2][2];
+    df1_request_t requests[2];
+    completion_t done;
+    memset(&done, 0, sizeof(done));
+    for (int i = 0; i < 2; i++) {
+        memset(&requests[i], 0, sizeof(df1_request_t));
+        requests[i].command = DF1_CMD_READ;
+        requests[i].addr = &addr;
+        requests[i].read_data = data[i];
+        requests[i].size = 2;
+        TEST_ASSERT(df1_loop_submit(loop, port, &requests[i], on_complete, &done) == 0, "提交请求失败");
+    }
+    df1_loop_process(loop, 0);
+
+    // 对端读走命令后关闭：TCP 发出 FIN 而不是 RST，连接上读到0字节
+    uint8_t command[64];
+    struct pollfd pfd = {peer_fd, POLLIN, 0};
+    TEST_ASSERT(poll(&pfd, 1, 1000) == 1 && read(peer_fd, command, sizeof(command)) > 0, "对端应收到命令");
+    long long start = now_ms();
+    close(peer_fd);
+    while (df1_loop_pending(loop) > 0 && now_ms() - start < 1000) {
+        df1_loop_process(loop, 50);
+    }
+    TEST_ASSERT(df1_loop_pending(loop) == 0 && done.calls == 2, "对端关闭后请求应全部完成");
+    TEST_ASSERT(requests[0].status == -1 && requests[1].status == -1, "对端关闭后请求应失败");
+    TEST_ASSERT(now_ms() - start < 500, "请求应在超时之前失败");
+
+    // 连接已不再监听：没有请求时每一轮都等满超时
+    int rounds = 0;
+    start = now_ms();
+    while (now_ms() - start < 200) {
+        df1_loop_process(loop, 50);
+        rounds++;
+    }
+    TEST_ASSERT(rounds <= 5, "对端关闭后事件循环不应空转");
+    TEST_ASSERT(df1_loop_submit(loop, port, &requests[0], on_complete, &done) != 0, "对端关闭后提交应该失败");
+
+    df1_loop_destroy(loop);
+    return 1;
+}
+
+// 测试TCP对端与伪终端从设备关闭后连接失败
+int test_peer_closed() {
+    printf("测试对端关闭...\n");
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    TEST_ASSERT(listener >= 0 && bind(listener, (struct sockaddr*)&addr, sizeof(addr)) == 0 &&
+                listen(listener, 1) == 0 && getsockname(listener, (struct sockaddr*)&addr, &addr_len) == 0,
+                "创建监听套接字失败");
+
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, DF1_HALF_DUPLEX, 1000);
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "tcp://127.0.0.1:%u",
+             (unsigned)ntohs(addr.sin_port));
+    df1_serial_t* port = df1_serial_create();
+    TEST_ASSERT(port && df1_serial_open(port, &serial_config, &config) == 0, "连接失败");
+    int fd = accept(listener, NULL, NULL);
+    TEST_ASSERT(fd >= 0, "接受连接失败");
+    TEST_ASSERT(check_peer_close(port, fd), "TCP对端关闭");
+    df1_serial_destroy(port);
+    close(listener);
+
+    // 伪终端主设备：从设备关闭后读取只返回 EAGAIN，由挂断事件判断
+    df1_transport_t pty;
+    df1_transport_init(&pty);
+    TEST_ASSERT(df1_transport_open(&pty, &df1_transport_pty, &serial_config) == 0, "打开伪终端失败");
+    int slave = open(df1_transport_pty_name(&pty), O_RDWR | O_NOCTTY);
+    TEST_ASSERT(slave >= 0, "打开伪终端从设备失败");
+    port = df1_serial_create();
+    TEST_ASSERT(port && df1_serial_open_transport(port, &pty, &serial_config, &config) == 0, "打开连接失败");
+    TEST_ASSERT(check_peer_close(port, slave), "伪终端从设备关闭");
+    df1_serial_destroy(port);
+
+    TEST_PASS("对端关闭");
+}
+
+int main() {
+    printf("AB DF1 事件循环单元测试\n");
+    printf("=======================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_multiplexed_ports();
+    total++; passed += test_deadline_timer();
+    total++; passed += test_peer_closed();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,296 @@
+#define _XOPEN_SOURCE 600
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "df1_master.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+#define TIMEOUT_MS 20
+
+static const uint8_t ACK[] = {DF1_DLE, DF1_ACK};
+static const uint8_t EOT[] = {DF1_DLE, DF1_EOT};
+
+// 打开伪终端上的半双工连接：测试在主端 peer 上扮演从站，每一步之前写入从站的应答
+static df1_serial_t* open_pty(int* peer) {
+    *peer = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (*peer < 0) {
+        return NULL;
+    }
+    if (grantpt(*peer) != 0 || unlockpt(*peer) != 0) {
+        close(*peer);
+        return NULL;
+    }
+
+    df1_serial_config_t serial_config;
+    df1_serial_config_default(&serial_config);
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "%s", ptsname(*peer));
+    serial_config.timeout_ms = TIMEOUT_MS;
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+
+    df1_serial_t* port = df1_serial_create();
+    if (!port || df1_serial_open(port, &serial_config, &config) != 0) {
+        df1_serial_destroy(port);
+        close(*peer);
+        return NULL;
+    }
+    return port;
+}
+
+// 取出主站已发送的全部字节：读到10毫秒内没有新的字节为止
+static size_t take_output(int peer, uint8_t* buffer, size_t size) {
+    size_t length = 0;
+    struct pollfd pfd = {peer, POLLIN, 0};
+    while (length < size && poll(&pfd, 1, 10) > 0) {
+        ssize_t n = read(peer, buffer + length, size - length);
+        if (n <= 0) {
+            break;
+        }
+        length += (size_t)n;
+    }
+    return length;
+}
+
+// 构建从站1发往主站的消息帧
+static size_t build_message(uint8_t cmd, uint16_t tns, const uint8_t* data, size_t size, uint8_t* buffer,
+                            size_t buffer_size) {
+    df1_config_t config;
+    df1_config_init(&config, 1, 0, 1);
+    uint8_t pdu[64] = {0x00, 0x01, cmd, 0x00, (uint8_t)(tns & 0xFF), (uint8_t)(tns >> 8)};
+    memcpy(pdu + 6, data, size);
+
+    size_t actual_size = 0;
+    df1_build_frame(&config, pdu, 6 + size, buffer, buffer_size, &actual_size);
+    return actual_size;
+}
+
+// 写入从站的应答后执行一次线路操作，返回主站发出的字节
+static size_t step_with(df1_master_t* master, int peer, const uint8_t* input, size_t input_size, uint8_t* output,
+                        size_t output_size, int* result) {
+    if (input_size > 0 && write(peer, input, input_size) != (ssize_t)input_size) {
+        *result = -1;
+        return 0;
+    }
+    *result = df1_master_step(master);
+    return take_output(peer, output, output_size);
+}
+
+// 记录主动上报消息回调
+typedef struct {
+    int calls;
+    uint8_t station;
+    uint8_t cmd;
+    uint16_t tns;
+} messages_t;
+
+static void on_message(void* user_data, uint8_t station, const df1_frame_t* message) {
+    messages_t* messages = (messages_t*)user_data;
+    messages->calls++;
+    messages->station = station;
+    messages->cmd = message->cmd;
+    messages->tns = message->tns;
+}
+
+// 测试空闲从站每次 DLE EOT 或无应答后轮询间隔加倍，收到消息后恢复
+int test_idle_backoff() {
+    printf("测试空闲轮询退避...\n");
+
+    int peer = -1;
+    df1_serial_t* port = open_pty(&peer);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    df1_master_config_t config;
+    df1_master_config_default(&config, TIMEOUT_MS);
+    config.idle_poll_min_ms = 50;
+    config.idle_poll_max_ms = 200;
+
+    df1_master_t master;
+    TEST_ASSERT(df1_master_init(&master, port, &config) == 0, "初始化主站失败");
+    TEST_ASSERT(df1_master_add_station(&master, 1, 1) == 0, "添加从站失败");
+    TEST_ASSERT(df1_master_add_station(&master, 1, 1) != 0, "重复添加从站应该失败");
+    messages_t messages;
+    memset(&messages, 0, sizeof(messages));
+    df1_master_set_message_callback(&master, on_message, &messages);
+    df1_master_station_t* st = &master.stations[0];
+
+    uint8_t poll[8];
+    size_t poll_size = 0;
+    TEST_ASSERT(df1_build_poll(1, poll, sizeof(poll), &poll_size) == 0, "构建轮询包失败");
+
+    // 每次 DLE EOT 后间隔加倍，直到上限
+    uint8_t output[256];
+    int result = 0;
+    const int intervals[] = {100, 200, 200};
+    for (int i = 0; i < 3; i++) {
+        st->next_poll_ms = 0; // 让轮询立即到期
+        size_t length = step_with(&master, peer, EOT, sizeof(EOT), output, sizeof(output), &result);
+        TEST_ASSERT(result == 1, "轮询失败");
+        TEST_ASSERT(length == poll_size && memcmp(output, poll, poll_size) == 0, "应发送 DLE ENQ STN BCC 轮询包");
+        TEST_ASSERT(st->eots == (unsigned long)i + 1, "DLE EOT 次数错误");
+        TEST_ASSERT(st->poll_interval_ms == intervals[i], "DLE EOT 后轮询间隔应加倍");
+        if (i == 0) {
+            TEST_ASSERT(df1_master_step(&master) == 0, "轮询间隔未到时不应再次轮询");
+        }
+    }
+
+    // 无应答同样退避
+    st->next_poll_ms = 0;
+    step_with(&master, peer, NULL, 0, output, sizeof(output), &result);
+    TEST_ASSERT(result == 1 && st->timeouts == 1, "无应答应计为超时");
+    TEST_ASSERT(st->poll_interval_ms == 200, "无应答后轮询间隔应保持上限");
+
+    // 收到消息后应答 DLE ACK，间隔恢复为最小值并立即再次轮询
+    uint8_t message[64];
+    const uint8_t data[] = {0x01, 0x02};
+    size_t message_size = build_message(0x0F, 0x1234, data, sizeof(data), message, sizeof(message));
+    st->next_poll_ms = 0;
+    size_t length = step_with(&master, peer, message, message_size, output, sizeof(output), &result);
+    TEST_ASSERT(result == 1, "轮询失败");
+    TEST_ASSERT(length == poll_size + 2 && memcmp(output + poll_size, ACK, 2) == 0, "收到消息后应回复 DLE ACK");
+    TEST_ASSERT(st->poll_interval_ms == 50, "收到消息后轮询间隔应恢复");
+    TEST_ASSERT(df1_master_step(&master) == 1, "收到消息后应立即再次轮询");
+    take_output(peer, output, sizeof(output));
+
+    TEST_ASSERT(master.unsolicited == 1 && messages.calls == 1, "未匹配命令的消息应回调一次");
+    TEST_ASSERT(messages.station == 1 && messages.cmd == 0x0F && messages.tns == 0x1234, "回调的消息内容错误");
+
+    df1_serial_destroy(port);
+    close(peer);
+    TEST_PASS("空闲轮询退避");
+}
+
+// 测试从站未收到 ACK 而重发的消息按 (CMD, TNS) 丢弃
+int test_duplicate_message() {
+    printf("测试重复消息检测...\n");
+
+    int peer = -1;
+    df1_serial_t* port = open_pty(&peer);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    df1_master_t master;
+    TEST_ASSERT(df1_master_init(&master, port, NULL) == 0, "初始化主站失败");
+    TEST_ASSERT(df1_master_add_station(&master, 1, 1) == 0, "添加从站失败");
+    messages_t messages;
+    memset(&messages, 0, sizeof(messages));
+    df1_master_set_message_callback(&master, on_message, &messages);
+    df1_master_station_t* st = &master.stations[0];
+
+    // 依次收到：新消息、重发、同CMD新TNS、同TNS新CMD
+    const struct {
+        uint8_t cmd;
+        uint16_t tns;
+        int calls;
+    } script[] = {{0x0F, 7, 1}, {0x0F, 7, 1}, {0x0F, 8, 2}, {0x06, 8, 3}};
+
+    uint8_t message[64];
+    uint8_t output[256];
+    int result = 0;
+    for (size_t i = 0; i < sizeof(script) / sizeof(script[0]); i++) {
+        size_t message_size = build_message(script[i].cmd, script[i].tns, NULL, 0, message, sizeof(message));
+        st->next_poll_ms = 0;
+        size_t length = step_with(&master, peer, message, message_size, output, sizeof(output), &result);
+        TEST_ASSERT(result == 1, "轮询失败");
+        TEST_ASSERT(length >= 2 && memcmp(output + length - 2, ACK, 2) == 0, "重复的消息也应回复 DLE ACK");
+        TEST_ASSERT(messages.calls == script[i].calls, "重复消息检测错误");
+    }
+    TEST_ASSERT(st->messages == 4 && master.unsolicited == 3, "消息计数错误");
+    TEST_ASSERT(messages.cmd == 0x06 && messages.tns == 8, "回调的消息内容错误");
+
+    df1_serial_destroy(port);
+    close(peer);
+    TEST_PASS("重复消息检测");
+}
+
+// 测试命令经 ACK 确认后，轮询得到的响应按事务ID完成请求而不回调
+int test_reply_matched() {
+    printf("测试响应匹配...\n");
+
+    int peer = -1;
+    df1_serial_t* port = open_pty(&peer);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    df1_master_t master;
+    TEST_ASSERT(df1_master_init(&master, port, NULL) == 0, "初始化主站失败");
+    TEST_ASSERT(df1_master_add_station(&master, 1, 1) == 0, "添加从站失败");
+    messages_t messages;
+    memset(&messages, 0, sizeof(messages));
+    df1_master_set_message_callback(&master, on_message, &messages);
+    df1_master_station_t* st = &master.stations[0];
+
+    df1_address_t addr;
+    TEST_ASSERT(df1_address_parse("N7:0", &addr) == 0, "解析地址失败");
+    uint8_t data[2] = {0, 0};
+    df1_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.command = DF1_CMD_READ;
+    request.addr = &addr;
+    request.read_data = data;
+    request.size = sizeof(data);
+    TEST_ASSERT(df1_master_submit(&master, 2, &request) != 0, "向不存在的从站提交应该失败");
+    TEST_ASSERT(df1_master_submit(&master, 1, &request) == 0, "提交请求失败");
+    TEST_ASSERT(request.status == DF1_REQUEST_PENDING && df1_master_pending(&master) == 1, "请求应处于等待状态");
+
+    // 有待发送的命令时先发送命令，从站以 DLE ACK 确认
+    uint8_t output[256];
+    int result = 0;
+    size_t length = step_with(&master, peer, ACK, sizeof(ACK), output, sizeof(output), &result);
+    TEST_ASSERT(result == 1 && length > 2 && output[0] == DF1_DLE && output[1] == DF1_SOH, "应发送命令帧");
+    TEST_ASSERT(st->polls == 0 && st->pending_count == 1, "确认后的命令应等待响应");
+
+    // 响应按事务ID匹配
+    const uint8_t reply_data[] = {0x34, 0x12};
+    uint8_t reply[64];
+    size_t reply_size = build_message(0x4F, port->df1_config.transaction_id, reply_data, sizeof(reply_data), reply,
+                                      sizeof(reply));
+    st->next_poll_ms = 0;
+    length = step_with(&master, peer, reply, reply_size, output, sizeof(output), &result);
+    TEST_ASSERT(result == 1 && memcmp(output + length - 2, ACK, 2) == 0, "收到响应后应回复 DLE ACK");
+    TEST_ASSERT(request.status == 0 && request.actual_size == 2, "请求应成功完成");
+    TEST_ASSERT(data[0] == 0x34 && data[1] == 0x12, "响应数据错误");
+    TEST_ASSERT(st->pending_count == 0 && df1_master_pending(&master) == 0, "请求应已完成");
+    TEST_ASSERT(messages.calls == 0 && master.unsolicited == 0, "匹配命令的响应不应回调");
+
+    df1_serial_destroy(port);
+    close(peer);
+    TEST_PASS("响应匹配");
+}
+
+int main() {
+    printf("AB DF1 轮询主站单元测试\n");
+    printf("=======================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_idle_backoff();
+    total++; passed += test_duplicate_message();
+    total++; passed += test_reply_matched();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <string.h>
+#include "df1_plan.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+#define MAX_ITEMS 256
+
+static df1_address_t addrs[MAX_ITEMS];
+static df1_plan_item_t items[MAX_ITEMS];
+static uint8_t buffers[MAX_ITEMS][8];
+
+// 按地址字符串准备标签
+static size_t setup_items(const char* const* names, const size_t* sizes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        df1_address_parse(names[i], &addrs[i]);
+        items[i].addr = &addrs[i];
+        items[i].size = sizes[i];
+        items[i].data = buffers[i];
+        items[i].status = 1;
+    }
+    return count;
+}
+
+// 测试同一文件中相邻元素合并为一次读取
+int test_adjacent_elements() {
+    printf("测试相邻元素合并...\n");
+    
+    // 倒序注册 N7:0 ~ N7:99
+    for (int i = 0; i < 100; i++) {
+        addrs[i].data_code = DF1_ADDR_N;
+        addrs[i].db_block = 7;
+        addrs[i].address_start = (uint16_t)(99 - i);
+        items[i].addr = &addrs[i];
+        items[i].size = 2;
+        items[i].data = buffers[i];
+    }
+    
+    df1_plan_t plan;
+    df1_plan_init(&plan);
+    TEST_ASSERT(df1_plan_build(&plan, NULL, items, 100) == 0, "规划失败");
+    TEST_ASSERT(plan.block_count == 1, "相邻元素应合并为一次读取");
+    TEST_ASSERT(plan.blocks[0].addr.data_code == DF1_ADDR_N && plan.blocks[0].addr.db_block == 7 &&
+               plan.blocks[0].addr.address_start == 0, "块起始地址错误");
+    TEST_ASSERT(plan.blocks[0].size == 200 && plan.blocks[0].addr.length == 100, "块大小错误");
+    TEST_ASSERT(plan.slice_count == 100 && plan.data_size == 200, "分片数错误");
+    TEST_ASSERT(plan.slices[0].item == 99 && plan.slices[0].offset == 0, "分片应按元素排序");
+    TEST_ASSERT(plan.slices[99].item == 0 && plan.slices[99].offset == 198, "分片偏移错误");
+    
+    df1_plan_free(&plan);
+    TEST_PASS("相邻元素合并");
+}
+
+// 测试按文件号与数据类型分组
+int test_grouping() {
+    printf("测试按文件分组...\n");
+    
+    const char* names[] = {"N7:0", "N9:0", "F8:0", "N7:1", "F8:1", "T4:0", "T4:1"};
+    const size_t sizes[] = {2, 2, 4, 2, 4, 6, 6};
+    size_t count = setup_items(names, sizes, 7);
+    
+    df1_plan_t plan;
+    df1_plan_init(&plan);
+    TEST_ASSERT(df1_plan_build(&plan, NULL, items, count) == 0, "规划失败");
+    TEST_ASSERT(plan.block_count == 4, "应按文件分为4次读取");
+    
+    size_t total = 0;
+    for (size_t i = 0; i < plan.block_count; i++) {
+        const df1_plan_block_t* block = &plan.blocks[i];
+        if (block->addr.data_code == DF1_ADDR_F) {
+            TEST_ASSERT(block->size == 8 && block->count == 2, "F8 块错误");
+        } else if (block->addr.data_code == DF1_ADDR_T) {
+            TEST_ASSERT(block->size == 12 && block->count == 2, "T4 块错误");
+        } else if (block->addr.db_block == 7) {
+            TEST_ASSERT(block->size == 4 && block->count == 2, "N7 块错误");
+        } else {
+            TEST_ASSERT(block->addr.db_block == 9 && block->size == 2, "N9 块错误");
+        }
+        total += block->count;
+    }
+    TEST_ASSERT(total == count, "每个标签应属于一个块");
+    
+    df1_plan_free(&plan);
+    TEST_PASS("按文件分组");
+}
+
+// 测试间隔阈值与读取大小上限
+int test_gap_and_limit() {
+    printf("测试间隔阈值与大小上限...\n");
+    
+    const char* names[] = {"N7:0", "N7:10"};
+    const size_t sizes[] = {2, 2};
+    size_t count = setup_items(names, sizes, 2);
+    
+    df1_plan_config_t config;
+    df1_plan_config_default(&config);
+    df1_plan_t plan;
+    df1_plan_init(&plan);
+    
+    // N7:1 ~ N7:9 共9个未请求的元素
+    config.max_gap = 8;
+    TEST_ASSERT(df1_plan_build(&plan, &config, items, count) == 0 && plan.block_count == 2, "间隔超过阈值不应合并");
+    config.max_gap = 9;
+    TEST_ASSERT(df1_plan_build(&plan, &config, items, count) == 0 && plan.block_count == 1, "间隔不超过阈值应合并");
+    TEST_ASSERT(plan.blocks[0].size == 22 && plan.slices[1].offset == 20, "合并后的块大小错误");
+    
+    // N7:0 ~ N7:199 共400字节，超过单次读取上限
+    for (int i = 0; i < 200; i++) {
+        addrs[i].data_code = DF1_ADDR_N;
+        addrs[i].db_block = 7;
+        addrs[i].address_start = (uint16_t)i;
+        items[i].addr = &addrs[i];
+        items[i].size = 2;
+    }
+    TEST_ASSERT(df1_plan_build(&plan, NULL, items, 200) == 0, "规划失败");
+    TEST_ASSERT(plan.block_count == 2, "超过上限应拆分");
+    TEST_ASSERT(plan.blocks[0].size <= DF1_PLAN_DEFAULT_MAX_READ && plan.blocks[1].size <= DF1_PLAN_DEFAULT_MAX_READ,
+               "块大小不应超过上限");
+    TEST_ASSERT(plan.blocks[0].size + plan.blocks[1].size == 400, "拆分后总大小错误");
+    
+    // 单个标签超过上限
+    items[0].size = DF1_PLAN_DEFAULT_MAX_READ + 2;
+    TEST_ASSERT(df1_plan_build(&plan, NULL, items, 1) != 0, "单个标签超过上限应该失败");
+    TEST_ASSERT(plan.block_count == 0, "失败后计划应为空");
+    
+    df1_plan_free(&plan);
+    TEST_PASS("间隔阈值与大小上限");
+}
+
+// 测试子元素按字合并
+int test_sub_elements() {
+    printf("测试子元素合并...\n");
+    
+    df1_plan_config_t config;
+    df1_plan_config_default(&config);
+    df1_plan_t plan;
+    df1_plan_init(&plan);
+    
+    // 单独的子元素只读取一个字
+    const char* single[] = {"T4:5.ACC"};
+    const size_t single_sizes[] = {2};
+    size_t count = setup_items(single, single_sizes, 1);
+    TEST_ASSERT(df1_plan_build(&plan, &config, items, count) == 0 && plan.block_count == 1, "规划失败");
+    TEST_ASSERT(plan.blocks[0].addr.address_start == 5 && plan.blocks[0].addr.sub_element == 2 &&
+               plan.blocks[0].size == 2, "单个子元素应只读取2字节");
+    
+    // 同一元素内的子元素从第一个子元素开始读取
+    const char* inside[] = {"T4:0.ACC", "T4:0.PRE"};
+    const size_t inside_sizes[] = {2, 2};
+    count = setup_items(inside, inside_sizes, 2);
+    TEST_ASSERT(df1_plan_build(&plan, &config, items, count) == 0 && plan.block_count == 1, "规划失败");
+    TEST_ASSERT(plan.blocks[0].addr.sub_element == 1 && plan.blocks[0].size == 4, "元素内子元素块错误");
+    TEST_ASSERT(plan.slices[0].item == 1 && plan.slices[0].offset == 0 && plan.slices[1].offset == 2, "子元素偏移错误");
+    
+    // 跨元素合并时块退回到元素起点
+    const char* across[] = {"T4:0.ACC", "T4:1.ACC", "T4:1/DN"};
+    const size_t across_sizes[] = {2, 2, 2};
+    count = setup_items(across, across_sizes, 3);
+    TEST_ASSERT(df1_plan_build(&plan, &config, items, count) == 0 && plan.block_count == 1, "规划失败");
+    TEST_ASSERT(plan.blocks[0].addr.address_start == 0 && plan.blocks[0].addr.sub_element == 0 &&
+               plan.blocks[0].size == 12, "跨元素的块应从元素起点读取");
+    TEST_ASSERT(plan.slices[0].offset == 4 && plan.slices[1].offset == 6 && plan.slices[2].offset == 10,
+               "跨元素的分片偏移错误");
+    
+    // 不允许间隔时分别读取
+    config.max_gap = 0;
+    count = setup_items(across, across_sizes, 2);
+    TEST_ASSERT(df1_plan_build(&plan, &config, items, count) == 0 && plan.block_count == 2, "不应合并");
+    TEST_ASSERT(plan.blocks[0].size == 2 && plan.blocks[1].size == 2, "应各读取2字节");
+    
+    df1_plan_free(&plan);
+    TEST_PASS("子元素合并");
+}
+
+// 测试块数据散布到标签
+int test_scatter() {
+    printf("测试结果散布...\n");
+    
+    const char* names[] = {"N7:2", "N7:0", "N7:3"};
+    const size_t sizes[] = {2, 4, 2};
+    size_t count = setup_items(names, sizes, 3);
+    
+    df1_plan_t plan;
+    df1_plan_init(&plan);
+    TEST_ASSERT(df1_plan_build(&plan, NULL, items, count) == 0 && plan.block_count == 1, "规划失败");
+    TEST_ASSERT(plan.blocks[0].size == 8, "重叠标签的块大小错误");
+    
+    const uint8_t data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    df1_plan_scatter(&plan, 0, 0, data, sizeof(data), items);
+    TEST_ASSERT(items[0].status == 0 && buffers[0][0] == 4 && buffers[0][1] == 5, "N7:2 数据错误");
+    TEST_ASSERT(items[1].status == 0 && memcmp(buffers[1], data, 4) == 0, "N7:0 数据错误");
+    TEST_ASSERT(items[2].status == 0 && buffers[2][0] == 6 && buffers[2][1] == 7, "N7:3 数据错误");
+    
+    // 响应过短时只有完整覆盖的标签成功
+    df1_plan_scatter(&plan, 0, 0, data, 6, items);
+    TEST_ASSERT(items[0].status == 0 && items[1].status == 0, "完整覆盖的标签应成功");
+    TEST_ASSERT(items[2].status == -1, "未完整覆盖的标签应失败");
+    
+    df1_plan_scatter(&plan, 0, -1, NULL, 0, items);
+    TEST_ASSERT(items[0].status == -1 && items[1].status == -1 && items[2].status == -1, "块失败时标签应失败");
+    
+    df1_plan_free(&plan);
+    TEST_PASS("结果散布");
+}
+
+int main() {
+    printf("AB DF1 读取合并单元测试\n");
+    printf("========================\n\n");
+    
+    int passed = 0;
+    int total = 0;
+    
+    total++; passed += test_adjacent_elements();
+    total++; passed += test_grouping();
+    total++; passed += test_gap_and_limit();
+    total++; passed += test_sub_elements();
+    total++; passed += test_scatter();
+    
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+    
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -84,6 +84,93 @@ int test_build_write_command() {
     TEST_PASS("写命令构建");
 }
 
+// 测试使用已解析地址构建命令
+int test_build_command_addr() {
+    printf("测试已解析地址命令构建...\n");
+    
+    df1_config_t config;
+    df1_config_init(&config, 1, 2, 0);
+    
+    df1_address_t addr;
+    TEST_ASSERT(df1_address_parse("N7:300", &addr) == 0, "地址解析失败");
+    
+    uint8_t expected[256], buffer[256];
+    size_t expected_size, actual_size;
+    uint8_t write_data[] = {0x10, 0x34};
+    
+    TEST_ASSERT(df1_build_read_command(&config, "N7:300", 2, expected, sizeof(expected), &expected_size) == 0,
+               "字符串地址读命令构建失败");
+    TEST_ASSERT(df1_build_read_command_addr(&config, &addr, 2, buffer, sizeof(buffer), &actual_size) == 0,
+               "已解析地址读命令构建失败");
+    TEST_ASSERT(actual_size == expected_size && memcmp(buffer, expected, actual_size) == 0,
+               "两种读命令构建结果应该相同");
+    
+    TEST_ASSERT(df1_build_write_command(&config, "N7:300", write_data, sizeof(write_data),
+                                       expected, sizeof(expected), &expected_size) == 0,
+               "字符串地址写命令构建失败");
+    TEST_ASSERT(df1_build_write_command_addr(&config, &addr, write_data, sizeof(write_data),
+                                            buffer, sizeof(buffer), &actual_size) == 0,
+               "已解析地址写命令构建失败");
+    TEST_ASSERT(actual_size == expected_size && memcmp(buffer, expected, actual_size) == 0,
+               "两种写命令构建结果应该相同");
+    
+    TEST_ASSERT(df1_build_read_command_addr(&config, NULL, 2, buffer, sizeof(buffer), &actual_size) != 0,
+               "NULL地址应该失败");
+    
+    // 子元素地址只读取该子元素：DLE SOH STN DLE STX DST SRC CMD STS TNS TNS FNC 长度 文件 类型 元素 子元素
+    TEST_ASSERT(df1_build_read_command(&config, "T4:3.ACC", 2, buffer, sizeof(buffer), &actual_size) == 0,
+               "子元素读命令构建失败");
+    TEST_ASSERT(buffer[12] == 2 && buffer[13] == 4 && buffer[14] == DF1_ADDR_T && buffer[15] == 3 && buffer[16] == 2,
+               "子元素字段错误");
+    
+    TEST_PASS("已解析地址命令构建");
+}
+
+// 测试缓冲区越界检查与DLE转义
+int test_build_command_bounds() {
+    printf("测试命令缓冲区越界检查...\n");
+    
+    df1_config_t config;
+    df1_config_init(&config, 0x10, 0x10, 0);
+    config.transaction_id = 0x1010;
+    
+    uint8_t buffer[256];
+    size_t actual_size = 0;
+    
+    // 站号、目标节点和事务ID中的0x10都需要转义
+    TEST_ASSERT(df1_build_read_command(&config, "N7:0", 2, buffer, sizeof(buffer), &actual_size) == 0,
+               "含DLE字节的读命令构建失败");
+    TEST_ASSERT(buffer[2] == 0x10 && buffer[3] == 0x10, "站号DLE转义错误");
+    TEST_ASSERT(buffer[4] == 0x10 && buffer[5] == 0x02, "DLE STX位置错误");
+    TEST_ASSERT(buffer[6] == 0x10 && buffer[7] == 0x10, "目标节点DLE转义错误");
+    
+    size_t full_size = actual_size;
+    
+    // 缓冲区恰好够用时成功，少一个字节时失败
+    TEST_ASSERT(df1_build_read_command(&config, "N7:0", 2, buffer, full_size, &actual_size) == 0,
+               "缓冲区恰好够用时应该成功");
+    TEST_ASSERT(df1_build_read_command(&config, "N7:0", 2, buffer, full_size - 1, &actual_size) != 0,
+               "缓冲区不足应该失败");
+    
+    uint8_t write_data[64] = {0};
+    TEST_ASSERT(df1_build_write_command(&config, "N7:0", write_data, sizeof(write_data), buffer, 32,
+                                       &actual_size) != 0,
+               "写命令缓冲区不足应该失败");
+    
+    // 长度字段只有一个字节，超过255的长度不能被截断后发送
+    uint8_t frame[DF1_MAX_FRAME_SIZE];
+    uint8_t large_data[256] = {0};
+    TEST_ASSERT(df1_build_read_command(&config, "N7:0", 255, frame, sizeof(frame), &actual_size) == 0,
+               "255字节读命令应该成功");
+    TEST_ASSERT(df1_build_read_command(&config, "N7:0", 256, frame, sizeof(frame), &actual_size) != 0,
+               "超过255字节的读命令应该失败");
+    TEST_ASSERT(df1_build_write_command(&config, "N7:0", large_data, sizeof(large_data), frame, sizeof(frame),
+                                       &actual_size) != 0,
+               "超过255字节的写命令应该失败");
+    
+    TEST_PASS("命令缓冲区越界检查");
+}
+
 // 测试无效参数处理
 int test_invalid_parameters() {
     printf("测试无效参数处理...\n");
@@ -165,6 +252,294 @@ int test_response_parsing() {
     TEST_PASS("响应解析");
 }
 
+// 测试流式解码器
+int test_stream_decoder() {
+    printf("测试流式解码器...\n");
+    
+    df1_config_t config;
+    df1_config_init(&config, 1, 2, 0);
+    config.transaction_id = 0x1234;
+    
+    uint8_t frame_bytes[256];
+    size_t frame_size;
+    uint8_t write_data[] = {0x11, 0x22, 0x33, 0x44};
+    TEST_ASSERT(df1_build_write_command(&config, "N7:0", write_data, sizeof(write_data),
+                                       frame_bytes, sizeof(frame_bytes), &frame_size) == 0,
+               "构建测试帧失败");
+    
+    df1_decoder_t decoder;
+    df1_frame_t frame;
+    size_t consumed;
+    
+    // 一次输入整帧：无转义时零拷贝
+    df1_decoder_init(&decoder, DF1_CHECK_CRC16);
+    TEST_ASSERT(df1_decoder_push(&decoder, frame_bytes, frame_size, &consumed, &frame) == DF1_DECODE_FRAME,
+               "整帧解码失败");
+    TEST_ASSERT(consumed == frame_size, "消耗字节数错误");
+    TEST_ASSERT(frame.zero_copy, "无转义的整帧应该零拷贝");
+    TEST_ASSERT(frame.pdu >= frame_bytes && frame.pdu < frame_bytes + frame_size, "零拷贝视图应指向输入");
+    TEST_ASSERT(frame.has_station && frame.station == 1, "站号错误");
+    TEST_ASSERT(frame.dst == 2 && frame.src == 0 && frame.tns == 0x1234, "帧头字段错误");
+    TEST_ASSERT(frame.data_length == 6 + sizeof(write_data), "数据长度错误");
+    TEST_ASSERT(memcmp(frame.data + 6, write_data, sizeof(write_data)) == 0, "数据内容错误");
+    TEST_ASSERT(df1_frame_check(&frame, 0x1234) == 0, "事务ID校验失败");
+    TEST_ASSERT(df1_frame_check(&frame, 0x1235) != 0, "事务ID不匹配应该失败");
+    
+    // 逐字节输入
+    df1_decoder_reset(&decoder);
+    int result = DF1_DECODE_NEED_MORE;
+    for (size_t i = 0; i < frame_size; i++) {
+        result = df1_decoder_push(&decoder, &frame_bytes[i], 1, &consumed, &frame);
+        TEST_ASSERT(i + 1 == frame_size || result == DF1_DECODE_NEED_MORE, "帧未结束时不应返回结果");
+    }
+    TEST_ASSERT(result == DF1_DECODE_FRAME, "逐字节解码失败");
+    TEST_ASSERT(!frame.zero_copy, "跨输入的帧不应零拷贝");
+    TEST_ASSERT(memcmp(frame.data + 6, write_data, sizeof(write_data)) == 0, "逐字节解码数据错误");
+    
+    // 含转义的帧
+    uint8_t escaped_data[] = {0x10, 0x10, 0x03};
+    TEST_ASSERT(df1_build_write_command(&config, "N7:0", escaped_data, sizeof(escaped_data),
+                                       frame_bytes, sizeof(frame_bytes), &frame_size) == 0,
+               "构建转义帧失败");
+    TEST_ASSERT(df1_decoder_push(&decoder, frame_bytes, frame_size, &consumed, &frame) == DF1_DECODE_FRAME,
+               "转义帧解码失败");
+    TEST_ASSERT(!frame.zero_copy, "含转义的帧不应零拷贝");
+    TEST_ASSERT(memcmp(frame.data + 6, escaped_data, sizeof(escaped_data)) == 0, "转义数据还原错误");
+    
+    // 前导垃圾字节与连续两帧
+    uint8_t stream[512];
+    size_t stream_size = 0;
+    stream[stream_size++] = 0x55;
+    stream[stream_size++] = 0x10;
+    memcpy(&stream[stream_size], frame_bytes, frame_size);
+    stream_size += frame_size;
+    memcpy(&stream[stream_size], frame_bytes, frame_size);
+    stream_size += frame_size;
+    
+    size_t offset = 0;
+    int frames = 0;
+    while (offset < stream_size) {
+        result = df1_decoder_push(&decoder, stream + offset, stream_size - offset, &consumed, &frame);
+        offset += consumed;
+        if (result == DF1_DECODE_FRAME) {
+            frames++;
+        }
+    }
+    TEST_ASSERT(frames == 2, "连续帧数量错误");
+    
+    // 校验错误
+    frame_bytes[frame_size - 1] ^= 0xFF;
+    TEST_ASSERT(df1_decoder_push(&decoder, frame_bytes, frame_size, &consumed, &frame) == DF1_DECODE_BAD_CHECKSUM,
+               "CRC错误应该被检测到");
+    
+    // BCC校验
+    config.check_type = DF1_CHECK_BCC;
+    df1_decoder_init(&decoder, DF1_CHECK_BCC);
+    TEST_ASSERT(df1_build_read_command(&config, "F8:1", 4, frame_bytes, sizeof(frame_bytes), &frame_size) == 0,
+               "构建BCC帧失败");
+    TEST_ASSERT(df1_decoder_push(&decoder, frame_bytes, frame_size, &consumed, &frame) == DF1_DECODE_FRAME,
+               "BCC帧解码失败");
+    frame_bytes[frame_size - 1]++;
+    TEST_ASSERT(df1_decoder_push(&decoder, frame_bytes, frame_size, &consumed, &frame) == DF1_DECODE_BAD_CHECKSUM,
+               "BCC错误应该被检测到");
+    
+    TEST_PASS("流式解码器");
+}
+
+// 测试截断与空响应
+int test_truncated_response() {
+    printf("测试截断响应...\n");
+    
+    uint8_t data[10];
+    size_t actual_size;
+    uint8_t truncated[] = {0x10, 0x02, 0x02, 0x00, 0x4F, 0x00, 0x01, 0x00, 0x12};
+    
+    TEST_ASSERT(df1_parse_response(truncated, 0, data, sizeof(data), &actual_size) != 0, "空响应应该失败");
+    TEST_ASSERT(df1_parse_response(truncated, 1, data, sizeof(data), &actual_size) != 0, "单字节响应应该失败");
+    TEST_ASSERT(df1_parse_response(truncated, sizeof(truncated), data, sizeof(data), &actual_size) != 0,
+               "缺少DLE ETX的响应应该失败");
+    
+    TEST_PASS("截断响应");
+}
+
+// 测试轮询包：站号为 0x10 时需要转义，BCC 只计算站号
+int test_build_poll() {
+    printf("测试构建轮询包...\n");
+
+    uint8_t buffer[8];
+    size_t actual_size = 0;
+
+    TEST_ASSERT(df1_build_poll(0x05, buffer, sizeof(buffer), &actual_size) == 0, "构建轮询包失败");
+    TEST_ASSERT(actual_size == 4, "轮询包长度错误");
+    TEST_ASSERT(buffer[0] == DF1_DLE && buffer[1] == DF1_ENQ && buffer[2] == 0x05 && buffer[3] == 0xFB,
+               "轮询包内容错误");
+
+    TEST_ASSERT(df1_build_poll(0x10, buffer, sizeof(buffer), &actual_size) == 0, "构建轮询包失败");
+    TEST_ASSERT(actual_size == 5 && buffer[2] == DF1_DLE && buffer[3] == DF1_DLE && buffer[4] == 0xF0,
+               "站号 0x10 应转义");
+
+    TEST_ASSERT(df1_build_poll(0x10, buffer, 4, &actual_size) != 0, "缓冲区不足应该失败");
+
+    TEST_PASS("构建轮询包");
+}
+
+// 测试校验函数：CRC-16/ARC 标准校验值，并与帧编码器的结果一致
+int test_checksums() {
+    printf("测试校验函数...\n");
+
+    const uint8_t check[] = "123456789";
+    TEST_ASSERT(df1_crc16(0, check, 9) == 0xBB3D, "CRC16校验值错误");
+    TEST_ASSERT(df1_crc16(df1_crc16(0, check, 4), check + 4, 5) == 0xBB3D, "CRC16分段累加错误");
+    TEST_ASSERT(df1_bcc(check, 9) == (uint8_t)(0x100 - (0x1DD & 0xFF)), "BCC错误");
+
+    // 全双工：CRC 覆盖去除转义后的PDU与ETX，BCC 只覆盖PDU
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    config.duplex = DF1_FULL_DUPLEX;
+    const uint8_t pdu[] = {0x01, 0x00, 0x0F, 0x00, 0x10, 0x00, 0xA2};
+    uint8_t buffer[64];
+    size_t actual_size = 0;
+    TEST_ASSERT(df1_build_frame(&config, pdu, sizeof(pdu), buffer, sizeof(buffer), &actual_size) == 0, "构建帧失败");
+    uint16_t crc = df1_crc16(df1_crc16(0, pdu, sizeof(pdu)), (const uint8_t*)"\x03", 1);
+    TEST_ASSERT(buffer[actual_size - 2] == (uint8_t)(crc >> 8) && buffer[actual_size - 1] == (uint8_t)(crc & 0xFF),
+               "CRC16与帧编码器不一致");
+
+    config.check_type = DF1_CHECK_BCC;
+    TEST_ASSERT(df1_build_frame(&config, pdu, sizeof(pdu), buffer, sizeof(buffer), &actual_size) == 0, "构建帧失败");
+    TEST_ASSERT(buffer[actual_size - 1] == df1_bcc(pdu, sizeof(pdu)), "BCC与帧编码器不一致");
+
+    // 半双工：站号与 STX 也参与CRC，站号参与BCC
+    config.duplex = DF1_HALF_DUPLEX;
+    config.check_type = DF1_CHECK_CRC16;
+    TEST_ASSERT(df1_build_frame(&config, pdu, sizeof(pdu), buffer, sizeof(buffer), &actual_size) == 0, "构建帧失败");
+    const uint8_t head[] = {0x01, 0x02};
+    crc = df1_crc16(df1_crc16(df1_crc16(0, head, 2), pdu, sizeof(pdu)), (const uint8_t*)"\x03", 1);
+    TEST_ASSERT(buffer[actual_size - 2] == (uint8_t)(crc >> 8) && buffer[actual_size - 1] == (uint8_t)(crc & 0xFF),
+               "半双工CRC16与帧编码器不一致");
+
+    TEST_PASS("校验函数");
+}
+
+// 测试掩码写命令构建
+int test_build_mask_write() {
+    printf("测试构建掩码写命令...\n");
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+
+    uint8_t buffer[64];
+    size_t actual_size = 0;
+    TEST_ASSERT(df1_build_mask_write_command(&config, "B3:0", 0x0020, 0x0020, buffer, sizeof(buffer), &actual_size) == 0,
+               "构建掩码写命令失败");
+    TEST_ASSERT(actual_size == 25, "掩码写命令长度错误");
+    TEST_ASSERT(buffer[7] == 0x0F && buffer[11] == DF1_CMD_MASK_WRITE, "命令与功能码错误");
+    TEST_ASSERT(buffer[12] == 2, "长度字段应为一个字");
+    TEST_ASSERT(buffer[13] == 3 && buffer[14] == DF1_ADDR_B && buffer[15] == 0 && buffer[16] == 0, "地址字段错误");
+    TEST_ASSERT(buffer[17] == 0x20 && buffer[18] == 0x00, "掩码错误");
+    TEST_ASSERT(buffer[19] == 0x20 && buffer[20] == 0x00, "数据错误");
+    TEST_ASSERT(buffer[21] == DF1_DLE && buffer[22] == DF1_ETX, "帧尾错误");
+
+    // 掩码中的 0x10 需要转义
+    TEST_ASSERT(df1_build_mask_write_command(&config, "N7:2", 0x0010, 0x0000, buffer, sizeof(buffer), &actual_size) == 0,
+               "构建掩码写命令失败");
+    TEST_ASSERT(buffer[17] == DF1_DLE && buffer[18] == DF1_DLE && buffer[19] == 0x00, "掩码DLE转义错误");
+
+    TEST_ASSERT(df1_build_mask_write_command(&config, "X3:0", 1, 1, buffer, sizeof(buffer), &actual_size) != 0,
+               "无效地址应该失败");
+
+    TEST_PASS("构建掩码写命令");
+}
+
+// 测试帧模板：任意事务ID下与完整编码逐字节相同
+int test_frame_template() {
+    printf("测试帧模板...\n");
+
+    df1_address_t addr;
+    TEST_ASSERT(df1_address_parse("N16:272", &addr) == 0, "地址解析失败"); // 文件号与元素号含 0x10
+
+    // 半双工/全双工、BCC/CRC16，站号与节点号含需要转义的 0x10
+    const uint8_t stations[] = {1, DF1_DLE};
+    uint8_t expected[DF1_MAX_FRAME_SIZE], buffer[DF1_MAX_FRAME_SIZE];
+    size_t expected_size, actual_size;
+    for (int mode = 0; mode < 8; mode++) {
+        df1_config_t config;
+        df1_config_init(&config, stations[mode & 1], DF1_DLE, 0);
+        config.check_type = (mode & 2) ? DF1_CHECK_BCC : DF1_CHECK_CRC16;
+        config.duplex = (mode & 4) ? DF1_FULL_DUPLEX : DF1_HALF_DUPLEX;
+
+        df1_frame_template_t tmpl;
+        TEST_ASSERT(df1_frame_template_read(&tmpl, &config, &addr, 16) == 0, "生成读命令模板失败");
+        TEST_ASSERT(df1_frame_template_matches(&tmpl, &config), "模板应与生成时的配置一致");
+
+        for (uint32_t tns = 0; tns <= 0xFFFF; tns++) {
+            config.transaction_id = (uint16_t)tns;
+            df1_build_read_command_addr(&config, &addr, 16, expected, sizeof(expected), &expected_size);
+            TEST_ASSERT(df1_frame_template_emit(&tmpl, (uint16_t)tns, buffer, sizeof(buffer), &actual_size) == 0,
+                        "模板输出失败");
+            TEST_ASSERT(actual_size == expected_size && memcmp(buffer, expected, actual_size) == 0,
+                        "模板输出应与完整编码相同");
+        }
+    }
+
+    // 由应用层数据生成：事务ID被忽略，其后的数据参与校验修补
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+    uint8_t pdu[] = {0x01, 0x00, 0x06, 0x00, 0xAA, 0xBB, 0x03, 0x10, 0x20};
+    df1_frame_template_t tmpl;
+    TEST_ASSERT(df1_frame_template_init(&tmpl, &config, pdu, sizeof(pdu)) == 0, "由应用层数据生成模板失败");
+    pdu[4] = 0x10;
+    pdu[5] = 0x12;
+    TEST_ASSERT(df1_build_frame(&config, pdu, sizeof(pdu), expected, sizeof(expected), &expected_size) == 0, "构建帧失败");
+    TEST_ASSERT(df1_frame_template_emit(&tmpl, 0x1210, buffer, sizeof(buffer), &actual_size) == 0, "模板输出失败");
+    TEST_ASSERT(actual_size == expected_size && memcmp(buffer, expected, actual_size) == 0, "模板输出应与完整编码相同");
+
+    // 缓冲区不足、配置变化与过长的数据
+    TEST_ASSERT(df1_frame_template_emit(&tmpl, 0x1010, buffer, tmpl.size + 1, &actual_size) != 0, "缓冲区不足应该失败");
+    config.dst_node = 2;
+    TEST_ASSERT(!df1_frame_template_matches(&tmpl, &config), "节点号变化后模板不应匹配");
+    uint8_t large[DF1_FRAME_TEMPLATE_SIZE] = {0};
+    TEST_ASSERT(df1_frame_template_init(&tmpl, &config, large, sizeof(large)) != 0, "超过模板大小应该失败");
+    TEST_ASSERT(!df1_frame_template_matches(&tmpl, &config), "生成失败后模板应无效");
+    TEST_ASSERT(df1_frame_template_init(&tmpl, &config, pdu, 5) != 0, "过短的应用层数据应该失败");
+
+    TEST_PASS("帧模板");
+}
+
+// 测试字节序转换
+int test_byte_order() {
+    printf("测试字节序转换...\n");
+
+    const uint8_t words[] = {0x34, 0x12, 0xFE, 0xFF};
+    int16_t values[2];
+    df1_le16_to_host(values, words, 2);
+    TEST_ASSERT(values[0] == 0x1234 && values[1] == -2, "16位小端序解码错误");
+
+    const uint8_t floats[] = {0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x20, 0xC1};
+    float reals[2];
+    df1_le32_to_host(reals, floats, 2);
+    TEST_ASSERT(reals[0] == 1.5f && reals[1] == -10.0f, "浮点小端序解码错误");
+
+    const uint8_t longs[] = {0x78, 0x56, 0x34, 0x12};
+    int32_t integer;
+    df1_le32_to_host(&integer, longs, 1);
+    TEST_ASSERT(integer == 0x12345678, "32位小端序解码错误");
+
+    uint8_t encoded[8];
+    df1_host_to_le16(encoded, values, 2);
+    TEST_ASSERT(memcmp(encoded, words, sizeof(words)) == 0, "16位小端序编码错误");
+    df1_host_to_le32(encoded, reals, 2);
+    TEST_ASSERT(memcmp(encoded, floats, sizeof(floats)) == 0, "浮点小端序编码错误");
+
+    // 原地转换
+    uint8_t in_place[4];
+    memcpy(in_place, longs, sizeof(longs));
+    df1_le32_to_host(in_place, in_place, 1);
+    memcpy(&integer, in_place, sizeof(integer));
+    TEST_ASSERT(integer == 0x12345678, "原地转换错误");
+
+    TEST_PASS("字节序转换");
+}
+
 // 测试错误描述
 int test_error_descriptions() {
     printf("测试错误描述...\n");
@@ -190,8 +565,17 @@ int main() {
     total++; passed += test_config_init();
     total++; passed += test_build_read_command();
     total++; passed += test_build_write_command();
+    total++; passed += test_build_command_addr();
+    total++; passed += test_build_command_bounds();
     total++; passed += test_invalid_parameters();
     total++; passed += test_response_parsing();
+    total++; passed += test_stream_decoder();
+    total++; passed += test_truncated_response();
+    total++; passed += test_build_poll();
+    total++; passed += test_checksums();
+    total++; passed += test_build_mask_write();
+    total++; passed += test_frame_template();
+    total++; passed += test_byte_order();
     total++; passed += test_error_descriptions();
     
     printf("\n测试结果: %d/%d 通过\n", passed, total);
@@ -0,0 +1,299 @@
+#define _XOPEN_SOURCE 600
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "df1_serial.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+#define TIMEOUT_MS 1000
+#define REPLY_SIZE 256
+
+// 打开伪终端：连接使用从端，测试在主端 peer 上扮演从站
+static df1_serial_t* open_pty(int* peer) {
+    *peer = posix_openpt(O_RDWR | O_NOCTTY);
+    if (*peer < 0) {
+        return NULL;
+    }
+    if (grantpt(*peer) != 0 || unlockpt(*peer) != 0) {
+        close(*peer);
+        return NULL;
+    }
+
+    df1_serial_config_t serial_config;
+    df1_serial_config_default(&serial_config);
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "%s", ptsname(*peer));
+    serial_config.timeout_ms = TIMEOUT_MS;
+
+    df1_config_t config;
+    df1_config_init(&config, 1, 1, 0);
+
+    df1_serial_t* port = df1_serial_create();
+    if (!port || df1_serial_open(port, &serial_config, &config) != 0) {
+        df1_serial_destroy(port);
+        close(*peer);
+        return NULL;
+    }
+    return port;
+}
+
+// CRC16（多项式 0xA001），按帧编码器的顺序累加
+static uint16_t crc16(uint16_t crc, uint8_t value) {
+    crc ^= value;
+    for (int i = 0; i < 8; i++) {
+        crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+    }
+    return crc;
+}
+
+// 构建站号1的响应帧：DLE SOH STN DLE STX DST SRC CMD STS TNS 数据 DLE ETX CRC
+static size_t build_reply(uint16_t tns, const uint8_t* data, size_t size, uint8_t* buffer) {
+    uint8_t pdu[REPLY_SIZE];
+    const uint8_t header[] = {0x00, 0x01, 0x4F, 0x00, (uint8_t)(tns & 0xFF), (uint8_t)(tns >> 8)};
+    memcpy(pdu, header, sizeof(header));
+    memcpy(pdu + sizeof(header), data, size);
+
+    size_t pos = 0;
+    buffer[pos++] = 0x10;
+    buffer[pos++] = 0x01;
+    buffer[pos++] = 0x01;
+    buffer[pos++] = 0x10;
+    buffer[pos++] = 0x02;
+    uint16_t crc = crc16(crc16(0, 0x01), 0x02);
+    for (size_t i = 0; i < sizeof(header) + size; i++) {
+        crc = crc16(crc, pdu[i]);
+        buffer[pos++] = pdu[i];
+        if (pdu[i] == 0x10) {
+            buffer[pos++] = 0x10;
+        }
+    }
+    buffer[pos++] = 0x10;
+    buffer[pos++] = 0x03;
+    crc = crc16(crc, 0x03);
+    buffer[pos++] = (uint8_t)(crc >> 8);
+    buffer[pos++] = (uint8_t)(crc & 0xFF);
+    return pos;
+}
+
+// 在子进程中扮演从站：每收到一条命令，以 chunk 字节一段、每段间隔1毫秒交出同一事务ID的响应
+static pid_t start_peer(int peer, const uint8_t* data, size_t size, int commands, size_t chunk) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+
+    df1_decoder_t decoder;
+    df1_decoder_init(&decoder, DF1_CHECK_CRC16);
+    struct timespec wait = {0, 1000000L};
+    while (commands > 0) {
+        uint8_t input[REPLY_SIZE];
+        ssize_t n = read(peer, input, sizeof(input));
+        if (n <= 0) {
+            _exit(1);
+        }
+
+        size_t offset = 0;
+        while (offset < (size_t)n) {
+            size_t consumed = 0;
+            df1_frame_t frame;
+            int result = df1_decoder_push(&decoder, input + offset, (size_t)n - offset, &consumed, &frame);
+            offset += consumed;
+            if (result != DF1_DECODE_FRAME) {
+                continue;
+            }
+
+            uint8_t reply[2 * REPLY_SIZE];
+            size_t reply_size = build_reply(frame.tns, data, size, reply);
+            for (size_t pos = 0; pos < reply_size; pos += chunk) {
+                size_t length = reply_size - pos < chunk ? reply_size - pos : chunk;
+                if (write(peer, reply + pos, length) != (ssize_t)length) {
+                    _exit(1);
+                }
+                nanosleep(&wait, NULL);
+            }
+            commands--;
+        }
+    }
+    _exit(0);
+}
+
+// 测试响应分成多段到达时拼成完整的帧
+int test_chunked_reply() {
+    printf("测试响应分段到达...\n");
+
+    int peer = -1;
+    df1_serial_t* port = open_pty(&peer);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    uint8_t table[100];
+    for (size_t i = 0; i < sizeof(table); i++) {
+        table[i] = (uint8_t)(i * 5 + 1); // 包含需要转义的 0x10
+    }
+    pid_t pid = start_peer(peer, table, sizeof(table), 8, 7);
+    TEST_ASSERT(pid > 0, "启动从站进程失败");
+
+    int failures = 0;
+    for (int i = 0; i < 8; i++) {
+        uint8_t data[100];
+        size_t actual = 0;
+        if (df1_serial_read(port, "N7:0", data, sizeof(data), &actual) != 0 || actual != sizeof(data) ||
+            memcmp(data, table, sizeof(data)) != 0) {
+            failures++;
+        }
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    TEST_ASSERT(failures == 0, "分段到达的响应读取失败");
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0, "从站进程异常退出");
+    TEST_ASSERT(port->rx_head == port->rx_tail, "接收缓冲区中不应有剩余字节");
+
+    df1_serial_destroy(port);
+    close(peer);
+    TEST_PASS("响应分段到达");
+}
+
+// 测试帧之后的多余字节保留在接收缓冲区中，供下一次事务使用
+int test_extra_bytes_kept() {
+    printf("测试帧后多余字节...\n");
+
+    int peer = -1;
+    df1_serial_t* port = open_pty(&peer);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    uint16_t tns = port->df1_config.transaction_id;
+    const uint8_t first[2] = {111, 0};
+    const uint8_t second[2] = {222, 0};
+    uint8_t stream[2 * REPLY_SIZE];
+    uint8_t next[REPLY_SIZE];
+    size_t reply_size = build_reply((uint16_t)(tns + 1), first, sizeof(first), stream);
+    size_t next_size = build_reply((uint16_t)(tns + 2), second, sizeof(second), next);
+
+    // 第一条响应之后紧跟下一条响应的前半段，一次读取全部收到
+    size_t half = next_size / 2;
+    memcpy(stream + reply_size, next, half);
+    TEST_ASSERT(write(peer, stream, reply_size + half) == (ssize_t)(reply_size + half), "写入响应失败");
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0 && value == 111, "读取 N7:0 错误");
+    TEST_ASSERT(port->rx_head - port->rx_tail == half, "帧之后的多余字节应保留在接收缓冲区中");
+
+    // 只交出后半段：保留的前半段与之拼成完整的响应
+    TEST_ASSERT(write(peer, next + half, next_size - half) == (ssize_t)(next_size - half), "写入响应失败");
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:1", &value) == 0 && value == 222, "保留的字节应用于下一次事务");
+    TEST_ASSERT(port->rx_head == port->rx_tail, "接收缓冲区中不应有剩余字节");
+
+    df1_serial_destroy(port);
+    close(peer);
+    TEST_PASS("帧后多余字节");
+}
+
+// 测试之前事务的迟到响应被丢弃，不会作为当前请求的结果
+int test_late_reply_dropped() {
+    printf("测试迟到响应...\n");
+
+    int peer = -1;
+    df1_serial_t* port = open_pty(&peer);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    // 上一个事务ID的响应（数据为111）在当前响应之前到达
+    uint16_t tns = port->df1_config.transaction_id;
+    const uint8_t stale[2] = {111, 0};
+    const uint8_t current[2] = {222, 0};
+    uint8_t stream[2 * REPLY_SIZE];
+    size_t size = build_reply(tns, stale, sizeof(stale), stream);
+    size += build_reply((uint16_t)(tns + 1), current, sizeof(current), stream + size);
+    TEST_ASSERT(write(peer, stream, size) == (ssize_t)size, "写入响应失败");
+
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0, "迟到响应之后读取失败");
+    TEST_ASSERT(value == 222, "迟到的旧事务响应不应作为当前请求的结果");
+    TEST_ASSERT(port->rx_head == port->rx_tail, "接收缓冲区中不应有剩余字节");
+
+    df1_serial_destroy(port);
+    close(peer);
+    TEST_PASS("迟到响应");
+}
+
+// 测试帧中的 0x0D、0x11、0x13 等控制字节原样收发，不被终端的输入转换改写
+int test_control_bytes() {
+    printf("测试控制字节...\n");
+
+    int peer = -1;
+    df1_serial_t* port = open_pty(&peer);
+    TEST_ASSERT(port != NULL, "打开伪终端失败");
+
+    // 事务ID为 0x110D，命令与响应的帧头中也带有控制字节
+    port->df1_config.transaction_id = 0x110C;
+    const uint8_t payload[] = {0x0D, 0x11, 0x13, 0x0A, 0x0D, 0xFF};
+    uint8_t reply[REPLY_SIZE];
+    size_t reply_size = build_reply(0x110D, payload, sizeof(payload), reply);
+    TEST_ASSERT(write(peer, reply, reply_size) == (ssize_t)reply_size, "写入响应失败");
+
+    uint8_t data[sizeof(payload)];
+    size_t actual = 0;
+    TEST_ASSERT(df1_serial_read(port, "N7:0", data, sizeof(data), &actual) == 0, "含控制字节的响应读取失败");
+    TEST_ASSERT(actual == sizeof(payload) && memcmp(data, payload, sizeof(payload)) == 0, "控制字节被改写");
+
+    // 从站收到的命令同样原样到达
+    df1_decoder_t decoder;
+    df1_decoder_init(&decoder, DF1_CHECK_CRC16);
+    df1_frame_t frame;
+    int result = DF1_DECODE_NEED_MORE;
+    while (result == DF1_DECODE_NEED_MORE) {
+        uint8_t input[REPLY_SIZE];
+        ssize_t n = read(peer, input, sizeof(input));
+        if (n <= 0) {
+            break;
+        }
+        size_t offset = 0;
+        while (offset < (size_t)n && result == DF1_DECODE_NEED_MORE) {
+            size_t consumed = 0;
+            result = df1_decoder_push(&decoder, input + offset, (size_t)n - offset, &consumed, &frame);
+            offset += consumed;
+        }
+    }
+    TEST_ASSERT(result == DF1_DECODE_FRAME && frame.tns == 0x110D, "从站收到的命令被改写");
+
+    df1_serial_destroy(port);
+    close(peer);
+    TEST_PASS("控制字节");
+}
+
+int main() {
+    printf("AB DF1 接收路径单元测试\n");
+    printf("=======================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_chunked_reply();
+    total++; passed += test_extra_bytes_kept();
+    total++; passed += test_late_reply_dropped();
+    total++; passed += test_control_bytes();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,316 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "df1_serial.h"
+#include "df1_sim.h"
+#include "df1_capture.h"
+#include "test_fixture.h"
+#include "df1_rtt.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 测试往返时间估计、退避与传输时间
+int test_estimator() {
+    printf("测试往返时间估计...\n");
+
+    TEST_ASSERT(df1_rtt_char_time_us(19200, 8, 0, 1) == 521, "19200 8N1 每字符时间错误");
+    TEST_ASSERT(df1_rtt_char_time_us(9600, 8, 1, 1) == 1146, "9600 8E1 每字符时间错误");
+    TEST_ASSERT(df1_rtt_char_time_us(0, 8, 0, 1) == 0, "无效波特率应返回0");
+
+    df1_rtt_config_t config;
+    df1_rtt_config_default(&config, 1000);
+    TEST_ASSERT(config.enabled && config.min_rto_ms == 20 && config.max_rto_ms == 1000, "默认配置错误");
+
+    df1_rtt_t rtt;
+    df1_rtt_init(&rtt, &config);
+    TEST_ASSERT(rtt.rto_ms == 1000 && df1_rtt_timeout(&rtt, 0, 0) == 1000, "没有样本时应使用上限");
+
+    // 第一个样本：SRTT = 10ms，RTTVAR = 5ms，RTO = 10 + 4 * 5 = 30ms
+    df1_rtt_sample(&rtt, 10000, 0);
+    TEST_ASSERT(rtt.srtt_us == 10000 && rtt.rttvar_us == 5000 && rtt.rto_ms == 30, "第一个样本的估计错误");
+
+    // 稳定的样本使偏差收敛，RTO 不低于下限
+    for (int i = 0; i < 50; i++) {
+        df1_rtt_sample(&rtt, 10000, 0);
+    }
+    TEST_ASSERT(rtt.srtt_us == 10000 && rtt.rto_ms == 20, "稳定样本后 RTO 应收敛到下限");
+
+    // 每次重发加倍，不超过上限
+    TEST_ASSERT(df1_rtt_timeout(&rtt, 1, 0) == 40 && df1_rtt_timeout(&rtt, 2, 0) == 80, "重发退避错误");
+    TEST_ASSERT(df1_rtt_timeout(&rtt, 10, 0) == 1000, "退避不应超过上限");
+
+    // 传输时间从样本中扣除、在超时中加回
+    config.char_time_us = 1000;
+    df1_rtt_init(&rtt, &config);
+    df1_rtt_sample(&rtt, 110000, 100);
+    TEST_ASSERT(rtt.srtt_us == 10000, "样本应扣除传输时间");
+    TEST_ASSERT(df1_rtt_timeout(&rtt, 0, 100) == rtt.rto_ms + 100, "超时应加上传输时间");
+
+    // 停用时不学习，始终使用上限
+    config.enabled = false;
+    df1_rtt_init(&rtt, &config);
+    df1_rtt_sample(&rtt, 10000, 0);
+    TEST_ASSERT(rtt.samples == 0 && df1_rtt_timeout(&rtt, 0, 0) == 1000, "停用时应使用固定超时");
+
+    TEST_PASS("往返时间估计");
+}
+
+// 测试离线判定、快速失败与定期探测
+int test_offline() {
+    printf("测试离线判定...\n");
+
+    df1_rtt_config_t config;
+    df1_rtt_config_default(&config, 1000);
+    config.offline_after = 3;
+    config.probe_interval_ms = 100;
+    df1_rtt_t rtt;
+    df1_rtt_init(&rtt, &config);
+
+    df1_rtt_failure(&rtt, 0);
+    df1_rtt_failure(&rtt, 0);
+    TEST_ASSERT(!rtt.offline && df1_rtt_allow(&rtt, 0), "未达到次数时不应离线");
+    df1_rtt_failure(&rtt, 0);
+    TEST_ASSERT(rtt.offline, "连续无应答后应判定离线");
+
+    TEST_ASSERT(!df1_rtt_allow(&rtt, 50) && rtt.fast_fails == 1, "探测间隔内应直接失败");
+    TEST_ASSERT(df1_rtt_allow(&rtt, 100), "到达探测时间应放行一个事务");
+    TEST_ASSERT(!df1_rtt_allow(&rtt, 101), "一个探测间隔只放行一个事务");
+
+    // 探测失败：下一次探测再等一个间隔
+    df1_rtt_failure(&rtt, 150);
+    TEST_ASSERT(rtt.offline && !df1_rtt_allow(&rtt, 200) && df1_rtt_allow(&rtt, 250), "探测失败后应继续离线");
+
+    df1_rtt_success(&rtt);
+    TEST_ASSERT(!rtt.offline && rtt.failures == 0 && df1_rtt_allow(&rtt, 251), "有应答后应恢复在线");
+
+    TEST_PASS("离线判定");
+}
+
+static char trace_path[64];
+
+// 从主站发出的线路字节中找出重发使用的事务ID（前一条命令没有收到应答时换号发出的命令），
+// 之后的新命令不应再使用这些事务ID。同一帧在 NAK 或 ENQ 后原样重发不算新命令
+static int check_retry_tns(int* retries) {
+    FILE* file = fopen(trace_path, "rb");
+    df1_trace_header_t header;
+    TEST_ASSERT(file != NULL && df1_trace_read_header(file, &header) == 0, "读取抓包文件失败");
+
+    static df1_trace_record_t record;
+    static df1_decoder_t decoders[2];
+    static uint8_t retry_tns[65536];
+    memset(retry_tns, 0, sizeof(retry_tns));
+    df1_decoder_init(&decoders[DF1_CAPTURE_TX], header.check_type);
+    df1_decoder_init(&decoders[DF1_CAPTURE_RX], header.check_type);
+
+    bool sent = false;
+    bool answered = false;
+    uint16_t last_tns = 0;
+    *retries = 0;
+    while (df1_trace_read_record(file, &record) == 1) {
+        size_t offset = 0;
+        while (offset < record.size) {
+            size_t consumed = 0;
+            df1_frame_t frame;
+            int result = df1_decoder_push(&decoders[record.direction], record.data + offset, record.size - offset,
+                                          &consumed, &frame);
+            offset += consumed;
+            if (result != DF1_DECODE_FRAME) {
+                continue;
+            }
+            if (record.direction == DF1_CAPTURE_RX) {
+                answered = answered || frame.tns == last_tns;
+                continue;
+            }
+            if (sent && frame.tns == last_tns) {
+                continue;
+            }
+            TEST_ASSERT(!retry_tns[frame.tns], "新命令不应再使用重发过的事务ID");
+            if (sent && !answered) {
+                retry_tns[frame.tns] = 1;
+                (*retries)++;
+            }
+            sent = true;
+            answered = false;
+            last_tns = frame.tns;
+        }
+    }
+    fclose(file);
+    remove(trace_path);
+    return 1;
+}
+
+// 丢帧后按测得的往返时间以新的事务ID重发：每次丢帧只耽误几十毫秒，而不是1秒的固定超时
+static int check_recovery(df1_duplex_t duplex) {
+    df1_sim_t* sim = fixture_sim_create(duplex);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_loopback(sim, duplex, 1000);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    int16_t value = 0;
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT(df1_serial_write_int16(port, "N7:3", 321) == 0, "写入失败");
+    }
+    TEST_ASSERT(port->rtt.samples > 0 && port->rtt.rto_ms < 1000, "应得到往返样本");
+
+    // 记录主站发出的全部命令，即模拟从站看到的事务ID
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, duplex, 1000);
+    df1_capture_t* capture = df1_capture_create(1 << 20);
+    TEST_ASSERT(capture && df1_capture_open_file(capture, trace_path, &config) == 0, "打开抓包文件失败");
+    TEST_ASSERT(df1_serial_set_capture(port, capture) == 0, "设置抓包失败");
+
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    faults.duplex = duplex;
+    faults.drop_rate = 0.2;
+    faults.seed = 3;
+    df1_sim_set_faults(sim, &faults);
+
+    int failures = 0;
+    long long start = now_ms();
+    for (int i = 0; i < 40; i++) {
+        if (df1_serial_read_int16(port, "N7:3", &value) != 0) {
+            failures++;
+        } else {
+            TEST_ASSERT(value == 321, "读取值错误");
+        }
+    }
+    long long elapsed = now_ms() - start;
+
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+    TEST_ASSERT(stats.dropped >= 3, "应注入丢帧");
+    TEST_ASSERT(failures <= 2, "丢帧应由重发恢复");
+    TEST_ASSERT(elapsed < (long long)stats.dropped * 100, "每次丢帧的恢复时间应远小于1秒的固定超时");
+
+    // 重发之后再发出超过半个事务ID空间的新命令：重发的事务ID若不取自连接的计数器
+    // （如原值 + 0x8001），计数器会在此期间把它再分配给新命令
+    df1_sim_config_default(&faults);
+    faults.duplex = duplex;
+    df1_sim_set_faults(sim, &faults);
+    for (int i = 0; i < 0x8000 + 64; i++) {
+        TEST_ASSERT(df1_serial_read_int16(port, "N7:3", &value) == 0, "读取失败");
+        if (i % 1024 == 0) {
+            df1_capture_flush(capture);
+        }
+    }
+    df1_capture_flush(capture);
+    TEST_ASSERT(df1_capture_dropped(capture) == 0, "不应丢弃抓包记录");
+
+    df1_serial_destroy(port);
+    df1_capture_destroy(capture);
+    df1_sim_destroy(sim);
+
+    int retries = 0;
+    TEST_ASSERT(check_retry_tns(&retries), "重发的事务ID被新命令再次使用");
+    TEST_ASSERT(retries >= 3, "模拟从站应看到以新事务ID重发的命令");
+    return 1;
+}
+
+int test_recovery() {
+    printf("测试丢帧恢复...\n");
+
+    TEST_ASSERT(check_recovery(DF1_HALF_DUPLEX), "半双工丢帧恢复失败");
+    TEST_ASSERT(check_recovery(DF1_FULL_DUPLEX), "全双工丢帧恢复失败");
+
+    TEST_PASS("丢帧恢复");
+}
+
+// 测试离线从站的请求直接失败，恢复后由探测重新上线
+int test_offline_fast_fail() {
+    printf("测试离线快速失败...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_HALF_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_HALF_DUPLEX, 1000);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    df1_rtt_config_t config;
+    df1_rtt_config_default(&config, 200);
+    config.offline_after = 2;
+    config.probe_interval_ms = 100;
+    TEST_ASSERT(df1_serial_set_rtt_config(port, &config) == 0, "设置自适应超时失败");
+
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0, "读取失败");
+
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    faults.duplex = DF1_HALF_DUPLEX;
+    faults.drop_rate = 1.0;
+    df1_sim_set_faults(sim, &faults);
+
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) != 0, "不应答时读取应该失败");
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) != 0, "不应答时读取应该失败");
+    TEST_ASSERT(port->rtt.offline, "连续无应答后应判定离线");
+
+    long long start = now_ms();
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) != 0, "离线时读取应该失败");
+    TEST_ASSERT(now_ms() - start < 10 && port->rtt.fast_fails == 1, "离线时应直接失败");
+
+    // 从站恢复：探测间隔之后的请求作为探测发出并成功
+    df1_sim_config_default(&faults);
+    faults.duplex = DF1_HALF_DUPLEX;
+    df1_sim_set_faults(sim, &faults);
+    struct timespec wait = {0, 120 * 1000000L};
+    nanosleep(&wait, NULL);
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0, "探测应成功");
+    TEST_ASSERT(!port->rtt.offline, "探测成功后应恢复在线");
+
+    // 停用后恢复为固定超时、不重发
+    config.enabled = false;
+    TEST_ASSERT(df1_serial_set_rtt_config(port, &config) == 0 && port->link.rtt == NULL, "停用自适应超时失败");
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0, "停用后读取失败");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("离线快速失败");
+}
+
+int main() {
+    printf("AB DF1 自适应超时单元测试\n");
+    printf("=========================\n\n");
+
+    snprintf(trace_path, sizeof(trace_path), "/tmp/test_rtt_%ld.trace", (long)getpid());
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_estimator();
+    total++; passed += test_offline();
+    total++; passed += test_recovery();
+    total++; passed += test_offline_fast_fail();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
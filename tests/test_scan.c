@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "df1_scan.h"
+#include "test_fixture.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+#define SLOW_FILES 24
+
+// 打开经伪终端连接的模拟从站：N7 与慢周期扫描用的 N10 起各文件中，每个字的低字节为元素号，
+// 高字节为 0x55
+static df1_serial_t* open_sim(df1_sim_t** sim, int latency_us) {
+    *sim = fixture_sim_create(DF1_HALF_DUPLEX);
+    if (!*sim) {
+        return NULL;
+    }
+
+    char address[16];
+    for (int i = 0; i < 300; i++) {
+        const uint8_t value[2] = {(uint8_t)i, 0x55};
+        snprintf(address, sizeof(address), "N7:%d", i);
+        df1_sim_set(*sim, 1, address, value, sizeof(value));
+        if (i < SLOW_FILES) {
+            snprintf(address, sizeof(address), "N%d:0", 10 + i);
+            if (df1_sim_add_file(*sim, 1, DF1_ADDR_N, (uint16_t)(10 + i), 1) != 0 ||
+                df1_sim_set(*sim, 1, address, value, sizeof(value)) != 0) {
+                return NULL;
+            }
+        }
+    }
+
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    faults.latency_us = latency_us;
+    df1_sim_set_faults(*sim, &faults);
+
+    df1_serial_t* port = fixture_open_pty(*sim, DF1_HALF_DUPLEX, 1000);
+    if (port && df1_sim_start(*sim) != 0) {
+        df1_serial_destroy(port);
+        return NULL;
+    }
+    return port;
+}
+
+typedef struct {
+    int calls;
+    int failures;
+} updates_t;
+
+static void on_update(void* user_data, int tag, int status, const uint8_t* data, size_t size) {
+    updates_t* updates = (updates_t*)user_data;
+    (void)tag;
+    updates->calls++;
+    if (status != 0 || !data || size != 2 || data[1] != 0x55) {
+        updates->failures++;
+    }
+}
+
+// 测试线路繁忙时快周期扫描类仍保持周期
+int test_scan_classes() {
+    printf("测试扫描类与EDF调度...\n");
+
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, 2000);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    df1_scanner_t* scanner = df1_scanner_create(port);
+    TEST_ASSERT(scanner != NULL, "创建扫描引擎失败");
+
+    int fast = df1_scanner_add_class(scanner, 25);
+    int slow = df1_scanner_add_class(scanner, 250);
+    TEST_ASSERT(fast >= 0 && slow >= 0, "添加扫描类失败");
+    TEST_ASSERT(df1_scanner_add_class(scanner, 0) < 0, "周期为0应该失败");
+
+    updates_t fast_updates = {0, 0};
+    updates_t slow_updates = {0, 0};
+    int fast_tag = df1_scanner_add_tag(scanner, fast, "N7:0", 2, on_update, &fast_updates);
+    TEST_ASSERT(fast_tag >= 0, "注册标签失败");
+    TEST_ASSERT(df1_scanner_value(scanner, fast_tag, NULL) == NULL, "读取前不应有数据");
+
+    // 慢周期扫描类的标签分布在不同文件中无法合并，单独占用线路约 24 条命令的时间，超过快周期
+    char address[16];
+    for (int i = 0; i < SLOW_FILES; i++) {
+        snprintf(address, sizeof(address), "N%d:0", 10 + i);
+        TEST_ASSERT(df1_scanner_add_tag(scanner, slow, address, 2, on_update, &slow_updates) >= 0, "注册标签失败");
+    }
+    TEST_ASSERT(df1_scanner_add_tag(scanner, slow, "X9:0", 2, NULL, NULL) < 0, "无效地址应该失败");
+
+    TEST_ASSERT(df1_scanner_run(scanner, 600) == 0, "运行扫描失败");
+
+    df1_scan_stats_t fast_stats, slow_stats;
+    TEST_ASSERT(df1_scanner_get_stats(scanner, fast, &fast_stats) == 0, "获取统计失败");
+    TEST_ASSERT(df1_scanner_get_stats(scanner, slow, &slow_stats) == 0, "获取统计失败");
+    printf("  快: %lu 周期, %lu 超时, 最大抖动 %lld ms; 慢: %lu 周期, %lu 超时, 最长 %lld ms\n",
+           fast_stats.scans, fast_stats.overruns, fast_stats.jitter_max_ms,
+           slow_stats.scans, slow_stats.overruns, slow_stats.duration_max_ms);
+
+    TEST_ASSERT(fast_stats.period_ms == 25 && fast_stats.scans >= 18, "快周期扫描次数不足");
+    TEST_ASSERT(fast_stats.jitter_max_ms < 25, "快周期抖动应小于周期");
+    TEST_ASSERT(slow_stats.scans >= 1, "慢周期扫描应完成");
+    TEST_ASSERT(fast_updates.failures == 0 && slow_updates.failures == 0, "读取应全部成功");
+    TEST_ASSERT(fast_updates.calls == (int)fast_stats.scans, "每个周期应回调一次");
+
+    size_t size = 0;
+    const uint8_t* value = df1_scanner_value(scanner, fast_tag, &size);
+    TEST_ASSERT(value && size == 2 && value[1] == 0x55, "最近一次读取的数据错误");
+
+    df1_scanner_reset_stats(scanner);
+    TEST_ASSERT(df1_scanner_get_stats(scanner, fast, &fast_stats) == 0 && fast_stats.scans == 0, "统计应清零");
+
+    df1_scanner_destroy(scanner);
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("扫描类与EDF调度");
+}
+
+typedef struct {
+    int index;
+    int calls;
+    int failures;
+} element_check_t;
+
+static void on_element(void* user_data, int tag, int status, const uint8_t* data, size_t size) {
+    element_check_t* check = (element_check_t*)user_data;
+    (void)tag;
+    check->calls++;
+    if (status != 0 || size != 2 || data[0] != (uint8_t)check->index || data[1] != 0x55) {
+        check->failures++;
+    }
+}
+
+// 测试同一文件中的相邻标签合并为一次块读取并散布回各标签
+int test_scan_coalescing() {
+    printf("测试扫描读取合并...\n");
+
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, 0);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    df1_scanner_t* scanner = df1_scanner_create(port);
+    int scan_class = df1_scanner_add_class(scanner, 50);
+    TEST_ASSERT(scanner && scan_class >= 0, "创建扫描引擎失败");
+
+    // 倒序注册 N7:0 ~ N7:99，外加与之间隔较远的 N7:200
+    element_check_t checks[101];
+    char address[16];
+    for (int i = 99; i >= 0; i--) {
+        checks[i].index = i;
+        checks[i].calls = 0;
+        checks[i].failures = 0;
+        snprintf(address, sizeof(address), "N7:%d", i);
+        TEST_ASSERT(df1_scanner_add_tag(scanner, scan_class, address, 2, on_element, &checks[i]) >= 0, "注册标签失败");
+    }
+    checks[100].index = 200;
+    checks[100].calls = 0;
+    checks[100].failures = 0;
+    TEST_ASSERT(df1_scanner_add_tag(scanner, scan_class, "N7:200", 2, on_element, &checks[100]) >= 0, "注册标签失败");
+
+    df1_scan_stats_t stats;
+    do {
+        TEST_ASSERT(df1_scanner_step(scanner) >= 0, "扫描失败");
+        df1_scanner_get_stats(scanner, scan_class, &stats);
+    } while (stats.scans == 0);
+
+    df1_sim_stats_t sim_stats;
+    df1_sim_get_stats(sim, &sim_stats);
+    TEST_ASSERT(sim_stats.commands == 2, "101个标签应合并为2次读取");
+    TEST_ASSERT(stats.errors == 0, "读取应全部成功");
+    for (int i = 0; i < 101; i++) {
+        TEST_ASSERT(checks[i].calls == 1 && checks[i].failures == 0, "标签数据应散布到对应的标签");
+    }
+
+    df1_scanner_destroy(scanner);
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("扫描读取合并");
+}
+
+typedef struct {
+    df1_scanner_t* scanner;
+    int scan_class;
+    int added;
+} adder_t;
+
+static void on_add_tag(void* user_data, int tag, int status, const uint8_t* data, size_t size) {
+    adder_t* adder = (adder_t*)user_data;
+    (void)tag;
+    (void)status;
+    (void)data;
+    (void)size;
+    adder->added = df1_scanner_add_tag(adder->scanner, adder->scan_class, "N7:1", 2, NULL, NULL);
+}
+
+// 测试回调中注册标签被拒绝，回调之外可以继续注册
+int test_scan_callback_add() {
+    printf("测试回调中注册标签...\n");
+
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, 0);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    adder_t adder;
+    adder.scanner = df1_scanner_create(port);
+    adder.scan_class = df1_scanner_add_class(adder.scanner, 50);
+    adder.added = 0;
+    TEST_ASSERT(adder.scanner && adder.scan_class >= 0, "创建扫描引擎失败");
+    TEST_ASSERT(df1_scanner_add_tag(adder.scanner, adder.scan_class, "N7:0", 2, on_add_tag, &adder) >= 0,
+                "注册标签失败");
+
+    TEST_ASSERT(df1_scanner_step(adder.scanner) == 1, "扫描失败");
+    TEST_ASSERT(adder.added < 0, "回调中注册标签应该失败");
+    TEST_ASSERT(df1_scanner_add_tag(adder.scanner, adder.scan_class, "N7:1", 2, NULL, NULL) >= 0,
+                "回调之外注册标签失败");
+
+    df1_scanner_destroy(adder.scanner);
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("回调中注册标签");
+}
+
+int main() {
+    printf("AB DF1 扫描引擎单元测试\n");
+    printf("=======================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_scan_classes();
+    total++; passed += test_scan_coalescing();
+    total++; passed += test_scan_callback_add();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
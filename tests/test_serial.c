@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "df1_serial.h"
+#include "df1_master.h"
+#include "df1_sim.h"
+#include "test_fixture.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+#define TIMEOUT_MS 200
+
+// 测试各数据类型的读写经模拟从站往返
+int test_read_write() {
+    printf("测试读写往返...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_FULL_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_FULL_DUPLEX, TIMEOUT_MS);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    // 从站数据表预置的值
+    const uint8_t n7[4] = {0x34, 0x12, 0xCE, 0xFF};
+    TEST_ASSERT(df1_sim_set(sim, 1, "N7:10", n7, sizeof(n7)) == 0, "预置数据失败");
+    int16_t values[2];
+    TEST_ASSERT(df1_serial_read_int16_array(port, "N7:10", values, 2) == 0, "读取整数失败");
+    TEST_ASSERT(values[0] == 0x1234 && values[1] == -50, "读取整数错误");
+
+    const float floats[3] = {1.5f, -2.25f, 1000.0f};
+    TEST_ASSERT(df1_serial_write_float_array(port, "F8:4", floats, 3) == 0, "写入浮点数失败");
+    float read_back[3];
+    TEST_ASSERT(df1_serial_read_float_array(port, "F8:4", read_back, 3) == 0, "读取浮点数失败");
+    TEST_ASSERT(memcmp(floats, read_back, sizeof(floats)) == 0, "浮点数往返错误");
+
+    const int32_t longs[2] = {123456789, -987654321};
+    TEST_ASSERT(df1_serial_write_int32_array(port, "L9:0", longs, 2) == 0, "写入长整数失败");
+    uint8_t raw[4];
+    TEST_ASSERT(df1_sim_get(sim, 1, "L9:1", raw, sizeof(raw)) == 0, "读取数据表失败");
+    TEST_ASSERT((int32_t)(raw[0] | raw[1] << 8 | raw[2] << 16 | (uint32_t)raw[3] << 24) == -987654321,
+                "长整数应按小端序写入数据表");
+
+    // 掩码写只修改指定位
+    TEST_ASSERT(df1_serial_write_int16(port, "B3:1", 0x00F0) == 0, "写入位文件失败");
+    TEST_ASSERT(df1_serial_set_bits(port, "B3:1", 0x0003) == 0, "置位失败");
+    TEST_ASSERT(df1_serial_clear_bits(port, "B3:1", 0x0010) == 0, "清位失败");
+    int16_t word = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "B3:1", &word) == 0 && word == 0x00E3, "掩码写结果错误");
+    bool bit = false;
+    TEST_ASSERT(df1_serial_write_bit(port, "B3/40", true) == 0, "写位失败");
+    TEST_ASSERT(df1_serial_read_bit(port, "B3:2/8", &bit) == 0 && bit, "B3/40 应为 B3:2/8");
+
+    // 定时器子元素与控制位
+    const uint8_t timer[6] = {0x00, 0x20, 0xE8, 0x03, 0x2C, 0x01}; // DN，PRE 1000，ACC 300
+    TEST_ASSERT(df1_sim_set(sim, 1, "T4:2", timer, sizeof(timer)) == 0, "预置定时器失败");
+    TEST_ASSERT(df1_serial_read_int16(port, "T4:2.ACC", &word) == 0 && word == 300, "读取 ACC 错误");
+    TEST_ASSERT(df1_serial_read_bit(port, "T4:2/DN", &bit) == 0 && bit, "读取 DN 错误");
+    TEST_ASSERT(df1_serial_write_int16(port, "C5:0.PRE", 42) == 0, "写入 PRE 失败");
+    TEST_ASSERT(df1_sim_get(sim, 1, "C5:0.PRE", raw, 2) == 0 && raw[0] == 42 && raw[1] == 0, "PRE 写入位置错误");
+
+    // 超过单条命令的块读写
+    uint8_t block[600];
+    for (size_t i = 0; i < sizeof(block); i++) {
+        block[i] = (uint8_t)(i * 7);
+    }
+    TEST_ASSERT(df1_serial_write_block(port, "N7:0", block, sizeof(block)) == 0, "块写入失败");
+    uint8_t block_read[600];
+    size_t actual = 0;
+    TEST_ASSERT(df1_serial_read_block(port, "N7:0", block_read, sizeof(block_read), &actual) == 0, "块读取失败");
+    TEST_ASSERT(actual == sizeof(block) && memcmp(block, block_read, sizeof(block)) == 0, "块读写数据错误");
+
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+    TEST_ASSERT(stats.errors == 0 && stats.bad_frames == 0, "不应有错误");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("读写往返");
+}
+
+// 测试从站以错误状态应答
+int test_error_status() {
+    printf("测试错误状态...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_FULL_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_FULL_DUPLEX, TIMEOUT_MS);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    df1_address_t missing, beyond;
+    df1_address_parse("N17:0", &missing);
+    df1_address_parse("N7:299", &beyond);
+    uint8_t data[4];
+    df1_request_t requests[2];
+    memset(requests, 0, sizeof(requests));
+    requests[0].command = DF1_CMD_READ;
+    requests[0].addr = &missing;
+    requests[0].read_data = data;
+    requests[0].size = 2;
+    requests[1] = requests[0];
+    requests[1].addr = &beyond;
+    requests[1].size = 4;
+
+    TEST_ASSERT(df1_serial_transact(port, requests, 2) != 0, "读取不存在的地址应失败");
+    TEST_ASSERT(requests[0].sts == 0xF0 && requests[0].ext_sts == 0x06, "文件不存在的扩展状态错误");
+    TEST_ASSERT(requests[1].sts == 0xF0 && requests[1].ext_sts == 0x0A, "越界的扩展状态错误");
+
+    // 错误之后连接仍可用
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:299", &value) == 0, "错误后读取失败");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("错误状态");
+}
+
+// 测试通过伪终端的半双工事务
+int test_pty_half_duplex() {
+    printf("测试伪终端半双工...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_HALF_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_pty(sim, DF1_HALF_DUPLEX, TIMEOUT_MS);
+    TEST_ASSERT(port != NULL && df1_sim_start(sim) == 0, "打开从设备失败");
+
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT(df1_serial_write_int16(port, "N7:5", (int16_t)(i * 100)) == 0, "写入失败");
+        int16_t value = 0;
+        TEST_ASSERT(df1_serial_read_int16(port, "N7:5", &value) == 0 && value == i * 100, "读取错误");
+    }
+
+    df1_serial_destroy(port);
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+    df1_sim_destroy(sim);
+    TEST_ASSERT(stats.commands == 100, "从站执行的命令数错误");
+    TEST_PASS("伪终端半双工");
+}
+
+// 测试多点线路上的轮询主站
+int test_multidrop() {
+    printf("测试多点轮询...\n");
+
+    const uint8_t stations[3] = {2, 5, 9};
+    df1_sim_t* sim = fixture_sim_create_stations(DF1_HALF_DUPLEX, true, stations, 3);
+    TEST_ASSERT(sim != NULL && df1_sim_open_pty(sim) == 0 && df1_sim_start(sim) == 0, "启动模拟从站失败");
+    for (int i = 0; i < 3; i++) {
+        const uint8_t value[2] = {stations[i], 0x77};
+        df1_sim_set(sim, stations[i], "N7:0", value, sizeof(value));
+    }
+
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, DF1_HALF_DUPLEX, TIMEOUT_MS);
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "%s", df1_sim_port_name(sim));
+    df1_serial_t* port = df1_serial_create();
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) == 0, "打开从设备失败");
+
+    df1_master_t* master = (df1_master_t*)malloc(sizeof(df1_master_t));
+    TEST_ASSERT(master && df1_master_init(master, port, NULL) == 0, "初始化轮询主站失败");
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(df1_master_add_station(master, stations[i], stations[i]) == 0, "添加从站失败");
+    }
+    df1_address_t addr;
+    df1_address_parse("N7:0", &addr);
+    uint8_t data[3][4][2];
+    df1_request_t requests[3][4];
+    memset(requests, 0, sizeof(requests));
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            requests[i][j].command = DF1_CMD_READ;
+            requests[i][j].addr = &addr;
+            requests[i][j].read_data = data[i][j];
+            requests[i][j].size = 2;
+            TEST_ASSERT(df1_master_submit(master, stations[i], &requests[i][j]) == 0, "提交请求失败");
+        }
+    }
+    TEST_ASSERT(df1_master_run(master, 5000) == 0, "轮询执行失败");
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            TEST_ASSERT(requests[i][j].status == 0, "请求应成功");
+            TEST_ASSERT(data[i][j][0] == stations[i] && data[i][j][1] == 0x77, "应读到对应从站的数据");
+        }
+    }
+
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+    TEST_ASSERT(stats.commands == 12 && stats.polls >= 12, "从站命令数或轮询数错误");
+
+    free(master);
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("多点轮询");
+}
+
+// 测试注入的线路错误由链路层重发恢复
+int test_fault_injection() {
+    printf("测试故障注入...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_FULL_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_FULL_DUPLEX, TIMEOUT_MS);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    faults.nak_rate = 0.1;
+    faults.corrupt_rate = 0.1;
+    df1_sim_set_faults(sim, &faults);
+
+    for (int i = 0; i < 200; i++) {
+        int16_t value = 0;
+        TEST_ASSERT(df1_serial_write_int16(port, "N7:1", (int16_t)i) == 0, "有NAK和校验错误时写入应重发成功");
+        TEST_ASSERT(df1_serial_read_int16(port, "N7:1", &value) == 0 && value == i, "有NAK和校验错误时读取应成功");
+    }
+
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+    TEST_ASSERT(stats.naks > 0 && stats.corrupted > 0 && stats.retransmits > 0, "应注入NAK与校验错误");
+    TEST_ASSERT(stats.commands == 400, "每条命令应只执行一次");
+
+    // 丢帧时请求超时失败，恢复后连接可用
+    faults.nak_rate = 0;
+    faults.corrupt_rate = 0;
+    faults.drop_rate = 1.0;
+    df1_sim_set_faults(sim, &faults);
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:1", &value) != 0, "丢帧时读取应失败");
+
+    faults.drop_rate = 0;
+    faults.latency_us = 3000;
+    df1_sim_set_faults(sim, &faults);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:1", &value) == 0 && value == 199, "恢复后读取失败");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long long elapsed_us = (end.tv_sec - start.tv_sec) * 1000000LL + (end.tv_nsec - start.tv_nsec) / 1000;
+    TEST_ASSERT(elapsed_us >= 3000, "应包含注入的处理延迟");
+
+    df1_sim_get_stats(sim, &stats);
+    TEST_ASSERT(stats.dropped > 0, "应记录丢弃的命令");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("故障注入");
+}
+
+int main() {
+    printf("AB DF1 模拟从站集成测试\n");
+    printf("=======================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_read_write();
+    total++; passed += test_error_status();
+    total++; passed += test_pty_half_duplex();
+    total++; passed += test_multidrop();
+    total++; passed += test_fault_injection();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
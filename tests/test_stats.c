@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "df1_serial.h"
+#include "df1_sim.h"
+#include "test_fixture.h"
+#include "df1_stats.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+// 测试直方图的分位数误差与边界
+int test_histogram() {
+    printf("测试延迟直方图...\n");
+
+    static df1_histogram_t histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    TEST_ASSERT(df1_histogram_percentile(&histogram, 0.5) == 0, "空直方图分位数应为0");
+
+    for (uint64_t value = 1; value <= 1000; value++) {
+        df1_histogram_record(&histogram, value);
+    }
+    TEST_ASSERT(histogram.count == 1000 && histogram.min_ns == 1 && histogram.max_ns == 1000, "样本数或最值错误");
+    TEST_ASSERT(df1_histogram_mean(&histogram) == 500.5, "平均值错误");
+
+    uint64_t p50 = df1_histogram_percentile(&histogram, 0.5);
+    uint64_t p99 = df1_histogram_percentile(&histogram, 0.99);
+    TEST_ASSERT(p50 >= 500 && p50 <= 500 + 500 / DF1_HISTOGRAM_SUB_BUCKETS, "p50 超出误差范围");
+    TEST_ASSERT(p99 >= 990 && p99 <= 1000, "p99 超出误差范围");
+    TEST_ASSERT(df1_histogram_percentile(&histogram, 1.0) == 1000, "p100 应为最大值");
+
+    // 小于子区间数的值精确记录
+    memset(&histogram, 0, sizeof(histogram));
+    df1_histogram_record(&histogram, 3);
+    df1_histogram_record(&histogram, 7);
+    TEST_ASSERT(df1_histogram_percentile(&histogram, 0.5) == 3, "小值应精确记录");
+
+    // 超出范围的值计入最后一个区间，分位数不超过最大值
+    uint64_t huge = (uint64_t)1 << 50;
+    df1_histogram_record(&histogram, huge);
+    TEST_ASSERT(histogram.buckets[DF1_HISTOGRAM_BUCKETS - 1] == 1, "超出范围的值应计入最后一个区间");
+    TEST_ASSERT(df1_histogram_percentile(&histogram, 1.0) == huge, "最大分位数应为最大值");
+
+    TEST_ASSERT(strcmp(df1_phase_name(DF1_PHASE_FIRST_BYTE), "first_byte") == 0, "阶段名称错误");
+
+    TEST_PASS("延迟直方图");
+}
+
+#ifdef DF1_ENABLE_STATS
+
+// 测试全双工流水路径的计数与各阶段样本
+int test_full_duplex_stats() {
+    printf("测试全双工统计...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_FULL_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_FULL_DUPLEX, 100);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    static df1_stats_t stats;
+    int16_t value;
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0, "读取失败");
+    }
+    TEST_ASSERT(df1_serial_read_int16(port, "N20:0", &value) != 0, "不存在的文件应该失败");
+
+    TEST_ASSERT(df1_serial_get_stats(port, &stats) == 0, "获取统计失败");
+    TEST_ASSERT(stats.transactions == 51 && stats.errors == 1, "事务计数错误");
+    TEST_ASSERT(stats.bytes_sent > 51 * 10 && stats.bytes_received > 51 * 10, "字节计数错误");
+    TEST_ASSERT(stats.crc_errors == 0 && stats.naks_received == 0 && stats.retries == 0 && stats.timeouts == 0,
+               "无故障时不应有错误计数");
+    TEST_ASSERT(stats.phases[DF1_PHASE_ENCODE].count == 51, "编码阶段样本数错误");
+    TEST_ASSERT(stats.phases[DF1_PHASE_TOTAL].count == 51, "总时间样本数错误");
+    TEST_ASSERT(stats.phases[DF1_PHASE_DECODE].count == 51, "解码阶段样本数错误");
+    TEST_ASSERT(stats.phases[DF1_PHASE_TRANSMIT].count >= 51, "发送阶段样本数错误");
+    TEST_ASSERT(stats.phases[DF1_PHASE_FIRST_BYTE].count == 51, "首字节阶段样本数错误");
+    TEST_ASSERT(stats.phases[DF1_PHASE_FRAME].count == 51, "帧接收阶段样本数错误");
+    TEST_ASSERT(df1_histogram_percentile(&stats.phases[DF1_PHASE_TOTAL], 0.99) > 0, "总时间分位数应大于0");
+
+    df1_serial_reset_stats(port);
+    TEST_ASSERT(df1_serial_get_stats(port, &stats) == 0 && stats.transactions == 0 &&
+               stats.phases[DF1_PHASE_TOTAL].count == 0, "清零统计失败");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("全双工统计");
+}
+
+// 测试 NAK、校验错误与超时的计数
+int test_fault_stats() {
+    printf("测试故障计数...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_FULL_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    faults.nak_rate = 0.2;
+    faults.corrupt_rate = 0.2;
+    faults.seed = 7;
+    df1_sim_set_faults(sim, &faults);
+
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_FULL_DUPLEX, 100);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    int16_t value;
+    for (int i = 0; i < 100; i++) {
+        df1_serial_read_int16(port, "N7:1", &value);
+    }
+
+    static df1_stats_t stats;
+    TEST_ASSERT(df1_serial_get_stats(port, &stats) == 0, "获取统计失败");
+    TEST_ASSERT(stats.transactions == 100, "事务计数错误");
+    TEST_ASSERT(stats.naks_received > 0 && stats.retries >= stats.naks_received - stats.errors, "NAK 与重发计数错误");
+    TEST_ASSERT(stats.crc_errors > 0 && stats.naks_sent >= stats.crc_errors, "校验错误计数错误");
+
+    // 从站不应答：ACK 超时后发送 ENQ 计为重试，最终等待超时
+    df1_serial_reset_stats(port);
+    df1_sim_config_default(&faults);
+    faults.drop_rate = 1.0;
+    df1_sim_set_faults(sim, &faults);
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:1", &value) != 0, "不应答时读取应该失败");
+    TEST_ASSERT(df1_serial_get_stats(port, &stats) == 0, "获取统计失败");
+    TEST_ASSERT(stats.timeouts == 1 && stats.errors == 1, "超时计数错误");
+    TEST_ASSERT(stats.retries >= 1, "ENQ 重试计数错误");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("故障计数");
+}
+
+// 测试半双工逐条执行路径的各阶段样本与超时
+int test_half_duplex_stats() {
+    printf("测试半双工统计...\n");
+
+    df1_sim_t* sim = fixture_sim_create(DF1_HALF_DUPLEX);
+    TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+    df1_serial_t* port = fixture_open_loopback(sim, DF1_HALF_DUPLEX, 100);
+    TEST_ASSERT(port != NULL, "打开连接失败");
+
+    int16_t value;
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT(df1_serial_read_int16(port, "N7:2", &value) == 0, "读取失败");
+    }
+
+    static df1_stats_t stats;
+    TEST_ASSERT(df1_serial_get_stats(port, &stats) == 0, "获取统计失败");
+    TEST_ASSERT(stats.transactions == 20 && stats.errors == 0, "事务计数错误");
+    for (int phase = 0; phase < DF1_PHASE_COUNT; phase++) {
+        TEST_ASSERT(stats.phases[phase].count == 20, "每个阶段应各有20个样本");
+    }
+    TEST_ASSERT(stats.phases[DF1_PHASE_TOTAL].max_ns >= stats.phases[DF1_PHASE_DECODE].max_ns, "总时间应不小于解码时间");
+
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    faults.drop_rate = 1.0;
+    df1_sim_set_faults(sim, &faults);
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:2", &value) != 0, "不应答时读取应该失败");
+    TEST_ASSERT(df1_serial_get_stats(port, &stats) == 0, "获取统计失败");
+    TEST_ASSERT(stats.timeouts == 1 && stats.errors == 1 && stats.transactions == 21, "超时计数错误");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("半双工统计");
+}
+
+#else
+
+// 未启用统计时快照接口返回失败
+int test_stats_disabled() {
+    printf("测试未启用统计...\n");
+
+    df1_serial_t* port = df1_serial_create();
+    TEST_ASSERT(port != NULL, "创建连接失败");
+    static df1_stats_t stats;
+    TEST_ASSERT(df1_serial_get_stats(port, &stats) != 0, "未启用统计时应返回失败");
+    df1_serial_destroy(port);
+
+    TEST_PASS("未启用统计");
+}
+
+#endif
+
+int main() {
+    printf("AB DF1 统计单元测试\n");
+    printf("===================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_histogram();
+#ifdef DF1_ENABLE_STATS
+    total++; passed += test_full_duplex_stats();
+    total++; passed += test_fault_stats();
+    total++; passed += test_half_duplex_stats();
+#else
+    total++; passed += test_stats_disabled();
+#endif
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,314 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include "df1_serial.h"
+#include "df1_loop.h"
+#include "test_fixture.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+// 创建 N7:0 ~ N7:99 为 0x5A 填充的模拟从站
+static df1_sim_t* create_filled_sim(df1_duplex_t duplex) {
+    uint8_t fill[200];
+    memset(fill, 0x5A, sizeof(fill));
+    df1_sim_t* sim = fixture_sim_create(duplex);
+    if (sim && df1_sim_set(sim, 1, "N7:0", fill, sizeof(fill)) != 0) {
+        df1_sim_destroy(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+static unsigned long sim_commands(df1_sim_t* sim) {
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+    return stats.commands;
+}
+
+// 测试内存回环的基本收发语义
+int test_loopback_pair() {
+    printf("测试内存回环收发...\n");
+
+    df1_transport_t a, b;
+    TEST_ASSERT(df1_transport_loopback_pair(&a, &b) == 0, "创建内存回环失败");
+    TEST_ASSERT(df1_transport_poll_fd(&a) == -1, "内存回环不应有文件描述符");
+
+    uint8_t buffer[8];
+    struct iovec iov = {buffer, sizeof(buffer)};
+    TEST_ASSERT(df1_transport_recv(&b, &iov, 1) == -1 && errno == EAGAIN, "没有数据时应返回 EAGAIN");
+    TEST_ASSERT(df1_transport_wait(&b, DF1_TRANSPORT_READ, 10) == 0, "没有数据时等待应超时");
+    TEST_ASSERT(df1_transport_wait(&a, DF1_TRANSPORT_WRITE, 10) == 1, "缓冲区空闲时应可写");
+
+    const uint8_t data[5] = {1, 2, 3, 4, 5};
+    TEST_ASSERT(df1_transport_send(&a, data, sizeof(data)) == 5, "发送失败");
+    TEST_ASSERT(df1_transport_wait(&b, DF1_TRANSPORT_READ, 10) == 1, "有数据时应可读");
+
+    // 分两段接收
+    uint8_t first[2], second[8];
+    struct iovec parts[2] = {{first, sizeof(first)}, {second, sizeof(second)}};
+    TEST_ASSERT(df1_transport_recv(&b, parts, 2) == 5, "接收字节数错误");
+    TEST_ASSERT(first[0] == 1 && first[1] == 2 && second[0] == 3 && second[2] == 5, "接收数据错误");
+
+    // 缓冲区满时只接受部分数据
+    static uint8_t bulk[DF1_LOOPBACK_BUFFER_SIZE + 10];
+    TEST_ASSERT(df1_transport_send(&a, bulk, sizeof(bulk)) == DF1_LOOPBACK_BUFFER_SIZE, "应只写入缓冲区容量");
+    TEST_ASSERT(df1_transport_send(&a, bulk, 1) == -1 && errno == EAGAIN, "缓冲区满时应返回 EAGAIN");
+    TEST_ASSERT(df1_transport_wait(&a, DF1_TRANSPORT_WRITE, 10) == 0, "缓冲区满时等待可写应超时");
+
+    df1_transport_close(&b);
+    TEST_ASSERT(df1_transport_send(&a, data, 1) == -1 && errno == EPIPE, "对端关闭后发送应返回 EPIPE");
+    TEST_ASSERT(df1_transport_recv(&a, &iov, 1) == 0, "对端关闭后接收应返回0");
+    df1_transport_close(&a);
+    TEST_ASSERT(a.ops == NULL, "关闭后应为未打开状态");
+
+    TEST_PASS("内存回环收发");
+}
+
+// 测试单线程通过内存回环完成读写事务
+int test_loopback_serial() {
+    printf("测试内存回环事务...\n");
+
+    df1_duplex_t modes[2] = {DF1_HALF_DUPLEX, DF1_FULL_DUPLEX};
+    for (int m = 0; m < 2; m++) {
+        df1_sim_t* sim = create_filled_sim(modes[m]);
+        TEST_ASSERT(sim != NULL, "创建模拟从站失败");
+        df1_serial_t* port = fixture_open_loopback(sim, modes[m], 1000);
+        TEST_ASSERT(port != NULL, "打开连接失败");
+
+        for (int i = 0; i < 100; i++) {
+            uint8_t data[20];
+            size_t actual = 0;
+            TEST_ASSERT(df1_serial_read(port, "N7:0", data, sizeof(data), &actual) == 0, "读取失败");
+            TEST_ASSERT(actual == sizeof(data) && data[0] == 0x5A && data[19] == 0x5A, "读取数据错误");
+        }
+        TEST_ASSERT(df1_serial_write_int16(port, "N7:1", 1234) == 0, "写入失败");
+        TEST_ASSERT(sim_commands(sim) == 101, "模拟从站收到的命令数错误");
+
+        // 事件循环依赖文件描述符
+        df1_loop_t* loop = df1_loop_create();
+        TEST_ASSERT(loop && df1_loop_add(loop, port) != 0, "内存回环不应能加入事件循环");
+        df1_loop_destroy(loop);
+
+        df1_serial_destroy(port);
+        df1_sim_destroy(sim);
+    }
+
+    TEST_PASS("内存回环事务");
+}
+
+// 测试经TCP连接终端服务器
+int test_tcp() {
+    printf("测试TCP传输...\n");
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    TEST_ASSERT(listener >= 0 && bind(listener, (struct sockaddr*)&addr, sizeof(addr)) == 0 &&
+                listen(listener, 1) == 0 && getsockname(listener, (struct sockaddr*)&addr, &addr_len) == 0,
+                "创建监听套接字失败");
+
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, DF1_FULL_DUPLEX, 1000);
+    df1_serial_t* port = df1_serial_create();
+
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "tcp://127.0.0.1");
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) != 0, "缺少端口号应失败");
+
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "tcp://127.0.0.1:%u",
+             (unsigned)ntohs(addr.sin_port));
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) == 0, "连接失败");
+
+    int fd = accept(listener, NULL, NULL);
+    TEST_ASSERT(fd >= 0, "接受连接失败");
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // 应答与响应分两次写出
+
+    // 模拟从站在接受的连接上应答
+    df1_transport_t accepted;
+    df1_transport_init(&accepted);
+    accepted.ops = &df1_transport_tcp;
+    accepted.fd = fd;
+    df1_sim_t* sim = create_filled_sim(DF1_FULL_DUPLEX);
+    TEST_ASSERT(sim && df1_sim_attach(sim, &accepted) == 0 && df1_sim_start(sim) == 0, "启动模拟从站失败");
+
+    TEST_ASSERT(port->transport.ops == &df1_transport_tcp, "应使用TCP后端");
+    for (int i = 0; i < 20; i++) {
+        int16_t value = 0;
+        TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) == 0, "读取失败");
+        TEST_ASSERT(value == 0x5A5A, "读取数据错误");
+    }
+
+    // 终端服务器断开后请求失败
+    df1_sim_destroy(sim);
+    int16_t value = 0;
+    TEST_ASSERT(df1_serial_read_int16(port, "N7:0", &value) != 0, "对端关闭后读取应失败");
+
+    df1_serial_destroy(port);
+    close(listener);
+    TEST_PASS("TCP传输");
+}
+
+// 测试伪终端主设备后端
+int test_pty() {
+    printf("测试伪终端传输...\n");
+
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, DF1_HALF_DUPLEX, 1000);
+
+    df1_transport_t pty;
+    TEST_ASSERT(df1_transport_open(&pty, &df1_transport_pty, &serial_config) == 0, "打开伪终端失败");
+    TEST_ASSERT(df1_transport_pty_name(&pty) != NULL && df1_transport_poll_fd(&pty) >= 0,
+                "应有从设备名称与文件描述符");
+
+    // 从设备一侧尚未打开时等待不应出错
+    TEST_ASSERT(df1_transport_wait(&pty, DF1_TRANSPORT_READ, 5) == 0, "从设备未打开时等待应超时");
+    df1_sim_t* sim = create_filled_sim(DF1_HALF_DUPLEX);
+    TEST_ASSERT(sim && df1_sim_attach(sim, &pty) == 0 && df1_sim_start(sim) == 0, "启动模拟从站失败");
+
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "%s", df1_sim_port_name(sim));
+    df1_serial_t* port = df1_serial_create();
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) == 0, "打开从设备失败");
+    TEST_ASSERT(port->transport.ops == &df1_transport_serial, "从设备应使用终端后端");
+
+    for (int i = 0; i < 20; i++) {
+        uint8_t data[100];
+        size_t actual = 0;
+        TEST_ASSERT(df1_serial_read(port, "N7:0", data, sizeof(data), &actual) == 0, "读取失败");
+        TEST_ASSERT(actual == sizeof(data) && data[99] == 0x5A, "读取数据错误");
+    }
+
+    df1_serial_destroy(port);
+    TEST_ASSERT(sim_commands(sim) == 20, "模拟从站收到的命令数错误");
+    df1_sim_destroy(sim);
+    TEST_PASS("伪终端传输");
+}
+
+// 测试串口调优参数：任意波特率、发送后等待完成、低延迟与 RS-485
+// 经 termios2 读回内核中的输出波特率，布局与 src/df1_transport.c 相同
+#if defined(__linux__) && defined(TCGETS2) && !defined(__mips__) && !defined(__powerpc__) && !defined(__sparc__) && \
+    !defined(__alpha__)
+#define HAVE_TERMIOS2 1
+
+struct termios2 {
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[19];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+
+static long output_speed(int fd) {
+    struct termios2 options;
+    return ioctl(fd, TCGETS2, &options) == 0 ? (long)options.c_ospeed : -1;
+}
+#endif
+
+int test_serial_tuning() {
+    printf("测试串口调优参数...\n");
+
+    df1_serial_config_t serial_config;
+    df1_config_t config;
+    fixture_master_config(&serial_config, &config, DF1_HALF_DUPLEX, 1000);
+
+    df1_sim_t* sim = create_filled_sim(DF1_HALF_DUPLEX);
+    TEST_ASSERT(sim && df1_sim_open_pty(sim) == 0 && df1_sim_start(sim) == 0, "启动模拟从站失败");
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "%s", df1_sim_port_name(sim));
+
+    // 驱动不支持 RS-485 时打开应失败，不应在方向控制缺失时静默运行
+    df1_serial_t* port = df1_serial_create();
+    serial_config.rs485 = true;
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) != 0, "伪终端不支持RS-485，打开应失败");
+    serial_config.rs485 = false;
+
+    serial_config.baud_rate = -1;
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) != 0, "无效波特率应打开失败");
+
+    // 非标准波特率与发送后等待完成；伪终端不支持低延迟标志，应被忽略
+    serial_config.baud_rate = 250000;
+    serial_config.drain = true;
+    serial_config.low_latency = true;
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) == 0, "非标准波特率打开失败");
+    TEST_ASSERT(port->transport.drain, "应启用发送后等待完成");
+#ifdef HAVE_TERMIOS2
+    TEST_ASSERT(output_speed(port->transport.fd) == 250000, "非标准波特率未生效");
+#endif
+
+    for (int i = 0; i < 10; i++) {
+        uint8_t data[100];
+        size_t actual = 0;
+        TEST_ASSERT(df1_serial_read(port, "N7:0", data, sizeof(data), &actual) == 0, "读取失败");
+        TEST_ASSERT(actual == sizeof(data) && data[0] == 0x5A, "读取数据错误");
+    }
+
+    // 标准波特率经 cfsetspeed 设置
+    df1_serial_close(port);
+    serial_config.baud_rate = 230400;
+    TEST_ASSERT(df1_serial_open(port, &serial_config, &config) == 0, "标准波特率打开失败");
+#ifdef HAVE_TERMIOS2
+    TEST_ASSERT(output_speed(port->transport.fd) == 230400, "标准波特率未生效");
+#endif
+    uint8_t data[100];
+    size_t actual = 0;
+    TEST_ASSERT(df1_serial_read(port, "N7:0", data, sizeof(data), &actual) == 0 && data[0] == 0x5A, "读取失败");
+
+    df1_serial_destroy(port);
+    TEST_ASSERT(sim_commands(sim) == 11, "模拟从站收到的命令数错误");
+    df1_sim_destroy(sim);
+    TEST_PASS("串口调优参数");
+}
+
+int main() {
+    printf("AB DF1 传输层单元测试\n");
+    printf("=====================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_loopback_pair();
+    total++; passed += test_loopback_serial();
+    total++; passed += test_tcp();
+    total++; passed += test_pty();
+    total++; passed += test_serial_tuning();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
@@ -0,0 +1,227 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "df1_worker.h"
+#include "test_fixture.h"
+
+// 简单的测试框架宏
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_PASS(message) \
+    do { \
+        printf("PASS: %s\n", message); \
+        return 1; \
+    } while(0)
+
+// 打开经伪终端连接的模拟从站，N7:0 的高字节为 0x55
+static df1_serial_t* open_sim(df1_sim_t** sim, df1_duplex_t duplex, int latency_us) {
+    const uint8_t value[2] = {0x00, 0x55};
+    *sim = fixture_sim_create(duplex);
+    if (!*sim || df1_sim_set(*sim, 1, "N7:0", value, sizeof(value)) != 0) {
+        return NULL;
+    }
+
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    faults.latency_us = latency_us;
+    df1_sim_set_faults(*sim, &faults);
+
+    df1_serial_t* port = fixture_open_pty(*sim, duplex, 1000);
+    if (port && df1_sim_start(*sim) != 0) {
+        df1_serial_destroy(port);
+        return NULL;
+    }
+    return port;
+}
+
+#define PRODUCERS 4
+#define REQUESTS_PER_PRODUCER 50
+
+typedef struct {
+    df1_worker_t* worker;
+    const df1_address_t* addr;
+    int failures;
+} producer_t;
+
+static void* producer_main(void* arg) {
+    producer_t* producer = (producer_t*)arg;
+    for (int i = 0; i < REQUESTS_PER_PRODUCER; i++) {
+        uint8_t data[2] = {0, 0};
+        df1_request_t request;
+        memset(&request, 0, sizeof(request));
+        request.command = DF1_CMD_READ;
+        request.addr = producer->addr;
+        request.read_data = data;
+        request.size = 2;
+
+        df1_priority_t priority = (i % 2) ? DF1_PRIORITY_LOW : DF1_PRIORITY_NORMAL;
+        if (df1_worker_execute(producer->worker, &request, priority) != 0 || request.actual_size != 2 ||
+            data[1] != 0x55) {
+            producer->failures++;
+        }
+    }
+    return NULL;
+}
+
+// 测试多个线程通过同一个连接同步执行请求
+int test_concurrent_producers() {
+    printf("测试多线程共享连接...\n");
+
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, DF1_FULL_DUPLEX, 0);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    df1_worker_t* worker = df1_worker_create(port);
+    TEST_ASSERT(worker != NULL, "创建工作线程失败");
+
+    df1_address_t addr;
+    df1_address_parse("N7:0", &addr);
+
+    pthread_t threads[PRODUCERS];
+    producer_t producers[PRODUCERS];
+    for (int i = 0; i < PRODUCERS; i++) {
+        producers[i].worker = worker;
+        producers[i].addr = &addr;
+        producers[i].failures = 0;
+        pthread_create(&threads[i], NULL, producer_main, &producers[i]);
+    }
+
+    int failures = 0;
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        failures += producers[i].failures;
+    }
+
+    df1_worker_destroy(worker);
+    df1_sim_stats_t stats;
+    df1_sim_get_stats(sim, &stats);
+
+    TEST_ASSERT(failures == 0, "所有请求应成功");
+    TEST_ASSERT(stats.commands == PRODUCERS * REQUESTS_PER_PRODUCER, "模拟从站应执行全部命令");
+    TEST_ASSERT(stats.duplicates == 0, "事务ID不应重复");
+
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("多线程共享连接");
+}
+
+typedef struct {
+    pthread_mutex_t mutex;
+    int order[8];
+    int count;
+} order_t;
+
+typedef struct {
+    order_t* order;
+    int id;
+} tagged_t;
+
+static void on_complete(void* user_data, df1_request_t* request) {
+    tagged_t* tagged = (tagged_t*)user_data;
+    (void)request;
+    pthread_mutex_lock(&tagged->order->mutex);
+    tagged->order->order[tagged->order->count++] = tagged->id;
+    pthread_mutex_unlock(&tagged->order->mutex);
+}
+
+// 测试高优先级请求越过排队中的低优先级请求
+int test_priority_lanes() {
+    printf("测试优先级队列...\n");
+
+    // 模拟从站每条命令处理 300ms，其余请求在第一条请求执行期间排队
+    df1_sim_t* sim = NULL;
+    df1_serial_t* port = open_sim(&sim, DF1_HALF_DUPLEX, 300 * 1000);
+    TEST_ASSERT(port != NULL, "启动模拟从站失败");
+
+    df1_worker_t* worker = df1_worker_create(port);
+    TEST_ASSERT(worker != NULL, "创建工作线程失败");
+
+    df1_address_t addr;
+    df1_address_parse("N7:0", &addr);
+
+    order_t order;
+    memset(&order, 0, sizeof(order));
+    pthread_mutex_init(&order.mutex, NULL);
+
+    df1_request_t requests[4];
+    uint8_t data[4][2];
+    tagged_t tags[4];
+    df1_priority_t priorities[4] = {DF1_PRIORITY_LOW, DF1_PRIORITY_LOW, DF1_PRIORITY_LOW, DF1_PRIORITY_HIGH};
+    for (int i = 0; i < 4; i++) {
+        memset(&requests[i], 0, sizeof(df1_request_t));
+        requests[i].command = DF1_CMD_READ;
+        requests[i].addr = &addr;
+        requests[i].read_data = data[i];
+        requests[i].size = 2;
+        tags[i].order = &order;
+        tags[i].id = i;
+    }
+
+    // 第一条请求取出执行后，其余请求在队列中等待
+    TEST_ASSERT(df1_worker_submit(worker, &requests[0], priorities[0], on_complete, &tags[0]) == 0, "提交失败");
+    while (df1_worker_queued(worker) > 0) {
+        struct timespec wait = {0, 1000000L};
+        nanosleep(&wait, NULL);
+    }
+
+    for (int i = 1; i < 4; i++) {
+        TEST_ASSERT(df1_worker_submit(worker, &requests[i], priorities[i], on_complete, &tags[i]) == 0, "提交失败");
+    }
+    TEST_ASSERT(df1_worker_queued(worker) == 3, "排队请求数错误");
+
+    // 之后的命令不再延迟
+    df1_sim_config_t faults;
+    df1_sim_config_default(&faults);
+    df1_sim_set_faults(sim, &faults);
+
+    // 同步请求在全部异步请求之后排队，完成时前面的请求都已完成
+    uint8_t last[2];
+    df1_request_t barrier;
+    memset(&barrier, 0, sizeof(barrier));
+    barrier.command = DF1_CMD_READ;
+    barrier.addr = &addr;
+    barrier.read_data = last;
+    barrier.size = 2;
+    TEST_ASSERT(df1_worker_execute(worker, &barrier, DF1_PRIORITY_LOW) == 0, "同步请求失败");
+
+    df1_worker_destroy(worker);
+
+    TEST_ASSERT(order.count == 4, "所有请求应完成");
+    TEST_ASSERT(order.order[0] == 0 && order.order[1] == 3, "高优先级请求应越过排队的低优先级请求");
+    TEST_ASSERT(order.order[2] == 1 && order.order[3] == 2, "同一优先级应保持提交顺序");
+
+    pthread_mutex_destroy(&order.mutex);
+    df1_serial_destroy(port);
+    df1_sim_destroy(sim);
+    TEST_PASS("优先级队列");
+}
+
+int main() {
+    printf("AB DF1 共享连接单元测试\n");
+    printf("=======================\n\n");
+
+    int passed = 0;
+    int total = 0;
+
+    total++; passed += test_concurrent_producers();
+    total++; passed += test_priority_lanes();
+
+    printf("\n测试结果: %d/%d 通过\n", passed, total);
+
+    if (passed == total) {
+        printf("所有测试通过！\n");
+        return 0;
+    } else {
+        printf("有测试失败！\n");
+        return 1;
+    }
+}
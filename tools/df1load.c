@@ -0,0 +1,737 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "df1_serial.h"
+#include "df1_loop.h"
+#include "df1_sim.h"
+
+// DF1 链路负载发生器
+//
+// 在一条连接上按给定的读写比例轮流访问标签列表，保持指定数量的请求同时在途，
+// 统计吞吐量、延迟分位数、线路占用率以及错误与重试比例，用于估算一条串口线路
+// 在给定扫描周期下能承载多少标签。--sim 使用内置的模拟从站（伪终端），无需PLC。
+
+#define LOAD_MAX_TAGS 1024
+#define LOAD_MAX_DEPTH DF1_LINK_MAX_OUTSTANDING
+
+typedef enum {
+    FORMAT_TEXT,
+    FORMAT_JSON
+} output_format_t;
+
+// 按DLE转义规则扫描一个方向的字节流，统计链路控制字符
+typedef struct {
+    int state;                 // 0 数据，1 收到DLE，2 跳过帧尾校验字节
+    size_t check_left;         // 尚未跳过的校验字节数
+    unsigned long enq;         // DLE ENQ 个数
+    unsigned long nak;         // DLE NAK 个数
+} control_scan_t;
+
+// 计数传输层：包装实际的传输层，统计线路字节与链路控制字符
+typedef struct {
+    df1_transport_t inner;     // 实际的传输层
+    size_t check_size;         // 帧尾校验字节数
+    unsigned long tx_bytes;    // 发送字节数
+    unsigned long rx_bytes;    // 接收字节数
+    control_scan_t tx_scan;    // 发送方向：ENQ 为 ACK 超时，NAK 为拒收的响应
+    control_scan_t rx_scan;    // 接收方向：NAK 为从站拒收的命令
+} counting_t;
+
+typedef struct load load_t;
+
+// 一个在途请求
+typedef struct {
+    load_t* load;              // 所属负载
+    df1_request_t request;     // 请求
+    double submit_time;        // 提交时间（秒）
+    uint8_t read_data[DF1_MAX_DATA_SIZE]; // 读取数据
+    uint8_t write_data[DF1_MAX_DATA_SIZE]; // 写入数据
+} load_slot_t;
+
+struct load {
+    df1_loop_t* loop;          // 事件循环
+    df1_serial_t* port;        // 连接
+    df1_address_t tags[LOAD_MAX_TAGS]; // 已解析的标签
+    size_t tag_count;          // 标签数
+    size_t next_tag;           // 下一个访问的标签
+    size_t elements;           // 每次读写的元素数
+    double write_ratio;        // 写请求比例
+    unsigned int rng;          // 读写选择的随机数状态
+    double deadline;           // 停止提交的时间（秒）
+    unsigned long limit;       // 请求总数上限，0 表示不限
+    unsigned long submitted;   // 已提交的请求数
+    unsigned long completed;   // 已完成的请求数
+    unsigned long failed;      // 失败的请求数
+    unsigned long status_errors; // 以错误状态应答的请求数
+    unsigned long writes;      // 写请求数
+    unsigned long data_bytes;  // 读写的数据字节数
+    double* latencies;         // 每个请求的延迟（毫秒）
+    size_t latency_capacity;   // 延迟数组容量
+    load_slot_t slots[LOAD_MAX_DEPTH]; // 在途请求
+};
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void scan_control(control_scan_t* scan, size_t check_size, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t value = data[i];
+        if (scan->state == 2)
+        {
+            if (--scan->check_left == 0)
+            {
+                scan->state = 0;
+            }
+            continue;
+        }
+        if (scan->state == 0)
+        {
+            if (value == DF1_DLE)
+            {
+                scan->state = 1;
+            }
+            continue;
+        }
+
+        // DLE 之后的字节
+        scan->state = 0;
+        if (value == DF1_ENQ)
+        {
+            scan->enq++;
+        }
+        else if (value == DF1_NAK)
+        {
+            scan->nak++;
+        }
+        else if (value == DF1_ETX)
+        {
+            scan->state = 2;
+            scan->check_left = check_size;
+        }
+    }
+}
+
+static ssize_t counting_send(df1_transport_t* transport, const uint8_t* data, size_t size)
+{
+    counting_t* counting = transport->context;
+    ssize_t sent = counting->inner.ops->send(&counting->inner, data, size);
+    if (sent > 0)
+    {
+        counting->tx_bytes += (unsigned long)sent;
+        scan_control(&counting->tx_scan, counting->check_size, data, (size_t)sent);
+    }
+    return sent;
+}
+
+static ssize_t counting_recv(df1_transport_t* transport, const struct iovec* iov, int count)
+{
+    counting_t* counting = transport->context;
+    ssize_t received = counting->inner.ops->recv(&counting->inner, iov, count);
+    if (received > 0)
+    {
+        counting->rx_bytes += (unsigned long)received;
+        size_t left = (size_t)received;
+        for (int i = 0; i < count && left > 0; i++)
+        {
+            size_t part = iov[i].iov_len < left ? iov[i].iov_len : left;
+            scan_control(&counting->rx_scan, counting->check_size, iov[i].iov_base, part);
+            left -= part;
+        }
+    }
+    return received;
+}
+
+static int counting_wait(df1_transport_t* transport, int events, int timeout_ms)
+{
+    counting_t* counting = transport->context;
+    return counting->inner.ops->wait(&counting->inner, events, timeout_ms);
+}
+
+static int counting_set_min_read(df1_transport_t* transport, size_t size)
+{
+    counting_t* counting = transport->context;
+    if (!counting->inner.ops->set_min_read)
+    {
+        return 0;
+    }
+    int result = counting->inner.ops->set_min_read(&counting->inner, size);
+    transport->vmin = counting->inner.vmin;
+    return result;
+}
+
+static void counting_close(df1_transport_t* transport)
+{
+    counting_t* counting = transport->context;
+    df1_transport_close(&counting->inner);
+}
+
+static const df1_transport_ops_t counting_ops = {
+    "counting", NULL, counting_send, counting_recv, counting_wait, counting_set_min_read, counting_close,
+};
+
+static unsigned int next_random(unsigned int* state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// 地址对应的读写字节数：位与子元素地址为一个字
+static size_t tag_size(const df1_address_t* addr, size_t elements)
+{
+    if (addr->has_bit || addr->sub_element)
+    {
+        return 2;
+    }
+    size_t size = df1_address_element_size(addr->data_code) * elements;
+    return size > DF1_MAX_DATA_SIZE ? DF1_MAX_DATA_SIZE : size;
+}
+
+static void on_complete(void* user_data, df1_serial_t* port, df1_request_t* request);
+
+static int submit_next(load_t* load, load_slot_t* slot)
+{
+    if (now_seconds() >= load->deadline || (load->limit && load->submitted >= load->limit))
+    {
+        return -1;
+    }
+
+    const df1_address_t* addr = &load->tags[load->next_tag];
+    load->next_tag = (load->next_tag + 1) % load->tag_count;
+
+    df1_request_t* request = &slot->request;
+    memset(request, 0, sizeof(*request));
+    request->addr = addr;
+    request->size = tag_size(addr, load->elements);
+
+    bool write = load->write_ratio > 0.0
+                 && (double)next_random(&load->rng) / 4294967296.0 < load->write_ratio;
+    if (write && addr->has_bit)
+    {
+        // 位地址以掩码写修改单个位
+        request->command = DF1_CMD_MASK_WRITE;
+        request->mask = (uint16_t)(1u << addr->bit);
+        request->size = 2;
+        slot->write_data[0] = (uint8_t)(load->submitted & 1 ? request->mask : 0);
+        slot->write_data[1] = (uint8_t)(load->submitted & 1 ? request->mask >> 8 : 0);
+        request->write_data = slot->write_data;
+    }
+    else if (write)
+    {
+        request->command = DF1_CMD_WRITE;
+        for (size_t i = 0; i < request->size; i++)
+        {
+            slot->write_data[i] = (uint8_t)(load->submitted + i);
+        }
+        request->write_data = slot->write_data;
+    }
+    else
+    {
+        request->command = DF1_CMD_READ;
+        request->read_data = slot->read_data;
+    }
+
+    slot->submit_time = now_seconds();
+    if (df1_loop_submit(load->loop, load->port, request, on_complete, slot) != 0)
+    {
+        return -1;
+    }
+    load->submitted++;
+    if (write)
+    {
+        load->writes++;
+    }
+    return 0;
+}
+
+static void on_complete(void* user_data, df1_serial_t* port, df1_request_t* request)
+{
+    (void)port;
+    load_slot_t* slot = user_data;
+    load_t* load = slot->load;
+
+    if (load->completed == load->latency_capacity)
+    {
+        size_t capacity = load->latency_capacity ? load->latency_capacity * 2 : 4096;
+        double* latencies = realloc(load->latencies, capacity * sizeof(double));
+        if (latencies)
+        {
+            load->latencies = latencies;
+            load->latency_capacity = capacity;
+        }
+    }
+    if (load->completed < load->latency_capacity)
+    {
+        load->latencies[load->completed] = (now_seconds() - slot->submit_time) * 1e3;
+    }
+    load->completed++;
+
+    if (request->status != 0)
+    {
+        load->failed++;
+        if (request->sts != 0)
+        {
+            load->status_errors++;
+        }
+    }
+    else
+    {
+        load->data_bytes += request->command == DF1_CMD_READ ? request->actual_size : request->size;
+    }
+
+    submit_next(load, slot);
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, size_t count, double p)
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (double)(count - 1) + 0.5);
+    return sorted[index < count ? index : count - 1];
+}
+
+static int add_tag(load_t* load, const char* name)
+{
+    if (load->tag_count >= LOAD_MAX_TAGS)
+    {
+        fprintf(stderr, "标签数超过 %d\n", LOAD_MAX_TAGS);
+        return -1;
+    }
+    if (df1_address_parse(name, &load->tags[load->tag_count]) != 0)
+    {
+        fprintf(stderr, "无效地址: %s\n", name);
+        return -1;
+    }
+    load->tag_count++;
+    return 0;
+}
+
+static int add_tag_list(load_t* load, const char* list)
+{
+    char buffer[4096];
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    for (char* token = strtok(buffer, ", "); token; token = strtok(NULL, ", "))
+    {
+        if (add_tag(load, token) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int add_tag_file(load_t* load, const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "无法打开标签文件: %s\n", path);
+        return -1;
+    }
+
+    char line[256];
+    int result = 0;
+    while (result == 0 && fgets(line, sizeof(line), file))
+    {
+        char* name = line + strspn(line, " \t");
+        name[strcspn(name, " \t\r\n#")] = '\0';
+        if (*name)
+        {
+            result = add_tag(load, name);
+        }
+    }
+    fclose(file);
+    return result;
+}
+
+// 为模拟从站创建覆盖所有标签的数据文件
+static int setup_sim_files(df1_sim_t* sim, uint8_t station, const load_t* load)
+{
+    for (size_t i = 0; i < load->tag_count; i++)
+    {
+        const df1_address_t* addr = &load->tags[i];
+        bool seen = false;
+        size_t elements = 0;
+        for (size_t j = 0; j < load->tag_count; j++)
+        {
+            const df1_address_t* other = &load->tags[j];
+            if (other->data_code != addr->data_code || other->db_block != addr->db_block)
+            {
+                continue;
+            }
+            if (j < i)
+            {
+                seen = true;
+                break;
+            }
+            size_t end = (size_t)other->address_start + load->elements;
+            elements = end > elements ? end : elements;
+        }
+        if (!seen && df1_sim_add_file(sim, station, addr->data_code, addr->db_block, elements) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 每个字符在线路上的位数：起始位 + 数据位 + 校验位 + 停止位
+static int bits_per_char(const df1_serial_config_t* config)
+{
+    return 1 + config->data_bits + (config->parity ? 1 : 0) + config->stop_bits;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "用法: %s [选项] [端口]\n"
+            "  端口                  串口设备或 tcp://主机:端口，--sim 时省略\n"
+            "  --baud N              波特率（默认 19200），也用于计算线路占用率\n"
+            "  --drain               每次写入后等待发送完成\n"
+            "  --rs485               由驱动控制 RS-485 收发方向\n"
+            "  --half                半双工（默认全双工）\n"
+            "  --bcc                 BCC 校验（默认 CRC16）\n"
+            "  --station N --dst N --src N  站号与节点号（默认 1 1 0）\n"
+            "  --tags 列表           逗号分隔的标签，如 N7:0,N7:10,F8:0（默认 N7:0）\n"
+            "  --tag-file 文件       每行一个标签，# 之后为注释\n"
+            "  --elements N          每次读写的元素数（默认 1）\n"
+            "  --write-ratio R       写请求比例 0~1（默认 0）\n"
+            "  --depth N             同时在途的请求数（1~%d，默认 1；半双工一次只发送一条）\n"
+            "  --duration 秒         运行时间（默认 10）\n"
+            "  --count N             请求总数，达到后停止\n"
+            "  --timeout 毫秒        ACK 与响应超时（默认 1000）\n"
+            "  --seed N              读写选择的随机数种子\n"
+            "  --format text|json    输出格式\n"
+            "  --trace 文件          把线路收发写入抓包文件，用 df1trace 查看\n"
+            "  --sim                 使用内置模拟从站（伪终端）\n"
+            "  --sim-latency 微秒 --sim-jitter 微秒  模拟从站处理延迟\n"
+            "  --sim-drop R --sim-nak R --sim-corrupt R  模拟从站注入故障的概率\n",
+            program, LOAD_MAX_DEPTH);
+}
+
+int main(int argc, char* argv[])
+{
+    static load_t load;
+    const char* port_name = NULL;
+    df1_serial_config_t serial_config;
+    df1_config_t df1_config;
+    df1_sim_config_t sim_config;
+    output_format_t format = FORMAT_TEXT;
+    bool use_sim = false;
+    int depth = 1;
+    double duration = 10.0;
+    const char* trace_path = NULL;
+
+    df1_serial_config_default(&serial_config);
+    serial_config.timeout_ms = 1000;
+    df1_config_init(&df1_config, 1, 1, 0);
+    df1_config.duplex = DF1_FULL_DUPLEX;
+    df1_sim_config_default(&sim_config);
+    load.elements = 1;
+    load.rng = 0x2545F491;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (arg[0] != '-')
+        {
+            port_name = arg;
+            continue;
+        }
+        if (strcmp(arg, "--half") == 0)
+        {
+            df1_config.duplex = DF1_HALF_DUPLEX;
+            continue;
+        }
+        if (strcmp(arg, "--bcc") == 0)
+        {
+            df1_config.check_type = DF1_CHECK_BCC;
+            continue;
+        }
+        if (strcmp(arg, "--drain") == 0)
+        {
+            serial_config.drain = true;
+            continue;
+        }
+        if (strcmp(arg, "--rs485") == 0)
+        {
+            serial_config.rs485 = true;
+            continue;
+        }
+        if (strcmp(arg, "--sim") == 0)
+        {
+            use_sim = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--baud") == 0)
+            serial_config.baud_rate = atoi(value);
+        else if (strcmp(arg, "--station") == 0)
+            df1_config.station = (uint8_t)atoi(value);
+        else if (strcmp(arg, "--dst") == 0)
+            df1_config.dst_node = (uint8_t)atoi(value);
+        else if (strcmp(arg, "--src") == 0)
+            df1_config.src_node = (uint8_t)atoi(value);
+        else if (strcmp(arg, "--tags") == 0)
+        {
+            if (add_tag_list(&load, value) != 0)
+                return 1;
+        }
+        else if (strcmp(arg, "--tag-file") == 0)
+        {
+            if (add_tag_file(&load, value) != 0)
+                return 1;
+        }
+        else if (strcmp(arg, "--elements") == 0)
+            load.elements = (size_t)atoi(value);
+        else if (strcmp(arg, "--write-ratio") == 0)
+            load.write_ratio = atof(value);
+        else if (strcmp(arg, "--depth") == 0)
+            depth = atoi(value);
+        else if (strcmp(arg, "--duration") == 0)
+            duration = atof(value);
+        else if (strcmp(arg, "--count") == 0)
+            load.limit = strtoul(value, NULL, 10);
+        else if (strcmp(arg, "--timeout") == 0)
+            serial_config.timeout_ms = atoi(value);
+        else if (strcmp(arg, "--seed") == 0)
+            load.rng = (unsigned int)strtoul(value, NULL, 10) | 1u;
+        else if (strcmp(arg, "--format") == 0 && strcmp(value, "json") == 0)
+            format = FORMAT_JSON;
+        else if (strcmp(arg, "--format") == 0 && strcmp(value, "text") == 0)
+            format = FORMAT_TEXT;
+        else if (strcmp(arg, "--trace") == 0)
+            trace_path = value;
+        else if (strcmp(arg, "--sim-latency") == 0)
+            sim_config.latency_us = atoi(value);
+        else if (strcmp(arg, "--sim-jitter") == 0)
+            sim_config.jitter_us = atoi(value);
+        else if (strcmp(arg, "--sim-drop") == 0)
+            sim_config.drop_rate = atof(value);
+        else if (strcmp(arg, "--sim-nak") == 0)
+            sim_config.nak_rate = atof(value);
+        else if (strcmp(arg, "--sim-corrupt") == 0)
+            sim_config.corrupt_rate = atof(value);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((!port_name && !use_sim) || depth < 1 || depth > LOAD_MAX_DEPTH || load.elements < 1
+        || serial_config.baud_rate <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (load.tag_count == 0 && add_tag(&load, "N7:0") != 0)
+    {
+        return 1;
+    }
+
+    // 内置模拟从站：半双工按帧头站号、全双工按目标节点区分从站
+    df1_sim_t* sim = NULL;
+    if (use_sim)
+    {
+        uint8_t station = df1_config.duplex == DF1_HALF_DUPLEX ? df1_config.station : df1_config.dst_node;
+        sim_config.duplex = df1_config.duplex;
+        sim_config.check_type = df1_config.check_type;
+        sim = df1_sim_create(&sim_config);
+        if (!sim || df1_sim_add_station(sim, station) != 0 || setup_sim_files(sim, station, &load) != 0
+            || df1_sim_open_pty(sim) != 0 || df1_sim_start(sim) != 0)
+        {
+            fprintf(stderr, "启动模拟从站失败\n");
+            df1_sim_destroy(sim);
+            return 1;
+        }
+        port_name = df1_sim_port_name(sim);
+    }
+    snprintf(serial_config.port_name, sizeof(serial_config.port_name), "%s", port_name);
+
+    static counting_t counting;
+    df1_transport_t transport;
+    df1_transport_init(&transport);
+    df1_transport_init(&counting.inner);
+    if (df1_transport_open_auto(&counting.inner, &serial_config) != 0)
+    {
+        fprintf(stderr, "无法打开 %s\n", serial_config.port_name);
+        df1_sim_destroy(sim);
+        return 1;
+    }
+    counting.check_size = df1_config.check_type == DF1_CHECK_CRC16 ? 2 : 1;
+    transport.ops = &counting_ops;
+    transport.fd = counting.inner.fd;
+    transport.vmin = counting.inner.vmin;
+    transport.context = &counting;
+
+    df1_link_config_t link_config;
+    df1_link_config_default(&link_config, serial_config.timeout_ms);
+    link_config.max_outstanding = depth;
+
+    load.port = df1_serial_create();
+    load.loop = df1_loop_create();
+    if (!load.port || !load.loop || df1_serial_set_link_config(load.port, &link_config) != 0
+        || df1_serial_open_transport(load.port, &transport, &serial_config, &df1_config) != 0
+        || df1_loop_add(load.loop, load.port) != 0)
+    {
+        fprintf(stderr, "无法建立连接\n");
+        if (load.port && !load.port->is_open)
+        {
+            df1_transport_close(&counting.inner);
+        }
+        df1_loop_destroy(load.loop);
+        df1_serial_destroy(load.port);
+        df1_sim_destroy(sim);
+        return 1;
+    }
+
+    // 抓包挂在计数传输层上，记录连接实际收发的字节
+    df1_capture_t* capture = NULL;
+    if (trace_path)
+    {
+        capture = df1_capture_create(0);
+        if (!capture || df1_capture_open_file(capture, trace_path, &df1_config) != 0)
+        {
+            fprintf(stderr, "无法创建抓包文件: %s\n", trace_path);
+            df1_capture_destroy(capture);
+            df1_loop_destroy(load.loop);
+            df1_serial_destroy(load.port);
+            df1_sim_destroy(sim);
+            return 1;
+        }
+        df1_serial_set_capture(load.port, capture);
+    }
+
+    double start = now_seconds();
+    load.deadline = start + duration;
+    for (int i = 0; i < depth; i++)
+    {
+        load.slots[i].load = &load;
+        submit_next(&load, &load.slots[i]);
+    }
+    int result = 0;
+    while (df1_loop_pending(load.loop) > 0)
+    {
+        if (df1_loop_process(load.loop, 100) < 0)
+        {
+            result = -1;
+            break;
+        }
+        df1_capture_flush(capture);
+    }
+    double elapsed = now_seconds() - start;
+
+    // 汇总
+    size_t samples = load.completed < load.latency_capacity ? load.completed : load.latency_capacity;
+    double latency_sum = 0.0;
+    for (size_t i = 0; i < samples; i++)
+    {
+        latency_sum += load.latencies[i];
+    }
+    if (samples)
+    {
+        qsort(load.latencies, samples, sizeof(double), compare_double);
+    }
+    double mean = samples ? latency_sum / (double)samples : 0.0;
+    double p50 = percentile(load.latencies, samples, 0.50);
+    double p99 = percentile(load.latencies, samples, 0.99);
+    double p999 = percentile(load.latencies, samples, 0.999);
+    double max = samples ? load.latencies[samples - 1] : 0.0;
+
+    unsigned long ok = load.completed - load.failed;
+    double throughput = elapsed > 0.0 ? (double)ok / elapsed : 0.0;
+    unsigned long line_bytes = counting.tx_bytes + counting.rx_bytes;
+    int bits = bits_per_char(&serial_config);
+    double line_capacity = (double)serial_config.baud_rate / (double)bits; // 字节/秒
+    // 半双工线路收发共用，全双工按较忙的方向计算
+    double busy_bytes = df1_config.duplex == DF1_HALF_DUPLEX
+                            ? (double)line_bytes
+                            : (double)(counting.tx_bytes > counting.rx_bytes ? counting.tx_bytes : counting.rx_bytes);
+    double utilization = elapsed > 0.0 ? busy_bytes / elapsed / line_capacity : 0.0;
+    double bytes_per_request = load.completed ? busy_bytes / (double)load.completed : 0.0;
+    double line_limit = bytes_per_request > 0.0 ? line_capacity / bytes_per_request : 0.0;
+    unsigned long retries = counting.tx_scan.enq + counting.rx_scan.nak + counting.tx_scan.nak;
+    double error_rate = load.completed ? (double)load.failed / (double)load.completed : 0.0;
+    double retry_rate = load.completed ? (double)retries / (double)load.completed : 0.0;
+
+    if (format == FORMAT_JSON)
+    {
+        printf("{\"port\":\"%s\",\"duplex\":\"%s\",\"check\":\"%s\",\"baud\":%d,\"tags\":%zu,\"elements\":%zu,"
+               "\"depth\":%d,\"write_ratio\":%.3f,\"elapsed_s\":%.3f,\"requests\":%lu,\"ok\":%lu,\"failed\":%lu,"
+               "\"status_errors\":%lu,\"writes\":%lu,\"throughput_rps\":%.1f,\"data_bytes\":%lu,"
+               "\"latency_ms\":{\"mean\":%.3f,\"p50\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f},"
+               "\"tx_bytes\":%lu,\"rx_bytes\":%lu,\"bits_per_char\":%d,\"line_utilization\":%.4f,"
+               "\"line_limit_rps\":%.1f,\"ack_timeouts\":%lu,\"naks_received\":%lu,\"naks_sent\":%lu,"
+               "\"error_rate\":%.5f,\"retry_rate\":%.5f}\n",
+               serial_config.port_name, df1_config.duplex == DF1_HALF_DUPLEX ? "half" : "full",
+               df1_config.check_type == DF1_CHECK_CRC16 ? "crc16" : "bcc", serial_config.baud_rate, load.tag_count,
+               load.elements, depth, load.write_ratio, elapsed, load.completed, ok, load.failed, load.status_errors,
+               load.writes, throughput, load.data_bytes, mean, p50, p99, p999, max, counting.tx_bytes,
+               counting.rx_bytes, bits, utilization, line_limit, counting.tx_scan.enq, counting.rx_scan.nak,
+               counting.tx_scan.nak, error_rate, retry_rate);
+    }
+    else
+    {
+        printf("DF1 链路负载: %s（%s，%s），%zu 个标签 × %zu 元素，在途 %d，写比例 %.0f%%\n",
+               serial_config.port_name, df1_config.duplex == DF1_HALF_DUPLEX ? "半双工" : "全双工",
+               df1_config.check_type == DF1_CHECK_CRC16 ? "CRC16" : "BCC", load.tag_count, load.elements, depth,
+               load.write_ratio * 100.0);
+        printf("请求:   %lu 个，用时 %.2f 秒，成功 %lu，失败 %lu（%.3f%%，其中错误状态 %lu）\n", load.completed,
+               elapsed, ok, load.failed, error_rate * 100.0, load.status_errors);
+        printf("吞吐:   %.1f 请求/秒，%.1f 数据字节/秒\n", throughput,
+               elapsed > 0.0 ? (double)load.data_bytes / elapsed : 0.0);
+        printf("延迟:   平均 %.3f ms，p50 %.3f ms，p99 %.3f ms，p999 %.3f ms，最大 %.3f ms\n", mean, p50, p99, p999,
+               max);
+        printf("线路:   发送 %lu 字节，接收 %lu 字节，每请求 %.1f 字节\n", counting.tx_bytes, counting.rx_bytes,
+               bytes_per_request);
+        printf("        按 %d 波特（每字符 %d 位）占用 %.1f%%，线路饱和时约 %.1f 请求/秒",
+               serial_config.baud_rate, bits, utilization * 100.0, line_limit);
+        if (load.tag_count > 0 && line_limit > 0.0)
+        {
+            printf("，%zu 个标签全部扫描一遍约 %.1f ms", load.tag_count, (double)load.tag_count / line_limit * 1e3);
+        }
+        printf("\n");
+        printf("重试:   ACK 超时 %lu 次，收到 NAK %lu 次，发送 NAK %lu 次（每请求 %.3f%%）\n", counting.tx_scan.enq,
+               counting.rx_scan.nak, counting.tx_scan.nak, retry_rate * 100.0);
+    }
+
+    if (capture && df1_capture_dropped(capture) > 0)
+    {
+        fprintf(stderr, "抓包缓冲区满，丢弃 %lu 条记录\n", (unsigned long)df1_capture_dropped(capture));
+    }
+
+    df1_loop_destroy(load.loop);
+    df1_serial_close(load.port);
+    df1_serial_destroy(load.port);
+    df1_capture_destroy(capture);
+    df1_sim_destroy(sim);
+    free(load.latencies);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "df1_protocol.h"
+#include "df1_capture.h"
+
+// DF1 抓包文件解码器
+//
+// 读取 df1_capture 写出的抓包文件，每个方向用流式解码器切分出帧与链路控制字符，
+// 应答帧经 df1_parse_response 取出数据、按状态码给出错误描述，按时间顺序打印每个
+// 事件以及与上一事件的间隔，最后汇总各类事件的个数与最大间隔。
+
+// 一个方向的字节流
+typedef struct {
+    df1_decoder_t decoder;     // 流式解码器
+    uint8_t wire[DF1_MAX_FRAME_SIZE]; // 当前帧的线路字节（含转义），交给 df1_parse_response
+    size_t wire_length;        // 线路字节数
+    uint64_t first_ns;         // 当前帧第一个字节的时间
+} stream_t;
+
+// 汇总
+typedef struct {
+    unsigned long frames[2];   // 各方向的帧数
+    unsigned long acks[2];     // DLE ACK
+    unsigned long naks[2];     // DLE NAK
+    unsigned long enqs[2];     // DLE ENQ
+    unsigned long eots[2];     // DLE EOT
+    unsigned long bad[2];      // 校验错误或格式错误的帧
+    unsigned long status_errors; // 错误状态的应答
+    uint64_t max_gap_ns;       // 相邻事件的最大间隔
+} summary_t;
+
+// 已发送、尚未收到应答的命令，按事务ID低8位索引
+typedef struct {
+    uint64_t sent_ns;          // 第一次发送的时间
+    uint16_t tns;              // 事务ID
+    uint8_t function;          // 功能码（0x0F 命令的第一个数据字节，否则为命令字节）
+    bool used;                 // 是否在用
+} pending_t;
+
+typedef struct {
+    df1_trace_header_t header; // 文件头
+    stream_t streams[2];       // 发送、接收两个方向
+    summary_t summary;         // 汇总
+    pending_t pending[256];    // 等待应答的命令
+    uint64_t last_event_ns;    // 上一事件的时间
+    bool has_event;            // 是否已有事件
+    bool hex;                  // 打印数据字节
+    bool raw;                  // 打印每条原始记录
+} trace_t;
+
+static const char* function_name(uint8_t function)
+{
+    switch (function)
+    {
+    case DF1_CMD_READ:
+        return "读";
+    case DF1_CMD_WRITE:
+        return "写";
+    case DF1_CMD_MASK_WRITE:
+        return "掩码写";
+    default:
+        return "命令";
+    }
+}
+
+static void print_hex(const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        printf(" %02X", data[i]);
+    }
+}
+
+// 打印事件的时间列：相对文件开始的时间与距上一事件的间隔
+static void print_time(trace_t* trace, uint64_t timestamp_ns, df1_capture_dir_t direction)
+{
+    uint64_t gap = trace->has_event && timestamp_ns > trace->last_event_ns ? timestamp_ns - trace->last_event_ns : 0;
+    if (gap > trace->summary.max_gap_ns)
+    {
+        trace->summary.max_gap_ns = gap;
+    }
+    double time_ms = timestamp_ns >= trace->header.start_ns ? (double)(timestamp_ns - trace->header.start_ns) / 1e6 : 0.0;
+    printf("%12.3f ms  +%9.3f ms  %s  ", time_ms, (double)gap / 1e6, direction == DF1_CAPTURE_TX ? "TX" : "RX");
+    trace->last_event_ns = timestamp_ns;
+    trace->has_event = true;
+}
+
+static void print_frame(trace_t* trace, stream_t* stream, df1_capture_dir_t direction, uint64_t timestamp_ns,
+                        const df1_frame_t* frame)
+{
+    summary_t* summary = &trace->summary;
+    summary->frames[direction]++;
+    print_time(trace, timestamp_ns, direction);
+
+    if (frame->has_station)
+    {
+        printf("STN=%u ", frame->station);
+    }
+    bool reply = (frame->cmd & 0x40) != 0;
+    pending_t* pending = &trace->pending[frame->tns & 0xFF];
+
+    if (reply)
+    {
+        bool matched = pending->used && pending->tns == frame->tns;
+        printf("应答 %s %02X dst=%u src=%u tns=0x%04X", matched ? function_name(pending->function) : "命令",
+               frame->cmd, frame->dst, frame->src, frame->tns);
+
+        uint8_t data[DF1_MAX_PDU_SIZE];
+        size_t data_size = 0;
+        if (df1_parse_response(stream->wire, stream->wire_length, data, sizeof(data), &data_size) == 0)
+        {
+            printf(" 成功 数据 %zu 字节", data_size);
+            if (trace->hex)
+            {
+                print_hex(data, data_size);
+            }
+        }
+        else if (frame->sts != 0)
+        {
+            summary->status_errors++;
+            printf(" sts=%02X %s", frame->sts, df1_get_error_description(frame->sts));
+            if (frame->sts == 0xF0)
+            {
+                printf("（%s）", df1_get_ext_error_description(frame->ext_sts));
+            }
+        }
+        else
+        {
+            printf(" 数据 %zu 字节", frame->data_length);
+        }
+        if (matched)
+        {
+            printf("  往返 %.3f ms", (double)(timestamp_ns - pending->sent_ns) / 1e6);
+            pending->used = false;
+        }
+    }
+    else
+    {
+        uint8_t function = frame->cmd == 0x0F && frame->data_length > 0 ? frame->data[0] : frame->cmd;
+        printf("%s %02X dst=%u src=%u tns=0x%04X 数据 %zu 字节", function_name(function), frame->cmd, frame->dst,
+               frame->src, frame->tns, frame->data_length);
+        if (trace->hex)
+        {
+            print_hex(frame->data, frame->data_length);
+        }
+        // 重发的命令保留第一次发送的时间
+        if (!pending->used || pending->tns != frame->tns)
+        {
+            pending->sent_ns = timestamp_ns;
+            pending->tns = frame->tns;
+            pending->function = function;
+            pending->used = true;
+        }
+    }
+
+    if (timestamp_ns > stream->first_ns)
+    {
+        printf("  (帧 %.3f ms)", (double)(timestamp_ns - stream->first_ns) / 1e6);
+    }
+    printf("\n");
+}
+
+static void print_event(trace_t* trace, df1_capture_dir_t direction, uint64_t timestamp_ns, int result)
+{
+    summary_t* summary = &trace->summary;
+    const char* name = NULL;
+    switch (result)
+    {
+    case DF1_DECODE_ACK:
+        summary->acks[direction]++;
+        name = "DLE ACK";
+        break;
+    case DF1_DECODE_NAK:
+        summary->naks[direction]++;
+        name = "DLE NAK";
+        break;
+    case DF1_DECODE_ENQ:
+        summary->enqs[direction]++;
+        name = "DLE ENQ";
+        break;
+    case DF1_DECODE_EOT:
+        summary->eots[direction]++;
+        name = "DLE EOT";
+        break;
+    case DF1_DECODE_BAD_CHECKSUM:
+        summary->bad[direction]++;
+        name = "帧校验错误";
+        break;
+    case DF1_DECODE_OVERFLOW:
+        summary->bad[direction]++;
+        name = "帧过长";
+        break;
+    default:
+        summary->bad[direction]++;
+        name = "帧格式错误";
+        break;
+    }
+    print_time(trace, timestamp_ns, direction);
+    printf("%s\n", name);
+}
+
+// 把一条记录输入对应方向的解码器
+static void process_record(trace_t* trace, const df1_trace_record_t* record)
+{
+    stream_t* stream = &trace->streams[record->direction];
+
+    if (trace->raw)
+    {
+        printf("%12s     %-12s %s  记录 %zu 字节:", "", "", record->direction == DF1_CAPTURE_TX ? "TX" : "RX",
+               record->size);
+        print_hex(record->data, record->size);
+        printf("\n");
+    }
+
+    size_t offset = 0;
+    while (offset < record->size)
+    {
+        size_t consumed = 0;
+        df1_frame_t frame;
+        int result = df1_decoder_push(&stream->decoder, record->data + offset, record->size - offset, &consumed, &frame);
+
+        if (stream->wire_length == 0 && consumed > 0)
+        {
+            stream->first_ns = record->timestamp_ns;
+        }
+        size_t room = sizeof(stream->wire) - stream->wire_length;
+        size_t copy = consumed < room ? consumed : room;
+        memcpy(stream->wire + stream->wire_length, record->data + offset, copy);
+        stream->wire_length += copy;
+        offset += consumed;
+
+        if (result == DF1_DECODE_NEED_MORE)
+        {
+            if (consumed == 0)
+            {
+                break;
+            }
+            continue;
+        }
+
+        if (result == DF1_DECODE_FRAME)
+        {
+            print_frame(trace, stream, record->direction, record->timestamp_ns, &frame);
+            stream->wire_length = 0;
+        }
+        else if (result >= DF1_DECODE_ACK)
+        {
+            // 控制字符可能嵌在帧中间，只去掉它本身，保留正在接收的帧
+            print_event(trace, record->direction, record->timestamp_ns, result);
+            stream->wire_length = stream->wire_length >= 2 ? stream->wire_length - 2 : 0;
+        }
+        else
+        {
+            print_event(trace, record->direction, record->timestamp_ns, result);
+            stream->wire_length = 0;
+        }
+    }
+}
+
+static void print_summary(const trace_t* trace, unsigned long records)
+{
+    const summary_t* summary = &trace->summary;
+    printf("\n记录 %lu 条，最大间隔 %.3f ms\n", records, (double)summary->max_gap_ns / 1e6);
+    for (int direction = DF1_CAPTURE_TX; direction <= DF1_CAPTURE_RX; direction++)
+    {
+        printf("%s: 帧 %lu，ACK %lu，NAK %lu，ENQ %lu，EOT %lu，错误帧 %lu\n", direction == DF1_CAPTURE_TX ? "TX" : "RX",
+               summary->frames[direction], summary->acks[direction], summary->naks[direction],
+               summary->enqs[direction], summary->eots[direction], summary->bad[direction]);
+    }
+    printf("错误状态的应答 %lu\n", summary->status_errors);
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "用法: %s [选项] 抓包文件\n"
+            "  --hex                 打印命令与应答的数据字节\n"
+            "  --raw                 同时打印每条原始收发记录\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    static trace_t trace;
+    static df1_trace_record_t record;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--hex") == 0)
+            trace.hex = true;
+        else if (strcmp(argv[i], "--raw") == 0)
+            trace.raw = true;
+        else if (argv[i][0] != '-' && !path)
+            path = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "无法打开 %s\n", path);
+        return 1;
+    }
+    if (df1_trace_read_header(file, &trace.header) != 0)
+    {
+        fprintf(stderr, "%s 不是抓包文件或版本不支持\n", path);
+        fclose(file);
+        return 1;
+    }
+    df1_decoder_init(&trace.streams[DF1_CAPTURE_TX].decoder, trace.header.check_type);
+    df1_decoder_init(&trace.streams[DF1_CAPTURE_RX].decoder, trace.header.check_type);
+
+    time_t start = (time_t)(trace.header.start_realtime_ns / 1000000000ull);
+    char start_text[64];
+    strftime(start_text, sizeof(start_text), "%Y-%m-%d %H:%M:%S", localtime(&start));
+    printf("%s：%s，%s，开始于 %s\n\n", path, trace.header.duplex == DF1_FULL_DUPLEX ? "全双工" : "半双工",
+           trace.header.check_type == DF1_CHECK_CRC16 ? "CRC16" : "BCC", start_text);
+
+    unsigned long records = 0;
+    int result;
+    while ((result = df1_trace_read_record(file, &record)) == 1)
+    {
+        process_record(&trace, &record);
+        records++;
+    }
+    fclose(file);
+
+    print_summary(&trace, records);
+    if (result < 0)
+    {
+        fprintf(stderr, "抓包文件在第 %lu 条记录之后损坏\n", records);
+        return 1;
+    }
+    return 0;
+}